@@ -116,6 +116,16 @@ void Application::RegisterMcpTools() {
     PersonalityEvolver::GetInstance().Init();
     RegisterMemoryMcpTools(mcp_server);
 
+    // Memory writes are batched (write-behind); flush them once the assistant
+    // finishes speaking so a whole LLM turn costs a single commit
+    state_machine_.AddStateChangeListener([this](DeviceState old_state, DeviceState new_state) {
+        if (old_state == kDeviceStateSpeaking) {
+            Schedule([]() {
+                MemoryStorage::GetInstance().Flush();
+            });
+        }
+    });
+
     // Register pet MCP tools
     RegisterPetMcpTools(mcp_server);
 
@@ -316,11 +326,7 @@ void Application::Run() {
         }
 
         if (bits & MAIN_EVENT_SEND_AUDIO) {
-            while (auto packet = audio_service_.PopPacketFromSendQueue()) {
-                if (protocol_ && !protocol_->SendAudio(std::move(packet))) {
-                    break;
-                }
-            }
+            SendQueuedAudio();
         }
 
         if (bits & MAIN_EVENT_WAKE_WORD_DETECTED) {
@@ -356,6 +362,11 @@ void Application::Run() {
             // Check coin reward timer every second
             CoinSystem::GetInstance().CheckRewardTimer();
 
+            // Flush batched memory writes past their deadline (deferred while speaking)
+            if (GetDeviceState() != kDeviceStateSpeaking) {
+                MemoryStorage::GetInstance().FlushIfDue();
+            }
+
             // Update pet state periodically
             if (clock_ticks_ % PET_STATE_UPDATE_INTERVAL_SECS == 0) {
                 ESP_LOGI(TAG, "Pet state update tick (clock=%lu)", (unsigned long)clock_ticks_);
@@ -408,6 +419,36 @@ void Application::Run() {
     }
 }
 
+// Send everything in the audio send queue. A frame that is alone in the queue goes out
+// at once; frames that piled up (wake word pre-roll, main task busy, slow link) are
+// packed into one message when the server accepted audio batching, so the batch
+// size follows the queue depth and no frame is held back waiting for company
+void Application::SendQueuedAudio() {
+    std::unique_ptr<AudioStreamPacket> batch[AUDIO_BATCH_MAX_FRAMES];
+    std::unique_ptr<AudioStreamPacket> next = audio_service_.PopPacketFromSendQueue();
+    while (next) {
+        if (!protocol_) {
+            next = audio_service_.PopPacketFromSendQueue();
+            continue;
+        }
+        size_t max_frames = protocol_->audio_batch_frames();
+        size_t count = 0;
+        size_t bytes = 0;
+        while (next && count < max_frames) {
+            size_t size = next->payload.size() + AUDIO_BATCH_ENTRY_SIZE;
+            if (count > 0 && bytes + size > AUDIO_BATCH_MAX_BYTES) {
+                break;  // Starts the next batch
+            }
+            bytes += size;
+            batch[count++] = std::move(next);
+            next = audio_service_.PopPacketFromSendQueue();
+        }
+        if (!protocol_->SendAudioBatch(batch, count)) {
+            break;
+        }
+    }
+}
+
 void Application::HandleNetworkConnectedEvent() {
     ESP_LOGI(TAG, "Network connected");
     auto state = GetDeviceState();
@@ -707,155 +748,18 @@ void Application::InitializeProtocol() {
         });
     });
     
+    protocol_->OnIncomingMessage([this](const ServerMessage& message) {
+        HandleServerMessage(message);
+    });
+
+    // mcp and custom messages carry nested JSON and still arrive as a cJSON tree
     protocol_->OnIncomingJson([this, display](const cJSON* root) {
-        // Parse JSON data
         auto type = cJSON_GetObjectItem(root, "type");
-        if (strcmp(type->valuestring, "tts") == 0) {
-            auto state = cJSON_GetObjectItem(root, "state");
-            if (strcmp(state->valuestring, "start") == 0) {
-                Schedule([this]() {
-                    if (aborted_) {
-                        // 忽略这个TTS start，因为用户已经中止了讲话
-                        // 清除标志为下次对话做准备
-                        ESP_LOGI(TAG, "Ignoring TTS start (speaking was aborted)");
-                        aborted_ = false;
-                        return;
-                    }
-                    SetDeviceState(kDeviceStateSpeaking);
-                });
-            } else if (strcmp(state->valuestring, "stop") == 0) {
-                // 等待音频播放完成后再切换状态，避免 ResetDecoder() 清空队列导致 TTS 中断
-                Schedule([this]() {
-                    if (GetDeviceState() != kDeviceStateSpeaking) {
-                        return;
-                    }
-
-                    // 金币奖励和对话结束事件立即触发，不依赖音频播放完成
-                    ESP_LOGI("Application", "TTS stop received, triggering conversation end events");
-                    PetStateMachine::GetInstance().OnConversationEnd();
-                    CoinSystem::GetInstance().OnChatMessage();
-
-                    // 将长期记忆处理移到后台任务，避免阻塞主线程
-                    xTaskCreate([](void* arg) {
-                        ESP_LOGI("Application", "Background: Processing long-term memory...");
-                        ConversationManager::GetInstance().CheckAndProcess();
-                        ESP_LOGI("Application", "Background: Long-term memory processing complete");
-                        vTaskDelete(nullptr);
-                    }, "long_term_mem", 4096, nullptr, 5, nullptr);
-
-                    // 启动后台任务等待音频播放完成后再切换设备状态
-                    xTaskCreate([](void* arg) {
-                        auto app = static_cast<Application*>(arg);
-                        // 等待播放队列清空（最多等待5秒，避免卡住）
-                        int wait_count = 0;
-                        constexpr int kMaxWaitMs = 5000;
-                        constexpr int kCheckIntervalMs = 50;
-                        constexpr int kMaxWaitCount = kMaxWaitMs / kCheckIntervalMs;
-                        while (!app->audio_service_.IsPlaybackIdle() && wait_count < kMaxWaitCount) {
-                            vTaskDelay(pdMS_TO_TICKS(kCheckIntervalMs));
-                            wait_count++;
-                        }
-
-                        // 检查是否超时
-                        bool timed_out = (wait_count >= kMaxWaitCount);
-                        if (timed_out) {
-                            ESP_LOGW("Application", "Audio playback wait timed out after %d ms, forcing queue clear", kMaxWaitMs);
-                            // 超时则强制清空队列，避免卡住
-                            app->audio_service_.ResetDecoder();
-                        }
-
-                        // 音频播放完成（或超时），切换设备状态
-                        app->Schedule([app, timed_out]() {
-                            auto current_state = app->GetDeviceState();
-                            if (current_state != kDeviceStateSpeaking) {
-                                ESP_LOGW("Application", "State changed during wait (now %d), skipping state switch", current_state);
-                                return;  // 状态已改变，不再处理
-                            }
-                            ESP_LOGI("Application", "Audio playback %s, switching state", timed_out ? "timed out" : "finished");
-                            if (app->listening_mode_ == kListeningModeManualStop ||
-                                PetStateMachine::GetInstance().IsInContinuousRecovery()) {
-                                app->SetDeviceState(kDeviceStateIdle);
-                            } else {
-                                app->SetDeviceState(kDeviceStateListening);
-                            }
-                        });
-                        vTaskDelete(nullptr);
-                    }, "tts_wait", 2048, this, 5, nullptr);
-                });
-            } else if (strcmp(state->valuestring, "sentence_start") == 0) {
-                auto text = cJSON_GetObjectItem(root, "text");
-                if (cJSON_IsString(text)) {
-                    std::string message = text->valuestring;
-                    uint64_t now = esp_timer_get_time() / 1000;
-
-                    // 去重检查：10秒内的相同消息忽略
-                    if (message == last_sentence_text_ &&
-                        now - last_sentence_time_ < DUPLICATE_MESSAGE_THRESHOLD_MS) {
-                        ESP_LOGW(TAG, "Ignoring duplicate sentence_start (repeated within %llu ms)",
-                                 now - last_sentence_time_);
-                        return;
-                    }
-
-                    // 更新缓存
-                    last_sentence_text_ = message;
-                    last_sentence_time_ = now;
-
-                    ESP_LOGI(TAG, "<< %s", text->valuestring);
-                    Schedule([this, display, message]() {
-                        display->SetChatMessage("assistant", message.c_str());
-                        // Add to conversation memory
-                        ConversationManager::GetInstance().AddMessage("assistant", message.c_str());
-                        PersonalityEvolver::GetInstance().AddMessageCount(1);
-                    });
-                }
-            }
-        } else if (strcmp(type->valuestring, "stt") == 0) {
-            auto text = cJSON_GetObjectItem(root, "text");
-            if (cJSON_IsString(text)) {
-                ESP_LOGI(TAG, ">> %s", text->valuestring);
-                Schedule([this, display, message = std::string(text->valuestring)]() {
-                    display->SetChatMessage("user", message.c_str());
-                    // Add to conversation memory
-                    ConversationManager::GetInstance().AddMessage("user", message.c_str());
-                    PersonalityEvolver::GetInstance().AddMessageCount(1);
-                    // 追踪对话消息数（用于动态奖励）
-                    PetStateMachine::GetInstance().OnSessionMessage();
-                });
-            }
-        } else if (strcmp(type->valuestring, "llm") == 0) {
-            auto emotion = cJSON_GetObjectItem(root, "emotion");
-            if (cJSON_IsString(emotion)) {
-                Schedule([this, display, emotion_str = std::string(emotion->valuestring)]() {
-                    display->SetEmotion(emotion_str.c_str());
-                });
-            }
-        } else if (strcmp(type->valuestring, "mcp") == 0) {
+        if (strcmp(type->valuestring, "mcp") == 0) {
             auto payload = cJSON_GetObjectItem(root, "payload");
             if (cJSON_IsObject(payload)) {
                 McpServer::GetInstance().ParseMessage(payload);
             }
-        } else if (strcmp(type->valuestring, "system") == 0) {
-            auto command = cJSON_GetObjectItem(root, "command");
-            if (cJSON_IsString(command)) {
-                ESP_LOGI(TAG, "System command: %s", command->valuestring);
-                if (strcmp(command->valuestring, "reboot") == 0) {
-                    // Do a reboot if user requests a OTA update
-                    Schedule([this]() {
-                        Reboot();
-                    });
-                } else {
-                    ESP_LOGW(TAG, "Unknown system command: %s", command->valuestring);
-                }
-            }
-        } else if (strcmp(type->valuestring, "alert") == 0) {
-            auto status = cJSON_GetObjectItem(root, "status");
-            auto message = cJSON_GetObjectItem(root, "message");
-            auto emotion = cJSON_GetObjectItem(root, "emotion");
-            if (cJSON_IsString(status) && cJSON_IsString(message) && cJSON_IsString(emotion)) {
-                Alert(status->valuestring, message->valuestring, emotion->valuestring, Lang::Sounds::OGG_VIBRATION);
-            } else {
-                ESP_LOGW(TAG, "Alert command requires status, message and emotion");
-            }
 #if CONFIG_RECEIVE_CUSTOM_MESSAGE
         } else if (strcmp(type->valuestring, "custom") == 0) {
             auto payload = cJSON_GetObjectItem(root, "payload");
@@ -876,6 +780,175 @@ void Application::InitializeProtocol() {
     protocol_->Start();
 }
 
+void Application::HandleServerMessage(const ServerMessage& message) {
+    // Indexed by ServerMessageType. hello and goodbye are handled by the protocol,
+    // mcp and custom come through OnIncomingJson()
+    static void (Application::* const handlers[kServerMessageTypeCount])(const ServerMessage&) = {
+        nullptr,                            // kServerMessageUnknown
+        nullptr,                            // kServerMessageHello
+        nullptr,                            // kServerMessageGoodbye
+        &Application::HandleTtsMessage,
+        &Application::HandleSttMessage,
+        &Application::HandleLlmMessage,
+        nullptr,                            // kServerMessageMcp
+        &Application::HandleSystemMessage,
+        &Application::HandleAlertMessage,
+        nullptr,                            // kServerMessageCustom
+    };
+    auto handler = handlers[message.type];
+    if (handler == nullptr) {
+        ESP_LOGW(TAG, "Unknown message type: %s", message.type_name.c_str());
+        return;
+    }
+    (this->*handler)(message);
+}
+
+void Application::HandleTtsMessage(const ServerMessage& message) {
+    if (message.state == "start") {
+        Schedule([this]() {
+            if (aborted_) {
+                // 忽略这个TTS start，因为用户已经中止了讲话
+                // 清除标志为下次对话做准备
+                ESP_LOGI(TAG, "Ignoring TTS start (speaking was aborted)");
+                aborted_ = false;
+                return;
+            }
+            SetDeviceState(kDeviceStateSpeaking);
+        });
+    } else if (message.state == "stop") {
+        // 等待音频播放完成后再切换状态，避免 ResetDecoder() 清空队列导致 TTS 中断
+        Schedule([this]() {
+            if (GetDeviceState() != kDeviceStateSpeaking) {
+                return;
+            }
+
+            // 金币奖励和对话结束事件立即触发，不依赖音频播放完成
+            ESP_LOGI("Application", "TTS stop received, triggering conversation end events");
+            PetStateMachine::GetInstance().OnConversationEnd();
+            CoinSystem::GetInstance().OnChatMessage();
+
+            // 将长期记忆处理移到后台任务，避免阻塞主线程
+            xTaskCreate([](void* arg) {
+                ESP_LOGI("Application", "Background: Processing long-term memory...");
+                ConversationManager::GetInstance().CheckAndProcess();
+                ESP_LOGI("Application", "Background: Long-term memory processing complete");
+                vTaskDelete(nullptr);
+            }, "long_term_mem", 4096, nullptr, 5, nullptr);
+
+            // 启动后台任务等待音频播放完成后再切换设备状态
+            xTaskCreate([](void* arg) {
+                auto app = static_cast<Application*>(arg);
+                // 等待播放队列清空（最多等待5秒，避免卡住）
+                int wait_count = 0;
+                constexpr int kMaxWaitMs = 5000;
+                constexpr int kCheckIntervalMs = 50;
+                constexpr int kMaxWaitCount = kMaxWaitMs / kCheckIntervalMs;
+                while (!app->audio_service_.IsPlaybackIdle() && wait_count < kMaxWaitCount) {
+                    vTaskDelay(pdMS_TO_TICKS(kCheckIntervalMs));
+                    wait_count++;
+                }
+
+                // 检查是否超时
+                bool timed_out = (wait_count >= kMaxWaitCount);
+                if (timed_out) {
+                    ESP_LOGW("Application", "Audio playback wait timed out after %d ms, forcing queue clear", kMaxWaitMs);
+                    // 超时则强制清空队列，避免卡住
+                    app->audio_service_.ResetDecoder();
+                }
+
+                // 音频播放完成（或超时），切换设备状态
+                app->Schedule([app, timed_out]() {
+                    auto current_state = app->GetDeviceState();
+                    if (current_state != kDeviceStateSpeaking) {
+                        ESP_LOGW("Application", "State changed during wait (now %d), skipping state switch", current_state);
+                        return;  // 状态已改变，不再处理
+                    }
+                    ESP_LOGI("Application", "Audio playback %s, switching state", timed_out ? "timed out" : "finished");
+                    if (app->listening_mode_ == kListeningModeManualStop ||
+                        PetStateMachine::GetInstance().IsInContinuousRecovery()) {
+                        app->SetDeviceState(kDeviceStateIdle);
+                    } else {
+                        app->SetDeviceState(kDeviceStateListening);
+                    }
+                });
+                vTaskDelete(nullptr);
+            }, "tts_wait", 2048, this, 5, nullptr);
+        });
+    } else if (message.state == "sentence_start" && !message.text.empty()) {
+        uint64_t now = esp_timer_get_time() / 1000;
+
+        // 去重检查：10秒内的相同消息忽略
+        if (message.text == last_sentence_text_ &&
+            now - last_sentence_time_ < DUPLICATE_MESSAGE_THRESHOLD_MS) {
+            ESP_LOGW(TAG, "Ignoring duplicate sentence_start (repeated within %llu ms)",
+                     now - last_sentence_time_);
+            return;
+        }
+
+        // 更新缓存
+        last_sentence_text_ = message.text;
+        last_sentence_time_ = now;
+
+        ESP_LOGI(TAG, "<< %s", message.text.c_str());
+        Schedule([text = message.text]() {
+            auto display = Board::GetInstance().GetDisplay();
+            display->SetChatMessage("assistant", text.c_str());
+            // Add to conversation memory
+            ConversationManager::GetInstance().AddMessage("assistant", text.c_str());
+            PersonalityEvolver::GetInstance().AddMessageCount(1);
+        });
+    }
+}
+
+void Application::HandleSttMessage(const ServerMessage& message) {
+    if (message.text.empty()) {
+        return;
+    }
+    ESP_LOGI(TAG, ">> %s", message.text.c_str());
+    Schedule([text = message.text]() {
+        auto display = Board::GetInstance().GetDisplay();
+        display->SetChatMessage("user", text.c_str());
+        // Add to conversation memory
+        ConversationManager::GetInstance().AddMessage("user", text.c_str());
+        PersonalityEvolver::GetInstance().AddMessageCount(1);
+        // 追踪对话消息数（用于动态奖励）
+        PetStateMachine::GetInstance().OnSessionMessage();
+    });
+}
+
+void Application::HandleLlmMessage(const ServerMessage& message) {
+    if (message.emotion.empty()) {
+        return;
+    }
+    Schedule([emotion = message.emotion]() {
+        auto display = Board::GetInstance().GetDisplay();
+        display->SetEmotion(emotion.c_str());
+    });
+}
+
+void Application::HandleSystemMessage(const ServerMessage& message) {
+    if (message.command.empty()) {
+        return;
+    }
+    ESP_LOGI(TAG, "System command: %s", message.command.c_str());
+    if (message.command == "reboot") {
+        // Do a reboot if user requests a OTA update
+        Schedule([this]() {
+            Reboot();
+        });
+    } else {
+        ESP_LOGW(TAG, "Unknown system command: %s", message.command.c_str());
+    }
+}
+
+void Application::HandleAlertMessage(const ServerMessage& message) {
+    if (message.status.empty() || message.message.empty() || message.emotion.empty()) {
+        ESP_LOGW(TAG, "Alert command requires status, message and emotion");
+        return;
+    }
+    Alert(message.status.c_str(), message.message.c_str(), message.emotion.c_str(), Lang::Sounds::OGG_VIBRATION);
+}
+
 void Application::ShowActivationCode(const std::string& code, const std::string& message) {
     struct digit_sound {
         char digit;
@@ -1171,6 +1244,9 @@ void Application::Reboot() {
     protocol_.reset();
     audio_service_.Stop();
 
+    // Persist batched memory writes before restarting
+    MemoryStorage::GetInstance().Flush();
+
     vTaskDelay(pdMS_TO_TICKS(1000));
     esp_restart();
 }
@@ -1199,6 +1275,7 @@ bool Application::UpgradeFirmware(const std::string& url, const std::string& ver
 
     board.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
     audio_service_.Stop();
+    MemoryStorage::GetInstance().Flush();
     vTaskDelay(pdMS_TO_TICKS(1000));
 
     bool upgrade_success = Ota::Upgrade(upgrade_url, [display](int progress, size_t speed) {
@@ -156,6 +156,7 @@ private:
 
     // Event handlers
     void HandleStateChangedEvent();
+    void SendQueuedAudio();
     void HandleToggleChatEvent();
     void HandleStartListeningEvent();
     void HandleStopListeningEvent();
@@ -164,6 +165,15 @@ private:
     void HandleActivationDoneEvent();
     void HandleWakeWordDetectedEvent();
 
+    // Server control messages, called on the protocol's task. HandleServerMessage()
+    // dispatches on the message type through a table of the handlers below
+    void HandleServerMessage(const ServerMessage& message);
+    void HandleTtsMessage(const ServerMessage& message);
+    void HandleSttMessage(const ServerMessage& message);
+    void HandleLlmMessage(const ServerMessage& message);
+    void HandleSystemMessage(const ServerMessage& message);
+    void HandleAlertMessage(const ServerMessage& message);
+
     // Activation task (runs in background)
     void ActivationTask();
 
@@ -0,0 +1,205 @@
+#include "audio_buffer_pool.h"
+
+#include <esp_log.h>
+#include <new>
+
+#define TAG "AudioBufferPool"
+
+// ============== FixedBlockPool ==============
+
+void FixedBlockPool::Initialize(size_t block_size, size_t count) {
+    if (slab_ != nullptr) {
+        return;
+    }
+    // Keep every block aligned for any object type
+    block_size_ = (block_size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    slab_ = static_cast<uint8_t*>(::operator new(block_size_ * count, std::nothrow));
+    if (slab_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate slab of %u x %u bytes", (unsigned)count, (unsigned)block_size_);
+        return;
+    }
+    count_ = count;
+    free_.reserve(count);
+    for (size_t i = count; i > 0; i--) {
+        free_.push_back(slab_ + (i - 1) * block_size_);
+    }
+}
+
+void* FixedBlockPool::Allocate(size_t size, uint32_t& fallbacks) {
+    if (size <= block_size_ && !free_.empty()) {
+        void* ptr = free_.back();
+        free_.pop_back();
+        in_use_++;
+        return ptr;
+    }
+    fallbacks++;
+    return nullptr;
+}
+
+void FixedBlockPool::Free(void* ptr) {
+    in_use_--;
+    free_.push_back(ptr);
+}
+
+// ============== AudioBufferPool ==============
+
+void AudioBufferPool::Initialize(size_t pcm_samples, size_t task_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (initialized_) {
+        return;
+    }
+    initialized_ = true;
+    pcm_samples_ = pcm_samples;
+
+    pcm_free_.reserve(AUDIO_POOL_PCM_FRAMES);
+    for (int i = 0; i < AUDIO_POOL_PCM_FRAMES; i++) {
+        std::vector<int16_t> pcm;
+        pcm.reserve(pcm_samples);
+        pcm_free_.push_back(std::move(pcm));
+    }
+    opus_free_.reserve(AUDIO_POOL_OPUS_PACKETS);
+    for (int i = 0; i < AUDIO_POOL_OPUS_PACKETS; i++) {
+        std::vector<uint8_t> opus;
+        opus.reserve(AUDIO_POOL_OPUS_BYTES);
+        opus_free_.push_back(std::move(opus));
+    }
+    packets_.Initialize(sizeof(AudioStreamPacket), AUDIO_POOL_PACKET_OBJECTS);
+    tasks_.Initialize(task_size, AUDIO_POOL_TASK_OBJECTS);
+
+    ESP_LOGI(TAG, "Pool ready: %d PCM frames x %u samples, %d Opus buffers x %d bytes",
+        AUDIO_POOL_PCM_FRAMES, (unsigned)pcm_samples, AUDIO_POOL_OPUS_PACKETS, AUDIO_POOL_OPUS_BYTES);
+}
+
+std::vector<int16_t> AudioBufferPool::AcquirePcm() {
+    std::vector<int16_t> pcm;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pcm_free_.empty()) {
+            pcm = std::move(pcm_free_.back());
+            pcm_free_.pop_back();
+            pcm.clear();
+            return pcm;
+        }
+        allocations_++;
+    }
+    pcm.reserve(pcm_samples_);
+    return pcm;
+}
+
+void AudioBufferPool::ReleasePcm(std::vector<int16_t>&& pcm) {
+    if (pcm.capacity() == 0) {
+        return;
+    }
+    std::vector<int16_t> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pcm_free_.size() < AUDIO_POOL_PCM_FRAMES) {
+        pcm_free_.push_back(std::move(pcm));
+    } else {
+        // Pool is full (buffer came from a fallback); free it after unlocking
+        dropped = std::move(pcm);
+    }
+}
+
+std::vector<uint8_t> AudioBufferPool::AcquireOpus() {
+    std::vector<uint8_t> opus;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!opus_free_.empty()) {
+            opus = std::move(opus_free_.back());
+            opus_free_.pop_back();
+            opus.clear();
+            return opus;
+        }
+        allocations_++;
+    }
+    opus.reserve(AUDIO_POOL_OPUS_BYTES);
+    return opus;
+}
+
+void AudioBufferPool::ReleaseOpus(std::vector<uint8_t>&& opus) {
+    if (opus.capacity() == 0) {
+        return;
+    }
+    std::vector<uint8_t> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (opus_free_.size() < AUDIO_POOL_OPUS_PACKETS) {
+        opus_free_.push_back(std::move(opus));
+    } else {
+        dropped = std::move(opus);
+    }
+}
+
+std::unique_ptr<AudioStreamPacket> AudioBufferPool::AcquirePacket() {
+    auto packet = std::make_unique<AudioStreamPacket>();
+    packet->payload = AcquireOpus();
+    return packet;
+}
+
+void* AudioBufferPool::AllocatePacket(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        void* ptr = packets_.Allocate(size, allocations_);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+    }
+    return ::operator new(size);
+}
+
+void AudioBufferPool::FreePacket(void* ptr) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (packets_.Owns(ptr)) {
+            packets_.Free(ptr);
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+void* AudioBufferPool::AllocateTask(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        void* ptr = tasks_.Allocate(size, allocations_);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+    }
+    return ::operator new(size);
+}
+
+void AudioBufferPool::FreeTask(void* ptr) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tasks_.Owns(ptr)) {
+            tasks_.Free(ptr);
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+AudioPoolStats AudioBufferPool::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AudioPoolStats stats;
+    stats.allocations = allocations_;
+    stats.pcm_free = pcm_free_.size();
+    stats.opus_free = opus_free_.size();
+    stats.packets_in_use = packets_.InUse();
+    stats.tasks_in_use = tasks_.InUse();
+    return stats;
+}
+
+// ============== AudioStreamPacket ==============
+
+AudioStreamPacket::~AudioStreamPacket() {
+    AudioBufferPool::GetInstance().ReleaseOpus(std::move(payload));
+}
+
+void* AudioStreamPacket::operator new(size_t size) {
+    return AudioBufferPool::GetInstance().AllocatePacket(size);
+}
+
+void AudioStreamPacket::operator delete(void* ptr) {
+    AudioBufferPool::GetInstance().FreePacket(ptr);
+}
@@ -0,0 +1,119 @@
+#ifndef AUDIO_BUFFER_POOL_H
+#define AUDIO_BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "protocol.h"
+
+/*
+ * Recycled buffers for the 60 ms audio frames that flow through AudioService.
+ *
+ * Every frame used to allocate an AudioTask, an AudioStreamPacket, their PCM /
+ * Opus vectors and a few scratch vectors, which fragments the internal heap on
+ * small chips. Instead:
+ * - PCM frames and Opus payloads are std::vectors reserved once in Initialize()
+ *   and handed back and forth (the Opus and AFE components take std::vector).
+ * - AudioStreamPacket and AudioTask objects come from fixed slabs through their
+ *   class operator new / delete, and return their buffers when destroyed.
+ *
+ * When a pool is empty the caller gets a fresh heap buffer instead; each such
+ * fallback is counted in GetStats().allocations (steady state should be 0).
+ */
+
+#define AUDIO_POOL_PCM_FRAMES       8       // Encode + playback queues + in-flight frames
+#define AUDIO_POOL_OPUS_PACKETS     24
+#define AUDIO_POOL_OPUS_BYTES       320     // 60 ms Opus frame, grows on demand
+#define AUDIO_POOL_PACKET_OBJECTS   48      // Decode + send queues
+#define AUDIO_POOL_TASK_OBJECTS     12
+#define AUDIO_POOL_SERVER_SAMPLE_RATE 24000 // Default decoder rate before resampling
+
+struct AudioPoolStats {
+    uint32_t allocations = 0;       // Heap fallbacks because a pool was empty
+    uint32_t pcm_free = 0;
+    uint32_t opus_free = 0;
+    uint32_t packets_in_use = 0;
+    uint32_t tasks_in_use = 0;
+};
+
+// Fixed-size blocks carved from one allocation, with heap fallback
+class FixedBlockPool {
+public:
+    void Initialize(size_t block_size, size_t count);
+    void* Allocate(size_t size, uint32_t& fallbacks);
+    void Free(void* ptr);
+    bool Owns(const void* ptr) const {
+        return slab_ != nullptr && ptr >= slab_ && ptr < slab_ + block_size_ * count_;
+    }
+    uint32_t InUse() const { return in_use_; }
+
+private:
+    uint8_t* slab_ = nullptr;
+    size_t block_size_ = 0;
+    size_t count_ = 0;
+    std::vector<void*> free_;
+    uint32_t in_use_ = 0;
+};
+
+class AudioBufferPool {
+public:
+    static AudioBufferPool& GetInstance() {
+        static AudioBufferPool instance;
+        return instance;
+    }
+
+    // Allocate the slabs; pcm_samples is the largest PCM frame the pipeline handles
+    void Initialize(size_t pcm_samples, size_t task_size);
+
+    std::vector<int16_t> AcquirePcm();
+    void ReleasePcm(std::vector<int16_t>&& pcm);
+    std::vector<uint8_t> AcquireOpus();
+    void ReleaseOpus(std::vector<uint8_t>&& opus);
+
+    // Packet with a pooled payload buffer
+    std::unique_ptr<AudioStreamPacket> AcquirePacket();
+
+    void* AllocatePacket(size_t size);
+    void FreePacket(void* ptr);
+    void* AllocateTask(size_t size);
+    void FreeTask(void* ptr);
+
+    AudioPoolStats GetStats();
+
+private:
+    AudioBufferPool() = default;
+    ~AudioBufferPool() = default;
+    AudioBufferPool(const AudioBufferPool&) = delete;
+    AudioBufferPool& operator=(const AudioBufferPool&) = delete;
+
+    std::mutex mutex_;
+    bool initialized_ = false;
+    size_t pcm_samples_ = 0;
+    std::vector<std::vector<int16_t>> pcm_free_;
+    std::vector<std::vector<uint8_t>> opus_free_;
+    FixedBlockPool packets_;
+    FixedBlockPool tasks_;
+    uint32_t allocations_ = 0;
+};
+
+// Scratch PCM frame that goes back to the pool when it leaves scope
+class PooledPcm {
+public:
+    PooledPcm() : pcm_(AudioBufferPool::GetInstance().AcquirePcm()) {}
+    ~PooledPcm() { AudioBufferPool::GetInstance().ReleasePcm(std::move(pcm_)); }
+    PooledPcm(const PooledPcm&) = delete;
+    PooledPcm& operator=(const PooledPcm&) = delete;
+
+    std::vector<int16_t>& operator*() { return pcm_; }
+    std::vector<int16_t>* operator->() { return &pcm_; }
+    // Hand the buffer to a new owner (e.g. an AudioTask), which releases it later
+    std::vector<int16_t> Take() { return std::move(pcm_); }
+
+private:
+    std::vector<int16_t> pcm_;
+};
+
+#endif // AUDIO_BUFFER_POOL_H
@@ -2,6 +2,7 @@
 #include "config.h"
 #include <esp_log.h>
 #include <cstring>
+#include <algorithm>
 
 #if CONFIG_USE_AUDIO_PROCESSOR
 #include "processors/afe_audio_processor.h"
@@ -23,6 +24,8 @@ constexpr int AUDIO_CHANNELS = 1;  // Mono
 
 AudioService::AudioService() {
     event_group_ = xEventGroupCreate();
+    /* No task is running until Start() */
+    xEventGroupSetBits(event_group_, AS_EVENT_OUTPUT_TASK_EXITED | AS_EVENT_CODEC_TASK_EXITED);
 }
 
 AudioService::~AudioService() {
@@ -41,13 +44,32 @@ void AudioService::Initialize(AudioCodec* codec) {
     codec_->Start();
 
     /* Setup the audio codec */
-    opus_decoder_ = std::make_unique<OpusDecoderWrapper>(codec->output_sample_rate(), AUDIO_CHANNELS, OPUS_FRAME_DURATION_MS);
+    opus_decoder_ = std::make_unique<OpusStreamDecoder>(codec->output_sample_rate(), AUDIO_CHANNELS, OPUS_FRAME_DURATION_MS);
     opus_encoder_ = std::make_unique<OpusEncoderWrapper>(AUDIO_INPUT_SAMPLE_RATE, AUDIO_CHANNELS, OPUS_FRAME_DURATION_MS);
     opus_encoder_->SetComplexity(0);
 
+    /* Size pooled PCM frames for the largest 60 ms frame: raw input, playback, or server audio before resampling */
+    int max_frame_rate = std::max({codec->input_sample_rate() * codec->input_channels(),
+        codec->output_sample_rate(), AUDIO_POOL_SERVER_SAMPLE_RATE});
+    AudioBufferPool::GetInstance().Initialize(OPUS_FRAME_DURATION_MS * max_frame_rate / 1000, sizeof(AudioTask));
+
     if (codec->input_sample_rate() != AUDIO_INPUT_SAMPLE_RATE) {
-        input_resampler_.Configure(codec->input_sample_rate(), AUDIO_INPUT_SAMPLE_RATE);
-        reference_resampler_.Configure(codec->input_sample_rate(), AUDIO_INPUT_SAMPLE_RATE);
+#if CONFIG_AUDIO_FIR_RESAMPLER_MONO
+        bool use_fir = true;
+#else
+        /* Mono input keeps OpusResampler unless the FIR is enabled for it in Kconfig */
+        bool use_fir = codec->input_channels() == 2;
+#endif
+        /* Mono and stereo input share one filter; OpusResampler only for unsupported ratios */
+        if (!use_fir || !fir_resampler_.Configure(codec->input_sample_rate(), AUDIO_INPUT_SAMPLE_RATE, codec->input_channels())) {
+            if (use_fir) {
+                ESP_LOGW(TAG, "Input uses OpusResampler");
+            }
+            input_resampler_.Configure(codec->input_sample_rate(), AUDIO_INPUT_SAMPLE_RATE);
+            if (codec->input_channels() == 2) {
+                reference_resampler_.Configure(codec->input_sample_rate(), AUDIO_INPUT_SAMPLE_RATE);
+            }
+        }
     }
 
 #if CONFIG_USE_AUDIO_PROCESSOR
@@ -82,7 +104,8 @@ void AudioService::Initialize(AudioCodec* codec) {
 
 void AudioService::Start() {
     service_stopped_ = false;
-    xEventGroupClearBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING | AS_EVENT_WAKE_WORD_RUNNING | AS_EVENT_AUDIO_PROCESSOR_RUNNING);
+    xEventGroupClearBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING | AS_EVENT_WAKE_WORD_RUNNING | AS_EVENT_AUDIO_PROCESSOR_RUNNING |
+        AS_EVENT_OUTPUT_TASK_EXITED | AS_EVENT_CODEC_TASK_EXITED);
 
     esp_timer_start_periodic(audio_power_timer_, 1000000);
 
@@ -95,11 +118,13 @@ void AudioService::Start() {
     }, "audio_input", 2048 * 3, this, 8, &audio_input_task_handle_, 0);
 
     /* Start the audio output task */
+    TaskHandle_t output_task = nullptr;
     xTaskCreate([](void* arg) {
         AudioService* audio_service = (AudioService*)arg;
         audio_service->AudioOutputTask();
         vTaskDelete(NULL);
-    }, "audio_output", 2048 * 2, this, 4, &audio_output_task_handle_);
+    }, "audio_output", 2048 * 2, this, 4, &output_task);
+    audio_output_task_handle_.store(output_task);
 #else
     /* Start the audio input task */
     xTaskCreate([](void* arg) {
@@ -109,19 +134,23 @@ void AudioService::Start() {
     }, "audio_input", 2048 * 2, this, 8, &audio_input_task_handle_);
 
     /* Start the audio output task */
+    TaskHandle_t output_task = nullptr;
     xTaskCreate([](void* arg) {
         AudioService* audio_service = (AudioService*)arg;
         audio_service->AudioOutputTask();
         vTaskDelete(NULL);
-    }, "audio_output", 2048, this, 4, &audio_output_task_handle_);
+    }, "audio_output", 2048, this, 4, &output_task);
+    audio_output_task_handle_.store(output_task);
 #endif
 
     /* Start the opus codec task */
+    TaskHandle_t codec_task = nullptr;
     xTaskCreate([](void* arg) {
         AudioService* audio_service = (AudioService*)arg;
         audio_service->OpusCodecTask();
         vTaskDelete(NULL);
-    }, "opus_codec", 2048 * 13, this, 5, &opus_codec_task_handle_);
+    }, "opus_codec", 2048 * 13, this, 5, &codec_task);
+    opus_codec_task_handle_.store(codec_task);
 }
 
 void AudioService::Stop() {
@@ -131,12 +160,43 @@ void AudioService::Stop() {
         AS_EVENT_WAKE_WORD_RUNNING |
         AS_EVENT_AUDIO_PROCESSOR_RUNNING);
 
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    audio_encode_queue_.clear();
-    audio_decode_queue_.clear();
-    audio_playback_queue_.clear();
-    audio_testing_queue_.clear();
-    audio_queue_cv_.notify_all();
+    /* Each consumer drops its queue when it sees the stop */
+    audio_encode_queue_.RequestClear();
+    audio_decode_queue_.RequestClear();
+    audio_playback_queue_.RequestClear();
+    NotifyTask(audio_output_task_handle_);
+    NotifyTask(opus_codec_task_handle_);
+    NotifyWaiter(encode_space_waiter_);
+    NotifyWaiter(decode_space_waiter_);
+
+    /* Wait until both tasks are past their last use of the handles and queues */
+    xEventGroupWaitBits(event_group_, AS_EVENT_OUTPUT_TASK_EXITED | AS_EVENT_CODEC_TASK_EXITED,
+        pdFALSE, pdTRUE, portMAX_DELAY);
+
+    std::lock_guard<std::mutex> lock(decode_push_mutex_);
+    audio_testing_queue_.Clear();
+}
+
+void AudioService::NotifyTask(const std::atomic<TaskHandle_t>& handle) {
+    TaskHandle_t task = handle.load();
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void AudioService::NotifyWaiter(std::atomic<TaskHandle_t>& waiter) {
+    TaskHandle_t task = waiter.exchange(nullptr);
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void AudioService::WaitForWaiterNotify(std::atomic<TaskHandle_t>& waiter) {
+    // The caller registers, retries its push, and only then blocks here, so a
+    // pop between the failed push and the registration is not missed. The
+    // timeout bounds the wait for producers that never get a notification.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(OPUS_FRAME_DURATION_MS));
+    waiter.store(nullptr);
 }
 
 bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples) {
@@ -151,26 +211,35 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
         if (!codec_->InputData(data)) {
             return false;
         }
-        if (codec_->input_channels() == 2) {
-            auto mic_channel = std::vector<int16_t>(data.size() / 2);
-            auto reference_channel = std::vector<int16_t>(data.size() / 2);
-            for (size_t i = 0, j = 0; i < mic_channel.size(); ++i, j += 2) {
-                mic_channel[i] = data[j];
-                reference_channel[i] = data[j + 1];
+        /* Scratch frames come from the buffer pool, so resampling does not touch the heap */
+        if (fir_resampler_.IsConfigured()) {
+            /* Mono, or mic + reference in one pass over the interleaved frame */
+            fir_resampler_.Process(data);
+        } else if (codec_->input_channels() == 2) {
+            PooledPcm mic_channel;
+            PooledPcm reference_channel;
+            mic_channel->resize(data.size() / 2);
+            reference_channel->resize(data.size() / 2);
+            for (size_t i = 0, j = 0; i < mic_channel->size(); ++i, j += 2) {
+                (*mic_channel)[i] = data[j];
+                (*reference_channel)[i] = data[j + 1];
             }
-            auto resampled_mic = std::vector<int16_t>(input_resampler_.GetOutputSamples(mic_channel.size()));
-            auto resampled_reference = std::vector<int16_t>(reference_resampler_.GetOutputSamples(reference_channel.size()));
-            input_resampler_.Process(mic_channel.data(), mic_channel.size(), resampled_mic.data());
-            reference_resampler_.Process(reference_channel.data(), reference_channel.size(), resampled_reference.data());
-            data.resize(resampled_mic.size() + resampled_reference.size());
-            for (size_t i = 0, j = 0; i < resampled_mic.size(); ++i, j += 2) {
-                data[j] = resampled_mic[i];
-                data[j + 1] = resampled_reference[i];
+            PooledPcm resampled_mic;
+            PooledPcm resampled_reference;
+            resampled_mic->resize(input_resampler_.GetOutputSamples(mic_channel->size()));
+            resampled_reference->resize(reference_resampler_.GetOutputSamples(reference_channel->size()));
+            input_resampler_.Process(mic_channel->data(), mic_channel->size(), resampled_mic->data());
+            reference_resampler_.Process(reference_channel->data(), reference_channel->size(), resampled_reference->data());
+            data.resize(resampled_mic->size() + resampled_reference->size());
+            for (size_t i = 0, j = 0; i < resampled_mic->size(); ++i, j += 2) {
+                data[j] = (*resampled_mic)[i];
+                data[j + 1] = (*resampled_reference)[i];
             }
         } else {
-            auto resampled = std::vector<int16_t>(input_resampler_.GetOutputSamples(data.size()));
-            input_resampler_.Process(data.data(), data.size(), resampled.data());
-            data = std::move(resampled);
+            PooledPcm resampled;
+            resampled->resize(input_resampler_.GetOutputSamples(data.size()));
+            input_resampler_.Process(data.data(), data.size(), resampled->data());
+            data.swap(*resampled);
         }
     } else {
         data.resize(samples * codec_->input_channels());
@@ -211,34 +280,34 @@ void AudioService::AudioInputTask() {
 
         /* Used for audio testing in NetworkConfiguring mode by clicking the BOOT button */
         if (bits & AS_EVENT_AUDIO_TESTING_RUNNING) {
-            if (audio_testing_queue_.size() >= AUDIO_TESTING_MAX_DURATION_MS / OPUS_FRAME_DURATION_MS) {
+            if (audio_testing_queue_.Size() >= AUDIO_TESTING_MAX_DURATION_MS / OPUS_FRAME_DURATION_MS) {
                 ESP_LOGW(TAG, "Audio testing queue is full, stopping audio testing");
                 EnableAudioTesting(false);
                 continue;
             }
-            std::vector<int16_t> data;
+            PooledPcm data;
             int samples = OPUS_FRAME_DURATION_MS * AUDIO_INPUT_SAMPLE_RATE / 1000;
-            if (ReadAudioData(data, AUDIO_INPUT_SAMPLE_RATE, samples)) {
-                // If input channels is 2, we need to fetch the left channel data
+            if (ReadAudioData(*data, AUDIO_INPUT_SAMPLE_RATE, samples)) {
+                // If input channels is 2, we need to fetch the left channel data (in place)
                 if (codec_->input_channels() == 2) {
-                    auto mono_data = std::vector<int16_t>(data.size() / 2);
-                    for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-                        mono_data[i] = data[j];
+                    size_t mono_samples = data->size() / 2;
+                    for (size_t i = 0, j = 0; i < mono_samples; ++i, j += 2) {
+                        (*data)[i] = (*data)[j];
                     }
-                    data = std::move(mono_data);
+                    data->resize(mono_samples);
                 }
-                PushTaskToEncodeQueue(kAudioTaskTypeEncodeToTestingQueue, std::move(data));
+                PushTaskToEncodeQueue(kAudioTaskTypeEncodeToTestingQueue, data.Take());
                 continue;
             }
         }
 
         /* Feed the wake word */
         if (bits & AS_EVENT_WAKE_WORD_RUNNING) {
-            std::vector<int16_t> data;
+            PooledPcm data;
             int samples = wake_word_->GetFeedSize();
             if (samples > 0) {
-                if (ReadAudioData(data, AUDIO_INPUT_SAMPLE_RATE, samples)) {
-                    wake_word_->Feed(data);
+                if (ReadAudioData(*data, AUDIO_INPUT_SAMPLE_RATE, samples)) {
+                    wake_word_->Feed(*data);
                     continue;
                 }
             }
@@ -246,11 +315,11 @@ void AudioService::AudioInputTask() {
 
         /* Feed the audio processor */
         if (bits & AS_EVENT_AUDIO_PROCESSOR_RUNNING) {
-            std::vector<int16_t> data;
+            PooledPcm data;
             int samples = audio_processor_->GetFeedSize();
             if (samples > 0) {
-                if (ReadAudioData(data, AUDIO_INPUT_SAMPLE_RATE, samples)) {
-                    audio_processor_->Feed(std::move(data));
+                if (ReadAudioData(*data, AUDIO_INPUT_SAMPLE_RATE, samples)) {
+                    audio_processor_->Feed(std::move(*data));  // Back to the pool unless the processor keeps it
                     continue;
                 }
             }
@@ -265,16 +334,17 @@ void AudioService::AudioInputTask() {
 
 void AudioService::AudioOutputTask() {
     while (true) {
-        std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this]() { return !audio_playback_queue_.empty() || service_stopped_; });
+        std::unique_ptr<AudioTask> task;
+        while (!service_stopped_ && !audio_playback_queue_.Pop(task)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
         if (service_stopped_) {
+            audio_playback_queue_.Clear();
             break;
         }
 
-        auto task = std::move(audio_playback_queue_.front());
-        audio_playback_queue_.pop_front();
-        audio_queue_cv_.notify_all();
-        lock.unlock();
+        /* A playback slot is free, the opus task may decode the next packet */
+        NotifyTask(opus_codec_task_handle_);
 
         if (!codec_->output_enabled()) {
             esp_timer_stop(audio_power_timer_);
@@ -290,66 +360,77 @@ void AudioService::AudioOutputTask() {
 #if CONFIG_USE_SERVER_AEC
         /* Record the timestamp for server AEC */
         if (task->timestamp > 0) {
-            lock.lock();
+            std::lock_guard<std::mutex> lock(timestamp_mutex_);
             timestamp_queue_.push_back(task->timestamp);
         }
 #endif
     }
 
+    audio_output_task_handle_.store(nullptr);  // No more notifications to this task
     ESP_LOGW(TAG, "Audio output task stopped");
+    xEventGroupSetBits(event_group_, AS_EVENT_OUTPUT_TASK_EXITED);
 }
 
 void AudioService::OpusCodecTask() {
     while (true) {
-        std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this]() {
-            return service_stopped_ ||
-                (!audio_encode_queue_.empty() && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) ||
-                (!audio_decode_queue_.empty() && audio_playback_queue_.size() < MAX_PLAYBACK_TASKS_IN_QUEUE);
-        });
         if (service_stopped_) {
+            audio_decode_queue_.Clear();
+            audio_encode_queue_.Clear();
             break;
         }
+        bool worked = false;
 
         /* Decode the audio from decode queue */
-        if (!audio_decode_queue_.empty() && audio_playback_queue_.size() < MAX_PLAYBACK_TASKS_IN_QUEUE) {
-            auto packet = std::move(audio_decode_queue_.front());
-            audio_decode_queue_.pop_front();
-            audio_queue_cv_.notify_all();
-            lock.unlock();
+        std::unique_ptr<AudioStreamPacket> packet;
+        if (audio_playback_queue_.Size() < MAX_PLAYBACK_TASKS_IN_QUEUE && audio_decode_queue_.Pop(packet)) {
+            NotifyWaiter(decode_space_waiter_);
+            worked = true;
+
+            if (decoder_reset_requested_.exchange(false)) {
+                opus_decoder_->ResetState();
+            }
 
             auto task = std::make_unique<AudioTask>();
             task->type = kAudioTaskTypeDecodeToPlaybackQueue;
+            task->pcm = AudioBufferPool::GetInstance().AcquirePcm();
             task->timestamp = packet->timestamp;
 
             SetDecodeSampleRate(packet->sample_rate, packet->frame_duration);
-            if (opus_decoder_->Decode(std::move(packet->payload), task->pcm)) {
+            // Frames lost on the way come from the jitter buffer as an empty payload
+            // (conceal) or as a copy of the next packet flagged fec (rebuild from it)
+            bool decoded;
+            if (packet->fec) {
+                decoded = opus_decoder_->DecodeFec(packet->payload, task->pcm);
+            } else {
+                decoded = opus_decoder_->Decode(std::move(packet->payload), task->pcm);
+            }
+            if (decoded) {
                 // Resample if the sample rate is different
                 if (opus_decoder_->sample_rate() != codec_->output_sample_rate()) {
                     int target_size = output_resampler_.GetOutputSamples(task->pcm.size());
-                    std::vector<int16_t> resampled(target_size);
-                    output_resampler_.Process(task->pcm.data(), task->pcm.size(), resampled.data());
-                    task->pcm = std::move(resampled);
+                    PooledPcm resampled;
+                    resampled->resize(target_size);
+                    output_resampler_.Process(task->pcm.data(), task->pcm.size(), resampled->data());
+                    task->pcm.swap(*resampled);
                 }
 
-                lock.lock();
-                audio_playback_queue_.push_back(std::move(task));
-                audio_queue_cv_.notify_all();
+                if (!audio_playback_queue_.Push(std::move(task))) {
+                    ESP_LOGW(TAG, "Playback queue is full, dropping frame");
+                }
+                NotifyTask(audio_output_task_handle_);
             } else {
                 ESP_LOGE(TAG, "Failed to decode audio");
-                lock.lock();
             }
             debug_statistics_.decode_count++;
         }
         
         /* Encode the audio to send queue */
-        if (!audio_encode_queue_.empty() && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) {
-            auto task = std::move(audio_encode_queue_.front());
-            audio_encode_queue_.pop_front();
-            audio_queue_cv_.notify_all();
-            lock.unlock();
+        std::unique_ptr<AudioTask> task;
+        if (audio_send_queue_.Size() < MAX_SEND_PACKETS_IN_QUEUE && audio_encode_queue_.Pop(task)) {
+            NotifyWaiter(encode_space_waiter_);
+            worked = true;
 
-            auto packet = std::make_unique<AudioStreamPacket>();
+            auto packet = AudioBufferPool::GetInstance().AcquirePacket();
             packet->frame_duration = OPUS_FRAME_DURATION_MS;
             packet->sample_rate = AUDIO_INPUT_SAMPLE_RATE;
             packet->timestamp = task->timestamp;
@@ -359,23 +440,26 @@ void AudioService::OpusCodecTask() {
             }
 
             if (task->type == kAudioTaskTypeEncodeToSendQueue) {
-                {
-                    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-                    audio_send_queue_.push_back(std::move(packet));
-                }
+                audio_send_queue_.Push(std::move(packet));
                 if (callbacks_.on_send_queue_available) {
                     callbacks_.on_send_queue_available();
                 }
             } else if (task->type == kAudioTaskTypeEncodeToTestingQueue) {
-                std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-                audio_testing_queue_.push_back(std::move(packet));
+                if (!audio_testing_queue_.Push(std::move(packet))) {
+                    ESP_LOGW(TAG, "Audio testing queue is full, dropping packet");
+                }
             }
             debug_statistics_.encode_count++;
-            lock.lock();
+        }
+
+        if (!worked) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         }
     }
 
+    opus_codec_task_handle_.store(nullptr);  // No more notifications to this task
     ESP_LOGW(TAG, "Opus codec task stopped");
+    xEventGroupSetBits(event_group_, AS_EVENT_CODEC_TASK_EXITED);
 }
 
 void AudioService::SetDecodeSampleRate(int sample_rate, int frame_duration) {
@@ -403,7 +487,7 @@ void AudioService::SetDecodeSampleRate(int sample_rate, int frame_duration) {
 
     // Now create new decoder with freed memory
     ESP_LOGI(TAG, "Creating new decoder (needs 18KB), free heap: %" PRIu32 " bytes", esp_get_free_heap_size());
-    auto new_decoder = std::make_unique<OpusDecoderWrapper>(sample_rate, 1, frame_duration);
+    auto new_decoder = std::make_unique<OpusStreamDecoder>(sample_rate, 1, frame_duration);
 
     // Check if new decoder was created successfully by attempting a test operation
     // If the internal audio_dec_ is nullptr, we'll detect it when trying to use it
@@ -421,46 +505,71 @@ void AudioService::PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t
     task->type = type;
     task->pcm = std::move(pcm);
     
-    /* Push the task to the encode queue */
-    std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-
     /* If the task is to send queue, we need to set the timestamp */
-    if (type == kAudioTaskTypeEncodeToSendQueue && !timestamp_queue_.empty()) {
-        if (timestamp_queue_.size() <= MAX_TIMESTAMPS_IN_QUEUE) {
-            task->timestamp = timestamp_queue_.front();
-        } else {
-            ESP_LOGW(TAG, "Timestamp queue (%u) is full, dropping timestamp", timestamp_queue_.size());
+    if (type == kAudioTaskTypeEncodeToSendQueue) {
+        std::lock_guard<std::mutex> lock(timestamp_mutex_);
+        if (!timestamp_queue_.empty()) {
+            if (timestamp_queue_.size() <= MAX_TIMESTAMPS_IN_QUEUE) {
+                task->timestamp = timestamp_queue_.front();
+            } else {
+                ESP_LOGW(TAG, "Timestamp queue (%u) is full, dropping timestamp", timestamp_queue_.size());
+            }
+            timestamp_queue_.pop_front();
         }
-        timestamp_queue_.pop_front();
     }
 
-    audio_queue_cv_.wait(lock, [this]() { return audio_encode_queue_.size() < MAX_ENCODE_TASKS_IN_QUEUE; });
-    audio_encode_queue_.push_back(std::move(task));
-    audio_queue_cv_.notify_all();
+    /*
+     * Push the task to the encode queue, waiting for the opus task to take one.
+     * The ring has two producers: the audio processor output (the AFE fetch task,
+     * or the input task for NoAudioProcessor) and the audio testing path of the
+     * input task. Testing can be enabled while the processor runs, and an AFE
+     * callback can still be in flight after Stop(), so they are serialized here.
+     * Holding the lock while waiting also keeps encode_space_waiter_ to one task.
+     */
+    std::lock_guard<std::mutex> lock(encode_push_mutex_);
+    while (!audio_encode_queue_.Push(std::move(task))) {
+        encode_space_waiter_.store(xTaskGetCurrentTaskHandle());
+        if (audio_encode_queue_.Push(std::move(task))) {
+            encode_space_waiter_.store(nullptr);
+            break;
+        }
+        if (service_stopped_) {
+            encode_space_waiter_.store(nullptr);
+            return;
+        }
+        WaitForWaiterNotify(encode_space_waiter_);
+    }
+    NotifyTask(opus_codec_task_handle_);
 }
 
 bool AudioService::PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> packet, bool wait) {
-    std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-    if (audio_decode_queue_.size() >= MAX_DECODE_PACKETS_IN_QUEUE) {
-        if (wait) {
-            audio_queue_cv_.wait(lock, [this]() { return audio_decode_queue_.size() < MAX_DECODE_PACKETS_IN_QUEUE; });
-        } else {
+    std::unique_lock<std::mutex> lock(decode_push_mutex_);
+    while (audio_decode_queue_.Size() >= MAX_DECODE_PACKETS_IN_QUEUE) {
+        if (!wait || service_stopped_) {
             return false;
         }
+        decode_space_waiter_.store(xTaskGetCurrentTaskHandle());
+        if (audio_decode_queue_.Size() < MAX_DECODE_PACKETS_IN_QUEUE) {
+            decode_space_waiter_.store(nullptr);
+            break;
+        }
+        lock.unlock();
+        WaitForWaiterNotify(decode_space_waiter_);
+        lock.lock();
     }
-    audio_decode_queue_.push_back(std::move(packet));
-    audio_queue_cv_.notify_all();
-    return true;
+    bool pushed = audio_decode_queue_.Push(std::move(packet));
+    lock.unlock();
+    NotifyTask(opus_codec_task_handle_);
+    return pushed;
 }
 
 std::unique_ptr<AudioStreamPacket> AudioService::PopPacketFromSendQueue() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    if (audio_send_queue_.empty()) {
+    std::unique_ptr<AudioStreamPacket> packet;
+    if (!audio_send_queue_.Pop(packet)) {
         return nullptr;
     }
-    auto packet = std::move(audio_send_queue_.front());
-    audio_send_queue_.pop_front();
-    audio_queue_cv_.notify_all();
+    /* A send slot is free, the opus task may encode the next frame */
+    NotifyTask(opus_codec_task_handle_);
     return packet;
 }
 
@@ -483,7 +592,7 @@ std::unique_ptr<AudioStreamPacket> AudioService::PopWakeWordPacket() {
     if (wake_word_ == nullptr) {
         return nullptr;
     }
-    auto packet = std::make_unique<AudioStreamPacket>();
+    auto packet = AudioBufferPool::GetInstance().AcquirePacket();
     if (wake_word_->GetWakeWordOpus(packet->payload)) {
         return packet;
     }
@@ -537,10 +646,16 @@ void AudioService::EnableAudioTesting(bool enable) {
         xEventGroupSetBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING);
     } else {
         xEventGroupClearBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING);
-        /* Copy audio_testing_queue_ to audio_decode_queue_ */
-        std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-        audio_decode_queue_ = std::move(audio_testing_queue_);
-        audio_queue_cv_.notify_all();
+        /* Replay audio_testing_queue_ through audio_decode_queue_ (sized to hold all of it) */
+        {
+            std::lock_guard<std::mutex> lock(decode_push_mutex_);
+            audio_decode_queue_.RequestClear();
+            std::unique_ptr<AudioStreamPacket> packet;
+            while (audio_testing_queue_.Pop(packet)) {
+                audio_decode_queue_.Push(std::move(packet));
+            }
+        }
+        NotifyTask(opus_codec_task_handle_);
     }
 }
 
@@ -645,11 +760,10 @@ void AudioService::PlaySound(const std::string_view& ogg) {
             }
 
             // Audio packet (Opus)
-            auto packet = std::make_unique<AudioStreamPacket>();
+            auto packet = AudioBufferPool::GetInstance().AcquirePacket();
             packet->sample_rate = sample_rate;
             packet->frame_duration = 60;
-            packet->payload.resize(pkt_len);
-            std::memcpy(packet->payload.data(), pkt_ptr, pkt_len);
+            packet->payload.assign(pkt_ptr, pkt_ptr + pkt_len);
             PushPacketToDecodeQueue(std::move(packet), true);
         }
 
@@ -658,23 +772,28 @@ void AudioService::PlaySound(const std::string_view& ogg) {
 }
 
 bool AudioService::IsIdle() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty();
+    return audio_encode_queue_.Empty() && audio_decode_queue_.Empty() && audio_playback_queue_.Empty() && audio_testing_queue_.Empty();
 }
 
 bool AudioService::IsPlaybackIdle() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    return audio_decode_queue_.empty() && audio_playback_queue_.empty();
+    return audio_decode_queue_.Empty() && audio_playback_queue_.Empty();
 }
 
 void AudioService::ResetDecoder() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    opus_decoder_->ResetState();
-    timestamp_queue_.clear();
-    audio_decode_queue_.clear();
-    audio_playback_queue_.clear();
-    audio_testing_queue_.clear();
-    audio_queue_cv_.notify_all();
+    /* The opus task owns the decoder; it resets it before the next decode */
+    decoder_reset_requested_ = true;
+    {
+        std::lock_guard<std::mutex> lock(timestamp_mutex_);
+        timestamp_queue_.clear();
+    }
+    audio_decode_queue_.RequestClear();
+    audio_playback_queue_.RequestClear();
+    {
+        std::lock_guard<std::mutex> lock(decode_push_mutex_);
+        audio_testing_queue_.Clear();
+    }
+    NotifyTask(opus_codec_task_handle_);
+    NotifyTask(audio_output_task_handle_);
 }
 
 void AudioService::CheckAndUpdateAudioPowerState() {
@@ -3,7 +3,7 @@
 
 #include <memory>
 #include <deque>
-#include <condition_variable>
+#include <atomic>
 #include <chrono>
 #include <mutex>
 
@@ -14,7 +14,6 @@
 #include <model_path.h>
 
 #include <opus_encoder.h>
-#include <opus_decoder.h>
 #include <opus_resampler.h>
 
 #include "audio_codec.h"
@@ -22,6 +21,10 @@
 #include "processors/audio_debugger.h"
 #include "wake_word.h"
 #include "protocol.h"
+#include "spsc_ring.h"
+#include "audio_buffer_pool.h"
+#include "polyphase_resampler.h"
+#include "opus_stream_decoder.h"
 
 
 /*
@@ -33,6 +36,9 @@
  * 
  * Decode Queue and Send Queue are the main queues, because Opus packets are quite smaller than PCM packets.
  * 
+ * Each queue is a lock-free SPSC ring. Instead of one shared condition variable, the task that
+ * changes a queue wakes only the task waiting on it (FreeRTOS task notifications). The decode
+ * queue has several producers (network, PlaySound, audio testing), which serialize on a mutex.
  */
 
 #define OPUS_FRAME_DURATION_MS 60
@@ -43,6 +49,12 @@
 #define AUDIO_TESTING_MAX_DURATION_MS 10000
 #define MAX_TIMESTAMPS_IN_QUEUE 3
 
+// Ring capacities (power of two, at least the limits above)
+#define DECODE_RING_CAPACITY 256    // Also holds the replayed audio testing queue
+#define SEND_RING_CAPACITY 64
+#define PLAYBACK_RING_CAPACITY 8    // Room for a full queue still waiting to be cleared
+#define TESTING_RING_CAPACITY 256
+
 #define AUDIO_POWER_TIMEOUT_MS 15000
 #define AUDIO_POWER_CHECK_INTERVAL_MS 1000
 
@@ -51,6 +63,8 @@
 #define AS_EVENT_WAKE_WORD_RUNNING          (1 << 1)
 #define AS_EVENT_AUDIO_PROCESSOR_RUNNING    (1 << 2)
 #define AS_EVENT_PLAYBACK_NOT_EMPTY         (1 << 3)
+#define AS_EVENT_OUTPUT_TASK_EXITED         (1 << 4)
+#define AS_EVENT_CODEC_TASK_EXITED          (1 << 5)
 
 struct AudioServiceCallbacks {
     std::function<void(void)> on_send_queue_available;
@@ -70,6 +84,11 @@ struct AudioTask {
     AudioTaskType type;
     std::vector<int16_t> pcm;
     uint32_t timestamp;
+
+    // Tasks live in AudioBufferPool's slab and give their PCM frame back to it
+    ~AudioTask() { AudioBufferPool::GetInstance().ReleasePcm(std::move(pcm)); }
+    static void* operator new(size_t size) { return AudioBufferPool::GetInstance().AllocateTask(size); }
+    static void operator delete(void* ptr) { AudioBufferPool::GetInstance().FreeTask(ptr); }
 };
 
 struct DebugStatistics {
@@ -118,9 +137,10 @@ private:
     std::unique_ptr<WakeWord> wake_word_;
     std::unique_ptr<AudioDebugger> audio_debugger_;
     std::unique_ptr<OpusEncoderWrapper> opus_encoder_;
-    std::unique_ptr<OpusDecoderWrapper> opus_decoder_;
+    std::unique_ptr<OpusStreamDecoder> opus_decoder_;
     OpusResampler input_resampler_;
     OpusResampler reference_resampler_;
+    PolyphaseResampler fir_resampler_;  // Mic (+ reference) input when the ratio is supported
     OpusResampler output_resampler_;
     DebugStatistics debug_statistics_;
     srmodel_list_t* models_list_ = nullptr;
@@ -129,16 +149,22 @@ private:
 
     // Audio encode / decode
     TaskHandle_t audio_input_task_handle_ = nullptr;
-    TaskHandle_t audio_output_task_handle_ = nullptr;
-    TaskHandle_t opus_codec_task_handle_ = nullptr;
-    std::mutex audio_queue_mutex_;
-    std::condition_variable audio_queue_cv_;
-    std::deque<std::unique_ptr<AudioStreamPacket>> audio_decode_queue_;
-    std::deque<std::unique_ptr<AudioStreamPacket>> audio_send_queue_;
-    std::deque<std::unique_ptr<AudioStreamPacket>> audio_testing_queue_;
-    std::deque<std::unique_ptr<AudioTask>> audio_encode_queue_;
-    std::deque<std::unique_ptr<AudioTask>> audio_playback_queue_;
+    // Cleared by each task on exit while other tasks may still notify it
+    std::atomic<TaskHandle_t> audio_output_task_handle_{nullptr};
+    std::atomic<TaskHandle_t> opus_codec_task_handle_{nullptr};
+    SpscRing<std::unique_ptr<AudioStreamPacket>, DECODE_RING_CAPACITY> audio_decode_queue_;
+    SpscRing<std::unique_ptr<AudioStreamPacket>, SEND_RING_CAPACITY> audio_send_queue_;
+    SpscRing<std::unique_ptr<AudioStreamPacket>, TESTING_RING_CAPACITY> audio_testing_queue_;
+    SpscRing<std::unique_ptr<AudioTask>, MAX_ENCODE_TASKS_IN_QUEUE> audio_encode_queue_;
+    SpscRing<std::unique_ptr<AudioTask>, PLAYBACK_RING_CAPACITY> audio_playback_queue_;
+    std::mutex decode_push_mutex_;  // Serializes decode queue producers
+    std::mutex encode_push_mutex_;  // Serializes encode queue producers (AFE output task, input task testing)
+    // Producers blocked on a full queue, woken by the consumer
+    std::atomic<TaskHandle_t> encode_space_waiter_{nullptr};
+    std::atomic<TaskHandle_t> decode_space_waiter_{nullptr};
+    std::atomic<bool> decoder_reset_requested_{false};
     // For server AEC
+    std::mutex timestamp_mutex_;
     std::deque<uint32_t> timestamp_queue_;
 
     bool wake_word_initialized_ = false;
@@ -155,6 +181,9 @@ private:
     void AudioOutputTask();
     void OpusCodecTask();
     void PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t>&& pcm);
+    void NotifyTask(const std::atomic<TaskHandle_t>& task);
+    void NotifyWaiter(std::atomic<TaskHandle_t>& waiter);
+    void WaitForWaiterNotify(std::atomic<TaskHandle_t>& waiter);
     void SetDecodeSampleRate(int sample_rate, int frame_duration);
     void CheckAndUpdateAudioPowerState();
 };
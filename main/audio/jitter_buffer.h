@@ -0,0 +1,266 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+ * Reordering jitter buffer for the UDP audio downlink (MQTT + UDP protocol).
+ *
+ * Packets are released in sequence order as soon as they are contiguous, so an
+ * in-order stream passes straight through without added latency. When a sequence
+ * number is missing, the packets behind it are held for up to the target delay and
+ * a late packet that shows up in time is put back in its place. The target delay
+ * follows the measured inter-arrival jitter (the RFC 3550 estimator, with the send
+ * time taken from the sequence number and the frame duration), and is raised to
+ * how long recent out-of-order packets would have needed, decaying over a few
+ * seconds: occasional reordering barely moves the smoothed jitter.
+ *
+ * A packet that does not arrive in time is released as a loss packet made by the
+ * caller. It has an empty payload, which tells the decoder to conceal the frame
+ * (Opus PLC). With in-band FEC enabled and the next packet already held, the loss
+ * packet carries a copy of the next packet with fec set, and the decoder rebuilds
+ * the lost frame from it. Only the first JITTER_MAX_CONCEAL_FRAMES frames of a gap
+ * are concealed; beyond that PLC fades to silence anyway, so the rest is skipped.
+ *
+ * Not thread-safe. Packet needs a std::vector<uint8_t> payload and a bool fec.
+ * Time is any millisecond clock (wrapping is fine).
+ */
+
+#define JITTER_BUFFER_WINDOW        8       // Packets held at most (480 ms of 60 ms frames)
+#define JITTER_MIN_DELAY_MS         20      // Wait at least this long for a missing packet
+#define JITTER_MAX_DELAY_MS         240
+#define JITTER_DELAY_FACTOR         2       // Target delay = factor x measured jitter
+#define JITTER_PEAK_DECAY_SHIFT     8       // Reordering peak decays by 1/256 per packet (~15 s)
+#define JITTER_MAX_CONCEAL_FRAMES   3       // Longer gaps are skipped after this many frames
+#define JITTER_RESET_GAP            100     // Sequence jumps beyond this restart the stream
+#define JITTER_PAUSE_MS             1000    // Arrival gaps beyond this are pauses in the speech
+
+template <typename Packet, size_t WINDOW = JITTER_BUFFER_WINDOW>
+class JitterBuffer {
+public:
+    using PacketPtr = std::unique_ptr<Packet>;
+
+    enum PushResult {
+        kPushAccepted,
+        kPushLate,          // Its slot was already played or concealed; dropped
+        kPushDuplicate,     // Already held; dropped
+        kPushReset,         // Sequence jumped (new stream): held packets flushed, restarted here
+    };
+
+    struct Stats {
+        uint32_t received = 0;
+        uint32_t reordered = 0;     // Arrived after a later packet, still in time
+        uint32_t late = 0;
+        uint32_t duplicates = 0;
+        uint32_t concealed = 0;     // Lost, released for PLC
+        uint32_t recovered = 0;     // Lost, released with the next packet for FEC
+        uint32_t skipped = 0;       // Lost deep in a long gap, not concealed
+        uint32_t resets = 0;
+    };
+
+    void Configure(int frame_duration_ms, bool fec) {
+        frame_ms_ = frame_duration_ms > 0 ? frame_duration_ms : 60;
+        fec_ = fec;
+    }
+
+    // Drop everything held and start over at the next packet
+    void Reset() {
+        for (auto& slot : slots_) {
+            slot.packet.reset();
+        }
+        held_ = 0;
+        started_ = false;
+        have_last_ = false;
+        jitter_q4_ = 0;
+        peak_q4_ = 0;
+        conceal_run_ = 0;
+        stats_ = Stats();
+    }
+
+    // Insert packet sequence, arrived at now_ms, and release whatever became playable.
+    // emit(PacketPtr) receives packets in sequence order; make() returns a new
+    // packet for a loss (sample rate and frame duration filled in, payload empty)
+    template <typename Emit, typename Make>
+    PushResult Push(uint32_t sequence, PacketPtr packet, uint32_t now_ms, Emit&& emit, Make&& make) {
+        stats_.received++;
+        UpdateJitter(sequence, now_ms);
+
+        PushResult result = kPushAccepted;
+        if (!started_) {
+            started_ = true;
+            next_seq_ = sequence;
+            max_seq_ = sequence;
+        }
+        int32_t offset = (int32_t)(sequence - next_seq_);
+        if (offset > JITTER_RESET_GAP || offset < -JITTER_RESET_GAP) {
+            Flush(emit);
+            next_seq_ = sequence;
+            max_seq_ = sequence;
+            stats_.resets++;
+            result = kPushReset;
+        } else if (offset < 0) {
+            stats_.late++;
+            return kPushLate;
+        }
+
+        // Past the window: the oldest missing frames are given up on now
+        while (sequence - next_seq_ >= WINDOW) {
+            ReleaseHead(emit, make);
+        }
+
+        Slot& slot = slots_[sequence % WINDOW];
+        if (slot.packet) {
+            stats_.duplicates++;
+            return kPushDuplicate;
+        }
+        if ((int32_t)(sequence - max_seq_) < 0) {
+            stats_.reordered++;
+        } else {
+            max_seq_ = sequence;
+        }
+        slot.packet = std::move(packet);
+        slot.arrival_ms = now_ms;
+        held_++;
+
+        Drain(now_ms, emit, make);
+        return result;
+    }
+
+    // Release held packets whose missing predecessor is overdue; call once
+    // GetTimeToDeadline() has passed
+    template <typename Emit, typename Make>
+    void Poll(uint32_t now_ms, Emit&& emit, Make&& make) {
+        Drain(now_ms, emit, make);
+    }
+
+    // Milliseconds until Poll() has work, or -1 when nothing is held
+    int32_t GetTimeToDeadline(uint32_t now_ms) const {
+        if (held_ == 0) {
+            return -1;
+        }
+        int32_t remaining = (int32_t)(OldestArrival() + GetDelayMs() - now_ms);
+        return remaining > 0 ? remaining : 0;
+    }
+
+    uint32_t GetJitterMs() const { return jitter_q4_ >> 4; }
+    uint32_t GetDelayMs() const {
+        uint32_t delay = std::max(GetJitterMs() * JITTER_DELAY_FACTOR, peak_q4_ >> 4);
+        return delay < JITTER_MIN_DELAY_MS ? JITTER_MIN_DELAY_MS : (delay > JITTER_MAX_DELAY_MS ? JITTER_MAX_DELAY_MS : delay);
+    }
+    size_t GetHeldCount() const { return held_; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Slot {
+        PacketPtr packet;
+        uint32_t arrival_ms = 0;
+    };
+
+    // RFC 3550: D = (R_i - R_j) - (S_i - S_j), J += (|D| - J) / 16, kept as J * 16
+    void UpdateJitter(uint32_t sequence, uint32_t now_ms) {
+        int32_t seq_delta = (int32_t)(sequence - last_seq_);
+        int32_t d = (int32_t)(now_ms - last_arrival_ms_) - seq_delta * frame_ms_;
+        uint32_t magnitude = d < 0 ? -d : d;
+        // Longer gaps are pauses between sentences or a new stream, not network jitter
+        if (have_last_ && seq_delta != 0 && seq_delta <= JITTER_RESET_GAP && seq_delta >= -JITTER_RESET_GAP &&
+            magnitude <= JITTER_PAUSE_MS) {
+            jitter_q4_ += magnitude - ((jitter_q4_ + 8) >> 4);
+
+            // Behind the newest packet: the packet after this one arrived about d - frame
+            // ago, which is how long the gap had to be held open for this one
+            if (seq_delta < 0 && d > frame_ms_) {
+                uint32_t needed_q4 = (uint32_t)(d - frame_ms_ + JITTER_MIN_DELAY_MS) << 4;
+                peak_q4_ = std::max(peak_q4_, needed_q4);
+            } else {
+                peak_q4_ -= peak_q4_ >> JITTER_PEAK_DECAY_SHIFT;
+            }
+        }
+        if (!have_last_ || seq_delta > 0) {
+            have_last_ = true;
+            last_seq_ = sequence;
+            last_arrival_ms_ = now_ms;
+        }
+    }
+
+    uint32_t OldestArrival() const {
+        uint32_t oldest = 0;
+        bool found = false;
+        for (const auto& slot : slots_) {
+            if (slot.packet && (!found || (int32_t)(slot.arrival_ms - oldest) < 0)) {
+                oldest = slot.arrival_ms;
+                found = true;
+            }
+        }
+        return oldest;
+    }
+
+    template <typename Emit, typename Make>
+    void ReleaseHead(Emit& emit, Make& make) {
+        Slot& head = slots_[next_seq_ % WINDOW];
+        if (head.packet) {
+            emit(std::move(head.packet));
+            held_--;
+            conceal_run_ = 0;
+        } else if (conceal_run_ < JITTER_MAX_CONCEAL_FRAMES) {
+            PacketPtr lost = make();
+            Slot& next = slots_[(next_seq_ + 1) % WINDOW];
+            if (fec_ && next.packet) {
+                lost->payload.assign(next.packet->payload.begin(), next.packet->payload.end());
+                lost->fec = true;
+                stats_.recovered++;
+            } else {
+                stats_.concealed++;
+            }
+            emit(std::move(lost));
+            conceal_run_++;
+        } else {
+            stats_.skipped++;
+        }
+        next_seq_++;
+    }
+
+    template <typename Emit, typename Make>
+    void Drain(uint32_t now_ms, Emit& emit, Make& make) {
+        while (held_ > 0) {
+            if (!slots_[next_seq_ % WINDOW].packet &&
+                (int32_t)(now_ms - OldestArrival()) < (int32_t)GetDelayMs()) {
+                break;  // Still waiting for the missing packet
+            }
+            ReleaseHead(emit, make);
+        }
+    }
+
+    // Release everything held, in order, without concealing the gaps
+    template <typename Emit>
+    void Flush(Emit& emit) {
+        for (size_t i = 0; i < WINDOW && held_ > 0; i++) {
+            Slot& slot = slots_[(next_seq_ + i) % WINDOW];
+            if (slot.packet) {
+                emit(std::move(slot.packet));
+                held_--;
+            }
+        }
+        conceal_run_ = 0;
+    }
+
+    Slot slots_[WINDOW];
+    size_t held_ = 0;
+    bool started_ = false;
+    uint32_t next_seq_ = 0;     // Next sequence number to release
+    uint32_t max_seq_ = 0;      // Highest sequence number received
+    bool have_last_ = false;
+    uint32_t last_seq_ = 0;
+    uint32_t last_arrival_ms_ = 0;
+    uint32_t jitter_q4_ = 0;
+    uint32_t peak_q4_ = 0;      // Wait recent out-of-order packets needed, x16
+    uint8_t conceal_run_ = 0;   // Consecutive frames lost so far
+    int frame_ms_ = 60;
+    bool fec_ = false;
+    Stats stats_;
+};
+
+#endif // JITTER_BUFFER_H
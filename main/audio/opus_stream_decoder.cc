@@ -0,0 +1,61 @@
+#include "opus_stream_decoder.h"
+
+#include <esp_log.h>
+
+#define TAG "OpusStreamDecoder"
+
+OpusStreamDecoder::OpusStreamDecoder(int sample_rate, int channels, int duration_ms)
+    : sample_rate_(sample_rate), duration_ms_(duration_ms), channels_(channels) {
+    frame_size_ = sample_rate / 1000 * duration_ms;
+    int error;
+    decoder_ = opus_decoder_create(sample_rate, channels, &error);
+    if (decoder_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to create decoder: %s", opus_strerror(error));
+    }
+}
+
+OpusStreamDecoder::~OpusStreamDecoder() {
+    if (decoder_ != nullptr) {
+        opus_decoder_destroy(decoder_);
+    }
+}
+
+bool OpusStreamDecoder::DecodeFrame(const uint8_t* data, size_t size, bool fec, std::vector<int16_t>& pcm) {
+    if (decoder_ == nullptr) {
+        return false;
+    }
+    pcm.resize(frame_size_ * channels_);
+    int ret = opus_decode(decoder_, data, size, pcm.data(), frame_size_, fec ? 1 : 0);
+    if (ret < 0) {
+        ESP_LOGE(TAG, "Failed to decode audio, error: %s", opus_strerror(ret));
+        return false;
+    }
+    pcm.resize(ret * channels_);
+    return true;
+}
+
+bool OpusStreamDecoder::Decode(std::vector<uint8_t>&& opus, std::vector<int16_t>& pcm) {
+    if (opus.empty()) {
+        return Conceal(pcm);
+    }
+    return DecodeFrame(opus.data(), opus.size(), false, pcm);
+}
+
+bool OpusStreamDecoder::Conceal(std::vector<int16_t>& pcm) {
+    // No data: the decoder extrapolates frame_size_ samples
+    return DecodeFrame(nullptr, 0, false, pcm);
+}
+
+bool OpusStreamDecoder::DecodeFec(const std::vector<uint8_t>& next_opus, std::vector<int16_t>& pcm) {
+    if (next_opus.empty()) {
+        return Conceal(pcm);
+    }
+    // Falls back to PLC inside libopus when the packet carries no FEC data
+    return DecodeFrame(next_opus.data(), next_opus.size(), true, pcm);
+}
+
+void OpusStreamDecoder::ResetState() {
+    if (decoder_ != nullptr) {
+        opus_decoder_ctl(decoder_, OPUS_RESET_STATE);
+    }
+}
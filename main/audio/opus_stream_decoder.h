@@ -0,0 +1,47 @@
+#ifndef OPUS_STREAM_DECODER_H
+#define OPUS_STREAM_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "opus.h"
+
+/*
+ * Opus decoder for the downlink, on libopus directly.
+ *
+ * Same interface as OpusDecoderWrapper, plus the two ways to fill in a frame the
+ * jitter buffer gave up on: Conceal() extrapolates it from the decoder state
+ * (PLC), DecodeFec() rebuilds it from the in-band FEC data carried by the next
+ * packet when the server encodes with it. OpusDecoderWrapper only exposes plain
+ * decoding.
+ */
+class OpusStreamDecoder {
+public:
+    OpusStreamDecoder(int sample_rate, int channels, int duration_ms);
+    ~OpusStreamDecoder();
+    OpusStreamDecoder(const OpusStreamDecoder&) = delete;
+    OpusStreamDecoder& operator=(const OpusStreamDecoder&) = delete;
+
+    // Decode one packet; an empty payload is a lost frame and gets concealed
+    bool Decode(std::vector<uint8_t>&& opus, std::vector<int16_t>& pcm);
+    // Frame for a lost packet, from packet loss concealment
+    bool Conceal(std::vector<int16_t>& pcm);
+    // Frame for a lost packet, from the FEC data in the packet after it
+    bool DecodeFec(const std::vector<uint8_t>& next_opus, std::vector<int16_t>& pcm);
+    void ResetState();
+
+    int sample_rate() const { return sample_rate_; }
+    int duration_ms() const { return duration_ms_; }
+
+private:
+    bool DecodeFrame(const uint8_t* data, size_t size, bool fec, std::vector<int16_t>& pcm);
+
+    OpusDecoder* decoder_ = nullptr;
+    int sample_rate_;
+    int duration_ms_;
+    int frame_size_;    // Samples per channel
+    int channels_;
+};
+
+#endif // OPUS_STREAM_DECODER_H
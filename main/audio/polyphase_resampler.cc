@@ -0,0 +1,165 @@
+#include "polyphase_resampler.h"
+
+#include <esp_log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#define TAG "PolyphaseResampler"
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+static double BesselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+bool PolyphaseResampler::Configure(int input_sample_rate, int output_sample_rate, int channels) {
+    phases_ = 0;
+    if (input_sample_rate <= 0 || output_sample_rate <= 0 || channels < 1 || channels > 2) {
+        return false;
+    }
+    int g = std::gcd(input_sample_rate, output_sample_rate);
+    int phases = output_sample_rate / g;
+    int step = input_sample_rate / g;
+    // Taps per phase span a fixed number of samples at the lower of the two rates, so
+    // the transition band has the same width in Hz at every ratio (32 input samples
+    // at 48k would leave a ~5 kHz wide transition and let 9-10 kHz alias in-band)
+    int taps_per_phase = POLYPHASE_RESAMPLER_MIN_TAPS * std::max(1, (step + phases - 1) / phases);
+    if (phases > POLYPHASE_RESAMPLER_MAX_PHASES || taps_per_phase > POLYPHASE_RESAMPLER_MAX_TAPS) {
+        ESP_LOGW(TAG, "Unsupported ratio %d -> %d", input_sample_rate, output_sample_rate);
+        return false;
+    }
+
+    // Kaiser-windowed sinc at the upsampled rate, cut off just below the lower Nyquist
+    const int taps = taps_per_phase * phases;
+    const double beta = 6.0;
+    const double cutoff = 0.45 * std::min(input_sample_rate, output_sample_rate) / ((double)input_sample_rate * phases);
+    const double center = (taps - 1) / 2.0;
+    std::vector<double> prototype(taps);
+    for (int n = 0; n < taps; n++) {
+        double x = n - center;
+        double sinc = (x == 0) ? 2 * cutoff : std::sin(2 * M_PI * cutoff * x) / (M_PI * x);
+        double r = x / center;
+        prototype[n] = sinc * BesselI0(beta * std::sqrt(std::max(0.0, 1 - r * r))) / BesselI0(beta);
+    }
+
+    // Split into phases, reversed so each output reads its input window forwards.
+    // Every phase is normalized to unity DC gain in Q15.
+    coefficients_.assign(phases * taps_per_phase, 0);
+    for (int p = 0; p < phases; p++) {
+        int16_t* c = &coefficients_[p * taps_per_phase];
+        double sum = 0;
+        for (int m = 0; m < taps_per_phase; m++) {
+            sum += prototype[p + (taps_per_phase - 1 - m) * phases];
+        }
+        int total = 0, largest = 0;
+        for (int m = 0; m < taps_per_phase; m++) {
+            c[m] = (int16_t)std::lround(prototype[p + (taps_per_phase - 1 - m) * phases] / sum * 32768.0);
+            total += c[m];
+            if (std::abs(c[m]) > std::abs(c[largest])) {
+                largest = m;
+            }
+        }
+        c[largest] += 32768 - total;
+    }
+
+    channels_ = channels;
+    taps_ = taps_per_phase;
+    phases_ = phases;
+    step_ = step;
+    Reset();
+    ESP_LOGI(TAG, "Configured %d -> %d Hz, %d channel(s) (%d/%d, %d taps per phase)", input_sample_rate,
+        output_sample_rate, channels, phases, step, taps_per_phase);
+    return true;
+}
+
+void PolyphaseResampler::Reset() {
+    position_ = 0;
+    work_.assign((taps_ - 1) * channels_, 0);
+}
+
+void PolyphaseResampler::Process(std::vector<int16_t>& data) {
+    if (!IsConfigured()) {
+        return;
+    }
+    const size_t history = (taps_ - 1) * channels_;
+    const size_t frames = data.size() / channels_;
+    const size_t span = frames * phases_;
+
+    // The only copy: append the block after the history, then filter back into data
+    work_.resize(history + frames * channels_);
+    memcpy(work_.data() + history, data.data(), frames * channels_ * sizeof(int16_t));
+
+    size_t out_frames = (size_t)position_ < span ? (span - position_ + step_ - 1) / step_ : 0;
+    data.resize(out_frames * channels_);
+    // Fixed trip counts for the MAC loop: one instance per channel count and tap count
+    const int kernel = channels_ * 4 + taps_ / POLYPHASE_RESAMPLER_MIN_TAPS;
+    switch (kernel) {
+    case 1 * 4 + 1: FilterBlock<1, 1 * POLYPHASE_RESAMPLER_MIN_TAPS>(work_.data(), data.data(), out_frames); break;
+    case 1 * 4 + 2: FilterBlock<1, 2 * POLYPHASE_RESAMPLER_MIN_TAPS>(work_.data(), data.data(), out_frames); break;
+    case 1 * 4 + 3: FilterBlock<1, 3 * POLYPHASE_RESAMPLER_MIN_TAPS>(work_.data(), data.data(), out_frames); break;
+    case 2 * 4 + 1: FilterBlock<2, 1 * POLYPHASE_RESAMPLER_MIN_TAPS>(work_.data(), data.data(), out_frames); break;
+    case 2 * 4 + 2: FilterBlock<2, 2 * POLYPHASE_RESAMPLER_MIN_TAPS>(work_.data(), data.data(), out_frames); break;
+    case 2 * 4 + 3: FilterBlock<2, 3 * POLYPHASE_RESAMPLER_MIN_TAPS>(work_.data(), data.data(), out_frames); break;
+    }
+
+    position_ += (int)(out_frames * step_) - (int)span;
+    memmove(work_.data(), work_.data() + frames * channels_, history * sizeof(int16_t));
+    work_.resize(history);
+}
+
+static inline int16_t SaturateQ15(int32_t acc) {
+    acc = (acc + (1 << 14)) >> 15;
+    return (int16_t)std::clamp(acc, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+}
+
+template <int CHANNELS, int TAPS>
+void PolyphaseResampler::FilterBlock(const int16_t* work, int16_t* out, size_t out_frames) {
+    // Output n sits at upsampled position position_ + n * step_; walk input index and
+    // phase incrementally instead of dividing per sample
+    size_t index = position_ / phases_;
+    int phase = position_ % phases_;
+    const size_t index_step = step_ / phases_;
+    const int phase_step = step_ % phases_;
+
+    for (size_t n = 0; n < out_frames; n++) {
+        const int16_t* __restrict x = work + index * CHANNELS;
+        const int16_t* __restrict c = &coefficients_[phase * TAPS];
+#if CONFIG_IDF_TARGET_ARCH_XTENSA || CONFIG_IDF_TARGET_ARCH_RISCV
+        // Two independent accumulators per channel, fixed trip count: maps onto the
+        // dual MAC pipelines and lets the compiler keep everything in registers
+        int32_t acc0[CHANNELS] = {}, acc1[CHANNELS] = {};
+        for (int m = 0; m < TAPS; m += 2) {
+            for (int ch = 0; ch < CHANNELS; ch++) {
+                acc0[ch] += c[m] * x[m * CHANNELS + ch];
+                acc1[ch] += c[m + 1] * x[(m + 1) * CHANNELS + ch];
+            }
+        }
+        for (int ch = 0; ch < CHANNELS; ch++) {
+            out[n * CHANNELS + ch] = SaturateQ15(acc0[ch] + acc1[ch]);
+        }
+#else
+        int32_t acc[CHANNELS] = {};
+        for (int m = 0; m < TAPS; m++) {
+            for (int ch = 0; ch < CHANNELS; ch++) {
+                acc[ch] += c[m] * x[m * CHANNELS + ch];
+            }
+        }
+        for (int ch = 0; ch < CHANNELS; ch++) {
+            out[n * CHANNELS + ch] = SaturateQ15(acc[ch]);
+        }
+#endif
+
+        index += index_step;
+        phase += phase_step;
+        if (phase >= phases_) {
+            phase -= phases_;
+            index++;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef POLYPHASE_RESAMPLER_H
+#define POLYPHASE_RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Polyphase FIR resampler for mono or interleaved stereo (mic + AEC reference) input.
+ *
+ * ReadAudioData used to deinterleave the two channels, run each through its own
+ * OpusResampler and interleave the results again: three passes and four scratch
+ * frames. This kernel reads the interleaved frame once and writes interleaved
+ * output, filtering both channels with the same Q15 coefficients so they stay
+ * sample-aligned for the AEC. Mono input goes through the same filter, so the
+ * mic signal the AFE and wake word see does not depend on the codec's channel
+ * count.
+ *
+ * Only rational ratios with at most POLYPHASE_RESAMPLER_MAX_PHASES output phases
+ * and at most 3:1 decimation are supported (e.g. 24k/32k/48k -> 16k); Configure()
+ * returns false otherwise and the caller keeps the OpusResampler path.
+ */
+
+// Taps per phase: MIN_TAPS, times ceil(input / output) when decimating (48k -> 16k: 96)
+#define POLYPHASE_RESAMPLER_MIN_TAPS    32      // Even (the MAC loop is unrolled by 2)
+#define POLYPHASE_RESAMPLER_MAX_TAPS    (3 * POLYPHASE_RESAMPLER_MIN_TAPS)
+#define POLYPHASE_RESAMPLER_MAX_PHASES  8
+
+class PolyphaseResampler {
+public:
+    // channels: 1, or 2 for interleaved stereo
+    bool Configure(int input_sample_rate, int output_sample_rate, int channels);
+    bool IsConfigured() const { return phases_ > 0; }
+    void Reset();
+
+    // Resample the interleaved frames in data, in place; data is resized to the output
+    void Process(std::vector<int16_t>& data);
+
+private:
+    template <int CHANNELS, int TAPS>
+    void FilterBlock(const int16_t* work, int16_t* out, size_t out_frames);
+
+    int channels_ = 0;
+    int taps_ = 0;          // Taps per phase
+    int phases_ = 0;        // L: upsampling factor
+    int step_ = 0;          // M: decimation factor
+    int position_ = 0;      // Next output position in upsampled samples, relative to the block
+    std::vector<int16_t> coefficients_; // phases_ x taps_, Q15
+    std::vector<int16_t> work_; // Interleaved history (taps_ - 1 frames) + current block
+};
+
+#endif // POLYPHASE_RESAMPLER_H
@@ -1,4 +1,5 @@
 #include "afe_audio_processor.h"
+#include "audio_buffer_pool.h"
 #include <esp_log.h>
 
 #define PROCESSOR_RUNNING 0x01
@@ -160,11 +161,12 @@ void AfeAudioProcessor::AudioProcessorTask() {
                 if (output_buffer_.size() == frame_samples_) {
                     // If buffer size equals frame size, move the entire buffer
                     output_callback_(std::move(output_buffer_));
-                    output_buffer_.clear();
-                    output_buffer_.reserve(frame_samples_);
+                    output_buffer_ = AudioBufferPool::GetInstance().AcquirePcm();
                 } else {
                     // If buffer size exceeds frame size, copy one frame and remove it
-                    output_callback_(std::vector<int16_t>(output_buffer_.begin(), output_buffer_.begin() + frame_samples_));
+                    auto frame = AudioBufferPool::GetInstance().AcquirePcm();
+                    frame.assign(output_buffer_.begin(), output_buffer_.begin() + frame_samples_);
+                    output_callback_(std::move(frame));
                     output_buffer_.erase(output_buffer_.begin(), output_buffer_.begin() + frame_samples_);
                 }
             }
@@ -16,15 +16,14 @@ void NoAudioProcessor::Feed(std::vector<int16_t>&& data) {
     }
 
     if (codec_->input_channels() == 2) {
-        // If input channels is 2, we need to fetch the left channel data
-        auto mono_data = std::vector<int16_t>(data.size() / 2);
-        for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-            mono_data[i] = data[j];
+        // If input channels is 2, we need to fetch the left channel data (in place, keeps the pooled buffer)
+        size_t mono_samples = data.size() / 2;
+        for (size_t i = 0, j = 0; i < mono_samples; ++i, j += 2) {
+            data[i] = data[j];
         }
-        output_callback_(std::move(mono_data));
-    } else {
-        output_callback_(std::move(data));
+        data.resize(mono_samples);
     }
+    output_callback_(std::move(data));
 }
 
 void NoAudioProcessor::Start() {
@@ -0,0 +1,112 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/*
+ * Fixed-capacity lock-free ring for exactly one producer task and one
+ * consumer task. Indices are free-running counters, so CAPACITY must be a
+ * power of two; Size() may be read from any task.
+ *
+ * Other tasks must not Pop(). To drop the contents from elsewhere (reset,
+ * stop), call RequestClear(): everything pushed before the call stops
+ * counting in Size() immediately and is destroyed by the consumer on its next
+ * Pop() or Clear(). Items pushed after the call are kept. Until then the
+ * dropped items still occupy slots, so size CAPACITY above the queue limit
+ * when the ring can be cleared while full.
+ */
+template <typename T, size_t CAPACITY>
+class SpscRing {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    // Producer only. The item is left untouched if the ring is full.
+    bool Push(T&& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= CAPACITY) {
+            return false;
+        }
+        slots_[head & (CAPACITY - 1)] = std::move(item);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool Pop(T& item) {
+        size_t tail = DropCleared(tail_.load(std::memory_order_relaxed));
+        if (tail == head_.load(std::memory_order_acquire)) {
+            tail_.store(tail, std::memory_order_release);
+            return false;
+        }
+        item = std::move(slots_[tail & (CAPACITY - 1)]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: destroy everything currently queued
+    void Clear() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            slots_[tail & (CAPACITY - 1)] = T();
+        }
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    // Any task
+    void RequestClear() {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t clear_to = clear_to_.load(std::memory_order_relaxed);
+        while (Before(clear_to, head) &&
+               !clear_to_.compare_exchange_weak(clear_to, head, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        }
+    }
+
+    size_t Size() const {
+        // Read head after tail so head - tail never underflows, and retry if the
+        // tail moved meanwhile: a task preempted between the two loads would
+        // otherwise pair a stale tail with a newer head and exceed CAPACITY
+        size_t tail = ReadTail();
+        while (true) {
+            size_t head = head_.load(std::memory_order_acquire);
+            size_t again = ReadTail();
+            if (again == tail) {
+                return head - tail;
+            }
+            tail = again;
+        }
+    }
+
+    bool Empty() const { return Size() == 0; }
+    static constexpr size_t Capacity() { return CAPACITY; }
+
+private:
+    static bool Before(size_t a, size_t b) {
+        return (ptrdiff_t)(b - a) > 0;
+    }
+
+    // First item still counted by Size()
+    size_t ReadTail() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t clear_to = clear_to_.load(std::memory_order_acquire);
+        return Before(tail, clear_to) ? clear_to : tail;
+    }
+
+    size_t DropCleared(size_t tail) {
+        size_t clear_to = clear_to_.load(std::memory_order_acquire);
+        for (; Before(tail, clear_to); ++tail) {
+            slots_[tail & (CAPACITY - 1)] = T();
+        }
+        return tail;
+    }
+
+    T slots_[CAPACITY] = {};
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+    std::atomic<size_t> clear_to_{0};   // Items before this index are dropped
+};
+
+#endif // SPSC_RING_H
@@ -1,6 +1,7 @@
 #include "power_save_timer.h"
 #include "application.h"
 #include "settings.h"
+#include "memory_storage.h"
 
 #include <esp_log.h>
 
@@ -71,6 +72,7 @@ void PowerSaveTimer::PowerSaveCheck() {
         if (!in_sleep_mode_) {
             ESP_LOGI(TAG, "Enabling power save mode");
             in_sleep_mode_ = true;
+            MemoryStorage::GetInstance().Flush();
             if (on_enter_sleep_mode_) {
                 on_enter_sleep_mode_();
             }
@@ -99,6 +101,7 @@ void PowerSaveTimer::PowerSaveCheck() {
         }
     }
     if (seconds_to_shutdown_ != -1 && ticks_ >= seconds_to_shutdown_ && on_shutdown_request_) {
+        MemoryStorage::GetInstance().Flush();
         on_shutdown_request_();
     }
 }
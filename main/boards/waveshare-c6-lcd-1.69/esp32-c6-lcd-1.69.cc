@@ -37,6 +37,7 @@ struct WifiConfigBin {
 #include <esp_lcd_panel_vendor.h>
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_commands.h>
 #include <esp_timer.h>
 #include <esp_lvgl_port.h>
 #include <esp_lcd_touch_cst816s.h>
@@ -46,7 +47,10 @@ struct WifiConfigBin {
 // Silent mode removed
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
 #include <cstring>
+#include <cinttypes>
+#include <algorithm>
 #include <math.h>
 #include <esp_sleep.h>
 #include <time.h>
@@ -58,10 +62,14 @@ struct WifiConfigBin {
 #include "background_manager.h"
 // Item loader (40x40 items: coin, poop)
 #include "item_loader.h"
+// Pet compositor (background + items + pet sprite, damage tracking)
+#include "pet_compositor.h"
 // Scene items manager (spawning, collision detection)
 #include "pet/scene_items.h"
 // Ambient dialogue system (cute pet dialogues)
 #include "pet/ambient_dialogue.h"
+// Memory storage (flush batched writes before power off)
+#include "memory/memory_storage.h"
 
 #define TAG "waveshare_lcd_1_69"
 
@@ -100,16 +108,15 @@ enum class PetBehaviorState : uint8_t {
 static const char* RANDOM_ACTIONS[] = {"pet_head", "talk", "listen"};
 static const int RANDOM_ACTION_COUNT = 3;
 
-// Composite buffer dimensions (full screen size)
-#define COMPOSITE_WIDTH   280
-#define COMPOSITE_HEIGHT  240
-
 // Animation scaling configuration (100% = no scaling)
 // Source animation: 160x160, no scaling to save memory/CPU
 #define ANIM_SCALE_PERCENT  100  // Scale percentage (100 = no scaling)
 #define ANIM_SCALED_WIDTH   ((ANIM_FRAME_WIDTH * ANIM_SCALE_PERCENT) / 100)   // 160
 #define ANIM_SCALED_HEIGHT  ((ANIM_FRAME_HEIGHT * ANIM_SCALE_PERCENT) / 100)  // 160
 
+// The span compositor copies pet runs 1:1 from the source frame
+static_assert(ANIM_SCALE_PERCENT == 100, "Span compositing does not scale the pet sprite");
+
 // Animation position within composite buffer (centered after scaling)
 #define ANIM_OFFSET_IN_COMPOSITE_X  ((COMPOSITE_WIDTH - ANIM_SCALED_WIDTH) / 2)    // 60
 #define ANIM_OFFSET_IN_COMPOSITE_Y  ((COMPOSITE_HEIGHT - ANIM_SCALED_HEIGHT) / 2)  // 40
@@ -117,51 +124,15 @@ static const int RANDOM_ACTION_COUNT = 3;
 // Composite buffer position on screen (full screen, start from top)
 #define COMPOSITE_SCREEN_Y  0
 
-// UI areas to skip during direct LCD output (to preserve LVGL-drawn UI)
-#define TOP_UI_HEIGHT     25   // Height of top bar (status icons, matches bg_offset_y)
-#define BOTTOM_UI_HEIGHT  25   // Height of bottom bar (subtitles)
-
-// Background color range for transparency (from all frames in index.json + 20% margin)
-// All frames bg_color_rgb range: R(1-7), G(173-206), B(104-138)
-// Expand 20%: R(0-9), G(166-213), B(97-145)
-// Convert to RGB565:
-#define BG_R_MIN  0    // 0 >> 3 = 0
-#define BG_R_MAX  3    // 9 >> 3 = 1
-#define BG_G_MIN  36   // 166 >> 2 = 41
-#define BG_G_MAX  46   // 213 >> 2 = 53
-#define BG_B_MIN  10   // 97 >> 3 = 12
-#define BG_B_MAX  14   // 145 >> 3 = 18
-
-// Helper: Check if RGB565 pixel is within background color range
-static inline bool is_background_color(uint16_t pixel) {
-    uint8_t r = (pixel >> 11) & 0x1F;  // 5-bit red
-    uint8_t g = (pixel >> 5) & 0x3F;   // 6-bit green
-    uint8_t b = pixel & 0x1F;          // 5-bit blue
-    // Note: BG_R_MIN is 0, so r >= BG_R_MIN is always true for uint8_t
-    return (r <= BG_R_MAX &&
-            g >= BG_G_MIN && g <= BG_G_MAX &&
-            b >= BG_B_MIN && b <= BG_B_MAX);
-}
-
 // Item position center in composite buffer (near bottom of animation area)
 // Animation bottom Y = 40 + 160 = 200, items at Y=180 appear at pet's feet level
 #define ITEM_CENTER_X  (COMPOSITE_WIDTH / 2)   // 140
 #define ITEM_CENTER_Y  180                     // Near ground level
 
 // Cached item bounds - pre-computed once per frame to avoid 53K function calls
-// Each item stores screen-space bounding box for fast inline rejection
-struct CachedItemBounds {
-    int16_t x1, y1, x2, y2;  // Screen coordinates (x1,y1) to (x2,y2) exclusive
-    uint8_t item_type;       // ITEM_TYPE_COIN or ITEM_TYPE_POOP
-    bool active;
-};
-
-// Maximum cached items = MAX_SCENE_COINS + MAX_SCENE_POOPS = 8
-#define MAX_CACHED_ITEMS 8
+static_assert(MAX_SCENE_COINS + MAX_SCENE_POOPS <= MAX_CACHED_ITEMS, "Every scene item must fit the draw list");
 static CachedItemBounds cached_items[MAX_CACHED_ITEMS];
 static uint8_t cached_item_count = 0;
-static int16_t cached_items_min_y = COMPOSITE_HEIGHT;  // Quick rejection for rows above all items
-static int16_t cached_items_max_y = 0;                  // Quick rejection for rows below all items
 
 // Prepare item bounds cache - call once per frame before rendering
 // Returns true if there are any active items to render
@@ -171,8 +142,6 @@ static bool prepare_item_bounds_cache() {
     uint8_t poop_count = scene_mgr.GetPoopCount();
 
     cached_item_count = 0;
-    cached_items_min_y = COMPOSITE_HEIGHT;
-    cached_items_max_y = 0;
 
     if (coin_count == 0 && poop_count == 0) {
         return false;
@@ -201,8 +170,7 @@ static bool prepare_item_bounds_cache() {
         c.y2 = c.y1 + ITEM_HEIGHT;
         c.item_type = ITEM_TYPE_POOP;
         c.active = true;
-        if (c.y1 < cached_items_min_y) cached_items_min_y = c.y1;
-        if (c.y2 > cached_items_max_y) cached_items_max_y = c.y2;
+        c.runs = item_loader.GetOpaqueRuns(c.item_type);
         cached_item_count++;
     }
 
@@ -216,8 +184,7 @@ static bool prepare_item_bounds_cache() {
         c.y2 = c.y1 + ITEM_HEIGHT;
         c.item_type = ITEM_TYPE_COIN;
         c.active = true;
-        if (c.y1 < cached_items_min_y) cached_items_min_y = c.y1;
-        if (c.y2 > cached_items_max_y) cached_items_max_y = c.y2;
+        c.runs = item_loader.GetOpaqueRuns(c.item_type);
 
         // Debug: log coin caching details
         static uint32_t coin_cache_log = 0;
@@ -231,39 +198,119 @@ static bool prepare_item_bounds_cache() {
     // Debug: log item caching status (once per 60 frames to avoid spam)
     static uint32_t item_log_counter = 0;
     if (cached_item_count > 0 && (item_log_counter++ % 60) == 0) {
-        ESP_LOGI(TAG, "Items cached: %d (y range: %d-%d)", cached_item_count, cached_items_min_y, cached_items_max_y);
+        ESP_LOGI(TAG, "Items cached: %d", cached_item_count);
     }
 
     return cached_item_count > 0;
 }
 
-// Fast item pixel lookup using cached bounds - call from rendering loop
-// Only checks cached items, assumes prepare_item_bounds_cache() was called
-static inline bool sample_item_pixel_fast(int16_t screen_x, int16_t screen_y, uint16_t* out_pixel) {
-    // Quick row rejection (most rows have no items)
-    if (screen_y < cached_items_min_y || screen_y >= cached_items_max_y) {
-        return false;
+// =============================================================================
+// Compositing - only re-composite and push rectangles that changed
+// (damage tracking and span compositing live in images/pet_compositor.cc)
+// =============================================================================
+
+#define RENDER_STATS_LOG_FRAMES     60  // Log damage counters every ~10s
+
+static PetCompositor pet_compositor;
+
+// Pet frames decoded by AnimationLoader (the frame is already decoded by the time the
+// compositor asks, so this is a cache hit)
+class AnimationFrameSource : public PetFrameSource {
+public:
+    const uint16_t* GetFrame(uint16_t frame_idx) override {
+        return (const uint16_t*)AnimationLoader::GetInstance().GetFrameByIndex(frame_idx);
     }
+};
 
-    auto& item_loader = ItemLoader::GetInstance();
+// Background rows - from the RAM buffer, or decoded from flash one row at a time
+class CompositeBackgroundSource : public PetBackgroundSource {
+public:
+    CompositeBackgroundSource(const uint16_t* ram, uint16_t ram_width, uint16_t bg_idx, uint16_t* row_buffer)
+        : ram_(ram), ram_width_(ram_width), bg_idx_(bg_idx), row_buffer_(row_buffer) {}
 
-    for (uint8_t i = 0; i < cached_item_count; i++) {
-        const auto& c = cached_items[i];
-        // Bounds check
-        if (screen_x < c.x1 || screen_x >= c.x2 ||
-            screen_y < c.y1 || screen_y >= c.y2) {
-            continue;
+    const uint16_t* GetRow(uint16_t y) override {
+        if (ram_ != nullptr) {
+            // Fast mode: background already in RAM (280x240)
+            return &ram_[y * ram_width_];
         }
-        // Inside this item - check transparency
-        uint16_t local_x = screen_x - c.x1;
-        uint16_t local_y = screen_y - c.y1;
-        if (item_loader.IsTransparent(c.item_type, local_x, local_y)) {
-            continue;  // Transparent pixel, check next item
+        auto& bg_loader = BackgroundLoader::GetInstance();
+        if (row_buffer_ != nullptr && bg_loader.IsInitialized()) {
+            // Slow mode: decode row from flash
+            bg_loader.DecodeRow(bg_idx_, y, row_buffer_);
+            return row_buffer_;
         }
-        *out_pixel = item_loader.GetPixel(c.item_type, local_x, local_y);
-        return true;
+        return nullptr;
+    }
+
+private:
+    const uint16_t* ram_;
+    uint16_t ram_width_;
+    uint16_t bg_idx_;
+    uint16_t* row_buffer_;
+};
+
+// Per-frame render counters (accumulated between log lines)
+static struct {
+    uint32_t frames;            // Frames that composited something
+    uint32_t idle_frames;       // Frames with no damage at all
+    uint32_t pixels;            // Pixels composited
+    uint32_t spi_bytes;         // Bytes sent to the panel (or invalidated in LVGL)
+    uint32_t last_pixels;       // Most recent frame
+    uint32_t last_spi_bytes;
+    int64_t window_start_us;    // Start of the current log window
+    int64_t busy_us;            // Time the animation timer spent rendering (DMA waits excluded)
+    int64_t dma_wait_us;        // Direct LCD mode: time spent waiting for strip transfers
+    uint32_t transfers;         // Direct LCD mode: panel transactions
+} render_stats = {};
+
+// DMA wait of the frame being rendered (not counted as busy time)
+static int64_t render_frame_wait_us = 0;
+
+// Account one frame and log the averages periodically
+static void render_stats_frame(uint32_t pixels, uint32_t spi_bytes) {
+    render_stats.last_pixels = pixels;
+    render_stats.last_spi_bytes = spi_bytes;
+    if (pixels == 0) {
+        render_stats.idle_frames++;
+    } else {
+        render_stats.frames++;
+        render_stats.pixels += pixels;
+        render_stats.spi_bytes += spi_bytes;
+    }
+
+    uint32_t total = render_stats.frames + render_stats.idle_frames;
+    int64_t now = esp_timer_get_time();
+    if (render_stats.window_start_us == 0) {
+        render_stats.window_start_us = now;
+    }
+    if (total >= RENDER_STATS_LOG_FRAMES) {
+        uint32_t full_pixels = COMPOSITE_WIDTH * (DAMAGE_BAND_Y2 - DAMAGE_BAND_Y1);
+        int64_t elapsed_us = std::max<int64_t>(now - render_stats.window_start_us, 1);
+        auto& loader = AnimationLoader::GetInstance();
+        AnimFrameCacheStats cache = loader.GetFrameCacheStats();
+        uint32_t lookups = cache.hits + cache.misses;
+        ESP_LOGI(TAG, "Render: %" PRIu32 " frames (%" PRIu32 " idle), avg %" PRIu32 " px / %" PRIu32
+                 " SPI bytes per frame (full frame %" PRIu32 " px), frame cache %u frames / %u KB, hit %" PRIu32
+                 "%%, prefetched %" PRIu32 ", delta %" PRIu32,
+                 total, render_stats.idle_frames, render_stats.pixels / total,
+                 render_stats.spi_bytes / total, full_pixels, cache.frames, (unsigned)(cache.bytes / 1024),
+                 lookups > 0 ? cache.hits * 100 / lookups : 0, loader.GetPrefetchHits(),
+                 loader.GetDeltaFrames());
+        ESP_LOGI(TAG, "Render: %.1f fps, render CPU %d%%, %" PRIu32 " LCD transfers, DMA wait %d ms, "
+                 "assets %s, internal free %u KB",
+                 total * 1000000.0f / elapsed_us, (int)(render_stats.busy_us * 100 / elapsed_us),
+                 render_stats.transfers, (int)(render_stats.dma_wait_us / 1000),
+                 loader.IsMapped() ? "mmap" : "read",
+                 (unsigned)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024));
+        render_stats.frames = 0;
+        render_stats.idle_frames = 0;
+        render_stats.pixels = 0;
+        render_stats.spi_bytes = 0;
+        render_stats.window_start_us = now;
+        render_stats.busy_us = 0;
+        render_stats.dma_wait_us = 0;
+        render_stats.transfers = 0;
     }
-    return false;
 }
 
 // Animation frame range: 6 animations × 13 frames = 78 (indices 0-77)
@@ -533,12 +580,23 @@ static uint16_t* composite_buffer = nullptr;
 // Row buffer for reading background from flash (280 pixels = 560 bytes)
 static uint16_t* bg_row_buffer = nullptr;
 
-// Second row buffer for composited output (280 pixels = 560 bytes)
-// Used for low-memory row-by-row direct LCD output
-static uint16_t* composite_row_buffer = nullptr;
-
-// LCD panel handle for direct output
+// Low-memory direct LCD output: strips of rows are composited into one buffer while the
+// other is sent by SPI DMA (ping-pong). The strip height is sized from the free heap at init
+#define DIRECT_STRIP_MAX_ROWS      24               // 280 x 24 x 2 = 13 KB per strip
+#define DIRECT_STRIP_HEAP_RESERVE  (32 * 1024)      // DMA-capable RAM left for Wi-Fi/audio
+#define DIRECT_STRIP_WAIT_MS       100              // A full strip takes ~3 ms at 40 MHz
+static uint16_t* direct_strip_buffers[2] = {nullptr, nullptr};
+static uint8_t direct_strip_count = 0;              // 2 = ping-pong, 1 = wait for each strip
+static uint16_t direct_strip_rows = 0;
+static uint8_t direct_strip_next = 0;               // Buffer the next strip is composited into
+static uint8_t direct_strip_inflight = 0;           // Strips queued and not yet done
+static SemaphoreHandle_t direct_strip_done = nullptr;  // Given by the panel IO done callback
+static volatile bool direct_strip_active = false;   // Done callbacks are ours, not LVGL's
+
+// LCD panel (and its IO / LVGL display, for the done callback) for direct output
 static esp_lcd_panel_handle_t direct_lcd_panel = nullptr;
+static esp_lcd_panel_io_handle_t direct_lcd_io = nullptr;
+static lv_display_t* direct_lvgl_display = nullptr;
 
 // Top and bottom bar background buffers - DISABLED to save 14KB RAM
 // Both bars now use semi-transparent backgrounds with sampled colors instead
@@ -550,12 +608,6 @@ static uint16_t actual_bg_width = 0;
 static uint16_t actual_bg_height = 0;
 static uint16_t bg_offset_y = 0;  // Vertical offset to center background in composite area
 
-// Helper: Swap bytes in RGB565 (for direct LCD output mode)
-// LCD expects big-endian but ESP32 stores little-endian
-static inline uint16_t swap_bytes_rgb565(uint16_t pixel) {
-    return (pixel >> 8) | (pixel << 8);
-}
-
 // Helper: Invert RGB565 color (for direct LCD output mode)
 // When bypassing LVGL, we need to manually handle DISPLAY_INVERT_COLOR
 static inline uint16_t invert_rgb565(uint16_t pixel) {
@@ -566,6 +618,127 @@ static inline uint16_t invert_rgb565(uint16_t pixel) {
     return (r << 11) | (g << 5) | b;
 }
 
+// Panel IO color-transfer done callback (ISR). Registered in place of the one from
+// lvgl_port_add_disp(): while strips are being sent it counts them, otherwise it
+// completes LVGL's flush exactly like the port's callback does
+static bool direct_strip_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t* edata,
+                                    void* user_ctx) {
+    if (direct_strip_active) {
+        BaseType_t task_woken = pdFALSE;
+        xSemaphoreGiveFromISR(direct_strip_done, &task_woken);
+        return task_woken == pdTRUE;
+    }
+    lv_display_flush_ready((lv_display_t*)user_ctx);
+    return false;
+}
+
+static void direct_strip_free(void) {
+    for (auto& buffer : direct_strip_buffers) {
+        if (buffer != nullptr) {
+            heap_caps_free(buffer);
+            buffer = nullptr;
+        }
+    }
+    direct_strip_count = 0;
+    direct_strip_rows = 0;
+}
+
+// Allocate the strip buffers: as many rows as the free DMA-capable heap allows (keeping
+// DIRECT_STRIP_HEAP_RESERVE), two buffers if possible, else one single-row strip
+static bool direct_strip_init(void) {
+    if (direct_lcd_io == nullptr || direct_lvgl_display == nullptr) {
+        ESP_LOGE(TAG, "Direct LCD output: panel IO not available");
+        return false;
+    }
+    if (direct_strip_done == nullptr) {
+        direct_strip_done = xSemaphoreCreateCounting(2, 0);
+        if (direct_strip_done == nullptr) {
+            return false;
+        }
+    }
+
+    size_t row_bytes = COMPOSITE_WIDTH * sizeof(uint16_t);
+    size_t free_dma = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    size_t rows = free_dma > DIRECT_STRIP_HEAP_RESERVE ? (free_dma - DIRECT_STRIP_HEAP_RESERVE) / (2 * row_bytes) : 1;
+    rows = std::clamp<size_t>(rows, 1, DIRECT_STRIP_MAX_ROWS);
+
+    // The free total may be fragmented: halve the strip until both buffers fit
+    while (true) {
+        direct_strip_buffers[0] = (uint16_t*)heap_caps_malloc(rows * row_bytes, MALLOC_CAP_DMA);
+        direct_strip_buffers[1] = (uint16_t*)heap_caps_malloc(rows * row_bytes, MALLOC_CAP_DMA);
+        if (direct_strip_buffers[0] != nullptr && direct_strip_buffers[1] != nullptr) {
+            direct_strip_count = 2;
+            break;
+        }
+        if (rows == 1) {
+            if (direct_strip_buffers[0] == nullptr) {
+                std::swap(direct_strip_buffers[0], direct_strip_buffers[1]);
+            }
+            direct_strip_count = direct_strip_buffers[0] != nullptr ? 1 : 0;
+            break;
+        }
+        heap_caps_free(direct_strip_buffers[0]);
+        heap_caps_free(direct_strip_buffers[1]);
+        direct_strip_buffers[0] = direct_strip_buffers[1] = nullptr;
+        rows /= 2;
+    }
+    if (direct_strip_count == 0) {
+        return false;
+    }
+    direct_strip_rows = rows;
+
+    esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = direct_strip_trans_done,
+    };
+    esp_lcd_panel_io_register_event_callbacks(direct_lcd_io, &cbs, direct_lvgl_display);
+    return true;
+}
+
+// Wait until at most max_inflight strips are still being sent
+static void direct_strip_wait(uint8_t max_inflight) {
+    int64_t start = esp_timer_get_time();
+    while (direct_strip_inflight > max_inflight) {
+        if (xSemaphoreTake(direct_strip_done, pdMS_TO_TICKS(DIRECT_STRIP_WAIT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "Direct LCD output: strip transfer timed out");
+        }
+        direct_strip_inflight--;
+    }
+    int64_t waited = esp_timer_get_time() - start;
+    render_stats.dma_wait_us += waited;
+    render_frame_wait_us += waited;
+}
+
+// Start a frame of strips (LVGL port lock held). LVGL's last flush may still be in flight:
+// a NOP command waits for queued color transfers, so its done callback has run before
+// the callbacks are counted as ours
+static void direct_strip_begin(void) {
+    esp_lcd_panel_io_tx_param(direct_lcd_io, LCD_CMD_NOP, nullptr, 0);
+    while (xSemaphoreTake(direct_strip_done, 0) == pdTRUE) {
+    }
+    direct_strip_inflight = 0;
+    direct_strip_active = true;
+}
+
+// Buffer for the next strip, once its previous transfer is done
+static uint16_t* direct_strip_acquire(void) {
+    direct_strip_wait(direct_strip_count - 1);
+    return direct_strip_buffers[direct_strip_next];
+}
+
+// Queue the strip acquired last; the buffer is not touched again until it is done
+static void direct_strip_send(int x1, int y1, int x2, int y2) {
+    esp_lcd_panel_draw_bitmap(direct_lcd_panel, x1, y1, x2, y2, direct_strip_buffers[direct_strip_next]);
+    direct_strip_inflight++;
+    direct_strip_next = (direct_strip_next + 1) % direct_strip_count;
+    render_stats.transfers++;
+}
+
+// Wait for every strip of the frame before the bus goes back to LVGL
+static void direct_strip_finish(void) {
+    direct_strip_wait(0);
+    direct_strip_active = false;
+}
+
 // Helper: Convert ARGB8888 to RGB565
 static inline uint16_t argb8888_to_rgb565(uint32_t argb) {
     uint8_t r = (argb >> 16) & 0xFF;
@@ -689,9 +862,9 @@ static void init_static_background(void) {
     }
 
     // Calculate background offset in partition
-    // Animation data: 78 frames × 26368 bytes = 2,056,704 bytes
+    // Animation data: 78 frames × 26368 bytes = 2,056,704 bytes (v1), or the pack size (v2)
     // Background data starts after animation data
-    size_t anim_data_size = (size_t)ANIM_FRAME_COUNT * ANIM_FRAME_SIZE_RAW;
+    size_t anim_data_size = anim_loader.GetTotalDataSize();
     size_t bg_offset = anim_data_size;
 
     ESP_LOGI(TAG, "Initializing BackgroundLoader at offset %u (after %d animation frames)",
@@ -709,7 +882,8 @@ static void init_static_background(void) {
 
     // Initialize ItemLoader (items come after backgrounds in partition)
     // Layout: animation data | background data (16 × 67968) | item data (2 × 2368)
-    size_t item_offset = bg_offset + ((size_t)BG_COUNT * BG_FRAME_SIZE_RAW);
+    size_t item_offset = bg_offset + (bg_loader.IsPacked() ? bg_loader.GetTotalDataSize()
+                                                           : (size_t)BG_COUNT * BG_FRAME_SIZE_RAW);
     auto& item_loader = ItemLoader::GetInstance();
     if (!item_loader.Initialize(partition, item_offset, ITEM_TYPE_COUNT)) {
         ESP_LOGW(TAG, "ItemLoader init failed - scene items disabled");
@@ -752,21 +926,16 @@ static void init_static_background(void) {
     }
 
     if (!composite_buffer) {
-        // Full composite buffer failed - try low-memory mode with row-by-row output
+        // Full composite buffer failed - try low-memory mode with strip-by-strip output
         ESP_LOGW(TAG, "Failed to allocate composite buffer (%u bytes) - trying low-memory mode", (unsigned)composite_size);
 
-        // Allocate composite row buffer (only 280 pixels = 560 bytes)
-        size_t row_size = COMPOSITE_WIDTH * sizeof(uint16_t);
-        composite_row_buffer = (uint16_t*)heap_caps_malloc(row_size, MALLOC_CAP_DMA);
-        if (!composite_row_buffer) {
-            composite_row_buffer = (uint16_t*)malloc(row_size);
-        }
-
-        if (composite_row_buffer) {
+        if (direct_strip_init()) {
             use_direct_lcd_mode = true;
-            ESP_LOGI(TAG, "Low-memory mode enabled: row-by-row direct LCD output (%u bytes)", (unsigned)row_size);
+            ESP_LOGI(TAG, "Low-memory mode enabled: %d x %d-row strips to the LCD (%u bytes each)",
+                     direct_strip_count, direct_strip_rows,
+                     (unsigned)(direct_strip_rows * COMPOSITE_WIDTH * sizeof(uint16_t)));
         } else {
-            ESP_LOGE(TAG, "Failed to allocate even row buffer - compositing disabled");
+            ESP_LOGE(TAG, "Failed to allocate even a one-row strip - compositing disabled");
             return;
         }
     } else {
@@ -787,9 +956,8 @@ static void init_static_background(void) {
             free(composite_buffer);
             composite_buffer = nullptr;
         }
-        if (composite_row_buffer) {
-            free(composite_row_buffer);
-            composite_row_buffer = nullptr;
+        if (use_direct_lcd_mode) {
+            direct_strip_free();
             use_direct_lcd_mode = false;
         }
         return;
@@ -832,11 +1000,16 @@ static void init_static_background(void) {
 
     // NOTE: Bar color is set by check_and_update_background() to avoid duplication
 
+    // Next-frame prefetch takes what memory is left after the compositing buffers
+    anim_loader.StartPrefetch();
+
     // Summary log
     if (use_direct_lcd_mode) {
         ESP_LOGI(TAG, "Background system initialized (LOW-MEMORY MODE):");
-        ESP_LOGI(TAG, "  Mode: Direct LCD row-by-row output");
-        ESP_LOGI(TAG, "  Buffers: composite_row=%p, bg_row=%p", composite_row_buffer, bg_row_buffer);
+        ESP_LOGI(TAG, "  Mode: Direct LCD output, %d-row strips (%s)", direct_strip_rows,
+                 direct_strip_count == 2 ? "double-buffered" : "single buffer");
+        ESP_LOGI(TAG, "  Buffers: strips=%p/%p, bg_row=%p",
+                 direct_strip_buffers[0], direct_strip_buffers[1], bg_row_buffer);
     } else {
         ESP_LOGI(TAG, "Background system initialized (NORMAL MODE):");
         ESP_LOGI(TAG, "  Buffers: composite=%p, bg_row=%p, static_bg=%p",
@@ -951,6 +1124,9 @@ static void animation_switch_to(const char* emotion_name) {
         return;  // Not found or already playing
     }
 
+    // The prefetched frame belongs to the old animation
+    loader.CancelPrefetch();
+
     // Get first frame - try ARGB8888, then RGB565A8, then RGB565 with chroma key
     const uint8_t* frame_data;
     if (loader.IsARGBAvailable()) {
@@ -984,6 +1160,7 @@ static void animation_switch_to(const char* emotion_name) {
     anim_mgr.frame_dsc.data = frame_data;
 
     anim_mgr.current_anim = anim;
+    loader.PinFrames(anim->start_frame, anim->frame_count);  // Keep this loop in the frame cache
     anim_mgr.current_frame = 0;
     anim_mgr.anim_direction = 1;
 
@@ -1231,6 +1408,15 @@ static void animation_timer_callback(void* arg) {
 
     auto& loader = AnimationLoader::GetInstance();
 
+    // Low internal RAM (TLS handshake, audio buffers): halve the frame cache each tick
+    // until the cache's own reserve is free again; the budget stays at the smaller size
+    if (heap_caps_get_free_size(MALLOC_CAP_INTERNAL) < ANIM_FRAME_CACHE_MIN_FREE_INTERNAL) {
+        size_t cached = loader.GetFrameCacheStats().bytes;
+        if (cached > 0) {
+            loader.TrimFrameCache(cached / 2);
+        }
+    }
+
     // Use current animation from anim_mgr (set by animation_switch_to)
     // If no animation is set, default to idle
     if (anim_mgr.current_anim == nullptr) {
@@ -1243,6 +1429,10 @@ static void animation_timer_callback(void* arg) {
     // Calculate global frame index from current animation
     uint16_t global_frame_idx = anim_mgr.current_anim->start_frame + anim_mgr.current_frame;
 
+    // Render time from here to advance_frame counts as busy (CPU utilisation in the stats)
+    int64_t render_start_us = esp_timer_get_time();
+    render_frame_wait_us = 0;
+
     // Always use RGB565 mode for compositing (chroma key transparency)
     // Background color comes from animation frame's palette (index 0)
     const uint8_t* frame_data = loader.GetFrameByIndex(global_frame_idx);
@@ -1251,6 +1441,14 @@ static void animation_timer_callback(void* arg) {
         return;
     }
 
+    // Read the next frame in the background while this one is composited and sent
+    // (the low-priority task runs whenever this callback waits on LVGL or the LCD)
+    uint16_t next_frame = anim_mgr.current_frame + 1;
+    if (next_frame >= anim_mgr.current_anim->frame_count) {
+        next_frame = 0;
+    }
+    loader.Prefetch(anim_mgr.current_anim->start_frame + next_frame);
+
     // Background transparency is determined by color range (green tones)
     // No need to read palette - just check if pixel color is within background range
 
@@ -1278,14 +1476,16 @@ static void animation_timer_callback(void* arg) {
     // Uses chroma key (0xF81F) for transparency (hard edges)
     bool use_composite = false;
     bool use_direct_output = false;
+    uint32_t frame_pixels = 0;      // Pixels composited this frame
+    uint32_t frame_spi_bytes = 0;   // Bytes pushed (or invalidated) this frame
 
     // Check which compositing mode to use
     if (composite_buffer != nullptr && bg_row_buffer != nullptr) {
         // Full buffer mode - composite to buffer, then display via LVGL
         use_composite = true;
-    } else if (use_direct_lcd_mode && composite_row_buffer != nullptr &&
+    } else if (use_direct_lcd_mode && direct_strip_count > 0 &&
                bg_row_buffer != nullptr && direct_lcd_panel != nullptr) {
-        // Low-memory mode - composite row by row, direct to LCD
+        // Low-memory mode - composite strip by strip, direct to LCD
         use_direct_output = true;
     }
 
@@ -1301,108 +1501,54 @@ static void animation_timer_callback(void* arg) {
             }
         }
 
-        auto& bg_loader = BackgroundLoader::GetInstance();
-        const uint16_t* anim_frame = (const uint16_t*)frame_data;  // RGB565 format
-
         // Background: 280x240 fullscreen (from BackgroundLoader)
-        // Animation: 160x160 source scaled to ANIM_SCALED_WIDTH x ANIM_SCALED_HEIGHT, with dynamic offset
-        // Chroma key (green tones) in animation means transparent - show background through
-
-        // Calculate dynamic animation offset (base + walk-off offset)
-        int16_t dyn_offset_x = ANIM_OFFSET_IN_COMPOSITE_X + anim_mgr.anim_offset_x;
-        int16_t dyn_offset_y = ANIM_OFFSET_IN_COMPOSITE_Y + anim_mgr.anim_offset_y;
+        // Animation: 160x160 source at a dynamic offset, chroma key (green tones) is transparent
+        // Opacity is resolved once per decoded frame into per-row opaque runs
 
         // Pre-compute item bounds once per frame (avoids 53K+ function calls)
-        bool has_items = prepare_item_bounds_cache();
-
-        // Composite row by row (only render rows that will be output to LCD)
-        // Skip top UI (0-24) and bottom UI (215-239), only render visible area (25-214)
-        for (uint16_t y = TOP_UI_HEIGHT; y < COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT; y++) {
-            // Get background row - from RAM buffer or decode from flash
-            uint16_t* bg_row = nullptr;
-            if (static_bg_buffer != nullptr) {
-                // Fast mode: background already in RAM (280x240)
-                bg_row = &static_bg_buffer[y * actual_bg_width];
-            } else if (bg_row_buffer != nullptr && bg_loader.IsInitialized()) {
-                // Slow mode: decode row from flash
-                bg_loader.DecodeRow(current_bg_idx, y, bg_row_buffer);
-                bg_row = bg_row_buffer;
-            }
-
-            // Check if this row overlaps with scaled animation area (using dynamic offset)
-            bool in_anim_y = ((int16_t)y >= dyn_offset_y &&
-                              (int16_t)y < dyn_offset_y + ANIM_SCALED_HEIGHT);
-            // Map scaled Y to source Y using nearest-neighbor sampling
-            int16_t scaled_y = (int16_t)y - dyn_offset_y;  // Position within scaled output
-            uint16_t src_y = (scaled_y >= 0 && scaled_y < ANIM_SCALED_HEIGHT)
-                           ? (scaled_y * ANIM_FRAME_HEIGHT) / ANIM_SCALED_HEIGHT : 0;
-
-            // Determine output buffer
-            uint16_t* out_row = use_direct_output ? composite_row_buffer
-                                                  : &composite_buffer[y * COMPOSITE_WIDTH];
+        prepare_item_bounds_cache();
+
+        // Find what changed since the last composited frame (sprite, items, background)
+        PetScene scene = {};
+        scene.bg_idx = current_bg_idx;
+        scene.frame_idx = global_frame_idx;
+        scene.frame_width = ANIM_SCALED_WIDTH;
+        scene.frame_height = ANIM_SCALED_HEIGHT;
+        scene.sprite_x = ANIM_OFFSET_IN_COMPOSITE_X + anim_mgr.anim_offset_x;  // Base + walk-off offset
+        scene.sprite_y = ANIM_OFFSET_IN_COMPOSITE_Y + anim_mgr.anim_offset_y;
+        scene.mirror = anim_mgr.anim_mirror_x;
+        scene.items = cached_items;
+        scene.item_count = cached_item_count;
+        static AnimationFrameSource anim_frames;
+        pet_compositor.BeginFrame(scene, anim_frames, use_direct_output);
+
+        CompositeBackgroundSource background(static_bg_buffer, actual_bg_width, current_bg_idx, bg_row_buffer);
+        uint8_t dirty_count = pet_compositor.GetDirtyRectCount();
 
-            // Note: Item rendering uses pre-decoded memory buffers, no cache invalidation needed
-
-            for (uint16_t x = 0; x < COMPOSITE_WIDTH; x++) {
-                uint16_t out_pixel;
-                uint16_t item_pixel;
-
-                // Check if this pixel overlaps with scaled animation area (using dynamic offset)
-                bool in_anim_x = ((int16_t)x >= dyn_offset_x &&
-                                  (int16_t)x < dyn_offset_x + ANIM_SCALED_WIDTH);
-
-                if (in_anim_y && in_anim_x) {
-                    // Inside scaled animation area - sample from source with scaling
-                    int16_t scaled_x = (int16_t)x - dyn_offset_x;  // Position within scaled output
-                    uint16_t src_x = (scaled_x >= 0 && scaled_x < ANIM_SCALED_WIDTH)
-                                   ? (scaled_x * ANIM_FRAME_WIDTH) / ANIM_SCALED_WIDTH : 0;
-                    // Apply horizontal mirror if walking back (face right instead of left)
-                    if (anim_mgr.anim_mirror_x) {
-                        src_x = ANIM_FRAME_WIDTH - 1 - src_x;
-                    }
-                    uint16_t anim_pixel = anim_frame[src_y * ANIM_FRAME_WIDTH + src_x];
-
-                    if (is_background_color(anim_pixel)) {
-                        // Transparent animation pixel - check items first, then background
-                        if (has_items && sample_item_pixel_fast(x, y, &item_pixel)) {
-                            out_pixel = item_pixel;
-                        } else {
-                            out_pixel = (bg_row != nullptr) ? bg_row[x] : 0x0000;
-                        }
-                    } else {
-                        // Opaque animation pixel
-                        out_pixel = anim_pixel;
-                    }
-                } else {
-                    // Outside animation area - check items first, then background
-                    if (has_items && sample_item_pixel_fast(x, y, &item_pixel)) {
-                        out_pixel = item_pixel;
-                    } else {
-                        out_pixel = (bg_row != nullptr) ? bg_row[x] : 0x0000;
-                    }
-                }
-
-                // In direct LCD mode, need to swap bytes (LCD expects big-endian)
-                // LVGL handles this automatically, but we bypass LVGL in direct output
-                if (use_direct_output) {
-                    out_row[x] = swap_bytes_rgb565(out_pixel);
-                } else {
-                    out_row[x] = out_pixel;
-                }
+        if (use_direct_output) {
+            // Each dirty rect is sent as strips of up to direct_strip_rows rows: one panel
+            // transaction per strip, composited while the previous strip is DMA'd
+            // Dirty rects are disjoint and never cover the LVGL-drawn bars (rows 0-24, 215-239)
+            // LCD expects big-endian; LVGL does this swap, but we bypass LVGL here
+            if (dirty_count > 0) {
+                direct_strip_begin();
+                frame_pixels = pet_compositor.CompositeStrips(background, direct_strip_rows, true,
+                    direct_strip_acquire,
+                    [](const DirtyRect& rect, int16_t y1, int16_t y2) {
+                        direct_strip_send(DISPLAY_OFFSET_X + rect.x1, COMPOSITE_SCREEN_Y + y1,
+                                          DISPLAY_OFFSET_X + rect.x2, COMPOSITE_SCREEN_Y + y2);
+                    });
+                frame_spi_bytes = frame_pixels * sizeof(uint16_t);
+                direct_strip_finish();
             }
 
-            // In direct output mode, send each row immediately to LCD
-            // Skip top UI area (0-24) and bottom UI area (210-239) to preserve LVGL-drawn elements
-            // Only output rows 25-209 (185 rows) to LCD
-            if (use_direct_output) {
-                int screen_y = COMPOSITE_SCREEN_Y + y;
-                if (screen_y >= TOP_UI_HEIGHT && screen_y < (COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT)) {
-                    esp_lcd_panel_draw_bitmap(direct_lcd_panel,
-                                              DISPLAY_OFFSET_X, screen_y,
-                                              DISPLAY_OFFSET_X + COMPOSITE_WIDTH, screen_y + 1,
-                                              out_row);
-                }
-            }
+            // Everything dirty has been pushed to the panel
+            pet_compositor.ClearDamage();
+            render_stats_frame(frame_pixels, frame_spi_bytes);
+        } else {
+            // Composite row by row, only the dirty spans of each row
+            // Note: Item rendering uses pre-decoded memory buffers, no cache invalidation needed
+            frame_pixels = pet_compositor.CompositeDirty(background, composite_buffer);
         }
 
         // Release LVGL lock if we acquired it for direct output
@@ -1411,28 +1557,61 @@ static void animation_timer_callback(void* arg) {
         }
     }
 
-    // Skip LVGL image update if using direct LCD output (already sent row by row)
-    if (!use_direct_output) {
-        // Update frame descriptor for composite output (exclude bottom UI area)
-        size_t composite_pixels = COMPOSITE_WIDTH * (COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT);
-        anim_mgr.frame_dsc.header.w = COMPOSITE_WIDTH;
-        anim_mgr.frame_dsc.header.h = COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT;  // 210 rows (240 - 30)
-        if (use_composite) {
-            // Composited output is always RGB565
+    if (use_composite) {
+        // The image source only needs setting when the descriptor was pointed elsewhere
+        // (first frame, or animation_switch_to() loaded a raw frame into it)
+        static bool set_src = true;
+        if (anim_mgr.frame_dsc.data != (const uint8_t*)composite_buffer) {
+            set_src = true;
+            // Composited output is always RGB565 (exclude bottom UI area)
+            anim_mgr.frame_dsc.header.w = COMPOSITE_WIDTH;
+            anim_mgr.frame_dsc.header.h = COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT;  // 215 rows (240 - 25)
             anim_mgr.frame_dsc.header.cf = LV_COLOR_FORMAT_RGB565;
             anim_mgr.frame_dsc.header.stride = COMPOSITE_WIDTH * 2;
-            anim_mgr.frame_dsc.data_size = composite_pixels * sizeof(uint16_t);
+            anim_mgr.frame_dsc.data_size = COMPOSITE_WIDTH * (COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT) * sizeof(uint16_t);
             anim_mgr.frame_dsc.data = (const uint8_t*)composite_buffer;
-        } else {
-            // No compositing available - fallback to animation only (160x128)
-            anim_mgr.frame_dsc.header.w = ANIM_FRAME_WIDTH;
-            anim_mgr.frame_dsc.header.h = ANIM_FRAME_HEIGHT;
-            anim_mgr.frame_dsc.header.cf = LV_COLOR_FORMAT_RGB565;
-            anim_mgr.frame_dsc.header.stride = ANIM_FRAME_WIDTH * 2;
-            anim_mgr.frame_dsc.data_size = ANIM_FRAME_SIZE_RGB565;
-            anim_mgr.frame_dsc.data = frame_data;
         }
 
+        uint8_t dirty_count = pet_compositor.GetDirtyRectCount();
+        if (!set_src && dirty_count == 0) {
+            render_stats_frame(frame_pixels, 0);
+        } else if (lvgl_port_lock(0)) {
+            if (set_src) {
+                lv_image_set_src(anim_mgr.bg_image, &anim_mgr.frame_dsc);
+                lv_obj_invalidate(anim_mgr.bg_image);
+                frame_spi_bytes = anim_mgr.frame_dsc.data_size;
+                set_src = false;
+            } else {
+                // Only the dirty rects are redrawn by LVGL and flushed to the panel
+                lv_image_cache_drop(&anim_mgr.frame_dsc);
+                lv_area_t coords;
+                lv_obj_get_coords(anim_mgr.bg_image, &coords);
+                for (uint8_t r = 0; r < dirty_count; r++) {
+                    const DirtyRect& rect = pet_compositor.GetDirtyRect(r);
+                    lv_area_t area = {
+                        .x1 = coords.x1 + rect.x1,
+                        .y1 = coords.y1 + rect.y1,
+                        .x2 = coords.x1 + rect.x2 - 1,
+                        .y2 = coords.y1 + rect.y2 - 1,
+                    };
+                    lv_obj_invalidate_area(anim_mgr.bg_image, &area);
+                    frame_spi_bytes += (rect.x2 - rect.x1) * (rect.y2 - rect.y1) * sizeof(uint16_t);
+                }
+            }
+            pet_compositor.ClearDamage();
+            lvgl_port_unlock();
+            render_stats_frame(frame_pixels, frame_spi_bytes);
+        }
+        // LVGL busy: the dirty rects stay queued and are invalidated with the next frame
+    } else if (!use_direct_output) {
+        // No compositing available - fallback to animation only (160x128)
+        anim_mgr.frame_dsc.header.w = ANIM_FRAME_WIDTH;
+        anim_mgr.frame_dsc.header.h = ANIM_FRAME_HEIGHT;
+        anim_mgr.frame_dsc.header.cf = LV_COLOR_FORMAT_RGB565;
+        anim_mgr.frame_dsc.header.stride = ANIM_FRAME_WIDTH * 2;
+        anim_mgr.frame_dsc.data_size = ANIM_FRAME_SIZE_RGB565;
+        anim_mgr.frame_dsc.data = frame_data;
+
         // Update LVGL image
         if (lvgl_port_lock(0)) {
             lv_image_set_src(anim_mgr.bg_image, &anim_mgr.frame_dsc);
@@ -1442,6 +1621,8 @@ static void animation_timer_callback(void* arg) {
     }
 
 advance_frame:
+    render_stats.busy_us += esp_timer_get_time() - render_start_us - render_frame_wait_us;
+
     // Advance to next frame within current animation (loop within animation)
     if (anim_mgr.current_anim != nullptr) {
         anim_mgr.current_frame++;
@@ -1925,6 +2106,8 @@ public:
                     width, height, offset_x, offset_y, mirror_x, mirror_y, swap_xy) {
         // Store LCD panel handle for direct output mode (low memory fallback)
         direct_lcd_panel = panel_handle;
+        direct_lcd_io = io_handle;
+        direct_lvgl_display = display_;
 
         DisplayLockGuard lock(this);
         lv_obj_set_style_pad_left(status_bar_, LV_HOR_RES * 0.1, 0);
@@ -2529,6 +2712,7 @@ private:
         ESP_LOGI(TAG, "关机任务开始执行");
 
         board->GetDisplay()->ShowNotification("正在关机...");
+        MemoryStorage::GetInstance().Flush();  // 写回延迟提交的记忆
         vTaskDelay(pdMS_TO_TICKS(500));  // 等待显示
 
         ESP_LOGI(TAG, "调用 PowerOff()");
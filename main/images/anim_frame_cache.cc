@@ -0,0 +1,157 @@
+#include "anim_frame_cache.h"
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+
+#define TAG "AnimFrameCache"
+
+AnimFrameCache::~AnimFrameCache() {
+    Clear();
+}
+
+void AnimFrameCache::Configure(size_t pixel_bytes, size_t palette_colors, size_t budget_bytes) {
+    pixel_bytes_ = pixel_bytes;
+    palette_colors_ = palette_colors;
+    // Palette follows the pixels in the same block, keep it 2-byte aligned
+    entry_bytes_ = ((pixel_bytes + 1) & ~(size_t)1) + palette_colors * sizeof(uint16_t);
+    budget_ = budget_bytes;
+    entries_.reserve(budget_ / entry_bytes_);
+}
+
+const AnimFrameCache::Entry* AnimFrameCache::Lookup(uint16_t frame_idx) {
+    for (auto& entry : entries_) {
+        if (entry.frame_idx == frame_idx) {
+            entry.last_use = ++clock_;
+            hits_++;
+            return &entry;
+        }
+    }
+    misses_++;
+    return nullptr;
+}
+
+int AnimFrameCache::FindVictim(bool allow_pinned) const {
+    int victim = -1;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (!allow_pinned && IsPinned(entries_[i].frame_idx)) {
+            continue;
+        }
+        if (victim < 0 || entries_[i].last_use < entries_[victim].last_use) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+void AnimFrameCache::Free(size_t index) {
+    heap_caps_free(entries_[index].pixels);
+    entries_[index] = entries_.back();
+    entries_.pop_back();
+}
+
+AnimFrameCache::Entry* AnimFrameCache::Insert(uint16_t frame_idx) {
+    if (entry_bytes_ == 0 || budget_ < entry_bytes_) {
+        return nullptr;
+    }
+
+    uint8_t* block = nullptr;
+    if ((entries_.size() + 1) * entry_bytes_ > budget_) {
+        // Full: reuse the least recently used unpinned block. Pinned frames never
+        // displace each other - when the pinned animation is larger than the budget,
+        // keeping the frames already cached still hits every loop, whereas cycling
+        // through them LRU would never hit
+        int victim = FindVictim(false);
+        if (victim < 0) {
+            return nullptr;
+        }
+        block = entries_[victim].pixels;
+        entries_[victim] = entries_.back();
+        entries_.pop_back();
+    } else {
+        block = (uint8_t*)heap_caps_malloc(entry_bytes_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (block == nullptr &&
+            heap_caps_get_free_size(MALLOC_CAP_INTERNAL) > entry_bytes_ + ANIM_FRAME_CACHE_MIN_FREE_INTERNAL) {
+            block = (uint8_t*)heap_caps_malloc(entry_bytes_, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+        if (block == nullptr) {
+            // Out of memory before reaching the budget: settle at the current size
+            budget_ = entries_.size() * entry_bytes_;
+            ESP_LOGW(TAG, "Low memory, cache limited to %u frames", (unsigned)entries_.size());
+            return nullptr;
+        }
+    }
+
+    Entry entry;
+    entry.frame_idx = frame_idx;
+    entry.last_use = ++clock_;
+    entry.pixels = block;
+    entry.palette = (uint16_t*)(block + entry_bytes_ - palette_colors_ * sizeof(uint16_t));
+    entries_.push_back(entry);
+    return &entries_.back();
+}
+
+uint8_t* AnimFrameCache::SwapBlock(Entry* entry, uint8_t* block) {
+    uint8_t* old_block = entry->pixels;
+    entry->pixels = block;
+    entry->palette = (uint16_t*)(block + entry_bytes_ - palette_colors_ * sizeof(uint16_t));
+    return old_block;
+}
+
+bool AnimFrameCache::Contains(uint16_t frame_idx) const {
+    for (const auto& entry : entries_) {
+        if (entry.frame_idx == frame_idx) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AnimFrameCache::Remove(Entry* entry) {
+    size_t index = entry - entries_.data();
+    if (index < entries_.size()) {
+        Free(index);
+    }
+}
+
+void AnimFrameCache::Pin(uint16_t start, uint16_t count) {
+    pin_start_ = start;
+    pin_end_ = start + count;
+}
+
+void AnimFrameCache::Clear() {
+    while (!entries_.empty()) {
+        Free(entries_.size() - 1);
+    }
+}
+
+void AnimFrameCache::Shrink(size_t max_bytes) {
+    size_t before = entries_.size();
+    while (entries_.size() * entry_bytes_ > max_bytes) {
+        int victim = FindVictim(false);
+        if (victim < 0) {
+            victim = FindVictim(true);
+        }
+        Free(victim);
+    }
+    if (max_bytes < budget_) {
+        budget_ = max_bytes;
+    }
+    if (before != entries_.size()) {
+        ESP_LOGI(TAG, "Shrunk from %u to %u frames (budget %u bytes)",
+                 (unsigned)before, (unsigned)entries_.size(), (unsigned)budget_);
+    }
+}
+
+AnimFrameCacheStats AnimFrameCache::GetStats() const {
+    AnimFrameCacheStats stats = {};
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.frames = entries_.size();
+    for (const auto& entry : entries_) {
+        if (IsPinned(entry.frame_idx)) {
+            stats.pinned++;
+        }
+    }
+    stats.bytes = entries_.size() * entry_bytes_;
+    stats.budget = budget_;
+    return stats;
+}
@@ -0,0 +1,89 @@
+#ifndef _ANIM_FRAME_CACHE_H_
+#define _ANIM_FRAME_CACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Keep at least this much internal RAM free when the cache allocates from it
+// (PSRAM is used first when available)
+#define ANIM_FRAME_CACHE_MIN_FREE_INTERNAL  (64 * 1024)
+
+struct AnimFrameCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint16_t frames;        // Frames currently cached
+    uint16_t pinned;        // Of which inside the pinned range
+    size_t bytes;           // Bytes held by cached frames
+    size_t budget;          // Current byte budget
+};
+
+// Cache of flash frames for AnimationLoader: raw 8-bit indices plus the palette
+// already converted to RGB565, so a hit skips both the 26 KB flash read and the
+// palette conversion. Frames are evicted least-recently-used first; frames in the
+// pinned range (the current animation) are only evicted when memory is reclaimed
+class AnimFrameCache {
+public:
+    struct Entry {
+        uint16_t frame_idx;
+        uint32_t last_use;
+        uint8_t* pixels;        // pixel_bytes indices
+        uint16_t* palette;      // palette_colors RGB565 entries, right after pixels
+    };
+
+    ~AnimFrameCache();
+
+    // Frame geometry; must be called once before use
+    void Configure(size_t pixel_bytes, size_t palette_colors, size_t budget_bytes);
+
+    // Cached frame, or nullptr (counted as hit / miss)
+    const Entry* Lookup(uint16_t frame_idx);
+
+    // Slot to read a missed frame into, evicting LRU frames as needed
+    // Returns nullptr if the frame does not fit in the budget or memory
+    Entry* Insert(uint16_t frame_idx);
+
+    // Give a slot returned by Insert() the already filled block instead (same layout,
+    // GetEntryBytes() long) and return the slot's previous block to the caller
+    uint8_t* SwapBlock(Entry* entry, uint8_t* block);
+
+    // Whether frame_idx is cached (not counted as a hit or miss)
+    bool Contains(uint16_t frame_idx) const;
+
+    // Drop a slot returned by Insert() whose read failed
+    void Remove(Entry* entry);
+
+    // Frames [start, start + count) are not evicted to make room for other frames
+    void Pin(uint16_t start, uint16_t count);
+
+    // Free all cached frames; the budget is kept and the cache refills on demand
+    void Clear();
+
+    // Memory pressure: free frames (unpinned first) until at most max_bytes are held,
+    // and keep the budget at that size from now on
+    void Shrink(size_t max_bytes);
+
+    AnimFrameCacheStats GetStats() const;
+    size_t GetEntryBytes() const { return entry_bytes_; }
+
+private:
+    bool IsPinned(uint16_t frame_idx) const {
+        return frame_idx >= pin_start_ && frame_idx < pin_end_;
+    }
+    // Index of the least recently used entry (optionally skipping pinned ones), or -1
+    int FindVictim(bool allow_pinned) const;
+    void Free(size_t index);
+
+    size_t pixel_bytes_ = 0;
+    size_t palette_colors_ = 0;
+    size_t entry_bytes_ = 0;
+    size_t budget_ = 0;
+    uint16_t pin_start_ = 0;
+    uint16_t pin_end_ = 0;
+    uint32_t clock_ = 0;
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+    std::vector<Entry> entries_;
+};
+
+#endif // _ANIM_FRAME_CACHE_H_
@@ -1,8 +1,10 @@
 #include "animation_loader.h"
+#include "asset_map.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
 #include <esp_system.h>
 #include <string.h>
+#include <chrono>
 
 #define TAG "AnimLoader"
 
@@ -66,15 +68,38 @@ AnimationLoader& AnimationLoader::GetInstance() {
 AnimationLoader::AnimationLoader()
     : initialized_(false)
     , partition_(nullptr)
+    , mapped_frames_(nullptr)
     , pixel_buffer_(nullptr)
+    , palette_(nullptr)
     , cached_frame_idx_(0xFFFF)
+    , frame_pixels_(nullptr)
+    , frame_palette_(nullptr)
+    , prefetch_task_(nullptr)
+    , prefetch_buffer_(nullptr)
+    , prefetch_state_(kPrefetchIdle)
+    , prefetch_frame_(0xFFFF)
+    , prefetch_request_(0xFFFF)
+    , prefetch_generation_(0)
+    , prefetch_hits_(0)
+    , delta_base_(0xFFFF)
+    , delta_frames_(0)
     , decode_buffer_(nullptr)
+    , expanded_frame_(0xFFFF)
     , decode_buffer_argb_(nullptr)
     , decode_buffer_rgb565a8_(nullptr) {
-    memset(palette_, 0, sizeof(palette_));
 }
 
 AnimationLoader::~AnimationLoader() {
+    if (prefetch_task_) {
+        vTaskDelete(prefetch_task_);
+        prefetch_task_ = nullptr;
+    }
+
+    if (prefetch_buffer_) {
+        heap_caps_free(prefetch_buffer_);
+        prefetch_buffer_ = nullptr;
+    }
+
     if (pixel_buffer_) {
         heap_caps_free(pixel_buffer_);
         pixel_buffer_ = nullptr;
@@ -115,24 +140,58 @@ bool AnimationLoader::Initialize() {
     ESP_LOGI(TAG, "Assets partition found: %s, size: %lu KB",
              partition_->label, partition_->size / 1024);
 
-    // Log format info
-    ESP_LOGI(TAG, "Frame format:");
-    ESP_LOGI(TAG, "  Size: %dx%d", ANIM_FRAME_WIDTH, ANIM_FRAME_HEIGHT);
-    ESP_LOGI(TAG, "  Palette: %d colors (RGB888, %d bytes)", ANIM_PALETTE_COLORS, ANIM_PALETTE_SIZE);
-    ESP_LOGI(TAG, "  Pixels: %d bytes (8-bit indexed)", ANIM_PIXELS_SIZE);
-    ESP_LOGI(TAG, "  Frame size: %d bytes", ANIM_FRAME_SIZE_RAW);
-    ESP_LOGI(TAG, "  Total frames: %d", ANIM_TOTAL_FRAMES);
-    ESP_LOGI(TAG, "  Total data: %u bytes (%.1f MB)",
-             (unsigned)(ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW),
-             (ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW) / (1024.0f * 1024.0f));
-
-    // Allocate pixel buffer for reading from flash
-    pixel_buffer_ = (uint8_t*)heap_caps_malloc(ANIM_PIXELS_SIZE, MALLOC_CAP_DMA);
+    if (pack_.Open(partition_, 0)) {
+        // v2: header, one RGB565 palette per animation, RLE rows
+        if (pack_.GetWidth() != ANIM_FRAME_WIDTH || pack_.GetHeight() != ANIM_FRAME_HEIGHT ||
+            pack_.GetFrameCount() < ANIM_TOTAL_FRAMES || pack_.GetColors() > ANIM_PALETTE_COLORS) {
+            ESP_LOGE(TAG, "Asset pack is %dx%d with %d frames, expected %dx%d with %d frames",
+                     pack_.GetWidth(), pack_.GetHeight(), pack_.GetFrameCount(),
+                     ANIM_FRAME_WIDTH, ANIM_FRAME_HEIGHT, ANIM_TOTAL_FRAMES);
+            return false;
+        }
+        ESP_LOGI(TAG, "Frame format: asset pack v2, %d palettes, %u bytes%s",
+                 pack_.GetPaletteCount(), (unsigned)pack_.GetDataSize(),
+                 pack_.HasDeltas() ? ", delta frames" : "");
+    } else {
+        // Log format info (v1: headerless, per-frame RGB888 palette)
+        ESP_LOGI(TAG, "Frame format:");
+        ESP_LOGI(TAG, "  Size: %dx%d", ANIM_FRAME_WIDTH, ANIM_FRAME_HEIGHT);
+        ESP_LOGI(TAG, "  Palette: %d colors (RGB888, %d bytes)", ANIM_PALETTE_COLORS, ANIM_PALETTE_SIZE);
+        ESP_LOGI(TAG, "  Pixels: %d bytes (8-bit indexed)", ANIM_PIXELS_SIZE);
+        ESP_LOGI(TAG, "  Frame size: %d bytes", ANIM_FRAME_SIZE_RAW);
+        ESP_LOGI(TAG, "  Total frames: %d", ANIM_TOTAL_FRAMES);
+        ESP_LOGI(TAG, "  Total data: %u bytes (%.1f MB)",
+                 (unsigned)(ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW),
+                 (ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW) / (1024.0f * 1024.0f));
+
+        // Uncompressed indices can be used where they are in flash
+        mapped_frames_ = AssetMap::GetInstance().Data(partition_, 0, (size_t)ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW);
+    }
+
+    // Allocate pixel buffer (indices + converted palette) for reading from flash,
+    // or only the palette when the indices are read in place
+    size_t block_size = mapped_frames_ != nullptr ? ANIM_PALETTE_COLORS * sizeof(uint16_t) : ANIM_FRAME_BLOCK_SIZE;
+    pixel_buffer_ = (uint8_t*)heap_caps_malloc(block_size, MALLOC_CAP_DMA);
     if (!pixel_buffer_) {
-        ESP_LOGE(TAG, "Failed to allocate pixel buffer (%d bytes)", ANIM_PIXELS_SIZE);
+        ESP_LOGE(TAG, "Failed to allocate pixel buffer (%u bytes)", (unsigned)block_size);
         return false;
     }
-    ESP_LOGI(TAG, "Pixel buffer allocated: %d bytes", ANIM_PIXELS_SIZE);
+    ESP_LOGI(TAG, "Pixel buffer allocated: %u bytes", (unsigned)block_size);
+    palette_ = mapped_frames_ != nullptr ? (uint16_t*)pixel_buffer_ : BlockPalette(pixel_buffer_);
+    memset(palette_, 0, ANIM_PALETTE_COLORS * sizeof(uint16_t));
+    frame_pixels_ = pixel_buffer_;
+    frame_palette_ = palette_;
+
+    // Mapped v1 frames are already addressable: caching copies of them only costs RAM
+    size_t cache_budget = mapped_frames_ != nullptr ? 0 : (size_t)CONFIG_ANIM_FRAME_CACHE_SIZE_KB * 1024;
+    frame_cache_.Configure(ANIM_PIXELS_SIZE, ANIM_PALETTE_COLORS, cache_budget);
+    ESP_LOGI(TAG, "Frame cache budget: %u KB (%u bytes per frame)",
+             (unsigned)(cache_budget / 1024), (unsigned)frame_cache_.GetEntryBytes());
+    if (mapped_frames_ != nullptr) {
+        ESP_LOGI(TAG, "Frames read in place from flash: %u bytes of frame block, %d KB frame cache and "
+                 "the prefetch block not allocated",
+                 (unsigned)(ANIM_FRAME_BLOCK_SIZE - block_size), CONFIG_ANIM_FRAME_CACHE_SIZE_KB);
+    }
 
     // Allocate decode buffer for legacy API (one full frame RGB565)
     size_t decode_buf_size = ANIM_FRAME_SIZE_RGB565;
@@ -205,6 +264,163 @@ void AnimationLoader::FreeTransparentBuffers() {
     }
 }
 
+void AnimationLoader::PinFrames(uint16_t start_frame, uint16_t count) {
+    frame_cache_.Pin(start_frame, count);
+}
+
+void AnimationLoader::TrimFrameCache(size_t max_bytes) {
+    frame_cache_.Shrink(max_bytes);
+    // The current frame may have been freed, re-read it on next use
+    cached_frame_idx_ = 0xFFFF;
+    frame_pixels_ = pixel_buffer_;
+    frame_palette_ = palette_;
+}
+
+bool AnimationLoader::StartPrefetch() {
+    if (!initialized_) {
+        return false;
+    }
+    if (prefetch_task_ != nullptr) {
+        return true;
+    }
+    if (mapped_frames_ != nullptr) {
+        ESP_LOGI(TAG, "Frames are read in place, no prefetch needed");
+        return false;
+    }
+
+    // Second frame block for the task to read into; only from PSRAM or spare internal RAM,
+    // the compositing buffers come first
+    prefetch_buffer_ = (uint8_t*)heap_caps_malloc(ANIM_FRAME_BLOCK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!prefetch_buffer_ &&
+        heap_caps_get_free_size(MALLOC_CAP_INTERNAL) > ANIM_FRAME_BLOCK_SIZE + ANIM_FRAME_CACHE_MIN_FREE_INTERNAL) {
+        prefetch_buffer_ = (uint8_t*)heap_caps_malloc(ANIM_FRAME_BLOCK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!prefetch_buffer_) {
+        ESP_LOGW(TAG, "Not enough memory for frame prefetch, frames are read inline");
+        return false;
+    }
+
+    if (xTaskCreate([](void* arg) {
+        AnimationLoader* loader = (AnimationLoader*)arg;
+        loader->PrefetchLoop();
+        vTaskDelete(NULL);
+    }, "anim_prefetch", ANIM_PREFETCH_TASK_STACK, this, ANIM_PREFETCH_TASK_PRIORITY, &prefetch_task_) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create prefetch task");
+        heap_caps_free(prefetch_buffer_);
+        prefetch_buffer_ = nullptr;
+        prefetch_task_ = nullptr;
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Frame prefetch started (%d bytes)", ANIM_FRAME_BLOCK_SIZE);
+    return true;
+}
+
+void AnimationLoader::Prefetch(uint16_t frame_idx) {
+    if (prefetch_task_ == nullptr || frame_idx >= ANIM_TOTAL_FRAMES ||
+        frame_idx == cached_frame_idx_ || frame_cache_.Contains(frame_idx)) {
+        return;
+    }
+    // A delta from the current frame is a small read that is patched inline; the task
+    // would have to rebuild the frame from its key frame instead
+    if (pack_.HasDelta(frame_idx, cached_frame_idx_)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        if (prefetch_frame_ == frame_idx && prefetch_state_ != kPrefetchIdle) {
+            return;  // Already loading or ready
+        }
+        prefetch_request_ = frame_idx;
+    }
+    xTaskNotifyGive(prefetch_task_);
+}
+
+void AnimationLoader::CancelPrefetch() {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_request_ = 0xFFFF;
+    prefetch_generation_++;  // An in-flight read finishes into the buffer but is discarded
+    if (prefetch_state_ == kPrefetchReady) {
+        prefetch_state_ = kPrefetchIdle;
+        prefetch_frame_ = 0xFFFF;
+    }
+}
+
+void AnimationLoader::PrefetchLoop() {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (true) {
+            uint16_t frame_idx;
+            uint32_t generation;
+            uint8_t* block;
+            {
+                std::lock_guard<std::mutex> lock(prefetch_mutex_);
+                if (prefetch_request_ == 0xFFFF) {
+                    break;
+                }
+                frame_idx = prefetch_request_;
+                prefetch_request_ = 0xFFFF;
+                prefetch_state_ = kPrefetchLoading;
+                prefetch_frame_ = frame_idx;
+                generation = prefetch_generation_;
+                block = prefetch_buffer_;
+            }
+
+            // Flash read outside the lock; prefetch_buffer_ is ours until the state changes
+            bool ok = ReadFrame(frame_idx, block, BlockPalette(block));
+
+            {
+                std::lock_guard<std::mutex> lock(prefetch_mutex_);
+                if (ok && generation == prefetch_generation_) {
+                    prefetch_state_ = kPrefetchReady;
+                } else {
+                    prefetch_state_ = kPrefetchIdle;
+                    prefetch_frame_ = 0xFFFF;
+                }
+            }
+            prefetch_cv_.notify_all();
+        }
+    }
+}
+
+bool AnimationLoader::TakePrefetched(uint16_t frame_idx) const {
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+    if (prefetch_buffer_ == nullptr || prefetch_frame_ != frame_idx) {
+        return false;
+    }
+    if (prefetch_state_ == kPrefetchLoading) {
+        // Already being read: finishing that read is quicker than starting another
+        prefetch_cv_.wait_for(lock, std::chrono::milliseconds(ANIM_PREFETCH_WAIT_MS), [this, frame_idx] {
+            return prefetch_state_ != kPrefetchLoading || prefetch_frame_ != frame_idx;
+        });
+    }
+    if (prefetch_state_ != kPrefetchReady || prefetch_frame_ != frame_idx) {
+        return false;
+    }
+
+    // Swap buffers instead of copying: the filled block becomes a cache entry (the task
+    // gets the slot's old block) or the scratch block (the task gets the old scratch)
+    uint8_t* block = prefetch_buffer_;
+    AnimFrameCache::Entry* slot = frame_cache_.Insert(frame_idx);
+    if (slot != nullptr) {
+        prefetch_buffer_ = frame_cache_.SwapBlock(slot, block);
+        frame_palette_ = slot->palette;
+    } else {
+        prefetch_buffer_ = pixel_buffer_;
+        pixel_buffer_ = block;
+        palette_ = BlockPalette(block);
+        frame_palette_ = palette_;
+    }
+    frame_pixels_ = block;
+    cached_frame_idx_ = frame_idx;
+    prefetch_state_ = kPrefetchIdle;
+    prefetch_frame_ = 0xFFFF;
+    prefetch_hits_++;
+    return true;
+}
+
 const AnimationDef* AnimationLoader::GetAnimationDef(AnimLoaderType type) const {
     if (type >= ANIM_TYPE_COUNT) {
         return &ANIMATION_TABLE[ANIM_IDLE];
@@ -250,6 +466,106 @@ bool AnimationLoader::ReadAndDecodeFrame(uint16_t frame_idx) const {
     if (frame_idx == cached_frame_idx_) {
         return true;
     }
+    delta_base_ = 0xFFFF;
+
+    // v1 mapped: the indices are used in place, only the palette is converted
+    if (mapped_frames_ != nullptr) {
+        const uint8_t* frame = mapped_frames_ + (size_t)frame_idx * ANIM_FRAME_SIZE_RAW;
+        for (int i = 0; i < ANIM_PALETTE_COLORS; i++) {
+            palette_[i] = rgb888_to_rgb565(frame[i * 3], frame[i * 3 + 1], frame[i * 3 + 2]);
+        }
+        frame_pixels_ = frame + ANIM_PALETTE_SIZE;
+        frame_palette_ = palette_;
+        cached_frame_idx_ = frame_idx;
+        return true;
+    }
+
+    // Frame cache hit: indices and converted palette are already in RAM
+    const AnimFrameCache::Entry* hit = frame_cache_.Lookup(frame_idx);
+    if (hit != nullptr) {
+        frame_pixels_ = hit->pixels;
+        frame_palette_ = hit->palette;
+        cached_frame_idx_ = frame_idx;
+        return true;
+    }
+
+    // Next frame of a delta-encoded animation: read only what changed
+    if (PatchFromCurrent(frame_idx)) {
+        return true;
+    }
+
+    // Prefetched in the background: swap its buffer in
+    if (TakePrefetched(frame_idx)) {
+        return true;
+    }
+
+    // Miss: read straight into a cache slot if one is available, else the scratch buffers
+    // (the slot may reuse the current frame's memory, so the current frame is invalid from here)
+    AnimFrameCache::Entry* slot = frame_cache_.Insert(frame_idx);
+    uint8_t* pixels = slot != nullptr ? slot->pixels : pixel_buffer_;
+    uint16_t* palette = slot != nullptr ? slot->palette : palette_;
+    cached_frame_idx_ = 0xFFFF;
+
+    if (!ReadFrame(frame_idx, pixels, palette)) {
+        if (slot != nullptr) {
+            frame_cache_.Remove(slot);
+        }
+        return false;
+    }
+
+    frame_pixels_ = pixels;
+    frame_palette_ = palette;
+    cached_frame_idx_ = frame_idx;
+    return true;
+}
+
+bool AnimationLoader::PatchFromCurrent(uint16_t frame_idx) const {
+    uint16_t base_idx = cached_frame_idx_;
+    if (base_idx == 0xFFFF || !pack_.HasDelta(frame_idx, base_idx)) {
+        return false;
+    }
+
+    // Patch a copy of the current frame in the new frame's slot, or the current frame itself
+    // when it is the scratch block (or the LRU slot handed back). Both share a palette
+    const uint8_t* base_pixels = frame_pixels_;
+    const uint16_t* base_palette = frame_palette_;
+    AnimFrameCache::Entry* slot = frame_cache_.Insert(frame_idx);
+    uint8_t* pixels = slot != nullptr ? slot->pixels : pixel_buffer_;
+    uint16_t* palette = slot != nullptr ? slot->palette : palette_;
+    cached_frame_idx_ = 0xFFFF;
+    if (pixels != base_pixels) {
+        memcpy(pixels, base_pixels, ANIM_PIXELS_SIZE);
+    }
+    if (palette != base_palette) {
+        memcpy(palette, base_palette, ANIM_PALETTE_COLORS * sizeof(uint16_t));
+    }
+
+    for (int y = 0; y < ANIM_FRAME_HEIGHT; y++) {
+        dirty_x0_[y] = ANIM_FRAME_WIDTH;
+        dirty_x1_[y] = 0;
+    }
+    if (!pack_.PatchFrame(frame_idx, base_idx, pixels, dirty_x0_, dirty_x1_)) {
+        // The caller falls back to a full read
+        if (slot != nullptr) {
+            frame_cache_.Remove(slot);
+        }
+        return false;
+    }
+
+    frame_pixels_ = pixels;
+    frame_palette_ = palette;
+    cached_frame_idx_ = frame_idx;
+    delta_base_ = base_idx;
+    delta_frames_++;
+    return true;
+}
+
+bool AnimationLoader::ReadFrame(uint16_t frame_idx, uint8_t* pixels, uint16_t* palette) const {
+    if (pack_.IsOpen()) {
+        // v2: the palette is stored as RGB565 already
+        return pack_.ReadPalette(pack_.GetFramePalette(frame_idx), palette, ANIM_PALETTE_COLORS) &&
+               pack_.ReadFrame(frame_idx, pixels);
+    }
 
     // Calculate frame offset in partition
     size_t frame_offset = (size_t)frame_idx * ANIM_FRAME_SIZE_RAW;
@@ -264,7 +580,7 @@ bool AnimationLoader::ReadAndDecodeFrame(uint16_t frame_idx) const {
 
     // Convert RGB888 palette to RGB565
     for (int i = 0; i < ANIM_PALETTE_COLORS; i++) {
-        palette_[i] = rgb888_to_rgb565(
+        palette[i] = rgb888_to_rgb565(
             pal_rgb888[i * 3],
             pal_rgb888[i * 3 + 1],
             pal_rgb888[i * 3 + 2]
@@ -272,13 +588,11 @@ bool AnimationLoader::ReadAndDecodeFrame(uint16_t frame_idx) const {
     }
 
     // Read pixel indices
-    err = esp_partition_read(partition_, frame_offset + ANIM_PALETTE_SIZE, pixel_buffer_, ANIM_PIXELS_SIZE);
+    err = esp_partition_read(partition_, frame_offset + ANIM_PALETTE_SIZE, pixels, ANIM_PIXELS_SIZE);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read pixels for frame %d: %s", frame_idx, esp_err_to_name(err));
         return false;
     }
-
-    cached_frame_idx_ = frame_idx;
     return true;
 }
 
@@ -290,9 +604,30 @@ void AnimationLoader::DecodeFrame(uint16_t frame_idx, uint16_t* out_buf) const {
     // Decode indexed pixels to RGB565 (preserve original colors)
     // Background transparency is handled by color range check in compositing
     for (size_t i = 0; i < ANIM_PIXELS_SIZE; i++) {
-        uint8_t idx = pixel_buffer_[i];
-        out_buf[i] = palette_[idx];
+        uint8_t idx = frame_pixels_[i];
+        out_buf[i] = frame_palette_[idx];
+    }
+}
+
+void AnimationLoader::ExpandFrame(uint16_t frame_idx) const {
+    if (!ReadAndDecodeFrame(frame_idx) || expanded_frame_ == frame_idx) {
+        return;
+    }
+
+    if (delta_base_ != 0xFFFF && expanded_frame_ == delta_base_) {
+        // The buffer holds the delta's base frame: palette lookups only for the changed spans
+        for (int y = 0; y < ANIM_FRAME_HEIGHT; y++) {
+            size_t row_offset = (size_t)y * ANIM_FRAME_WIDTH;
+            for (size_t x = dirty_x0_[y]; x < dirty_x1_[y]; x++) {
+                decode_buffer_[row_offset + x] = frame_palette_[frame_pixels_[row_offset + x]];
+            }
+        }
+    } else {
+        for (size_t i = 0; i < ANIM_PIXELS_SIZE; i++) {
+            decode_buffer_[i] = frame_palette_[frame_pixels_[i]];
+        }
     }
+    expanded_frame_ = frame_idx;
 }
 
 void AnimationLoader::DecodeFrameARGB(uint16_t frame_idx, uint32_t* out_buf) const {
@@ -302,13 +637,13 @@ void AnimationLoader::DecodeFrameARGB(uint16_t frame_idx, uint32_t* out_buf) con
 
     // Decode indexed pixels to ARGB8888
     for (size_t i = 0; i < ANIM_PIXELS_SIZE; i++) {
-        uint8_t idx = pixel_buffer_[i];
+        uint8_t idx = frame_pixels_[i];
         if (idx == 0) {
             // Transparent background
             out_buf[i] = 0x00000000;
         } else {
             // Convert RGB565 to ARGB8888
-            uint16_t rgb565 = palette_[idx];
+            uint16_t rgb565 = frame_palette_[idx];
             uint8_t r = ((rgb565 >> 11) & 0x1F) << 3;
             uint8_t g = ((rgb565 >> 5) & 0x3F) << 2;
             uint8_t b = (rgb565 & 0x1F) << 3;
@@ -327,8 +662,8 @@ void AnimationLoader::DecodeFrameRGB565A8(uint16_t frame_idx, uint8_t* out_buf)
     uint8_t* alpha_buf = out_buf + ANIM_PIXELS_SIZE * sizeof(uint16_t);
 
     for (size_t i = 0; i < ANIM_PIXELS_SIZE; i++) {
-        uint8_t idx = pixel_buffer_[i];
-        rgb_buf[i] = palette_[idx];
+        uint8_t idx = frame_pixels_[i];
+        rgb_buf[i] = frame_palette_[idx];
         alpha_buf[i] = (idx == 0) ? 0x00 : 0xFF;
     }
 }
@@ -341,8 +676,8 @@ void AnimationLoader::DecodeBackgroundFrame(uint16_t frame_idx, uint16_t* out_bu
     // Decode indexed pixels to RGB565 WITHOUT chroma key
     // Background frames are rendered fully (no transparency)
     for (size_t i = 0; i < ANIM_PIXELS_SIZE; i++) {
-        uint8_t idx = pixel_buffer_[i];
-        out_buf[i] = palette_[idx];
+        uint8_t idx = frame_pixels_[i];
+        out_buf[i] = frame_palette_[idx];
     }
 }
 
@@ -354,8 +689,8 @@ void AnimationLoader::DecodeBackgroundRow(uint16_t frame_idx, uint16_t row_idx,
     // Decode one row of indexed pixels to RGB565 WITHOUT chroma key
     size_t row_offset = row_idx * ANIM_FRAME_WIDTH;
     for (size_t x = 0; x < ANIM_FRAME_WIDTH; x++) {
-        uint8_t idx = pixel_buffer_[row_offset + x];
-        out_buf[x] = palette_[idx];
+        uint8_t idx = frame_pixels_[row_offset + x];
+        out_buf[x] = frame_palette_[idx];
     }
 }
 
@@ -371,7 +706,7 @@ const uint8_t* AnimationLoader::GetFrame(AnimLoaderType type, uint8_t frame_idx)
     }
 
     uint16_t global_frame = anim->start_frame + frame_idx;
-    DecodeFrame(global_frame, decode_buffer_);
+    ExpandFrame(global_frame);
 
     return (const uint8_t*)decode_buffer_;
 }
@@ -381,7 +716,7 @@ const uint8_t* AnimationLoader::GetFrameByIndex(int frame_idx) {
         return nullptr;
     }
 
-    DecodeFrame((uint16_t)frame_idx, decode_buffer_);
+    ExpandFrame((uint16_t)frame_idx);
     return (const uint8_t*)decode_buffer_;
 }
 
@@ -408,6 +743,7 @@ const uint8_t* AnimationLoader::GetBackgroundFrameByIndex(int frame_idx) {
         return nullptr;
     }
 
+    expanded_frame_ = 0xFFFF;
     DecodeBackgroundFrame((uint16_t)frame_idx, decode_buffer_);
     return (const uint8_t*)decode_buffer_;
 }
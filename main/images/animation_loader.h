@@ -4,6 +4,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <mutex>
+#include <condition_variable>
+#include "anim_frame_cache.h"
+#include "asset_pack.h"
 
 // Animation output dimensions (160x160, centered on 280x240 display)
 #define ANIM_FRAME_WIDTH  160
@@ -18,6 +24,15 @@
 #define ANIM_PIXELS_SIZE    (ANIM_FRAME_WIDTH * ANIM_FRAME_HEIGHT)  // 25600 bytes
 #define ANIM_FRAME_SIZE_RAW (ANIM_PALETTE_SIZE + ANIM_PIXELS_SIZE)  // 26368 bytes per frame
 
+// In-RAM frame block: pixel indices followed by the RGB565 palette (same layout as
+// AnimFrameCache entries, so blocks can be swapped between the cache and the loader)
+#define ANIM_FRAME_BLOCK_SIZE (ANIM_PIXELS_SIZE + ANIM_PALETTE_COLORS * 2)  // 26112 bytes
+
+// Prefetch task: reads the next frame from flash while the current one is composited
+#define ANIM_PREFETCH_TASK_STACK    3072
+#define ANIM_PREFETCH_TASK_PRIORITY 1
+#define ANIM_PREFETCH_WAIT_MS       100     // Longest wait for an in-flight read of the wanted frame
+
 // Display dimensions
 #define ANIM_DISPLAY_WIDTH  280
 #define ANIM_DISPLAY_HEIGHT 240
@@ -91,7 +106,7 @@ public:
     void DecodeBackgroundRow(uint16_t frame_idx, uint16_t row_idx, uint16_t* out_buf) const;
 
     // Get current frame's palette (valid after ReadAndDecodeFrame)
-    const uint16_t* GetPalette() const { return palette_; }
+    const uint16_t* GetPalette() const { return frame_palette_; }
 
     // Get background color index (first palette entry is typically background)
     uint8_t GetBgColorIdx() const { return 0; }
@@ -103,8 +118,16 @@ public:
     // Get total frame count
     uint16_t GetFrameCount() const { return ANIM_TOTAL_FRAMES; }
 
-    // Get total data size in partition
-    size_t GetTotalDataSize() const { return (size_t)ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW; }
+    // Get total data size in partition (the background data starts right after)
+    size_t GetTotalDataSize() const {
+        return pack_.IsOpen() ? pack_.GetDataSize() : (size_t)ANIM_TOTAL_FRAMES * ANIM_FRAME_SIZE_RAW;
+    }
+
+    // frames.bin is an asset pack v2 (else the headerless v1 layout)
+    bool IsPacked() const { return pack_.IsOpen(); }
+
+    // Frames are read in place from the mapped partition (CONFIG_ANIM_ASSETS_MMAP)
+    bool IsMapped() const { return mapped_frames_ != nullptr || pack_.IsMapped(); }
 
     // Check if initialized
     bool IsInitialized() const { return initialized_; }
@@ -121,6 +144,32 @@ public:
     // Free transparent buffers to save memory for compositing
     void FreeTransparentBuffers();
 
+    // Frame cache: keep frames [start_frame, start_frame + count) cached while they play
+    void PinFrames(uint16_t start_frame, uint16_t count);
+
+    // Frame cache: give memory back, keeping at most max_bytes of frames from now on
+    // Call from the task that reads frames (the render loop does on low internal RAM)
+    void TrimFrameCache(size_t max_bytes);
+
+    AnimFrameCacheStats GetFrameCacheStats() const { return frame_cache_.GetStats(); }
+
+    // Start the background prefetch task and its frame buffer (call once compositing
+    // buffers are allocated). Returns false if memory is short; reads stay synchronous
+    bool StartPrefetch();
+
+    // Read frame_idx in the background so the next ReadAndDecodeFrame() only swaps
+    // buffers. Replaces any pending request; no-op if the frame is already cached
+    void Prefetch(uint16_t frame_idx);
+
+    // Drop pending and in-flight prefetches (animation switch)
+    void CancelPrefetch();
+
+    // Frames served by a completed prefetch (the rest of the misses were read inline)
+    uint32_t GetPrefetchHits() const { return prefetch_hits_; }
+
+    // Frames built by patching the previous frame with a delta (asset pack v2 with deltas)
+    uint32_t GetDeltaFrames() const { return delta_frames_; }
+
     // Legacy compatibility - get frame by animation type and index
     const uint8_t* GetFrame(AnimLoaderType type, uint8_t frame_idx);
     const uint8_t* GetFrameByIndex(int frame_idx);
@@ -141,18 +190,68 @@ private:
     AnimationLoader(const AnimationLoader&) = delete;
     AnimationLoader& operator=(const AnimationLoader&) = delete;
 
+    // Read a frame from flash into pixels / palette (RGB888 converted to RGB565)
+    bool ReadFrame(uint16_t frame_idx, uint8_t* pixels, uint16_t* palette) const;
+
+    // Take the prefetched frame if it is frame_idx (waits for an in-flight read of it)
+    bool TakePrefetched(uint16_t frame_idx) const;
+
+    // Build frame_idx from the current frame if the pack has a delta between them
+    bool PatchFromCurrent(uint16_t frame_idx) const;
+
+    // Expand frame_idx to RGB565 in decode_buffer_, only re-expanding the spans a delta
+    // changed when the buffer holds its base frame
+    void ExpandFrame(uint16_t frame_idx) const;
+
+    void PrefetchLoop();
+
+    static uint16_t* BlockPalette(uint8_t* block) { return (uint16_t*)(block + ANIM_PIXELS_SIZE); }
+
     bool initialized_;
     const esp_partition_t* partition_;
+    AssetPack pack_;        // v2 frames.bin, not open for v1
 
-    // Per-frame palette (converted from RGB888 to RGB565)
-    mutable uint16_t palette_[ANIM_PALETTE_COLORS];
+    // v1 frames.bin in the mapped partition: frame_pixels_ points straight into it and
+    // only the palette is converted, so the frame block, cache and prefetch are not used
+    const uint8_t* mapped_frames_;
 
-    // Frame buffer for reading pixel indices from flash
+    // Scratch frame block (ANIM_FRAME_BLOCK_SIZE) for frames the cache cannot hold
+    // palette_ points into it (per-frame palette converted from RGB888 to RGB565)
+    // With mapped_frames_ it only holds the palette
     mutable uint8_t* pixel_buffer_;
+    mutable uint16_t* palette_;
     mutable uint16_t cached_frame_idx_;
 
-    // Decode buffer for legacy API (one frame RGB565)
+    // Current frame: points into frame_cache_, mapped_frames_ or at pixel_buffer_ / palette_
+    mutable const uint8_t* frame_pixels_;
+    mutable const uint16_t* frame_palette_;
+
+    // Recently used frames (CONFIG_ANIM_FRAME_CACHE_SIZE_KB)
+    mutable AnimFrameCache frame_cache_;
+
+    // Prefetch: prefetch_buffer_ belongs to the task while kPrefetchLoading, otherwise
+    // to the caller, which swaps it with a cache slot or pixel_buffer_ when it is ready
+    enum PrefetchState { kPrefetchIdle, kPrefetchLoading, kPrefetchReady };
+    TaskHandle_t prefetch_task_;
+    mutable std::mutex prefetch_mutex_;
+    mutable std::condition_variable prefetch_cv_;
+    mutable uint8_t* prefetch_buffer_;
+    mutable PrefetchState prefetch_state_;
+    mutable uint16_t prefetch_frame_;       // Frame in prefetch_buffer_ (loading or ready)
+    uint16_t prefetch_request_;             // Frame to read next, 0xFFFF for none
+    uint32_t prefetch_generation_;          // Bumped by CancelPrefetch() to discard in-flight reads
+    mutable uint32_t prefetch_hits_;
+
+    // Delta frames: when the current frame was patched from delta_base_, the pixels
+    // that changed in each row are [dirty_x0_, dirty_x1_)
+    mutable uint16_t delta_base_;
+    mutable uint16_t dirty_x0_[ANIM_FRAME_HEIGHT];
+    mutable uint16_t dirty_x1_[ANIM_FRAME_HEIGHT];
+    mutable uint32_t delta_frames_;
+
+    // Decode buffer for legacy API (one frame RGB565) and the frame expanded in it
     uint16_t* decode_buffer_;
+    mutable uint16_t expanded_frame_;
 
     // Decode buffer for ARGB8888 with transparent background
     uint32_t* decode_buffer_argb_;
@@ -0,0 +1,53 @@
+#include "asset_map.h"
+#include <esp_log.h>
+#include <spi_flash_mmap.h>
+
+#define TAG "AssetMap"
+
+AssetMap& AssetMap::GetInstance() {
+    static AssetMap instance;
+    return instance;
+}
+
+AssetMap::~AssetMap() {
+    if (handle_ != 0) {
+        esp_partition_munmap(handle_);
+    }
+}
+
+bool AssetMap::Map(const esp_partition_t* partition) {
+    attempted_ = true;
+    partition_ = partition;
+#if CONFIG_ANIM_ASSETS_MMAP
+    // Mapping a range that is already mapped (by Assets) reuses its pages; otherwise
+    // the partition needs free MMU pages
+    int free_pages = spi_flash_mmap_get_free_pages(SPI_FLASH_MMAP_DATA);
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       (const void**)&root_, &handle_);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to mmap %s (%lu KB, %d free MMU pages): %s, assets are read with copies",
+                 partition->label, partition->size / 1024, free_pages, esp_err_to_name(err));
+        root_ = nullptr;
+        handle_ = 0;
+        return false;
+    }
+    ESP_LOGI(TAG, "Assets mapped in place: %s, %lu KB at %p", partition->label, partition->size / 1024, root_);
+    return true;
+#else
+    ESP_LOGI(TAG, "Asset mmap disabled, assets are read with copies");
+    return false;
+#endif
+}
+
+const uint8_t* AssetMap::Data(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (partition == nullptr) {
+        return nullptr;
+    }
+    if (!attempted_) {
+        Map(partition);
+    }
+    if (root_ == nullptr || partition != partition_ || offset > partition->size || size > partition->size - offset) {
+        return nullptr;
+    }
+    return root_ + offset;
+}
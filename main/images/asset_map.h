@@ -0,0 +1,42 @@
+#ifndef _ASSET_MAP_H_
+#define _ASSET_MAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_partition.h>
+
+// Read-only view of the assets partition through the flash cache (esp_partition_mmap),
+// shared by the frame loaders so indexed pixels can be read in place instead of being
+// copied out with esp_partition_read (which also stalls the flash cache while it runs).
+//
+// The whole partition is mapped once, with the same range as Assets::InitializePartition,
+// so both share the MMU pages. When CONFIG_ANIM_ASSETS_MMAP is off or the MMU has no
+// room, Data() returns nullptr and callers keep using esp_partition_read.
+//
+// Access pattern: the flash cache is small (a 160x160 frame is most of it), so readers
+// walk mapped data once, in storage order (row after row), rather than seeking back
+class AssetMap {
+public:
+    static AssetMap& GetInstance();
+
+    // Pointer to [offset, offset + size) of the partition, or nullptr (read mode).
+    // The partition is mapped on first use; call from the init task only
+    const uint8_t* Data(const esp_partition_t* partition, size_t offset, size_t size);
+
+    bool IsMapped() const { return root_ != nullptr; }
+
+private:
+    AssetMap() = default;
+    ~AssetMap();
+    AssetMap(const AssetMap&) = delete;
+    AssetMap& operator=(const AssetMap&) = delete;
+
+    bool Map(const esp_partition_t* partition);
+
+    const esp_partition_t* partition_ = nullptr;
+    esp_partition_mmap_handle_t handle_ = 0;
+    const uint8_t* root_ = nullptr;
+    bool attempted_ = false;
+};
+
+#endif // _ASSET_MAP_H_
@@ -0,0 +1,406 @@
+#include "asset_pack.h"
+#include "asset_map.h"
+#include <esp_log.h>
+#include <string.h>
+
+#define TAG "AssetPack"
+
+static inline uint16_t read_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool AssetPack::Open(const esp_partition_t* partition, size_t offset) {
+    partition_ = nullptr;
+    data_ = nullptr;
+    frames_.clear();
+    row_table_.clear();
+    row_table_frame_ = 0xFFFF;
+    if (partition == nullptr) {
+        return false;
+    }
+
+    uint8_t header[ASSET_PACK_HEADER_SIZE];
+    if (esp_partition_read(partition, offset, header, sizeof(header)) != ESP_OK ||
+        memcmp(header, ASSET_PACK_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    uint16_t version = read_le16(header + 4);
+    uint8_t compression = header[6];
+    uint8_t flags = header[7];
+    uint16_t width = read_le16(header + 8);
+    uint16_t height = read_le16(header + 10);
+    uint16_t frame_count = read_le16(header + 12);
+    uint16_t palette_count = read_le16(header + 14);
+    uint16_t colors = read_le16(header + 16);
+    uint16_t delta_count = (flags & ASSET_PACK_FLAG_DELTA) ? read_le16(header + 18) : 0;
+    uint32_t palette_offset = read_le32(header + 20);
+    uint32_t frame_offset = read_le32(header + 24);
+    uint32_t data_size = read_le32(header + 28);
+
+    if (version != ASSET_PACK_VERSION || compression > ASSET_PACK_RLE ||
+        width == 0 || width > ASSET_PACK_MAX_WIDTH || height == 0 || colors == 0 || colors > 256) {
+        ESP_LOGE(TAG, "Unsupported pack at 0x%X: version %u, compression %u, %ux%u, %u colors",
+                 (unsigned)offset, version, compression, width, height, colors);
+        return false;
+    }
+    if (offset + data_size > partition->size ||
+        palette_offset + (size_t)palette_count * colors * sizeof(uint16_t) > data_size ||
+        frame_offset + ((size_t)frame_count + delta_count) * ASSET_PACK_FRAME_ENTRY_SIZE > data_size) {
+        ESP_LOGE(TAG, "Pack at 0x%X exceeds its data size (%u bytes) or the partition",
+                 (unsigned)offset, (unsigned)data_size);
+        return false;
+    }
+
+    // Frame table (12 bytes per frame or extra delta)
+    size_t entry_count = (size_t)frame_count + delta_count;
+    std::vector<uint8_t> table(entry_count * ASSET_PACK_FRAME_ENTRY_SIZE);
+    if (esp_partition_read(partition, offset + frame_offset, table.data(), table.size()) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read frame table at 0x%X", (unsigned)(offset + frame_offset));
+        return false;
+    }
+    frames_.resize(entry_count);
+    for (size_t i = 0; i < entry_count; i++) {
+        const uint8_t* entry = table.data() + i * ASSET_PACK_FRAME_ENTRY_SIZE;
+        FrameEntry& frame = frames_[i];
+        frame.offset = read_le32(entry);
+        frame.size = read_le32(entry + 4);
+        if (i < frame_count) {
+            frame.palette = read_le16(entry + 8);
+            frame.frame = i;
+        } else {
+            // Extra delta: decodes to an existing frame and uses its palette
+            frame.frame = read_le16(entry + 8);
+            frame.palette = frame.frame < frame_count ? frames_[frame.frame].palette : 0xFFFF;
+        }
+        frame.base = (flags & ASSET_PACK_FLAG_DELTA) ? read_le16(entry + 10) : ASSET_PACK_NO_FRAME;
+
+        bool valid = frame.offset + frame.size <= data_size && frame.frame < frame_count &&
+                     frame.palette < palette_count;
+        if (frame.base == ASSET_PACK_NO_FRAME) {
+            valid = valid && i < frame_count && frame.size >= (height + 1u) * sizeof(uint32_t);
+        } else {
+            valid = valid && frame.base < frame_count && frame.base != frame.frame &&
+                    frame.size >= ASSET_PACK_DELTA_HEADER_SIZE;
+        }
+        if (!valid) {
+            ESP_LOGE(TAG, "Invalid frame entry %u in pack at 0x%X", (unsigned)i, (unsigned)offset);
+            frames_.clear();
+            return false;
+        }
+    }
+
+    // A delta keeps the unchanged pixels of its base, so both must share a palette; and
+    // every frame must reach a key frame within ASSET_PACK_MAX_DELTA_CHAIN steps
+    for (size_t i = 0; i < entry_count; i++) {
+        const FrameEntry& frame = frames_[i];
+        if (frame.base == ASSET_PACK_NO_FRAME) {
+            continue;
+        }
+        bool valid = frames_[frame.base].palette == frame.palette;
+        uint16_t k = frame.base;
+        for (int depth = 1; valid && frames_[k].base != ASSET_PACK_NO_FRAME; depth++) {
+            valid = depth < ASSET_PACK_MAX_DELTA_CHAIN;
+            k = frames_[k].base;
+        }
+        if (!valid) {
+            ESP_LOGE(TAG, "Delta entry %u in pack at 0x%X has a bad base frame", (unsigned)i, (unsigned)offset);
+            frames_.clear();
+            return false;
+        }
+    }
+
+    partition_ = partition;
+    base_offset_ = offset;
+    compression_ = compression;
+    flags_ = flags;
+    width_ = width;
+    height_ = height;
+    frame_count_ = frame_count;
+    palette_count_ = palette_count;
+    colors_ = colors;
+    palette_offset_ = palette_offset;
+    data_size_ = data_size;
+    data_ = AssetMap::GetInstance().Data(partition, offset, data_size);
+
+    ESP_LOGI(TAG, "Pack v%u at 0x%X: %ux%u, %u frames, %u palettes, %s%s, %u bytes (raw %u), %s",
+             version, (unsigned)offset, width_, height_, frame_count_, palette_count_,
+             compression_ == ASSET_PACK_RLE ? "RLE" : "raw", HasDeltas() ? " + delta" : "",
+             (unsigned)data_size_, (unsigned)((size_t)frame_count_ * (width_ * height_ + colors_ * 3)),
+             data_ != nullptr ? "mapped" : "read");
+    return true;
+}
+
+uint16_t AssetPack::GetFramePalette(uint16_t frame_idx) const {
+    if (frame_idx >= frames_.size()) {
+        return 0xFFFF;
+    }
+    return frames_[frame_idx].palette;
+}
+
+size_t AssetPack::GetFrameOffset(uint16_t frame_idx) const {
+    if (frame_idx >= frames_.size()) {
+        return 0;
+    }
+    return base_offset_ + frames_[frame_idx].offset;
+}
+
+bool AssetPack::ReadPalette(uint16_t palette_idx, uint16_t* out, size_t max_colors) const {
+    if (!IsOpen() || palette_idx >= palette_count_ || out == nullptr) {
+        return false;
+    }
+    size_t count = colors_ < max_colors ? colors_ : max_colors;
+    size_t offset = palette_offset_ + (size_t)palette_idx * colors_ * sizeof(uint16_t);
+    // Stored little-endian, the same as the target
+    if (data_ != nullptr) {
+        memcpy(out, data_ + offset, count * sizeof(uint16_t));
+        return true;
+    }
+    offset += base_offset_;
+    esp_err_t err = esp_partition_read(partition_, offset, out, count * sizeof(uint16_t));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read palette %u: %s", palette_idx, esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+size_t AssetPack::DecodeRow(const uint8_t* src, size_t src_len, uint8_t* out, size_t width) const {
+    if (compression_ == ASSET_PACK_RLE) {
+        return asset_rle_decode_row(src, src_len, out, width);
+    }
+    if (src_len < width) {
+        return 0;
+    }
+    memcpy(out, src, width);
+    return width;
+}
+
+int AssetPack::FindDelta(uint16_t frame_idx, uint16_t base_idx) const {
+    if (!HasDeltas() || frame_idx >= frame_count_ || base_idx == ASSET_PACK_NO_FRAME) {
+        return -1;
+    }
+    if (frames_[frame_idx].base == base_idx) {
+        return frame_idx;
+    }
+    for (size_t i = frame_count_; i < frames_.size(); i++) {
+        if (frames_[i].frame == frame_idx && frames_[i].base == base_idx) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool AssetPack::ReadFrame(uint16_t frame_idx, uint8_t* out) const {
+    if (!IsOpen() || frame_idx >= frame_count_ || out == nullptr) {
+        return false;
+    }
+
+    // Walk back to the key frame (chain length was checked in Open), then replay the deltas
+    uint16_t chain[ASSET_PACK_MAX_DELTA_CHAIN];
+    size_t depth = 0;
+    uint16_t key = frame_idx;
+    while (frames_[key].base != ASSET_PACK_NO_FRAME) {
+        chain[depth++] = key;
+        key = frames_[key].base;
+    }
+    if (!ReadKeyFrame(key, out)) {
+        return false;
+    }
+    while (depth > 0) {
+        if (!ApplyDelta(chain[--depth], out, nullptr, nullptr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssetPack::PatchFrame(uint16_t frame_idx, uint16_t base_idx, uint8_t* pixels,
+                           uint16_t* dirty_x0, uint16_t* dirty_x1) const {
+    int entry = FindDelta(frame_idx, base_idx);
+    if (!IsOpen() || entry < 0 || pixels == nullptr) {
+        return false;
+    }
+    return ApplyDelta(entry, pixels, dirty_x0, dirty_x1);
+}
+
+bool AssetPack::ApplyDelta(size_t entry_idx, uint8_t* pixels, uint16_t* dirty_x0, uint16_t* dirty_x1) const {
+    const FrameEntry& entry = frames_[entry_idx];
+    size_t pos = base_offset_ + entry.offset;
+    size_t end = pos + entry.size;
+    size_t max_span_bytes = ASSET_PACK_SPAN_HEADER_SIZE +
+                            (compression_ == ASSET_PACK_RLE ? ASSET_RLE_MAX_ROW_BYTES(width_) : width_);
+
+    uint8_t chunk[ASSET_PACK_CHUNK_SIZE];
+    const uint8_t* buf = chunk;
+    size_t len = 0;
+    size_t used = 0;
+    if (data_ != nullptr) {
+        // Mapped: the whole delta is addressable, nothing to refill
+        buf = data_ + entry.offset;
+        len = entry.size;
+        pos = end;
+    }
+    // Refill so that a whole span (header and pixels) is buffered
+    auto refill = [&]() -> bool {
+        if (len - used >= max_span_bytes || pos >= end) {
+            return true;
+        }
+        memmove(chunk, chunk + used, len - used);
+        len -= used;
+        used = 0;
+        size_t count = sizeof(chunk) - len;
+        if (count > end - pos) {
+            count = end - pos;
+        }
+        esp_err_t err = esp_partition_read(partition_, pos, chunk + len, count);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read delta of frame %u: %s", entry.frame, esp_err_to_name(err));
+            return false;
+        }
+        pos += count;
+        len += count;
+        return true;
+    };
+
+    if (!refill()) {
+        return false;
+    }
+    uint16_t span_count = read_le16(buf);
+    used = ASSET_PACK_DELTA_HEADER_SIZE;
+
+    for (uint16_t i = 0; i < span_count; i++) {
+        if (!refill()) {
+            return false;
+        }
+        size_t consumed = 0;
+        uint16_t y = 0;
+        uint16_t x = 0;
+        uint16_t length = 0;
+        if (len - used >= ASSET_PACK_SPAN_HEADER_SIZE) {
+            y = read_le16(buf + used);
+            x = read_le16(buf + used + 2);
+            length = read_le16(buf + used + 4);
+            used += ASSET_PACK_SPAN_HEADER_SIZE;
+            if (y < height_ && length > 0 && x + length <= width_) {
+                consumed = DecodeRow(buf + used, len - used, pixels + (size_t)y * width_ + x, length);
+            }
+        }
+        if (consumed == 0) {
+            ESP_LOGE(TAG, "Corrupt span %u in delta of frame %u", i, entry.frame);
+            return false;
+        }
+        used += consumed;
+
+        if (dirty_x0 != nullptr && dirty_x1 != nullptr) {
+            if (x < dirty_x0[y]) {
+                dirty_x0[y] = x;
+            }
+            if (x + length > dirty_x1[y]) {
+                dirty_x1[y] = x + length;
+            }
+        }
+    }
+    return true;
+}
+
+bool AssetPack::ReadKeyFrame(uint16_t frame_idx, uint8_t* out) const {
+    // Rows are stored back to back after the row table, so a frame is decoded as one
+    // stream without looking at the table
+    const FrameEntry& frame = frames_[frame_idx];
+    size_t pos = base_offset_ + frame.offset + (height_ + 1) * sizeof(uint32_t);
+    size_t end = base_offset_ + frame.offset + frame.size;
+    size_t max_row_bytes = compression_ == ASSET_PACK_RLE ? ASSET_RLE_MAX_ROW_BYTES(width_) : width_;
+
+    uint8_t chunk[ASSET_PACK_CHUNK_SIZE];
+    const uint8_t* buf = chunk;
+    size_t len = 0;
+    size_t used = 0;
+    if (data_ != nullptr) {
+        // Mapped: decode in place, walking the rows in storage order through the cache
+        buf = data_ + (pos - base_offset_);
+        len = end - pos;
+        pos = end;
+    }
+    for (uint16_t y = 0; y < height_; y++) {
+        // Refill so that a whole encoded row is buffered
+        if (len - used < max_row_bytes && pos < end) {
+            memmove(chunk, chunk + used, len - used);
+            len -= used;
+            used = 0;
+            size_t count = sizeof(chunk) - len;
+            if (count > end - pos) {
+                count = end - pos;
+            }
+            esp_err_t err = esp_partition_read(partition_, pos, chunk + len, count);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to read frame %u: %s", frame_idx, esp_err_to_name(err));
+                return false;
+            }
+            pos += count;
+            len += count;
+        }
+
+        size_t consumed = DecodeRow(buf + used, len - used, out + (size_t)y * width_, width_);
+        if (consumed == 0) {
+            ESP_LOGE(TAG, "Corrupt row %u in frame %u", y, frame_idx);
+            return false;
+        }
+        used += consumed;
+    }
+    return true;
+}
+
+bool AssetPack::ReadRow(uint16_t frame_idx, uint16_t row, uint8_t* out) const {
+    if (!IsOpen() || frame_idx >= frame_count_ || row >= height_ || out == nullptr) {
+        return false;
+    }
+    if (frames_[frame_idx].base != ASSET_PACK_NO_FRAME) {
+        ESP_LOGE(TAG, "Frame %u is a delta frame, rows cannot be read on their own", frame_idx);
+        return false;
+    }
+
+    const FrameEntry& frame = frames_[frame_idx];
+    uint32_t start;
+    uint32_t next;
+    if (data_ != nullptr) {
+        // Mapped: row table and row are read in place
+        const uint8_t* table = data_ + frame.offset;
+        start = read_le32(table + row * sizeof(uint32_t));
+        next = read_le32(table + (row + 1) * sizeof(uint32_t));
+    } else {
+        if (row_table_frame_ != frame_idx) {
+            row_table_.resize(height_ + 1);
+            esp_err_t err = esp_partition_read(partition_, base_offset_ + frame.offset, row_table_.data(),
+                                               row_table_.size() * sizeof(uint32_t));
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to read row table of frame %u: %s", frame_idx, esp_err_to_name(err));
+                row_table_frame_ = 0xFFFF;
+                return false;
+            }
+            row_table_frame_ = frame_idx;
+        }
+        start = row_table_[row];
+        next = row_table_[row + 1];
+    }
+
+    uint32_t size = next - start;
+    if (next < start || size > ASSET_RLE_MAX_ROW_BYTES(width_) || start + size > frame.size) {
+        ESP_LOGE(TAG, "Invalid row %u in frame %u", row, frame_idx);
+        return false;
+    }
+    if (data_ != nullptr) {
+        return DecodeRow(data_ + frame.offset + start, size, out, width_) == size;
+    }
+    row_buffer_.resize(ASSET_RLE_MAX_ROW_BYTES(width_));
+    esp_err_t err = esp_partition_read(partition_, base_offset_ + frame.offset + start, row_buffer_.data(), size);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read row %u of frame %u: %s", row, frame_idx, esp_err_to_name(err));
+        return false;
+    }
+    return DecodeRow(row_buffer_.data(), size, out, width_) == size;
+}
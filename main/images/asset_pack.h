@@ -0,0 +1,148 @@
+#ifndef _ASSET_PACK_H_
+#define _ASSET_PACK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <esp_partition.h>
+#include "asset_rle.h"
+
+// Asset pack v2: one self-describing section per asset file (frames / backgrounds / items),
+// produced by scripts/pack_assets_v2.py. Sections are concatenated in the assets partition
+// like the headerless v1 files; data_size gives the offset of the next section.
+//
+//   Header (32 bytes, little-endian)
+//     magic[4]        "APK2"
+//     version         uint16 (2)
+//     compression     uint8  (ASSET_PACK_RAW / ASSET_PACK_RLE)
+//     flags           uint8  (ASSET_PACK_FLAG_*)
+//     width, height   uint16
+//     frame_count     uint16
+//     palette_count   uint16 (one per animation, background or item)
+//     colors          uint16 (entries per palette)
+//     delta_count     uint16 (extra delta entries after the frame table, delta packs only)
+//     palette_offset  uint32 (from section start)
+//     frame_offset    uint32 (frame table, from section start)
+//     data_size       uint32 (whole section, header included)
+//   Palettes:    palette_count x colors x uint16 RGB565
+//   Frame table: frame_count x {uint32 offset (from section start), uint32 size, uint16 palette, uint16 base}
+//                then delta_count x {uint32 offset, uint32 size, uint16 frame, uint16 base}
+//   Key frame:   (height + 1) x uint32 row offsets (from frame start), then the rows
+//                (each row RLE encoded, see asset_rle.h, or width raw bytes)
+//
+// Delta packs (ASSET_PACK_FLAG_DELTA): a frame whose base is not ASSET_PACK_NO_FRAME is
+// stored as the changes from frame base (same palette). The extra entries are deltas that
+// are only used when playing from base to frame, e.g. the loop back from the last frame
+// of an animation to its first (a key frame). Without the flag base is reserved (0).
+//   Delta frame: uint16 span_count, uint16 reserved, then span_count spans of
+//                {uint16 y, uint16 x, uint16 length, length pixels encoded like a row}
+#define ASSET_PACK_MAGIC        "APK2"
+#define ASSET_PACK_VERSION      2
+#define ASSET_PACK_HEADER_SIZE  32
+#define ASSET_PACK_FRAME_ENTRY_SIZE 12
+
+#define ASSET_PACK_RAW          0
+#define ASSET_PACK_RLE          1
+
+#define ASSET_PACK_FLAG_DELTA   0x01
+#define ASSET_PACK_NO_FRAME     0xFFFF
+#define ASSET_PACK_DELTA_HEADER_SIZE 4
+#define ASSET_PACK_SPAN_HEADER_SIZE  6
+
+// Longest chain of deltas between a frame and its key frame (the packer inserts key
+// frames more often); bounds the work of a random access
+#define ASSET_PACK_MAX_DELTA_CHAIN   32
+
+// Stack buffer for streaming a frame from flash (kept small for the esp_timer task);
+// it must hold one encoded row (or span) of the widest supported image
+#define ASSET_PACK_CHUNK_SIZE   512
+#define ASSET_PACK_MAX_WIDTH    480
+static_assert(ASSET_PACK_SPAN_HEADER_SIZE + ASSET_RLE_MAX_ROW_BYTES(ASSET_PACK_MAX_WIDTH) <= ASSET_PACK_CHUNK_SIZE,
+              "chunk too small");
+
+// Reader for one v2 section. Open() keeps only the header and frame table in RAM
+// (12 bytes per frame); palettes and pixels are read from flash on demand, in place
+// through the flash cache when the partition is mapped (see asset_map.h)
+class AssetPack {
+public:
+    // Parse the section at offset; returns false (quietly) if it is not a v2 section,
+    // in which case the caller keeps using the headerless v1 layout
+    bool Open(const esp_partition_t* partition, size_t offset);
+
+    bool IsOpen() const { return partition_ != nullptr; }
+    uint16_t GetWidth() const { return width_; }
+    uint16_t GetHeight() const { return height_; }
+    uint16_t GetFrameCount() const { return frame_count_; }
+    uint16_t GetPaletteCount() const { return palette_count_; }
+    uint16_t GetColors() const { return colors_; }
+    size_t GetDataSize() const { return data_size_; }
+    bool HasDeltas() const { return (flags_ & ASSET_PACK_FLAG_DELTA) != 0; }
+
+    // Encoded data is decoded straight from the mapped partition (no copy to RAM)
+    bool IsMapped() const { return data_ != nullptr; }
+
+    // Palette used by a frame, or 0xFFFF for an invalid frame
+    uint16_t GetFramePalette(uint16_t frame_idx) const;
+
+    // Absolute partition offset of a frame's data (row table), 0 for an invalid frame
+    size_t GetFrameOffset(uint16_t frame_idx) const;
+
+    // Read a palette (already RGB565); at most max_colors entries are written
+    bool ReadPalette(uint16_t palette_idx, uint16_t* out, size_t max_colors) const;
+
+    // Read and decode a whole frame into width * height indices
+    // A delta frame is rebuilt from its key frame (random access, e.g. an animation switch)
+    bool ReadFrame(uint16_t frame_idx, uint8_t* out) const;
+
+    // Read and decode one row into width indices (key frames only)
+    // Keeps the row table of the last frame, so it is meant for a single reader task
+    bool ReadRow(uint16_t frame_idx, uint16_t row, uint8_t* out) const;
+
+    // Whether frame_idx is stored as a delta from base_idx
+    bool HasDelta(uint16_t frame_idx, uint16_t base_idx) const { return FindDelta(frame_idx, base_idx) >= 0; }
+
+    // Turn the decoded base_idx in pixels into frame_idx in place; only the changed spans
+    // are read. If dirty_x0 / dirty_x1 (height entries each) are given, each row's range
+    // is widened to cover the written pixels [x0, x1)
+    bool PatchFrame(uint16_t frame_idx, uint16_t base_idx, uint8_t* pixels,
+                    uint16_t* dirty_x0 = nullptr, uint16_t* dirty_x1 = nullptr) const;
+
+private:
+    struct FrameEntry {
+        uint32_t offset;
+        uint32_t size;
+        uint16_t palette;
+        uint16_t frame;     // Frame this entry decodes to (differs from the index for extra deltas)
+        uint16_t base;      // ASSET_PACK_NO_FRAME for key frames
+    };
+
+    // Decode width pixels from src (RLE or raw); returns bytes consumed, 0 on error
+    size_t DecodeRow(const uint8_t* src, size_t src_len, uint8_t* out, size_t width) const;
+
+    // Entry that turns base_idx into frame_idx, or -1
+    int FindDelta(uint16_t frame_idx, uint16_t base_idx) const;
+
+    bool ReadKeyFrame(uint16_t frame_idx, uint8_t* out) const;
+    bool ApplyDelta(size_t entry_idx, uint8_t* pixels, uint16_t* dirty_x0, uint16_t* dirty_x1) const;
+
+    const esp_partition_t* partition_ = nullptr;
+    size_t base_offset_ = 0;
+    uint8_t compression_ = ASSET_PACK_RAW;
+    uint8_t flags_ = 0;
+    uint16_t width_ = 0;
+    uint16_t height_ = 0;
+    uint16_t frame_count_ = 0;
+    uint16_t palette_count_ = 0;
+    uint16_t colors_ = 0;
+    uint32_t palette_offset_ = 0;
+    size_t data_size_ = 0;
+    const uint8_t* data_ = nullptr;     // Mapped section start, nullptr to use esp_partition_read
+    std::vector<FrameEntry> frames_;    // frame_count_ frames, then the extra deltas
+
+    // Row table of the frame last used by ReadRow(), and its encoded row buffer (unmapped only)
+    mutable std::vector<uint32_t> row_table_;
+    mutable std::vector<uint8_t> row_buffer_;
+    mutable uint16_t row_table_frame_ = 0xFFFF;
+};
+
+#endif // _ASSET_PACK_H_
@@ -0,0 +1,48 @@
+#ifndef _ASSET_RLE_H_
+#define _ASSET_RLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Row RLE used by asset pack v2 (PackBits style, one row of 8-bit indices per block)
+//   control 0..127:   copy the next control + 1 bytes
+//   control 128..255: repeat the next byte control - 125 times (3..130)
+#define ASSET_RLE_MAX_LITERAL   128
+#define ASSET_RLE_MIN_REPEAT    3
+#define ASSET_RLE_MAX_REPEAT    130
+
+// Worst case encoded size of a width-pixel row (all literals)
+#define ASSET_RLE_MAX_ROW_BYTES(width) ((width) + ((width) + ASSET_RLE_MAX_LITERAL - 1) / ASSET_RLE_MAX_LITERAL)
+
+// Decode one row of exactly width pixels from src
+// Returns the number of source bytes consumed, or 0 if src is truncated or overruns the row
+static inline size_t asset_rle_decode_row(const uint8_t* src, size_t src_len, uint8_t* dst, size_t width) {
+    size_t in = 0;
+    size_t out = 0;
+    while (out < width) {
+        if (in >= src_len) {
+            return 0;
+        }
+        uint8_t control = src[in++];
+        if (control < 128) {
+            size_t count = (size_t)control + 1;
+            if (in + count > src_len || out + count > width) {
+                return 0;
+            }
+            memcpy(dst + out, src + in, count);
+            in += count;
+            out += count;
+        } else {
+            size_t count = (size_t)control - 125;
+            if (in >= src_len || out + count > width) {
+                return 0;
+            }
+            memset(dst + out, src[in++], count);
+            out += count;
+        }
+    }
+    return in;
+}
+
+#endif // _ASSET_RLE_H_
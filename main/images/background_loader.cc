@@ -1,4 +1,5 @@
 #include "background_loader.h"
+#include "asset_map.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
 #include <string.h>
@@ -14,6 +15,7 @@ BackgroundLoader::BackgroundLoader()
     : initialized_(false)
     , partition_(nullptr)
     , base_offset_(0)
+    , mapped_(nullptr)
     , width_(BG_WIDTH)
     , height_(BG_HEIGHT)
     , total_bg_count_(0)
@@ -52,7 +54,20 @@ bool BackgroundLoader::Initialize(const esp_partition_t* partition, size_t backg
     height_ = BG_HEIGHT;
     frame_size_ = BG_FRAME_SIZE_RAW;
 
-    ESP_LOGI(TAG, "Background format: headerless per-frame RGB888 palette");
+    if (pack_.Open(partition, background_offset)) {
+        // v2: frame count from the pack header, compressed rows
+        if (pack_.GetWidth() != BG_WIDTH || pack_.GetHeight() != BG_HEIGHT) {
+            ESP_LOGE(TAG, "Asset pack is %dx%d, expected %dx%d",
+                     pack_.GetWidth(), pack_.GetHeight(), BG_WIDTH, BG_HEIGHT);
+            return false;
+        }
+        total_bg_count_ = pack_.GetFrameCount();
+        frame_size_ = 0;
+        ESP_LOGI(TAG, "Background format: asset pack v2 (%u bytes)", (unsigned)pack_.GetDataSize());
+    } else {
+        ESP_LOGI(TAG, "Background format: headerless per-frame RGB888 palette");
+        mapped_ = AssetMap::GetInstance().Data(partition, background_offset, (size_t)total_bg_count_ * frame_size_);
+    }
     ESP_LOGI(TAG, "Dimensions: %dx%d, frames: %d, frame_size: %u bytes",
              width_, height_, total_bg_count_, (unsigned)frame_size_);
     ESP_LOGI(TAG, "Base offset in partition: %u", (unsigned)base_offset_);
@@ -69,7 +84,8 @@ bool BackgroundLoader::Initialize(const esp_partition_t* partition, size_t backg
         return false;
     }
 
-    ESP_LOGI(TAG, "Row buffer allocated: %u bytes (low-memory mode)", (unsigned)width_);
+    ESP_LOGI(TAG, "Row buffer allocated: %u bytes (low-memory mode, %s)", (unsigned)width_,
+             mapped_ != nullptr || pack_.IsMapped() ? "rows read in place" : "rows read with copies");
 
     // Verify we can read the first frame's palette
     if (!ReadAndDecodeFrame(0)) {
@@ -99,15 +115,29 @@ bool BackgroundLoader::ReadAndDecodeFrame(uint16_t frame_idx) const {
         return true;
     }
 
+    if (pack_.IsOpen()) {
+        // v2: palette stored as RGB565
+        if (!pack_.ReadPalette(pack_.GetFramePalette(frame_idx), palette_, BG_PALETTE_COLORS)) {
+            return false;
+        }
+        cached_frame_idx_ = frame_idx;
+        return true;
+    }
+
     // Calculate frame offset
     size_t frame_offset = base_offset_ + ((size_t)frame_idx * frame_size_);
 
-    // Read RGB888 palette (768 bytes)
-    uint8_t palette_rgb888[BG_PALETTE_SIZE];
-    esp_err_t err = esp_partition_read(partition_, frame_offset, palette_rgb888, BG_PALETTE_SIZE);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read palette for frame %d: %s", frame_idx, esp_err_to_name(err));
-        return false;
+    // Read RGB888 palette (768 bytes), in place when mapped
+    uint8_t palette_buf[BG_PALETTE_SIZE];
+    const uint8_t* palette_rgb888 = palette_buf;
+    if (mapped_ != nullptr) {
+        palette_rgb888 = mapped_ + (frame_offset - base_offset_);
+    } else {
+        esp_err_t err = esp_partition_read(partition_, frame_offset, palette_buf, BG_PALETTE_SIZE);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read palette for frame %d: %s", frame_idx, esp_err_to_name(err));
+            return false;
+        }
     }
 
     // Convert RGB888 to RGB565
@@ -137,21 +167,33 @@ void BackgroundLoader::DecodeRow(uint16_t bg_idx, uint16_t row, uint16_t* out_bu
         return;
     }
 
-    // Calculate offset for this row's pixel data
-    size_t frame_offset = base_offset_ + ((size_t)bg_idx * frame_size_);
-    size_t row_offset = frame_offset + BG_PALETTE_SIZE + ((size_t)row * width_);
+    const uint8_t* indices = pixel_buffer_;
+    if (pack_.IsOpen()) {
+        // v2: the row is located through the frame's row table
+        if (!pack_.ReadRow(bg_idx, row, pixel_buffer_)) {
+            memset(out_buf, 0, width_ * sizeof(uint16_t));
+            return;
+        }
+    } else if (mapped_ != nullptr) {
+        // Mapped: expand the row straight from flash
+        indices = mapped_ + (size_t)bg_idx * frame_size_ + BG_PALETTE_SIZE + (size_t)row * width_;
+    } else {
+        // Calculate offset for this row's pixel data
+        size_t frame_offset = base_offset_ + ((size_t)bg_idx * frame_size_);
+        size_t row_offset = frame_offset + BG_PALETTE_SIZE + ((size_t)row * width_);
 
-    // Read row pixels from flash
-    esp_err_t err = esp_partition_read(partition_, row_offset, pixel_buffer_, width_);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read row %d: %s", row, esp_err_to_name(err));
-        memset(out_buf, 0, width_ * sizeof(uint16_t));
-        return;
+        // Read row pixels from flash
+        esp_err_t err = esp_partition_read(partition_, row_offset, pixel_buffer_, width_);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read row %d: %s", row, esp_err_to_name(err));
+            memset(out_buf, 0, width_ * sizeof(uint16_t));
+            return;
+        }
     }
 
     // Decode row using cached palette
     for (uint16_t x = 0; x < width_; x++) {
-        uint8_t idx = pixel_buffer_[x];
+        uint8_t idx = indices[x];
         out_buf[x] = palette_[idx];
     }
 }
@@ -184,12 +226,40 @@ bool BackgroundLoader::DecodeFull(uint16_t bg_idx, uint16_t* out_buf) const {
         return false;
     }
 
+    if (pack_.IsOpen()) {
+        // v2: decode the indices into the upper half of out_buf, then expand them to
+        // RGB565 from the front - pixel i is written at bytes 2i..2i+1, which never
+        // passes index i + width*height still to be read
+        size_t pixel_count = (size_t)width_ * height_;
+        uint8_t* indices = (uint8_t*)out_buf + pixel_count;
+        if (!pack_.ReadFrame(bg_idx, indices)) {
+            ESP_LOGE(TAG, "Failed to read background frame %d", bg_idx);
+            return false;
+        }
+        for (size_t i = 0; i < pixel_count; i++) {
+            out_buf[i] = palette_[indices[i]];
+        }
+        ESP_LOGI(TAG, "Full background decoded successfully (v2)");
+        return true;
+    }
+
     ESP_LOGI(TAG, "Decoding full background: bg=%d, size=%dx%d (row-by-row)",
              bg_idx, width_, height_);
 
     // Decode row by row to save memory
     size_t frame_offset = base_offset_ + ((size_t)bg_idx * frame_size_);
 
+    if (mapped_ != nullptr) {
+        // Mapped: one sequential pass over the indices in flash
+        const uint8_t* indices = mapped_ + (frame_offset - base_offset_) + BG_PALETTE_SIZE;
+        size_t pixel_count = (size_t)width_ * height_;
+        for (size_t i = 0; i < pixel_count; i++) {
+            out_buf[i] = palette_[indices[i]];
+        }
+        ESP_LOGI(TAG, "Full background decoded successfully (in place)");
+        return true;
+    }
+
     for (uint16_t y = 0; y < height_; y++) {
         size_t row_offset = frame_offset + BG_PALETTE_SIZE + ((size_t)y * width_);
 
@@ -215,5 +285,8 @@ size_t BackgroundLoader::GetFrameOffset(uint16_t bg_idx) const {
     if (!initialized_ || bg_idx >= total_bg_count_) {
         return 0;
     }
+    if (pack_.IsOpen()) {
+        return pack_.GetFrameOffset(bg_idx);
+    }
     return base_offset_ + ((size_t)bg_idx * frame_size_);
 }
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <esp_partition.h>
+#include "asset_pack.h"
 
 // Background dimensions (280x240 fullscreen)
 #define BG_WIDTH  280
@@ -38,7 +39,8 @@ typedef enum {
     BG_CATEGORY_COUNT
 } BackgroundCategory;
 
-// Background loader class - headerless per-frame RGB888 palette format
+// Background loader class - headerless per-frame RGB888 palette format,
+// or an asset pack v2 section (see asset_pack.h)
 // Same format as AnimationLoader but with 280x240 dimensions
 class BackgroundLoader {
 public:
@@ -79,9 +81,15 @@ public:
     // Get frame data offset for direct flash access
     size_t GetFrameOffset(uint16_t bg_idx) const;
 
-    // Get frame size
+    // Get frame size (v1 only; v2 frames are compressed to varying sizes)
     size_t GetFrameSize() const { return frame_size_; }
 
+    // backgrounds.bin is an asset pack v2 (else the headerless v1 layout)
+    bool IsPacked() const { return pack_.IsOpen(); }
+
+    // Size of the v2 section in the partition (the item data starts right after)
+    size_t GetTotalDataSize() const { return pack_.GetDataSize(); }
+
 private:
     BackgroundLoader();
     ~BackgroundLoader();
@@ -94,6 +102,8 @@ private:
     bool initialized_;
     const esp_partition_t* partition_;
     size_t base_offset_;  // Offset within partition
+    AssetPack pack_;      // v2 backgrounds.bin, not open for v1
+    const uint8_t* mapped_;  // v1 backgrounds.bin in the mapped partition, or nullptr
 
     // Background info
     uint16_t width_;            // Image width (280)
@@ -1,4 +1,5 @@
 #include "item_loader.h"
+#include "asset_map.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
 #include <string.h>
@@ -19,6 +20,7 @@ ItemLoader::ItemLoader()
     : initialized_(false)
     , partition_(nullptr)
     , base_offset_(0)
+    , mapped_(nullptr)
     , width_(ITEM_WIDTH)
     , height_(ITEM_HEIGHT)
     , total_item_count_(0)
@@ -68,7 +70,21 @@ bool ItemLoader::Initialize(const esp_partition_t* partition, size_t item_offset
     // We'll use the standard calculation but can adjust if needed
     frame_size_ = ITEM_FRAME_SIZE;
 
-    ESP_LOGI(TAG, "Item format: headerless per-frame RGB888 palette");
+    if (pack_.Open(partition, item_offset)) {
+        if (pack_.GetWidth() != ITEM_WIDTH || pack_.GetHeight() != ITEM_HEIGHT) {
+            ESP_LOGE(TAG, "Asset pack is %dx%d, expected %dx%d",
+                     pack_.GetWidth(), pack_.GetHeight(), ITEM_WIDTH, ITEM_HEIGHT);
+            return false;
+        }
+        if (pack_.GetFrameCount() < total_item_count_) {
+            total_item_count_ = pack_.GetFrameCount();
+        }
+        frame_size_ = 0;
+        ESP_LOGI(TAG, "Item format: asset pack v2 (%u bytes)", (unsigned)pack_.GetDataSize());
+    } else {
+        ESP_LOGI(TAG, "Item format: headerless per-frame RGB888 palette");
+        mapped_ = AssetMap::GetInstance().Data(partition, item_offset, (size_t)total_item_count_ * frame_size_);
+    }
     ESP_LOGI(TAG, "Dimensions: %dx%d, items: %d, frame_size: %u bytes",
              width_, height_, total_item_count_, (unsigned)frame_size_);
     ESP_LOGI(TAG, "Base offset in partition: 0x%X", (unsigned)base_offset_);
@@ -87,7 +103,7 @@ bool ItemLoader::Initialize(const esp_partition_t* partition, size_t item_offset
     ESP_LOGI(TAG, "Row buffer allocated: %u bytes", (unsigned)width_);
     ESP_LOGI(TAG, "Partition size: %u bytes, item data end: 0x%X",
              (unsigned)partition_->size,
-             (unsigned)(base_offset_ + ITEM_TYPE_COUNT * frame_size_));
+             (unsigned)(base_offset_ + (pack_.IsOpen() ? pack_.GetDataSize() : ITEM_TYPE_COUNT * frame_size_)));
 
     // Pre-decode all items to memory for fast rendering (no flash access during composite)
     bool items_decoded = true;
@@ -110,8 +126,11 @@ bool ItemLoader::Initialize(const esp_partition_t* partition, size_t item_offset
         if (DecodeFull(i, decoded_items_[i])) {
             // Store the background color in RGB565 for fast transparency check
             bg_color_rgb565_[i] = palette_[bg_color_index_[i]];
-            ESP_LOGI(TAG, "Item %d decoded OK (bg_idx=%d, bg_color=0x%04X)",
-                     i, bg_color_index_[i], bg_color_rgb565_[i]);
+            uint16_t key = bg_color_rgb565_[i];
+            opaque_runs_[i].Build(decoded_items_[i], ITEM_WIDTH, ITEM_HEIGHT,
+                                  [key](uint16_t pixel) { return pixel == key; });
+            ESP_LOGI(TAG, "Item %d decoded OK (bg_idx=%d, bg_color=0x%04X, %u opaque runs)",
+                     i, bg_color_index_[i], bg_color_rgb565_[i], (unsigned)opaque_runs_[i].GetRunCount());
         } else {
             ESP_LOGE(TAG, "Failed to decode item %d from flash!", i);
             free(decoded_items_[i]);
@@ -145,6 +164,15 @@ bool ItemLoader::ReadAndDecodeFrame(uint16_t frame_idx) const {
         return true;
     }
 
+    if (pack_.IsOpen()) {
+        // v2: palette stored as RGB565
+        if (!pack_.ReadPalette(pack_.GetFramePalette(frame_idx), palette_, ITEM_PALETTE_COLORS)) {
+            return false;
+        }
+        cached_frame_idx_ = frame_idx;
+        return true;
+    }
+
     // Calculate frame offset
     size_t frame_offset = base_offset_ + ((size_t)frame_idx * frame_size_);
 
@@ -155,13 +183,18 @@ bool ItemLoader::ReadAndDecodeFrame(uint16_t frame_idx) const {
         return false;
     }
 
-    // Read RGB888 palette (765 bytes for 255 colors)
-    uint8_t palette_rgb888[ITEM_PALETTE_SIZE];
-    esp_err_t err = esp_partition_read(partition_, frame_offset, palette_rgb888, ITEM_PALETTE_SIZE);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read palette at offset 0x%X: %s",
-                 (unsigned)frame_offset, esp_err_to_name(err));
-        return false;
+    // Read RGB888 palette (765 bytes for 255 colors), in place when mapped
+    uint8_t palette_buf[ITEM_PALETTE_SIZE];
+    const uint8_t* palette_rgb888 = palette_buf;
+    if (mapped_ != nullptr) {
+        palette_rgb888 = mapped_ + (frame_offset - base_offset_);
+    } else {
+        esp_err_t err = esp_partition_read(partition_, frame_offset, palette_buf, ITEM_PALETTE_SIZE);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read palette at offset 0x%X: %s",
+                     (unsigned)frame_offset, esp_err_to_name(err));
+            return false;
+        }
     }
 
     // Debug: show first few palette bytes to verify data
@@ -202,21 +235,16 @@ void ItemLoader::DecodeRow(uint16_t item_type, uint16_t row, uint16_t* out_buf)
         return;
     }
 
-    // Calculate offset for this row's pixel data
-    size_t frame_offset = base_offset_ + ((size_t)item_type * frame_size_);
-    size_t row_offset = frame_offset + ITEM_PALETTE_SIZE + ((size_t)row * width_);
-
     // Read row pixels from flash
-    esp_err_t err = esp_partition_read(partition_, row_offset, pixel_buffer_, width_);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read row %d: %s", row, esp_err_to_name(err));
+    const uint8_t* indices = ReadRowIndices(item_type, row);
+    if (!indices) {
         memset(out_buf, 0, width_ * sizeof(uint16_t));
         return;
     }
 
     // Decode row using cached palette
     for (uint16_t x = 0; x < width_; x++) {
-        uint8_t idx = pixel_buffer_[x];
+        uint8_t idx = indices[x];
         out_buf[x] = palette_[idx];
     }
 }
@@ -239,21 +267,16 @@ bool ItemLoader::DecodeFull(uint16_t item_type, uint16_t* out_buf) const {
     }
 
     // Decode row by row
-    size_t frame_offset = base_offset_ + ((size_t)item_type * frame_size_);
-
     for (uint16_t y = 0; y < height_; y++) {
-        size_t row_offset = frame_offset + ITEM_PALETTE_SIZE + ((size_t)y * width_);
-
         // Read row pixels from flash
-        esp_err_t err = esp_partition_read(partition_, row_offset, pixel_buffer_, width_);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to read row %d: %s", y, esp_err_to_name(err));
+        const uint8_t* indices = ReadRowIndices(item_type, y);
+        if (!indices) {
             return false;
         }
 
         // Decode row using cached palette
         for (uint16_t x = 0; x < width_; x++) {
-            uint8_t idx = pixel_buffer_[x];
+            uint8_t idx = indices[x];
             out_buf[y * width_ + x] = palette_[idx];
         }
     }
@@ -267,10 +290,31 @@ bool ItemLoader::DecodeFull(uint16_t item_type, uint16_t* out_buf) const {
     return true;
 }
 
+const uint8_t* ItemLoader::ReadRowIndices(uint16_t frame_idx, uint16_t row) const {
+    if (pack_.IsOpen()) {
+        return pack_.ReadRow(frame_idx, row, pixel_buffer_) ? pixel_buffer_ : nullptr;
+    }
+
+    size_t frame_offset = base_offset_ + ((size_t)frame_idx * frame_size_);
+    size_t row_offset = frame_offset + ITEM_PALETTE_SIZE + ((size_t)row * width_);
+    if (mapped_ != nullptr) {
+        return mapped_ + (row_offset - base_offset_);
+    }
+    esp_err_t err = esp_partition_read(partition_, row_offset, pixel_buffer_, width_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read row %d: %s", row, esp_err_to_name(err));
+        return nullptr;
+    }
+    return pixel_buffer_;
+}
+
 size_t ItemLoader::GetFrameOffset(uint16_t item_type) const {
     if (!initialized_ || item_type >= total_item_count_) {
         return 0;
     }
+    if (pack_.IsOpen()) {
+        return pack_.GetFrameOffset(item_type);
+    }
     return base_offset_ + ((size_t)item_type * frame_size_);
 }
 
@@ -301,3 +345,10 @@ bool ItemLoader::IsTransparent(uint16_t item_type, uint16_t x, uint16_t y) const
     uint16_t pixel = decoded_items_[item_type][y * width_ + x];
     return pixel == bg_color_rgb565_[item_type];
 }
+
+const SpriteRuns* ItemLoader::GetOpaqueRuns(uint16_t item_type) const {
+    if (!initialized_ || item_type >= ITEM_TYPE_COUNT || !opaque_runs_[item_type].IsBuilt()) {
+        return nullptr;
+    }
+    return &opaque_runs_[item_type];
+}
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <esp_partition.h>
+#include "sprite_runs.h"
+#include "asset_pack.h"
 
 // Item dimensions (40x40 pixels)
 #define ITEM_WIDTH  40
@@ -22,7 +24,7 @@
 #define ITEM_FRAME_SIZE     (ITEM_PALETTE_SIZE + ITEM_PIXELS_SIZE)  // 2365 bytes per frame
 
 // Item loader class - loads 40x40 item sprites from flash
-// Same format as BackgroundLoader but smaller dimensions
+// Same format as BackgroundLoader (v1 or asset pack v2) but smaller dimensions
 class ItemLoader {
 public:
     static ItemLoader& GetInstance();
@@ -59,6 +61,9 @@ public:
     // Check if pixel is transparent (background color)
     bool IsTransparent(uint16_t item_type, uint16_t x, uint16_t y) const;
 
+    // Opaque runs of a pre-decoded item (built at init), or nullptr if not available
+    const SpriteRuns* GetOpaqueRuns(uint16_t item_type) const;
+
     // Decode full item to RGB565 buffer
     // item_type: ITEM_TYPE_COIN or ITEM_TYPE_POOP
     // out_buf: must be at least ITEM_WIDTH * ITEM_HEIGHT * 2 bytes
@@ -85,9 +90,15 @@ private:
     // Read frame from flash and decode palette
     bool ReadAndDecodeFrame(uint16_t frame_idx) const;
 
+    // One row of indices: in place in the mapped partition, or read into pixel_buffer_
+    // Returns nullptr on error
+    const uint8_t* ReadRowIndices(uint16_t frame_idx, uint16_t row) const;
+
     bool initialized_;
     const esp_partition_t* partition_;
     size_t base_offset_;  // Offset within partition
+    AssetPack pack_;      // v2 items data, not open for v1
+    const uint8_t* mapped_;  // v1 item data in the mapped partition, or nullptr
 
     // Item info
     uint16_t width_;            // Image width (40)
@@ -109,6 +120,9 @@ private:
     // Each buffer is ITEM_WIDTH * ITEM_HEIGHT * 2 bytes = 3200 bytes
     uint16_t* decoded_items_[ITEM_TYPE_COUNT];
     uint16_t bg_color_rgb565_[ITEM_TYPE_COUNT];  // Pre-converted bg colors
+
+    // Per-row opaque spans of each decoded item, for span compositing
+    SpriteRuns opaque_runs_[ITEM_TYPE_COUNT];
 };
 
 #endif // _ITEM_LOADER_H_
@@ -0,0 +1,217 @@
+#include "pet_compositor.h"
+#include <string.h>
+#include <algorithm>
+#include <climits>
+
+static inline int damage_rect_area(const DirtyRect& r) {
+    return (r.x2 - r.x1) * (r.y2 - r.y1);
+}
+
+static inline DirtyRect damage_rect_union(const DirtyRect& a, const DirtyRect& b) {
+    return { std::min(a.x1, b.x1), std::min(a.y1, b.y1), std::max(a.x2, b.x2), std::max(a.y2, b.y2) };
+}
+
+static inline bool damage_item_in(const CachedItemBounds& item, const CachedItemBounds* list, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (list[i].x1 == item.x1 && list[i].y1 == item.y1 && list[i].item_type == item.item_type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PetCompositor::AddDamage(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    DirtyRect r = { std::max<int16_t>(x1, 0), std::max<int16_t>(y1, DAMAGE_BAND_Y1),
+                    std::min<int16_t>(x2, COMPOSITE_WIDTH), std::min<int16_t>(y2, DAMAGE_BAND_Y2) };
+    if (r.x1 >= r.x2 || r.y1 >= r.y2) {
+        return;
+    }
+    AddDamageRect(r);
+}
+
+void PetCompositor::AddDamageRect(DirtyRect r) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (uint8_t i = 0; i < dirty_rect_count_; i++) {
+            const DirtyRect& d = dirty_rects_[i];
+            if (r.x1 < d.x2 && d.x1 < r.x2 && r.y1 < d.y2 && d.y1 < r.y2) {
+                r = damage_rect_union(r, d);
+                dirty_rects_[i] = dirty_rects_[--dirty_rect_count_];
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (dirty_rect_count_ == MAX_DIRTY_RECTS) {
+        // List full - fold into the rect that grows the least, then re-merge
+        uint8_t best = 0;
+        int best_growth = INT_MAX;
+        for (uint8_t i = 0; i < dirty_rect_count_; i++) {
+            int growth = damage_rect_area(damage_rect_union(r, dirty_rects_[i])) - damage_rect_area(dirty_rects_[i]);
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = i;
+            }
+        }
+        r = damage_rect_union(r, dirty_rects_[best]);
+        dirty_rects_[best] = dirty_rects_[--dirty_rect_count_];
+        AddDamageRect(r);
+        return;
+    }
+    dirty_rects_[dirty_rect_count_++] = r;
+}
+
+void PetCompositor::AddFullDamage() {
+    dirty_rect_count_ = 0;
+    AddDamage(0, DAMAGE_BAND_Y1, COMPOSITE_WIDTH, DAMAGE_BAND_Y2);
+}
+
+void PetCompositor::BeginFrame(const PetScene& scene, PetFrameSource& frames, bool periodic_full_refresh) {
+    scene_ = scene;
+    item_count_ = std::min<uint8_t>(scene.item_count, MAX_CACHED_ITEMS);
+    if (item_count_ > 0) {
+        memcpy(items_, scene.items, sizeof(CachedItemBounds) * item_count_);
+    }
+    scene_.items = items_;
+    scene_.item_count = item_count_;
+
+    // Find what changed since the last composited frame (sprite, items, background)
+    const PetScene& s = scene_;
+    frames_since_full_++;
+    if (!last_valid_ || last_.bg_idx != s.bg_idx ||
+        (periodic_full_refresh && frames_since_full_ >= DAMAGE_FULL_REFRESH_FRAMES)) {
+        AddFullDamage();
+        frames_since_full_ = 0;
+    } else {
+        if (last_.frame_idx != s.frame_idx || last_.sprite_x != s.sprite_x ||
+            last_.sprite_y != s.sprite_y || last_.mirror != s.mirror) {
+            AddDamage(last_.sprite_x, last_.sprite_y,
+                      last_.sprite_x + last_.frame_width, last_.sprite_y + last_.frame_height);
+            AddDamage(s.sprite_x, s.sprite_y, s.sprite_x + s.frame_width, s.sprite_y + s.frame_height);
+        }
+        for (uint8_t i = 0; i < item_count_; i++) {
+            const auto& c = items_[i];
+            if (!damage_item_in(c, last_items_, last_item_count_)) {
+                AddDamage(c.x1, c.y1, c.x2, c.y2);
+            }
+        }
+        for (uint8_t i = 0; i < last_item_count_; i++) {
+            const auto& c = last_items_[i];
+            if (!damage_item_in(c, items_, item_count_)) {
+                AddDamage(c.x1, c.y1, c.x2, c.y2);
+            }
+        }
+    }
+
+    last_valid_ = true;
+    last_ = s;
+    memcpy(last_items_, items_, sizeof(CachedItemBounds) * item_count_);
+    last_item_count_ = item_count_;
+
+    // Rebuild the pet's opaque runs when a new frame was decoded
+    // (same index but another buffer: the loader re-decoded it elsewhere)
+    if (dirty_rect_count_ > 0) {
+        const uint16_t* pixels = frames.GetFrame(s.frame_idx);
+        if (pixels == nullptr) {
+            pet_runs_.Clear();
+            pet_runs_frame_idx_ = 0xFFFF;
+        } else if (pet_runs_frame_idx_ != s.frame_idx || pet_runs_.GetPixels() != pixels) {
+            pet_runs_.Build(pixels, s.frame_width, s.frame_height, is_background_color);
+            pet_runs_frame_idx_ = s.frame_idx;
+        }
+        BuildDrawList();
+    }
+}
+
+void PetCompositor::AddSprite(int16_t x, int16_t y, const SpriteRuns* runs, bool mirror) {
+    if (runs == nullptr || !runs->IsBuilt() || sprite_count_ == PET_MAX_SPRITES) {
+        return;
+    }
+    Sprite sprite = { x, y, (int16_t)(x + runs->GetWidth()), (int16_t)(y + runs->GetHeight()),
+                      (int16_t)(y + runs->GetOpaqueBottom()), runs, mirror };
+    if (sprite.x2 <= 0 || sprite.x1 >= COMPOSITE_WIDTH || sprite.y2 <= 0 || sprite.y1 >= COMPOSITE_HEIGHT) {
+        return;  // Off screen
+    }
+
+    // Insertion sort by depth; equal depths keep insertion order (later = in front)
+    uint8_t i = sprite_count_++;
+    while (i > 0 && sprites_[i - 1].depth > sprite.depth) {
+        sprites_[i] = sprites_[i - 1];
+        i--;
+    }
+    sprites_[i] = sprite;
+}
+
+void PetCompositor::BuildDrawList() {
+    // Items in reverse so earlier items stay on top at equal depth, then the pet,
+    // which stays on top of an item standing on the same line
+    sprite_count_ = 0;
+    for (int i = item_count_ - 1; i >= 0; i--) {
+        AddSprite(items_[i].x1, items_[i].y1, items_[i].runs, false);
+    }
+    AddSprite(scene_.sprite_x, scene_.sprite_y, &pet_runs_, scene_.mirror);
+
+    // Per-row masks: the cost is the sprites' height, not the screen's
+    memset(row_sprites_, 0, sizeof(row_sprites_));
+    for (uint8_t i = 0; i < sprite_count_; i++) {
+        int16_t y1 = std::max<int16_t>(sprites_[i].y1, 0);
+        int16_t y2 = std::min<int16_t>(sprites_[i].y2, COMPOSITE_HEIGHT);
+        for (int16_t y = y1; y < y2; y++) {
+            row_sprites_[y] |= 1 << i;
+        }
+    }
+}
+
+void PetCompositor::CompositeRowSpan(int16_t y, int16_t x1, int16_t x2, const uint16_t* bg_row,
+                                     uint16_t* out_row) const {
+    if (bg_row != nullptr) {
+        memcpy(out_row + x1, bg_row + x1, (x2 - x1) * sizeof(uint16_t));
+    } else {
+        memset(out_row + x1, 0, (x2 - x1) * sizeof(uint16_t));
+    }
+
+    // Sprites crossing this row, back to front (lowest bit first)
+    uint16_t active = row_sprites_[y];
+    while (active != 0) {
+        const Sprite& sprite = sprites_[__builtin_ctz(active)];
+        active &= active - 1;
+        if (sprite.x2 <= x1 || sprite.x1 >= x2) {
+            continue;
+        }
+        sprite.runs->BlitRow(y - sprite.y1, sprite.x1, sprite.mirror, out_row, x1, x2);
+    }
+}
+
+uint32_t PetCompositor::CompositeDirty(PetBackgroundSource& background, uint16_t* buffer) const {
+    // Composite row by row, only the dirty spans of each row
+    // Dirty rects never cover the top / bottom UI bars
+    uint32_t pixels = 0;
+    for (int16_t y = DAMAGE_BAND_Y1; y < DAMAGE_BAND_Y2 && dirty_rect_count_ > 0; y++) {
+        bool row_dirty = false;
+        for (uint8_t r = 0; r < dirty_rect_count_; r++) {
+            if (y >= dirty_rects_[r].y1 && y < dirty_rects_[r].y2) {
+                row_dirty = true;
+                break;
+            }
+        }
+        if (!row_dirty) {
+            continue;
+        }
+
+        const uint16_t* bg_row = background.GetRow(y);
+        uint16_t* out_row = &buffer[y * COMPOSITE_WIDTH];
+
+        // Dirty rects are disjoint, so each span of this row is composited once
+        for (uint8_t r = 0; r < dirty_rect_count_; r++) {
+            const DirtyRect& rect = dirty_rects_[r];
+            if (y < rect.y1 || y >= rect.y2) {
+                continue;
+            }
+            CompositeRowSpan(y, rect.x1, rect.x2, bg_row, out_row);
+            pixels += rect.x2 - rect.x1;
+        }
+    }
+    return pixels;
+}
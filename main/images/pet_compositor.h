@@ -0,0 +1,209 @@
+#ifndef _PET_COMPOSITOR_H_
+#define _PET_COMPOSITOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sprite_runs.h"
+
+// Pet scene compositor: background + scene items + pet sprite into RGB565, with damage
+// tracking so only the rectangles that changed since the last frame are re-composited.
+// Sprites (pet, coins, poops) are drawn in depth order - whoever stands lower on screen
+// is in front - so the pet can walk behind or in front of items.
+// Portable (no ESP-IDF dependencies): the board drives it from the animation timer and
+// scripts/pet_render_harness.cc runs the same code on a Linux host
+
+// Composite buffer dimensions (full screen size)
+#define COMPOSITE_WIDTH   280
+#define COMPOSITE_HEIGHT  240
+
+// UI areas drawn by LVGL over the composite (status bar, subtitles); never composited
+#define TOP_UI_HEIGHT     25   // Height of top bar (status icons, matches bg_offset_y)
+#define BOTTOM_UI_HEIGHT  25   // Height of bottom bar (subtitles)
+
+// Visible composite band (between top and bottom UI bars)
+#define DAMAGE_BAND_Y1  TOP_UI_HEIGHT
+#define DAMAGE_BAND_Y2  (COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT)
+
+#define MAX_DIRTY_RECTS  6      // More rects than this are merged together
+#define DAMAGE_FULL_REFRESH_FRAMES  60  // Direct LCD mode: repaint everything every ~10s
+
+// Maximum scene items = MAX_SCENE_COINS + MAX_SCENE_POOPS = 13
+#define MAX_CACHED_ITEMS 13
+
+// Draw list capacity: every scene item plus the pet (one bit each in the per-row masks)
+#define PET_MAX_SPRITES  (MAX_CACHED_ITEMS + 1)
+static_assert(PET_MAX_SPRITES <= 16, "Per-row sprite masks are 16 bits");
+
+// Background color range for transparency (from all frames in index.json + 20% margin)
+// All frames bg_color_rgb range: R(1-7), G(173-206), B(104-138)
+// Expand 20%: R(0-9), G(166-213), B(97-145)
+// Convert to RGB565:
+#define BG_R_MIN  0    // 0 >> 3 = 0
+#define BG_R_MAX  3    // 9 >> 3 = 1
+#define BG_G_MIN  36   // 166 >> 2 = 41
+#define BG_G_MAX  46   // 213 >> 2 = 53
+#define BG_B_MIN  10   // 97 >> 3 = 12
+#define BG_B_MAX  14   // 145 >> 3 = 18
+
+// Helper: Check if RGB565 pixel is within background color range
+static inline bool is_background_color(uint16_t pixel) {
+    uint8_t r = (pixel >> 11) & 0x1F;  // 5-bit red
+    uint8_t g = (pixel >> 5) & 0x3F;   // 6-bit green
+    uint8_t b = pixel & 0x1F;          // 5-bit blue
+    // Note: BG_R_MIN is 0, so r >= BG_R_MIN is always true for uint8_t
+    return (r <= BG_R_MAX &&
+            g >= BG_G_MIN && g <= BG_G_MAX &&
+            b >= BG_B_MIN && b <= BG_B_MAX);
+}
+
+// Helper: Swap bytes in RGB565 (for direct LCD output mode)
+// LCD expects big-endian but ESP32 stores little-endian
+static inline uint16_t swap_bytes_rgb565(uint16_t pixel) {
+    return (pixel >> 8) | (pixel << 8);
+}
+
+// Scene item in composite coordinates
+// Each item stores its screen-space bounding box for fast inline rejection
+struct CachedItemBounds {
+    int16_t x1, y1, x2, y2;  // Screen coordinates (x1,y1) to (x2,y2) exclusive
+    uint8_t item_type;       // ITEM_TYPE_COIN or ITEM_TYPE_POOP
+    bool active;
+    const SpriteRuns* runs;  // Opaque spans of this item type (nullptr = nothing to draw)
+};
+
+struct DirtyRect {
+    int16_t x1, y1, x2, y2;  // Composite coordinates, (x2,y2) exclusive
+};
+
+// Source of pet frames in RGB565 (AnimationLoader::GetFrameByIndex on the device)
+class PetFrameSource {
+public:
+    virtual ~PetFrameSource() = default;
+
+    // Frame frame_idx, valid until the next call; nullptr if it cannot be read
+    virtual const uint16_t* GetFrame(uint16_t frame_idx) = 0;
+};
+
+// Source of background rows in RGB565: a whole background in RAM, or rows decoded
+// from flash on demand (BackgroundLoader::DecodeRow)
+class PetBackgroundSource {
+public:
+    virtual ~PetBackgroundSource() = default;
+
+    // Row y (COMPOSITE_WIDTH pixels), valid until the next call; nullptr draws black
+    virtual const uint16_t* GetRow(uint16_t y) = 0;
+};
+
+// Everything one frame shows
+struct PetScene {
+    uint16_t bg_idx;
+    uint16_t frame_idx;             // Pet frame, fetched from the PetFrameSource
+    uint16_t frame_width;
+    uint16_t frame_height;
+    int16_t sprite_x, sprite_y;     // Pet's top-left corner in composite coordinates
+    bool mirror;
+    const CachedItemBounds* items;  // At equal depth, earlier items end up on top of later ones
+    uint8_t item_count;
+};
+
+class PetCompositor {
+public:
+    // Take this frame's scene: compare it against the last composited one and add the
+    // changed areas (previous + current sprite box, items that appeared, moved or
+    // disappeared) to the dirty rects. Rects not yet pushed are kept.
+    // periodic_full_refresh repaints everything every DAMAGE_FULL_REFRESH_FRAMES frames.
+    // The pet frame is fetched from frames only when something is dirty
+    void BeginFrame(const PetScene& scene, PetFrameSource& frames, bool periodic_full_refresh);
+
+    // Add a rectangle, clipped to the visible band; overlapping rects are merged
+    // so the list stays disjoint and every pixel is composited once
+    void AddDamage(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    void AddFullDamage();
+
+    // Dirty rects have been pushed to the display
+    void ClearDamage() { dirty_rect_count_ = 0; }
+
+    uint8_t GetDirtyRectCount() const { return dirty_rect_count_; }
+    const DirtyRect& GetDirtyRect(uint8_t i) const { return dirty_rects_[i]; }
+
+    // Composite one row span [x1, x2) into out_row (indexed by composite x)
+    // Layers are copied as whole runs: background, then the opaque spans of the sprites
+    // crossing this row, back to front
+    void CompositeRowSpan(int16_t y, int16_t x1, int16_t x2, const uint16_t* bg_row, uint16_t* out_row) const;
+
+    // Full composite buffer mode: composite the dirty spans of each row into buffer
+    // (COMPOSITE_WIDTH x COMPOSITE_HEIGHT), fetching each dirty background row once
+    // Returns the number of pixels composited
+    uint32_t CompositeDirty(PetBackgroundSource& background, uint16_t* buffer) const;
+
+    // Direct output mode: each dirty rect as strips of up to strip_rows rows. A strip is
+    // composited into acquire()'s buffer (rows rect width apart, byte-swapped for the
+    // panel when swap_bytes) and handed to send(rect, y1, y2) for rows [y1, y2)
+    // Returns the number of pixels composited
+    template <typename Acquire, typename Send>
+    uint32_t CompositeStrips(PetBackgroundSource& background, uint16_t strip_rows, bool swap_bytes,
+                             Acquire acquire, Send send) const {
+        uint32_t pixels = 0;
+        for (uint8_t r = 0; r < dirty_rect_count_; r++) {
+            const DirtyRect& rect = dirty_rects_[r];
+            uint16_t span = rect.x2 - rect.x1;
+            for (int16_t strip_y = rect.y1; strip_y < rect.y2; strip_y += strip_rows) {
+                int16_t strip_end = strip_y + strip_rows < rect.y2 ? strip_y + strip_rows : rect.y2;
+                uint16_t* strip = acquire();
+                for (int16_t y = strip_y; y < strip_end; y++) {
+                    // Strip rows are span pixels wide; out_row is indexed by composite x
+                    uint16_t* out_row = strip + (y - strip_y) * span - rect.x1;
+                    CompositeRowSpan(y, rect.x1, rect.x2, background.GetRow(y), out_row);
+                    if (swap_bytes) {
+                        for (int16_t x = rect.x1; x < rect.x2; x++) {
+                            out_row[x] = swap_bytes_rgb565(out_row[x]);
+                        }
+                    }
+                }
+                send(rect, strip_y, strip_end);
+                pixels += span * (strip_end - strip_y);
+            }
+        }
+        return pixels;
+    }
+
+private:
+    // One entry of the draw list
+    struct Sprite {
+        int16_t x1, y1, x2, y2;  // Composite coordinates, (x2,y2) exclusive
+        int16_t depth;           // Composite y just below the lowest opaque row (the feet)
+        const SpriteRuns* runs;
+        bool mirror;
+    };
+
+    void AddDamageRect(DirtyRect r);
+    void AddSprite(int16_t x, int16_t y, const SpriteRuns* runs, bool mirror);
+    void BuildDrawList();
+
+    DirtyRect dirty_rects_[MAX_DIRTY_RECTS] = {};
+    uint8_t dirty_rect_count_ = 0;
+
+    // Current frame
+    PetScene scene_ = {};
+    CachedItemBounds items_[MAX_CACHED_ITEMS] = {};
+    uint8_t item_count_ = 0;
+
+    // Draw list, back to front, rebuilt once per frame. row_sprites_[y] has bit i set
+    // when sprites_[i] crosses row y, so a row only visits the sprites it contains
+    Sprite sprites_[PET_MAX_SPRITES] = {};
+    uint8_t sprite_count_ = 0;
+    uint16_t row_sprites_[COMPOSITE_HEIGHT] = {};
+
+    // Opaque spans of the pet frame, rebuilt whenever a new frame is decoded
+    SpriteRuns pet_runs_;
+    uint16_t pet_runs_frame_idx_ = 0xFFFF;
+
+    // What was composited last time - compared against the next frame
+    bool last_valid_ = false;
+    PetScene last_ = {};
+    CachedItemBounds last_items_[MAX_CACHED_ITEMS] = {};
+    uint8_t last_item_count_ = 0;
+    uint16_t frames_since_full_ = 0;
+};
+
+#endif // _PET_COMPOSITOR_H_
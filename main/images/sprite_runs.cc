@@ -0,0 +1,47 @@
+#include "sprite_runs.h"
+#include <string.h>
+
+void SpriteRuns::Clear() {
+    pixels_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+    runs_.clear();
+    row_start_.clear();
+}
+
+uint16_t SpriteRuns::GetOpaqueBottom() const {
+    for (uint16_t y = height_; y > 0; y--) {
+        if (row_start_[y - 1] != row_start_[y]) {
+            return y;
+        }
+    }
+    return 0;
+}
+
+void SpriteRuns::BlitRow(uint16_t y, int dst_x, bool mirror, uint16_t* out, int clip_x1, int clip_x2) const {
+    if (pixels_ == nullptr || y >= height_) {
+        return;
+    }
+    const uint16_t* row = pixels_ + y * width_;
+
+    for (const SpriteRun* run = RowBegin(y); run != RowEnd(y); run++) {
+        // Destination span of this run (a mirrored run starts from the right edge)
+        int x1 = mirror ? dst_x + width_ - run->x - run->len : dst_x + run->x;
+        int x2 = x1 + run->len;
+        if (x1 < clip_x1) x1 = clip_x1;
+        if (x2 > clip_x2) x2 = clip_x2;
+        if (x1 >= x2) {
+            continue;
+        }
+
+        if (!mirror) {
+            memcpy(out + x1, row + (x1 - dst_x), (x2 - x1) * sizeof(uint16_t));
+        } else {
+            // Destination x maps to source column width - 1 - (x - dst_x)
+            const uint16_t* src = row + width_ - 1 - (x1 - dst_x);
+            for (int x = x1; x < x2; x++) {
+                out[x] = *src--;
+            }
+        }
+    }
+}
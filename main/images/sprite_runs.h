@@ -0,0 +1,75 @@
+#ifndef _SPRITE_RUNS_H_
+#define _SPRITE_RUNS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Opaque span within one sprite row: pixels [x, x + len) are drawn
+struct SpriteRun {
+    uint16_t x;
+    uint16_t len;
+};
+
+// Per-row lists of opaque spans for an RGB565 sprite (pet frame or scene item)
+// Transparency is resolved once in Build(); compositing then copies whole runs
+// instead of testing the chroma key and bounds for every pixel
+class SpriteRuns {
+public:
+    // Scan the sprite and record the opaque runs of every row
+    // is_transparent(pixel) decides which pixels show what is underneath
+    // The pixel buffer must stay valid (and unchanged) until the next Build()
+    template <typename IsTransparent>
+    void Build(const uint16_t* pixels, uint16_t width, uint16_t height, IsTransparent is_transparent) {
+        pixels_ = pixels;
+        width_ = width;
+        height_ = height;
+        runs_.clear();
+        row_start_.resize(height + 1);
+        for (uint16_t y = 0; y < height; y++) {
+            row_start_[y] = runs_.size();
+            const uint16_t* row = pixels + y * width;
+            uint16_t x = 0;
+            while (x < width) {
+                while (x < width && is_transparent(row[x])) {
+                    x++;
+                }
+                uint16_t start = x;
+                while (x < width && !is_transparent(row[x])) {
+                    x++;
+                }
+                if (x > start) {
+                    runs_.push_back({start, (uint16_t)(x - start)});
+                }
+            }
+        }
+        row_start_[height] = runs_.size();
+    }
+
+    void Clear();
+    bool IsBuilt() const { return pixels_ != nullptr; }
+    const uint16_t* GetPixels() const { return pixels_; }
+    uint16_t GetWidth() const { return width_; }
+    uint16_t GetHeight() const { return height_; }
+    size_t GetRunCount() const { return runs_.size(); }
+
+    // One past the lowest row with opaque pixels (0 = nothing opaque): where the sprite
+    // stands, used to depth-sort sprites
+    uint16_t GetOpaqueBottom() const;
+
+    const SpriteRun* RowBegin(uint16_t y) const { return runs_.data() + row_start_[y]; }
+    const SpriteRun* RowEnd(uint16_t y) const { return runs_.data() + row_start_[y + 1]; }
+
+    // Copy the opaque pixels of sprite row y into out, with the sprite's left edge at
+    // out[dst_x]; only out[clip_x1, clip_x2) is written. mirror flips the row horizontally
+    void BlitRow(uint16_t y, int dst_x, bool mirror, uint16_t* out, int clip_x1, int clip_x2) const;
+
+private:
+    const uint16_t* pixels_ = nullptr;
+    uint16_t width_ = 0;
+    uint16_t height_ = 0;
+    std::vector<SpriteRun> runs_;
+    std::vector<uint32_t> row_start_;  // Index of each row's first run, height + 1 entries
+};
+
+#endif // _SPRITE_RUNS_H_
@@ -91,7 +91,8 @@ std::string ConversationManager::GetRecentConversation(int rounds) {
         const ChatMessage& msg = short_term_[i];
 
         // Format time
-        struct tm* tm_info = localtime((time_t*)&msg.timestamp);
+        time_t timestamp = msg.timestamp;
+        struct tm* tm_info = localtime(&timestamp);
         char time_buf[16];
         strftime(time_buf, sizeof(time_buf), "%H:%M", tm_info);
 
@@ -243,7 +244,8 @@ std::string ConversationManager::GenerateSummary(const std::vector<ChatMessage>&
     uint32_t start_time = messages.front().timestamp;
     uint32_t end_time = messages.back().timestamp;
 
-    struct tm* start_tm = localtime((time_t*)&start_time);
+    time_t start = start_time;
+    struct tm* start_tm = localtime(&start);
     char time_buf[32];
     strftime(time_buf, sizeof(time_buf), "%m-%d %H:%M", start_tm);
 
@@ -0,0 +1,167 @@
+#ifndef KEYWORD_AUTOMATON_H
+#define KEYWORD_AUTOMATON_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Aho-Corasick automaton over UTF-8 bytes, built entirely at compile time.
+ *
+ * The trie is stored as first-child/next-sibling arrays with failure and
+ * dictionary-suffix links, so the tables live in flash (rodata) and a scan
+ * is a single pass over the text that reports every occurrence of every
+ * pattern, including overlapping ones and duplicates of the same text.
+ *
+ * Usage:
+ *   constexpr std::array<const char*, N> PATTERNS = {...};
+ *   constexpr size_t NODES = KeywordAutomaton<N, KeywordAutomatonMaxNodes(PATTERNS)>(
+ *       PATTERNS).GetNodeCount();
+ *   constexpr KeywordAutomaton<N, NODES> AUTOMATON(PATTERNS);
+ *   AUTOMATON.Scan(text, len, [](uint16_t pattern, size_t end) {...});
+ */
+template <size_t PATTERN_COUNT, size_t MAX_NODES>
+class KeywordAutomaton {
+public:
+    static constexpr uint16_t NONE = 0xFFFF;
+    static_assert(MAX_NODES < NONE && PATTERN_COUNT < NONE, "automaton too large");
+
+    constexpr explicit KeywordAutomaton(const std::array<const char*, PATTERN_COUNT>& patterns) {
+        for (size_t i = 0; i < MAX_NODES; i++) {
+            first_child_[i] = NONE;
+            next_sibling_[i] = NONE;
+            output_[i] = NONE;
+            dict_link_[i] = NONE;
+        }
+        for (size_t i = 0; i < PATTERN_COUNT; i++) {
+            same_text_next_[i] = NONE;
+        }
+        node_count_ = 1;
+
+        for (size_t p = 0; p < PATTERN_COUNT; p++) {
+            Insert(patterns[p], (uint16_t)p);
+        }
+        if (!overflow_) {
+            BuildLinks();
+        }
+    }
+
+    constexpr size_t GetNodeCount() const { return node_count_; }
+    constexpr bool Overflowed() const { return overflow_; }
+    constexpr size_t GetLength(uint16_t pattern) const { return length_[pattern]; }
+
+    // Calls visit(pattern, end) for each occurrence, in order of end offset
+    template <typename Visitor>
+    void Scan(const char* text, size_t length, Visitor&& visit) const {
+        uint16_t state = 0;
+        for (size_t i = 0; i < length; i++) {
+            uint8_t byte = (uint8_t)text[i];
+            uint16_t next = FindChild(state, byte);
+            while (next == NONE && state != 0) {
+                state = fail_[state];
+                next = FindChild(state, byte);
+            }
+            state = (next == NONE) ? 0 : next;
+
+            uint16_t node = (output_[state] != NONE) ? state : dict_link_[state];
+            while (node != NONE) {
+                for (uint16_t p = output_[node]; p != NONE; p = same_text_next_[p]) {
+                    visit(p, i + 1);
+                }
+                node = dict_link_[node];
+            }
+        }
+    }
+
+private:
+    constexpr uint16_t FindChild(uint16_t node, uint8_t byte) const {
+        for (uint16_t c = first_child_[node]; c != NONE; c = next_sibling_[c]) {
+            if (byte_[c] == byte) {
+                return c;
+            }
+        }
+        return NONE;
+    }
+
+    constexpr void Insert(const char* pattern, uint16_t id) {
+        uint16_t node = 0;
+        size_t length = 0;
+        for (; pattern[length] != '\0'; length++) {
+            uint8_t byte = (uint8_t)pattern[length];
+            uint16_t child = FindChild(node, byte);
+            if (child == NONE) {
+                if (node_count_ >= MAX_NODES) {
+                    overflow_ = true;
+                    return;
+                }
+                child = (uint16_t)node_count_++;
+                byte_[child] = byte;
+                next_sibling_[child] = first_child_[node];
+                first_child_[node] = child;
+            }
+            node = child;
+        }
+        length_[id] = (uint8_t)length;
+
+        // Several tables may share a pattern text; chain them on one node
+        if (output_[node] == NONE) {
+            output_[node] = id;
+        } else {
+            uint16_t p = output_[node];
+            while (same_text_next_[p] != NONE) {
+                p = same_text_next_[p];
+            }
+            same_text_next_[p] = id;
+        }
+    }
+
+    constexpr void BuildLinks() {
+        uint16_t queue[MAX_NODES] = {};
+        size_t head = 0, tail = 0;
+        for (uint16_t c = first_child_[0]; c != NONE; c = next_sibling_[c]) {
+            fail_[c] = 0;
+            queue[tail++] = c;
+        }
+        while (head < tail) {
+            uint16_t node = queue[head++];
+            for (uint16_t c = first_child_[node]; c != NONE; c = next_sibling_[c]) {
+                uint16_t f = fail_[node];
+                uint16_t target = FindChild(f, byte_[c]);
+                while (target == NONE && f != 0) {
+                    f = fail_[f];
+                    target = FindChild(f, byte_[c]);
+                }
+                fail_[c] = (target == NONE) ? 0 : target;
+                dict_link_[c] = (output_[fail_[c]] != NONE) ? fail_[c] : dict_link_[fail_[c]];
+                queue[tail++] = c;
+            }
+        }
+    }
+
+    size_t node_count_ = 0;
+    bool overflow_ = false;
+    uint8_t byte_[MAX_NODES] = {};
+    uint16_t first_child_[MAX_NODES] = {};
+    uint16_t next_sibling_[MAX_NODES] = {};
+    uint16_t fail_[MAX_NODES] = {};
+    uint16_t output_[MAX_NODES] = {};           // First pattern ending at node
+    uint16_t dict_link_[MAX_NODES] = {};        // Nearest suffix node with an output
+    uint16_t same_text_next_[PATTERN_COUNT] = {};
+    uint8_t length_[PATTERN_COUNT] = {};
+};
+
+// Upper bound on trie nodes for a pattern table (one node per pattern byte).
+// Build once with this bound to learn the exact count, then size the real
+// automaton with GetNodeCount(); the oversized one is never emitted.
+template <size_t PATTERN_COUNT>
+constexpr size_t KeywordAutomatonMaxNodes(const std::array<const char*, PATTERN_COUNT>& patterns) {
+    size_t total = 1;
+    for (size_t p = 0; p < PATTERN_COUNT; p++) {
+        for (size_t i = 0; patterns[p][i] != '\0'; i++) {
+            total++;
+        }
+    }
+    return total;
+}
+
+#endif // KEYWORD_AUTOMATON_H
@@ -0,0 +1,314 @@
+#include "keyword_index.h"
+#include <esp_log.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+
+#define TAG "KeywordIndex"
+
+namespace {
+
+constexpr char META_MAGIC[4] = {'X', 'Z', 'K', 'I'};
+constexpr int READ_CHUNK = 128;     // Postings per fread during lookup
+
+struct KeywordIndexMeta {
+    char magic[4];
+    uint32_t indexed_count;
+};
+
+uint32_t HashBytes(const char* data, size_t len) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Decode one UTF-8 sequence; returns its byte length (1 for invalid bytes)
+int DecodeUtf8(const uint8_t* s, uint32_t& cp) {
+    if (s[0] < 0x80) {
+        cp = s[0];
+        return 1;
+    }
+    if ((s[0] & 0xE0) == 0xC0 && (s[1] & 0xC0) == 0x80) {
+        cp = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    if ((s[0] & 0xF0) == 0xE0 && (s[1] & 0xC0) == 0x80 && (s[2] & 0xC0) == 0x80) {
+        cp = ((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        return 3;
+    }
+    if ((s[0] & 0xF8) == 0xF0 && (s[1] & 0xC0) == 0x80 && (s[2] & 0xC0) == 0x80 && (s[3] & 0xC0) == 0x80) {
+        cp = ((s[0] & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+        return 4;
+    }
+    cp = 0xFFFD;
+    return 1;
+}
+
+bool IsCjk(uint32_t cp) {
+    return (cp >= 0x3040 && cp <= 0x30FF) ||    // Hiragana / Katakana
+           (cp >= 0x3400 && cp <= 0x4DBF) ||    // CJK Extension A
+           (cp >= 0x4E00 && cp <= 0x9FFF) ||    // CJK Unified Ideographs
+           (cp >= 0xAC00 && cp <= 0xD7AF) ||    // Hangul syllables
+           (cp >= 0xF900 && cp <= 0xFAFF);      // CJK Compatibility Ideographs
+}
+
+bool IsWordChar(uint8_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+inline int TermBucket(uint32_t term) {
+    return term % KeywordIndex::BUCKET_COUNT;
+}
+
+inline uint32_t MakePosting(uint32_t term, uint32_t record_id) {
+    return (((term >> 5) & 0xFFF) << 20) | (record_id & KeywordIndex::MAX_RECORD_ID);
+}
+
+inline bool PostingMatches(uint32_t posting, uint32_t term) {
+    return (posting >> 20) == ((term >> 5) & 0xFFF);
+}
+
+}  // namespace
+
+void KeywordIndex::Tokenize(const char* text, std::vector<uint32_t>& terms) {
+    const uint8_t* s = (const uint8_t*)text;
+    const uint8_t* prev_cjk = nullptr;      // Previous character of the current CJK run
+
+    while (*s) {
+        if (IsWordChar(*s)) {
+            prev_cjk = nullptr;
+            char word[32];
+            size_t len = 0;
+            while (IsWordChar(*s)) {
+                if (len < sizeof(word)) {
+                    char c = *s;
+                    word[len++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+                }
+                s++;
+            }
+            terms.push_back(HashBytes(word, len));
+            continue;
+        }
+
+        uint32_t cp;
+        int n = DecodeUtf8(s, cp);
+        if (IsCjk(cp)) {
+            if (prev_cjk) {
+                // Bigram: previous character + this one
+                terms.push_back(HashBytes((const char*)prev_cjk, (s - prev_cjk) + n));
+            }
+            prev_cjk = s;
+        } else {
+            prev_cjk = nullptr;
+        }
+        s += n;
+    }
+}
+
+bool KeywordIndex::HasWord(const char* text) {
+    for (const uint8_t* s = (const uint8_t*)text; *s; s++) {
+        if (IsWordChar(*s)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void KeywordIndex::Init(const char* base_path, const char* name) {
+    snprintf(prefix_, sizeof(prefix_), "%s/%s", base_path, name);
+    indexed_count_ = 0;
+    stored_count_ = 0;
+    for (auto& postings : pending_) {
+        postings.clear();
+    }
+    pending_postings_ = 0;
+
+    char path[48];
+    MetaPath(path, sizeof(path));
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return;
+    }
+    KeywordIndexMeta meta;
+    if (fread(&meta, sizeof(meta), 1, f) == 1 && memcmp(meta.magic, META_MAGIC, 4) == 0) {
+        indexed_count_ = meta.indexed_count;
+        stored_count_ = meta.indexed_count;
+    }
+    fclose(f);
+}
+
+void KeywordIndex::BucketPath(int bucket, char* path, size_t size) {
+    snprintf(path, size, "%s_k%02d.pst", prefix_, bucket);
+}
+
+void KeywordIndex::MetaPath(char* path, size_t size) {
+    snprintf(path, size, "%s.kix", prefix_);
+}
+
+bool KeywordIndex::SaveMeta() {
+    char path[48];
+    MetaPath(path, sizeof(path));
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    KeywordIndexMeta meta;
+    memcpy(meta.magic, META_MAGIC, 4);
+    meta.indexed_count = indexed_count_;
+    bool ok = fwrite(&meta, sizeof(meta), 1, f) == 1;
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+bool KeywordIndex::Add(uint32_t record_id, const char* const* fields, int field_count) {
+    if (record_id != indexed_count_ || record_id > MAX_RECORD_ID) {
+        return false;
+    }
+
+    std::vector<uint32_t> terms;
+    for (int i = 0; i < field_count; i++) {
+        if (fields[i]) {
+            Tokenize(fields[i], terms);
+        }
+    }
+
+    // One posting per distinct term
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    for (uint32_t term : terms) {
+        pending_[TermBucket(term)].push_back(MakePosting(term, record_id));
+    }
+    pending_postings_ += terms.size();
+    indexed_count_ = record_id + 1;
+
+    if (pending_postings_ >= MAX_PENDING_POSTINGS) {
+        return Flush();
+    }
+    return true;
+}
+
+bool KeywordIndex::Flush() {
+    if (indexed_count_ == stored_count_) {
+        return true;
+    }
+
+    // Each bucket file is opened once per flush
+    bool ok = true;
+    for (int bucket = 0; bucket < BUCKET_COUNT && ok; bucket++) {
+        const auto& postings = pending_[bucket];
+        if (postings.empty()) {
+            continue;
+        }
+        char path[48];
+        BucketPath(bucket, path, sizeof(path));
+        FILE* f = fopen(path, "ab");
+        if (!f) {
+            ESP_LOGE(TAG, "Failed to open %s", path);
+            ok = false;
+            break;
+        }
+        ok = fwrite(postings.data(), sizeof(uint32_t), postings.size(), f) == postings.size();
+        if (fclose(f) != 0) {
+            ok = false;
+        }
+        if (!ok) {
+            ESP_LOGE(TAG, "Failed to write %s", path);
+        }
+    }
+    if (ok && !SaveMeta()) {
+        ESP_LOGE(TAG, "Failed to save index meta");
+        ok = false;
+    }
+
+    if (ok) {
+        stored_count_ = indexed_count_;
+    } else {
+        // Postings already appended for these records are harmless: Lookup()
+        // drops duplicate ids when they are indexed again
+        indexed_count_ = stored_count_;
+    }
+    for (auto& postings : pending_) {
+        postings.clear();
+        postings.shrink_to_fit();
+    }
+    pending_postings_ = 0;
+    return ok;
+}
+
+bool KeywordIndex::Lookup(const char* query, std::vector<uint32_t>& candidates) {
+    candidates.clear();
+
+    std::vector<uint32_t> terms;
+    Tokenize(query, terms);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty()) {
+        return false;
+    }
+
+    std::unique_ptr<uint32_t[]> chunk(new uint32_t[READ_CHUNK]);
+    std::vector<uint32_t> ids;
+    bool first = true;
+
+    for (uint32_t term : terms) {
+        char path[48];
+        BucketPath(TermBucket(term), path, sizeof(path));
+
+        ids.clear();
+        for (uint32_t posting : pending_[TermBucket(term)]) {
+            if (PostingMatches(posting, term)) {
+                ids.push_back(posting & MAX_RECORD_ID);
+            }
+        }
+        FILE* f = fopen(path, "rb");
+        if (f) {
+            size_t n;
+            while ((n = fread(chunk.get(), sizeof(uint32_t), READ_CHUNK, f)) > 0) {
+                for (size_t k = 0; k < n; k++) {
+                    if (PostingMatches(chunk[k], term)) {
+                        ids.push_back(chunk[k] & MAX_RECORD_ID);
+                    }
+                }
+            }
+            fclose(f);
+        }
+        // Postings are appended in record order; sort anyway in case a record
+        // was re-indexed after an interrupted Add()
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        if (first) {
+            candidates.swap(ids);
+            first = false;
+        } else {
+            std::vector<uint32_t> merged;
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  ids.begin(), ids.end(), std::back_inserter(merged));
+            candidates.swap(merged);
+        }
+        if (candidates.empty()) {
+            break;
+        }
+    }
+    return true;
+}
+
+void KeywordIndex::Clear() {
+    char path[48];
+    for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        BucketPath(bucket, path, sizeof(path));
+        remove(path);
+        pending_[bucket].clear();
+    }
+    pending_postings_ = 0;
+    indexed_count_ = 0;
+    stored_count_ = 0;
+    SaveMeta();
+}
@@ -0,0 +1,70 @@
+#ifndef KEYWORD_INDEX_H
+#define KEYWORD_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * On-flash inverted keyword index for one archive stream
+ *
+ * Terms are UTF-8 CJK bigrams and lowercase ASCII words (whole words only). Each term hashes to one of BUCKET_COUNT posting
+ * files; a posting is a packed uint32 (12-bit term sub-hash | 20-bit record id),
+ * so a lookup reads only the buckets of the query terms. Hash collisions and
+ * non-adjacent bigrams are filtered by the caller re-checking the record text.
+ *
+ * Postings of new records are buffered in RAM and appended to the bucket files
+ * together by Flush() (the archive calls it when a segment is sealed), so a
+ * record does not cost a write to every bucket it touches plus the meta file.
+ * The stored count only covers flushed records; records buffered at a reset
+ * are indexed again by the caller, see GetIndexedCount().
+ */
+class KeywordIndex {
+public:
+    static constexpr int BUCKET_COUNT = 32;
+    static constexpr uint32_t MAX_RECORD_ID = 0xFFFFF;
+    static constexpr size_t MAX_PENDING_POSTINGS = 512;     // 2KB buffered before an early Flush()
+
+    // base_path: directory, name: stream name ("fact", "moment", "event")
+    void Init(const char* base_path, const char* name);
+
+    // Number of records (from id 0) already in the index, buffered ones included
+    uint32_t GetIndexedCount() const { return indexed_count_; }
+
+    // Index a record; record_id must equal GetIndexedCount(). Returns false if
+    // the buffer was full and flushing it failed
+    bool Add(uint32_t record_id, const char* const* fields, int field_count);
+
+    // Append the buffered postings to the bucket files and store the indexed
+    // count. On failure the buffered records are dropped and GetIndexedCount()
+    // goes back to the stored count, so the caller indexes them again
+    bool Flush();
+
+    // Candidate record ids containing every query term, ascending.
+    // Returns false if the query has no indexable term, e.g. a single CJK
+    // character (caller should fall back to a scan).
+    bool Lookup(const char* query, std::vector<uint32_t>& candidates);
+
+    // Remove all posting files and reset the indexed count
+    void Clear();
+
+    // Append the term hashes of text (duplicates included) to terms
+    static void Tokenize(const char* text, std::vector<uint32_t>& terms);
+
+    // True if text has an ASCII word. Words are indexed whole, so a query with
+    // one may be part of a longer word ("ca" in "cat") and needs a scan
+    static bool HasWord(const char* text);
+
+private:
+    void BucketPath(int bucket, char* path, size_t size);
+    void MetaPath(char* path, size_t size);
+    bool SaveMeta();
+
+    char prefix_[40] = {0};
+    uint32_t indexed_count_ = 0;
+    uint32_t stored_count_ = 0;         // Records whose postings are in the bucket files
+    std::vector<uint32_t> pending_[BUCKET_COUNT];
+    size_t pending_postings_ = 0;
+};
+
+#endif // KEYWORD_INDEX_H
@@ -6,6 +6,9 @@
 #include <time.h>
 #include <errno.h>
 #include <cJSON.h>
+#include <memory>
+#include <functional>
+#include <algorithm>
 
 #define TAG "MemArchive"
 
@@ -15,8 +18,21 @@ MemoryArchive& MemoryArchive::GetInstance() {
 }
 
 MemoryArchive::~MemoryArchive() {
+    Deinit();
+}
+
+void MemoryArchive::Deinit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (initialized_) {
+        for (auto& stream : streams_) {
+            stream.keywords.Flush();
+        }
+        initialized_ = false;
+    }
     if (spiffs_mounted_) {
         esp_vfs_spiffs_unregister("memory");
+        spiffs_mounted_ = false;
         ESP_LOGI(TAG, "Memory SPIFFS unmounted");
     }
 }
@@ -69,58 +85,121 @@ bool MemoryArchive::Init() {
     ESP_LOGI(TAG, "SPIFFS is ready (flat filesystem, no directories needed)");
 
     initialized_ = true;
+
+    // Load segment and keyword indexes, then migrate any pre-segment JSONL archives
+    for (auto& stream : streams_) {
+        LoadIndex(stream);
+        stream.keywords.Init(ARCHIVE_BASE_PATH, stream.name);
+        SyncKeywordIndex(stream);
+        MigrateLegacyJsonl(stream);
+    }
+
     ESP_LOGI(TAG, "Memory archive initialized successfully");
     return true;
 }
 
 bool MemoryArchive::CreateDirectoryIfNotExists() {
     // SPIFFS is a flat filesystem - directories are not needed
-    // Files with "/" in the name (e.g., "/spiffs/memory/facts_archive.jsonl")
+    // Files with "/" in the name (e.g., "/spiffs/memory/fact_0001.seg")
     // will work directly without creating intermediate directories
     return true;
 }
 
-bool MemoryArchive::AppendToFile(const char* filename, const char* json_line) {
-    if (!initialized_) {
-        ESP_LOGW(TAG, "Archive not initialized");
-        return false;
-    }
+// ========== Record helpers ==========
 
-    FILE* f = fopen(filename, "a");
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open file for append: %s (errno: %d)", filename, errno);
-        return false;
-    }
+uint32_t MemoryArchive::DateKeyFromTime(time_t t) {
+    struct tm tm_info;
+    localtime_r(&t, &tm_info);
+    return (uint32_t)((tm_info.tm_year + 1900) * 10000 + (tm_info.tm_mon + 1) * 100 + tm_info.tm_mday);
+}
 
-    int written = fprintf(f, "%s\n", json_line);
-    if (written < 0) {
-        ESP_LOGE(TAG, "Failed to write to file: %s (errno: %d)", filename, errno);
-        fclose(f);
-        return false;
+uint32_t MemoryArchive::DateKeyFromString(const char* date) {
+    // Accepts YYYY-MM-DD (optionally followed by THH:MM:SS)
+    if (!date || strlen(date) < 10) {
+        return 0;
     }
-
-    if (fclose(f) != 0) {
-        ESP_LOGE(TAG, "Failed to close file: %s (errno: %d)", filename, errno);
-        return false;
+    int year = 0, month = 0, day = 0;
+    if (sscanf(date, "%4d-%2d-%2d", &year, &month, &day) != 3) {
+        return 0;
     }
+    return (uint32_t)(year * 10000 + month * 100 + day);
+}
 
-    return true;
+ArchiveRecord MemoryArchive::MakeFactRecord(const Fact& fact) {
+    ArchiveRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = time(nullptr);
+    record.date_key = DateKeyFromTime(record.timestamp);
+    record.kind = (uint8_t)ArchiveKind::FACT;
+    strncpy(record.content, fact.content, sizeof(record.content) - 1);
+    return record;
+}
+
+ArchiveRecord MemoryArchive::MakeMomentRecord(const SpecialMoment& moment) {
+    ArchiveRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = time(nullptr);
+    record.date_key = DateKeyFromTime(record.timestamp);
+    record.kind = (uint8_t)ArchiveKind::MOMENT;
+    record.emotion_type = moment.emotion.type;
+    record.emotion_intensity = moment.emotion.intensity;
+    record.importance = moment.importance;
+    strncpy(record.label, moment.topic, sizeof(record.label) - 1);
+    strncpy(record.content, moment.content, sizeof(record.content) - 1);
+    return record;
+}
+
+ArchiveRecord MemoryArchive::MakeEventRecord(const Event& event) {
+    ArchiveRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = time(nullptr);
+    record.date_key = DateKeyFromTime(record.timestamp);
+    record.kind = (uint8_t)ArchiveKind::EVENT;
+    record.emotion_type = event.emotion.type;
+    record.emotion_intensity = event.emotion.intensity;
+    record.importance = event.significance;
+    strncpy(record.label, event.event_type, sizeof(record.label) - 1);
+    strncpy(record.date, event.date, sizeof(record.date) - 1);
+    strncpy(record.content, event.content, sizeof(record.content) - 1);
+    return record;
 }
 
-std::string MemoryArchive::SerializeFact(const Fact& fact) {
+std::string MemoryArchive::SerializeRecord(const ArchiveRecord& record) {
+    // Same JSON shape as the original JSONL archive lines
     cJSON* root = cJSON_CreateObject();
 
-    // Add timestamp
     char timestamp[20];
-    time_t now = time(nullptr);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    time_t ts = record.timestamp;
+    struct tm tm_info;
+    localtime_r(&ts, &tm_info);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &tm_info);
     cJSON_AddStringToObject(root, "timestamp", timestamp);
 
-    cJSON_AddStringToObject(root, "type", "fact");
-    cJSON_AddStringToObject(root, "content", fact.content);
+    switch ((ArchiveKind)record.kind) {
+        case ArchiveKind::FACT:
+            cJSON_AddStringToObject(root, "type", "fact");
+            cJSON_AddStringToObject(root, "content", record.content);
+            break;
+        case ArchiveKind::MOMENT:
+            cJSON_AddStringToObject(root, "type", "moment");
+            cJSON_AddStringToObject(root, "topic", record.label);
+            cJSON_AddStringToObject(root, "content", record.content);
+            cJSON_AddNumberToObject(root, "emotion_type", record.emotion_type);
+            cJSON_AddNumberToObject(root, "emotion_intensity", record.emotion_intensity);
+            cJSON_AddNumberToObject(root, "importance", record.importance);
+            break;
+        case ArchiveKind::EVENT:
+        default:
+            cJSON_AddStringToObject(root, "type", "event");
+            cJSON_AddStringToObject(root, "date", record.date);
+            cJSON_AddStringToObject(root, "event_type", record.label);
+            cJSON_AddStringToObject(root, "content", record.content);
+            cJSON_AddNumberToObject(root, "significance", record.importance);
+            break;
+    }
 
     char* json_str = cJSON_PrintUnformatted(root);
-    std::string result(json_str);
+    std::string result(json_str ? json_str : "{}");
 
     cJSON_free(json_str);
     cJSON_Delete(root);
@@ -128,73 +207,398 @@ std::string MemoryArchive::SerializeFact(const Fact& fact) {
     return result;
 }
 
-std::string MemoryArchive::SerializeMoment(const SpecialMoment& moment) {
-    cJSON* root = cJSON_CreateObject();
+void MemoryArchive::RecordToItem(const ArchiveRecord& record, ArchivedItem& item) {
+    memset(&item, 0, sizeof(item));
 
-    // Add timestamp
-    char timestamp[20];
-    time_t now = time(nullptr);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
-    cJSON_AddStringToObject(root, "timestamp", timestamp);
+    time_t ts = record.timestamp;
+    struct tm tm_info;
+    localtime_r(&ts, &tm_info);
+    strftime(item.timestamp, sizeof(item.timestamp), "%Y-%m-%dT%H:%M:%S", &tm_info);
 
-    cJSON_AddStringToObject(root, "type", "moment");
-    cJSON_AddStringToObject(root, "topic", moment.topic);
-    cJSON_AddStringToObject(root, "content", moment.content);
-    cJSON_AddNumberToObject(root, "emotion_type", moment.emotion.type);
-    cJSON_AddNumberToObject(root, "emotion_intensity", moment.emotion.intensity);
-    cJSON_AddNumberToObject(root, "importance", moment.importance);
+    int kind = record.kind < (uint8_t)ArchiveKind::COUNT ? record.kind : (int)ArchiveKind::EVENT;
+    strncpy(item.type, streams_[kind].name, sizeof(item.type) - 1);
 
-    char* json_str = cJSON_PrintUnformatted(root);
-    std::string result(json_str);
+    std::string json = SerializeRecord(record);
+    strncpy(item.content, json.c_str(), sizeof(item.content) - 1);
+}
 
-    cJSON_free(json_str);
-    cJSON_Delete(root);
+// ========== Segment / index management ==========
 
-    return result;
+MemoryArchive::ArchiveStream* MemoryArchive::GetStream(const char* type) {
+    if (!type) {
+        return nullptr;
+    }
+    for (auto& stream : streams_) {
+        if (strcmp(stream.name, type) == 0) {
+            return &stream;
+        }
+    }
+    return nullptr;
 }
 
-std::string MemoryArchive::SerializeEvent(const Event& event) {
-    cJSON* root = cJSON_CreateObject();
+void MemoryArchive::SegmentPath(const ArchiveStream& stream, uint16_t segment, char* path, size_t size) {
+    snprintf(path, size, "%s/%s_%04u.seg", ARCHIVE_BASE_PATH, stream.name, (unsigned)segment);
+}
 
-    // Add timestamp
-    char timestamp[20];
-    time_t now = time(nullptr);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
-    cJSON_AddStringToObject(root, "timestamp", timestamp);
+void MemoryArchive::IndexPath(const ArchiveStream& stream, char* path, size_t size) {
+    snprintf(path, size, "%s/%s.idx", ARCHIVE_BASE_PATH, stream.name);
+}
 
-    cJSON_AddStringToObject(root, "type", "event");
-    cJSON_AddStringToObject(root, "date", event.date);
-    cJSON_AddStringToObject(root, "event_type", event.event_type);
-    cJSON_AddStringToObject(root, "content", event.content);
-    cJSON_AddNumberToObject(root, "significance", event.significance);
+bool MemoryArchive::LoadIndex(ArchiveStream& stream) {
+    stream.segments.clear();
+
+    char path[48];
+    IndexPath(stream, path, sizeof(path));
+
+    FILE* f = fopen(path, "rb");
+    if (f) {
+        ArchiveIndexHeader header;
+        if (fread(&header, sizeof(header), 1, f) == 1 &&
+            memcmp(header.magic, ARCHIVE_MAGIC_INDEX, 4) == 0 &&
+            header.version == ARCHIVE_FORMAT_VERSION) {
+            stream.segments.resize(header.entry_count);
+            if (header.entry_count > 0 &&
+                fread(stream.segments.data(), sizeof(ArchiveIndexEntry), header.entry_count, f) != header.entry_count) {
+                ESP_LOGW(TAG, "Index %s truncated, rebuilding", path);
+                stream.segments.clear();
+            }
+        } else {
+            ESP_LOGW(TAG, "Index %s invalid, rebuilding", path);
+        }
+        fclose(f);
+    }
 
-    char* json_str = cJSON_PrintUnformatted(root);
-    std::string result(json_str);
+    // The index only lists sealed segments; probe for segments written after
+    // the last index save (the active segment, or one sealed right before a reset)
+    size_t indexed = stream.segments.size();
+    uint16_t next = stream.segments.empty() ? 1 : stream.segments.back().segment + 1;
+    ArchiveIndexEntry entry;
+    while (ScanSegment(stream, next, entry)) {
+        stream.segments.push_back(entry);
+        if (entry.count < ARCHIVE_RECORDS_PER_SEGMENT) {
+            break;
+        }
+        next++;
+    }
 
-    cJSON_free(json_str);
-    cJSON_Delete(root);
+    // Persist segments sealed since the last index save
+    size_t sealed = stream.segments.size();
+    if (sealed > 0 && stream.segments.back().count < ARCHIVE_RECORDS_PER_SEGMENT) {
+        sealed--;
+    }
+    if (sealed > indexed) {
+        SaveIndex(stream);
+    }
 
-    return result;
+    size_t total = 0;
+    for (const auto& seg : stream.segments) {
+        total += seg.count;
+    }
+    ESP_LOGI(TAG, "Archive '%s': %d segments, %d records",
+             stream.name, (int)stream.segments.size(), (int)total);
+    return true;
+}
+
+bool MemoryArchive::SaveIndex(const ArchiveStream& stream) {
+    char path[48];
+    IndexPath(stream, path, sizeof(path));
+
+    // Only sealed segments go into the index
+    uint16_t sealed = 0;
+    for (const auto& seg : stream.segments) {
+        if (seg.count >= ARCHIVE_RECORDS_PER_SEGMENT) {
+            sealed++;
+        }
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "Failed to open index for write: %s (errno: %d)", path, errno);
+        return false;
+    }
+
+    ArchiveIndexHeader header;
+    memcpy(header.magic, ARCHIVE_MAGIC_INDEX, 4);
+    header.version = ARCHIVE_FORMAT_VERSION;
+    header.entry_count = sealed;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if (ok && sealed > 0) {
+        ok = fwrite(stream.segments.data(), sizeof(ArchiveIndexEntry), sealed, f) == sealed;
+    }
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write index: %s (errno: %d)", path, errno);
+    }
+    return ok;
+}
+
+bool MemoryArchive::ScanSegment(const ArchiveStream& stream, uint16_t segment, ArchiveIndexEntry& entry) {
+    char path[48];
+    SegmentPath(stream, segment, path, sizeof(path));
+
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.segment = segment;
+
+    size_t size = st.st_size;
+    size_t record_bytes = ARCHIVE_RECORDS_PER_SEGMENT * sizeof(ArchiveRecord);
+
+    // Sealed segment: trust the footer
+    if (size == record_bytes + sizeof(ArchiveSegmentFooter)) {
+        ArchiveSegmentFooter footer;
+        if (fseek(f, record_bytes, SEEK_SET) == 0 &&
+            fread(&footer, sizeof(footer), 1, f) == 1 &&
+            memcmp(footer.magic, ARCHIVE_MAGIC_SEGMENT, 4) == 0 &&
+            footer.count == ARCHIVE_RECORDS_PER_SEGMENT) {
+            entry.count = footer.count;
+            entry.first_date = footer.first_date;
+            entry.last_date = footer.last_date;
+            entry.first_ts = footer.first_ts;
+            entry.last_ts = footer.last_ts;
+            fclose(f);
+            return true;
+        }
+    }
+
+    // Active segment: count whole records (a torn trailing write is ignored
+    // and overwritten by the next append)
+    size_t count = std::min(size, record_bytes) / sizeof(ArchiveRecord);
+    entry.count = count;
+    if (count > 0) {
+        ArchiveRecord first, last;
+        if (ReadRecords(f, 0, 1, &first) && ReadRecords(f, count - 1, 1, &last)) {
+            entry.first_date = first.date_key;
+            entry.first_ts = first.timestamp;
+            entry.last_date = last.date_key;
+            entry.last_ts = last.timestamp;
+        }
+    }
+
+    fclose(f);
+    return true;
+}
+
+bool MemoryArchive::AppendRecord(ArchiveStream& stream, const ArchiveRecord& record) {
+    // Open a new segment when there is none or the last one is sealed
+    if (stream.segments.empty() || stream.segments.back().count >= ARCHIVE_RECORDS_PER_SEGMENT) {
+        ArchiveIndexEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.segment = stream.segments.empty() ? 1 : stream.segments.back().segment + 1;
+        stream.segments.push_back(entry);
+    }
+
+    ArchiveIndexEntry& active = stream.segments.back();
+    char path[48];
+    SegmentPath(stream, active.segment, path, sizeof(path));
+
+    // Write at the record slot explicitly so a torn previous write is overwritten
+    FILE* f = fopen(path, active.count == 0 ? "wb" : "r+b");
+    if (!f) {
+        ESP_LOGE(TAG, "Failed to open segment: %s (errno: %d)", path, errno);
+        return false;
+    }
+
+    bool ok = fseek(f, (long)active.count * sizeof(ArchiveRecord), SEEK_SET) == 0 &&
+              fwrite(&record, sizeof(record), 1, f) == 1;
+
+    if (ok) {
+        if (active.count == 0) {
+            active.first_date = record.date_key;
+            active.first_ts = record.timestamp;
+        }
+        active.last_date = record.date_key;
+        active.last_ts = record.timestamp;
+        active.count++;
+
+        if (active.count >= ARCHIVE_RECORDS_PER_SEGMENT) {
+            ArchiveSegmentFooter footer;
+            memcpy(footer.magic, ARCHIVE_MAGIC_SEGMENT, 4);
+            footer.version = ARCHIVE_FORMAT_VERSION;
+            footer.count = active.count;
+            footer.first_date = active.first_date;
+            footer.last_date = active.last_date;
+            footer.first_ts = active.first_ts;
+            footer.last_ts = active.last_ts;
+            ok = fwrite(&footer, sizeof(footer), 1, f) == 1;
+        }
+    }
+
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write segment: %s (errno: %d)", path, errno);
+        return false;
+    }
+
+    bool sealed = active.count >= ARCHIVE_RECORDS_PER_SEGMENT;
+    if (sealed) {
+        ESP_LOGI(TAG, "Sealed segment %s (%u records)", path, (unsigned)active.count);
+        SaveIndex(stream);
+    }
+
+    // After a failed index write the keyword index is behind: catch up from the segments
+    uint32_t total = GetRecordCount(stream);
+    if (stream.keywords.GetIndexedCount() + 1 == total) {
+        IndexRecord(stream, total - 1, record);
+    } else {
+        SyncKeywordIndex(stream);
+    }
+    if (sealed) {
+        // Postings are buffered until the segment is sealed
+        stream.keywords.Flush();
+    }
+    return true;
+}
+
+uint32_t MemoryArchive::GetRecordCount(const ArchiveStream& stream) {
+    // Every segment but the last is full, so record ids map directly to
+    // (segment = id / ARCHIVE_RECORDS_PER_SEGMENT, slot = id % ARCHIVE_RECORDS_PER_SEGMENT)
+    if (stream.segments.empty()) {
+        return 0;
+    }
+    return (stream.segments.size() - 1) * ARCHIVE_RECORDS_PER_SEGMENT + stream.segments.back().count;
 }
 
+bool MemoryArchive::IndexRecord(ArchiveStream& stream, uint32_t record_id, const ArchiveRecord& record) {
+    char label[sizeof(record.label) + 1] = {0};
+    char content[sizeof(record.content) + 1] = {0};
+    memcpy(label, record.label, sizeof(record.label));
+    memcpy(content, record.content, sizeof(record.content));
+    const char* fields[] = {label, content};
+
+    if (!stream.keywords.Add(record_id, fields, 2)) {
+        ESP_LOGW(TAG, "Failed to index %s record %u", stream.name, (unsigned)record_id);
+        return false;
+    }
+    return true;
+}
+
+void MemoryArchive::SyncKeywordIndex(ArchiveStream& stream) {
+    uint32_t total = GetRecordCount(stream);
+    uint32_t indexed = stream.keywords.GetIndexedCount();
+
+    if (indexed > total) {
+        ESP_LOGW(TAG, "Keyword index for '%s' ahead of archive (%u > %u), rebuilding",
+                 stream.name, (unsigned)indexed, (unsigned)total);
+        stream.keywords.Clear();
+        indexed = 0;
+    }
+    if (indexed == total) {
+        return;
+    }
+
+    // Catch up on records archived before the index existed (or lost on reset)
+    ESP_LOGI(TAG, "Indexing %u %s records", (unsigned)(total - indexed), stream.name);
+    std::unique_ptr<ArchiveRecord[]> batch(new ArchiveRecord[RECALL_BATCH]);
+    while (indexed < total) {
+        const auto& seg = stream.segments[indexed / ARCHIVE_RECORDS_PER_SEGMENT];
+        int pos = indexed % ARCHIVE_RECORDS_PER_SEGMENT;
+
+        char path[48];
+        SegmentPath(stream, seg.segment, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            ESP_LOGW(TAG, "Missing segment: %s", path);
+            return;
+        }
+        while (pos < seg.count) {
+            int n = std::min(RECALL_BATCH, seg.count - pos);
+            if (!ReadRecords(f, pos, n, batch.get())) {
+                fclose(f);
+                return;
+            }
+            for (int i = 0; i < n; i++) {
+                if (!IndexRecord(stream, indexed, batch[i])) {
+                    fclose(f);
+                    return;
+                }
+                indexed++;
+            }
+            pos += n;
+        }
+        fclose(f);
+    }
+    stream.keywords.Flush();
+}
+
+bool MemoryArchive::ReadRecords(FILE* f, int first, int count, ArchiveRecord* records) {
+    if (fseek(f, (long)first * sizeof(ArchiveRecord), SEEK_SET) != 0) {
+        return false;
+    }
+    return fread(records, sizeof(ArchiveRecord), count, f) == (size_t)count;
+}
+
+bool MemoryArchive::ReadRecordAt(const ArchiveStream& stream, uint32_t record_id, ArchiveRecord& record) {
+    if (record_id >= GetRecordCount(stream)) {
+        return false;
+    }
+    char path[48];
+    SegmentPath(stream, stream.segments[record_id / ARCHIVE_RECORDS_PER_SEGMENT].segment, path, sizeof(path));
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    bool ok = ReadRecords(f, record_id % ARCHIVE_RECORDS_PER_SEGMENT, 1, &record);
+    fclose(f);
+    return ok;
+}
+
+int MemoryArchive::LowerBoundDate(FILE* f, int count, uint32_t date_key) {
+    // Records are appended in time order, so binary search on date_key
+    int lo = 0, hi = count;
+    ArchiveRecord record;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (!ReadRecords(f, mid, 1, &record)) {
+            return lo;
+        }
+        if (record.date_key < date_key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// ========== Archive operations ==========
+
 bool MemoryArchive::ArchiveFacts(const std::vector<Fact>& facts) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (facts.empty()) {
         return true;
     }
+    if (!initialized_) {
+        ESP_LOGW(TAG, "Archive not initialized");
+        return false;
+    }
 
+    ArchiveStream& stream = streams_[(int)ArchiveKind::FACT];
     int archived_count = 0;
     for (const auto& fact : facts) {
-        std::string json_line = SerializeFact(fact);
-        if (AppendToFile(FACTS_ARCHIVE, json_line.c_str())) {
+        if (AppendRecord(stream, MakeFactRecord(fact))) {
             archived_count++;
         } else {
             ESP_LOGW(TAG, "Failed to archive fact: %s", fact.content);
         }
     }
 
-    ESP_LOGI(TAG, "Archived %d facts to %s", archived_count, FACTS_ARCHIVE);
+    ESP_LOGI(TAG, "Archived %d facts", archived_count);
     return archived_count > 0;
 }
 
@@ -204,18 +608,22 @@ bool MemoryArchive::ArchiveMoments(const std::vector<SpecialMoment>& moments) {
     if (moments.empty()) {
         return true;
     }
+    if (!initialized_) {
+        ESP_LOGW(TAG, "Archive not initialized");
+        return false;
+    }
 
+    ArchiveStream& stream = streams_[(int)ArchiveKind::MOMENT];
     int archived_count = 0;
     for (const auto& moment : moments) {
-        std::string json_line = SerializeMoment(moment);
-        if (AppendToFile(MOMENTS_ARCHIVE, json_line.c_str())) {
+        if (AppendRecord(stream, MakeMomentRecord(moment))) {
             archived_count++;
         } else {
             ESP_LOGW(TAG, "Failed to archive moment: %s - %s", moment.topic, moment.content);
         }
     }
 
-    ESP_LOGI(TAG, "Archived %d moments to %s", archived_count, MOMENTS_ARCHIVE);
+    ESP_LOGI(TAG, "Archived %d moments", archived_count);
     return archived_count > 0;
 }
 
@@ -225,18 +633,22 @@ bool MemoryArchive::ArchiveEvents(const std::vector<Event>& events) {
     if (events.empty()) {
         return true;
     }
+    if (!initialized_) {
+        ESP_LOGW(TAG, "Archive not initialized");
+        return false;
+    }
 
+    ArchiveStream& stream = streams_[(int)ArchiveKind::EVENT];
     int archived_count = 0;
     for (const auto& event : events) {
-        std::string json_line = SerializeEvent(event);
-        if (AppendToFile(EVENTS_ARCHIVE, json_line.c_str())) {
+        if (AppendRecord(stream, MakeEventRecord(event))) {
             archived_count++;
         } else {
             ESP_LOGW(TAG, "Failed to archive event: %s - %s", event.date, event.content);
         }
     }
 
-    ESP_LOGI(TAG, "Archived %d events to %s", archived_count, EVENTS_ARCHIVE);
+    ESP_LOGI(TAG, "Archived %d events", archived_count);
     return archived_count > 0;
 }
 
@@ -247,119 +659,54 @@ size_t MemoryArchive::GetArchiveCount(const char* type) {
         return 0;
     }
 
-    const char* filename = GetArchiveFilename(type);
-    if (!filename) {
-        return 0;
-    }
-
-    FILE* f = fopen(filename, "r");
-    if (!f) {
+    ArchiveStream* stream = GetStream(type);
+    if (!stream) {
         return 0;
     }
 
     size_t count = 0;
-    char line[1024];  // Increased buffer size
-    while (fgets(line, sizeof(line), f) != nullptr) {
-        // Only count complete lines (ending with newline)
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            count++;
-        } else if (len >= sizeof(line) - 1) {
-            // Line truncated, skip to end
-            int ch;
-            while ((ch = fgetc(f)) != '\n' && ch != EOF);
-            count++;  // Still count it as a line
-        }
+    for (const auto& seg : stream->segments) {
+        count += seg.count;
     }
-
-    fclose(f);
     return count;
 }
 
 // ========== Stage 2: Recall/Search Implementation ==========
 
-const char* MemoryArchive::GetArchiveFilename(const char* type) {
-    if (strcmp(type, "fact") == 0) {
-        return FACTS_ARCHIVE;
-    } else if (strcmp(type, "moment") == 0) {
-        return MOMENTS_ARCHIVE;
-    } else if (strcmp(type, "event") == 0) {
-        return EVENTS_ARCHIVE;
-    }
-    return nullptr;
-}
-
-bool MemoryArchive::ParseArchivedItem(const char* json_line, ArchivedItem& item) {
-    // Initialize item to avoid garbage data
-    memset(&item, 0, sizeof(item));
-
-    cJSON* root = cJSON_Parse(json_line);
-    if (!root) {
-        ESP_LOGW(TAG, "Failed to parse JSON line: %.50s...", json_line);
-        return false;
-    }
-
-    // Extract timestamp
-    cJSON* timestamp = cJSON_GetObjectItem(root, "timestamp");
-    if (timestamp && cJSON_IsString(timestamp)) {
-        strncpy(item.timestamp, timestamp->valuestring, sizeof(item.timestamp) - 1);
-    }
-
-    // Extract type
-    cJSON* type = cJSON_GetObjectItem(root, "type");
-    if (type && cJSON_IsString(type)) {
-        strncpy(item.type, type->valuestring, sizeof(item.type) - 1);
-    }
-
-    // Store the entire JSON as content (for flexible parsing later)
-    strncpy(item.content, json_line, sizeof(item.content) - 1);
-
-    cJSON_Delete(root);
-    return true;
-}
-
-bool MemoryArchive::MatchesTimeRange(const char* timestamp, const char* start_date, const char* end_date) {
-    // timestamp format: YYYY-MM-DDTHH:MM:SS
-    // date format: YYYY-MM-DD
-    // Simple string comparison works due to ISO 8601 format
-
-    if (start_date && strlen(start_date) > 0) {
-        if (strncmp(timestamp, start_date, 10) < 0) {
-            return false;
-        }
-    }
-
-    if (end_date && strlen(end_date) > 0) {
-        if (strncmp(timestamp, end_date, 10) > 0) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-bool MemoryArchive::ContainsKeyword(const char* content, const char* keyword) {
-    if (!keyword || strlen(keyword) == 0) {
-        return true;  // Empty keyword matches everything
+int MemoryArchive::CountKeyword(const ArchiveRecord& record, const char* keyword_lower) {
+    if (!keyword_lower || keyword_lower[0] == '\0') {
+        return 1;  // Empty keyword matches everything
     }
 
-    // Case-insensitive search
-    std::string content_lower(content);
-    std::string keyword_lower(keyword);
-
-    // Convert to lowercase
-    for (char& c : content_lower) {
-        if (c >= 'A' && c <= 'Z') {
-            c = c + ('a' - 'A');
-        }
-    }
-    for (char& c : keyword_lower) {
-        if (c >= 'A' && c <= 'Z') {
-            c = c + ('a' - 'A');
+    // Case-insensitive (ASCII) occurrence count without allocating;
+    // UTF-8 multibyte sequences compare byte-for-byte
+    size_t klen = strlen(keyword_lower);
+    auto count = [keyword_lower, klen](const char* text, size_t max_len) {
+        size_t tlen = strnlen(text, max_len);
+        int hits = 0;
+        for (size_t i = 0; i + klen <= tlen; i++) {
+            size_t j = 0;
+            while (j < klen) {
+                char c = text[i + j];
+                if (c >= 'A' && c <= 'Z') {
+                    c = c + ('a' - 'A');
+                }
+                if (c != keyword_lower[j]) {
+                    break;
+                }
+                j++;
+            }
+            if (j == klen) {
+                hits++;
+                i += klen - 1;
+            }
         }
-    }
+        return hits;
+    };
 
-    return content_lower.find(keyword_lower) != std::string::npos;
+    return count(record.content, sizeof(record.content)) +
+           count(record.label, sizeof(record.label)) +
+           count(record.date, sizeof(record.date));
 }
 
 std::vector<ArchivedItem> MemoryArchive::RecallByTimeRange(
@@ -373,56 +720,71 @@ std::vector<ArchivedItem> MemoryArchive::RecallByTimeRange(
         return results;
     }
 
-    const char* filename = GetArchiveFilename(type);
-    if (!filename) {
+    ArchiveStream* stream = GetStream(type);
+    if (!stream) {
         ESP_LOGW(TAG, "Unknown type: %s", type);
         return results;
     }
 
-    FILE* f = fopen(filename, "r");
-    if (!f) {
-        ESP_LOGI(TAG, "No archive file found for type: %s", type);
-        return results;
-    }
-
     ESP_LOGI(TAG, "Recalling %s by time range: %s to %s (limit: %d)",
              type, start_date ? start_date : "any", end_date ? end_date : "any", limit);
 
-    char line[1024];  // Increased buffer size for longer JSON lines
+    uint32_t start_key = DateKeyFromString(start_date);
+    uint32_t end_key = DateKeyFromString(end_date);
+    if (end_key == 0) {
+        end_key = UINT32_MAX;
+    }
+
+    std::unique_ptr<ArchiveRecord[]> batch(new ArchiveRecord[RECALL_BATCH]);
     int matched = 0;
-    int total_lines = 0;
-    int truncated_lines = 0;
+    int segments_opened = 0;
+    int records_read = 0;
+    bool done = false;
 
-    while (fgets(line, sizeof(line), f) != nullptr && matched < limit) {
-        total_lines++;
+    for (const auto& seg : stream->segments) {
+        if (done || matched >= limit) {
+            break;
+        }
+        if (seg.count == 0 || seg.last_date < start_key) {
+            continue;
+        }
+        if (seg.first_date > end_key) {
+            break;  // Segments are in time order
+        }
 
-        // Check for truncated line (no newline at end and buffer is full)
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            line[len - 1] = '\0';
-            len--;
-        } else if (len >= sizeof(line) - 1) {
-            // Line was truncated, skip to end of this line
-            ESP_LOGW(TAG, "Line %d truncated (>%d bytes), skipping", total_lines, (int)sizeof(line));
-            truncated_lines++;
-            int ch;
-            while ((ch = fgetc(f)) != '\n' && ch != EOF);
+        char path[48];
+        SegmentPath(*stream, seg.segment, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            ESP_LOGW(TAG, "Missing segment: %s", path);
             continue;
         }
+        segments_opened++;
 
-        ArchivedItem item;
-        if (ParseArchivedItem(line, item)) {
-            if (MatchesTimeRange(item.timestamp, start_date, end_date)) {
+        int pos = seg.first_date >= start_key ? 0 : LowerBoundDate(f, seg.count, start_key);
+        while (pos < seg.count && matched < limit && !done) {
+            int n = std::min(RECALL_BATCH, seg.count - pos);
+            if (!ReadRecords(f, pos, n, batch.get())) {
+                break;
+            }
+            records_read += n;
+            for (int i = 0; i < n && matched < limit; i++) {
+                if (batch[i].date_key > end_key) {
+                    done = true;
+                    break;
+                }
+                ArchivedItem item;
+                RecordToItem(batch[i], item);
                 results.push_back(item);
                 matched++;
             }
+            pos += n;
         }
+        fclose(f);
     }
 
-    fclose(f);
-
-    ESP_LOGI(TAG, "Recalled %d/%d items (scanned %d lines, %d truncated)",
-             matched, limit, total_lines, truncated_lines);
+    ESP_LOGI(TAG, "Recalled %d/%d items (opened %d segments, read %d records)",
+             matched, limit, segments_opened, records_read);
 
     return results;
 }
@@ -438,56 +800,134 @@ std::vector<ArchivedItem> MemoryArchive::RecallByKeyword(
         return results;
     }
 
-    const char* filename = GetArchiveFilename(type);
-    if (!filename) {
+    ArchiveStream* stream = GetStream(type);
+    if (!stream) {
         ESP_LOGW(TAG, "Unknown type: %s", type);
         return results;
     }
 
-    FILE* f = fopen(filename, "r");
-    if (!f) {
-        ESP_LOGI(TAG, "No archive file found for type: %s", type);
+    ESP_LOGI(TAG, "Recalling %s by keyword: '%s' (limit: %d)", type, keyword, limit);
+
+    std::string keyword_lower(keyword ? keyword : "");
+    for (char& c : keyword_lower) {
+        if (c >= 'A' && c <= 'Z') {
+            c = c + ('a' - 'A');
+        }
+    }
+
+    // ASCII words are indexed whole, but the match is a substring one: "ca" has
+    // to find "cat" and "cake" even when some record holds the word "ca" itself,
+    // so any query with an ASCII word is verified by scan
+    std::vector<uint32_t> candidates;
+    bool indexed = !KeywordIndex::HasWord(keyword_lower.c_str()) &&
+                   stream->keywords.GetIndexedCount() == GetRecordCount(*stream) &&
+                   stream->keywords.Lookup(keyword_lower.c_str(), candidates);
+    if (!indexed) {
+        // Index unavailable, query has no indexable term, or it has an ASCII word
+        ScanByKeyword(*stream, keyword_lower.c_str(), limit, results);
         return results;
     }
 
-    ESP_LOGI(TAG, "Recalling %s by keyword: '%s' (limit: %d)", type, keyword, limit);
+    // Only verify the newest candidates; older ones rarely outrank them
+    if (candidates.size() > MAX_KEYWORD_CANDIDATES) {
+        candidates.erase(candidates.begin(), candidates.end() - MAX_KEYWORD_CANDIDATES);
+    }
+
+    // Rank verified candidates by term frequency plus recency
+    struct Scored {
+        float score;
+        ArchiveRecord record;
+    };
+    std::vector<Scored> scored;
+    time_t now = time(nullptr);
+    int records_read = 0;
+
+    size_t i = 0;
+    while (i < candidates.size()) {
+        const auto& seg = stream->segments[candidates[i] / ARCHIVE_RECORDS_PER_SEGMENT];
+        char path[48];
+        SegmentPath(*stream, seg.segment, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+
+        // Candidates are ascending, so each segment is opened once
+        for (; i < candidates.size() && &stream->segments[candidates[i] / ARCHIVE_RECORDS_PER_SEGMENT] == &seg; i++) {
+            ArchiveRecord record;
+            if (!f || !ReadRecords(f, candidates[i] % ARCHIVE_RECORDS_PER_SEGMENT, 1, &record)) {
+                continue;
+            }
+            records_read++;
+            int tf = CountKeyword(record, keyword_lower.c_str());
+            if (tf == 0) {
+                continue;  // Hash collision or bigrams not adjacent
+            }
+            float age_days = now > (time_t)record.timestamp ? (now - record.timestamp) / 86400.0f : 0.0f;
+            scored.push_back({tf + 1.0f / (1.0f + age_days / 30.0f), record});
+        }
+        if (f) {
+            fclose(f);
+        }
+    }
 
-    char line[1024];  // Increased buffer size for longer JSON lines
+    std::stable_sort(scored.begin(), scored.end(), [](const Scored& a, const Scored& b) {
+        return a.score > b.score;
+    });
+
+    for (const auto& entry : scored) {
+        if ((int)results.size() >= limit) {
+            break;
+        }
+        ArchivedItem item;
+        RecordToItem(entry.record, item);
+        results.push_back(item);
+    }
+
+    ESP_LOGI(TAG, "Recalled %d/%d items (%d candidates, read %d records)",
+             (int)results.size(), limit, (int)candidates.size(), records_read);
+
+    return results;
+}
+
+void MemoryArchive::ScanByKeyword(ArchiveStream& stream, const char* keyword_lower, int limit,
+                                  std::vector<ArchivedItem>& results) {
+    std::unique_ptr<ArchiveRecord[]> batch(new ArchiveRecord[RECALL_BATCH]);
     int matched = 0;
-    int total_lines = 0;
-    int truncated_lines = 0;
+    int records_read = 0;
 
-    while (fgets(line, sizeof(line), f) != nullptr && matched < limit) {
-        total_lines++;
+    for (const auto& seg : stream.segments) {
+        if (matched >= limit) {
+            break;
+        }
+        if (seg.count == 0) {
+            continue;
+        }
 
-        // Check for truncated line
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            line[len - 1] = '\0';
-            len--;
-        } else if (len >= sizeof(line) - 1) {
-            ESP_LOGW(TAG, "Line %d truncated (>%d bytes), skipping", total_lines, (int)sizeof(line));
-            truncated_lines++;
-            int ch;
-            while ((ch = fgetc(f)) != '\n' && ch != EOF);
+        char path[48];
+        SegmentPath(stream, seg.segment, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            ESP_LOGW(TAG, "Missing segment: %s", path);
             continue;
         }
 
-        ArchivedItem item;
-        if (ParseArchivedItem(line, item)) {
-            if (ContainsKeyword(item.content, keyword)) {
-                results.push_back(item);
-                matched++;
+        for (int pos = 0; pos < seg.count && matched < limit; pos += RECALL_BATCH) {
+            int n = std::min(RECALL_BATCH, seg.count - pos);
+            if (!ReadRecords(f, pos, n, batch.get())) {
+                break;
+            }
+            records_read += n;
+            for (int i = 0; i < n && matched < limit; i++) {
+                if (CountKeyword(batch[i], keyword_lower) > 0) {
+                    ArchivedItem item;
+                    RecordToItem(batch[i], item);
+                    results.push_back(item);
+                    matched++;
+                }
             }
         }
+        fclose(f);
     }
 
-    fclose(f);
-
-    ESP_LOGI(TAG, "Recalled %d/%d items (scanned %d lines, %d truncated)",
-             matched, limit, total_lines, truncated_lines);
-
-    return results;
+    ESP_LOGI(TAG, "Recalled %d/%d items by scan (scanned %d records)", matched, limit, records_read);
 }
 
 std::vector<ArchivedItem> MemoryArchive::RecallRecent(const char* type, int limit) {
@@ -499,62 +939,274 @@ std::vector<ArchivedItem> MemoryArchive::RecallRecent(const char* type, int limi
         return results;
     }
 
-    const char* filename = GetArchiveFilename(type);
-    if (!filename) {
+    ArchiveStream* stream = GetStream(type);
+    if (!stream) {
         ESP_LOGW(TAG, "Unknown type: %s", type);
         return results;
     }
 
-    FILE* f = fopen(filename, "r");
-    if (!f) {
-        ESP_LOGI(TAG, "No archive file found for type: %s", type);
-        return results;
+    ESP_LOGI(TAG, "Recalling %d most recent %s items", limit, type);
+
+    results.reserve(limit > 0 ? limit : 0);
+    int records_read = ReadTail(*stream, limit, [this, &results](const ArchiveRecord& record) {
+        ArchivedItem item;
+        RecordToItem(record, item);
+        results.push_back(item);
+    });
+
+    // Return oldest-first, matching the append order of the archive
+    std::reverse(results.begin(), results.end());
+
+    ESP_LOGI(TAG, "Recalled %d recent items (read %d records, total archived: %d)",
+             (int)results.size(), records_read, (int)GetRecordCount(*stream));
+
+    return results;
+}
+
+int MemoryArchive::ReadTail(ArchiveStream& stream, int max_records,
+                            const std::function<void(const ArchiveRecord&)>& visit) {
+    // Seek backwards from the newest record one chunk at a time, so memory use
+    // is bounded by RECALL_BATCH records regardless of the archive size. Only
+    // complete records are visited: a torn trailing write is not counted in
+    // the active segment (see ScanSegment).
+    std::unique_ptr<ArchiveRecord[]> chunk(new ArchiveRecord[RECALL_BATCH]);
+    int visited = 0;
+
+    for (auto it = stream.segments.rbegin(); it != stream.segments.rend() && visited < max_records; ++it) {
+        const auto& seg = *it;
+        if (seg.count == 0) {
+            continue;
+        }
+
+        char path[48];
+        SegmentPath(stream, seg.segment, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            ESP_LOGW(TAG, "Missing segment: %s", path);
+            continue;
+        }
+
+        int end = seg.count;
+        while (end > 0 && visited < max_records) {
+            int n = std::min(RECALL_BATCH, end);
+            int first = end - n;
+            if (!ReadRecords(f, first, n, chunk.get())) {
+                break;
+            }
+            for (int i = n - 1; i >= 0 && visited < max_records; i--) {
+                visit(chunk[i]);
+                visited++;
+            }
+            end = first;
+        }
+        fclose(f);
     }
+    return visited;
+}
 
-    ESP_LOGI(TAG, "Recalling %d most recent %s items", limit, type);
+// ========== JSONL import/export ==========
+
+int MemoryArchive::ImportJsonl(const char* type, const char* path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ArchiveStream* stream = GetStream(type);
+    if (!initialized_ || !stream) {
+        return -1;
+    }
+    return ImportJsonlLocked(*stream, path, UINT32_MAX);
+}
 
-    // Read all lines first (JSONL is append-only, so last lines are most recent)
-    std::vector<std::string> all_lines;
-    char line[1024];  // Increased buffer size
-    int truncated_lines = 0;
+int MemoryArchive::ImportJsonlLocked(ArchiveStream& stream, const char* path, uint32_t resume_from) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
 
+    // Records from resume_from on that match the file line by line were appended by
+    // an interrupted import of the same file: skip them instead of appending them again
+    uint32_t total = GetRecordCount(stream);
+    uint32_t verify = resume_from;
+    int kind = &stream - streams_;
+    int imported = 0;
+    int skipped = 0;
+    char line[1024];
     while (fgets(line, sizeof(line), f) != nullptr) {
         size_t len = strlen(line);
         if (len > 0 && line[len - 1] == '\n') {
             line[len - 1] = '\0';
-            len--;
         } else if (len >= sizeof(line) - 1) {
-            // Line truncated, skip rest and don't add to results
-            ESP_LOGW(TAG, "Line truncated (>%d bytes), skipping", (int)sizeof(line));
-            truncated_lines++;
             int ch;
             while ((ch = fgetc(f)) != '\n' && ch != EOF);
             continue;
         }
-        all_lines.push_back(std::string(line));
+
+        ArchiveRecord record;
+        if (!ParseJsonlRecord(line, kind, record)) {
+            continue;
+        }
+
+        if (verify < total) {
+            ArchiveRecord stored;
+            if (ReadRecordAt(stream, verify, stored) && memcmp(&stored, &record, sizeof(record)) == 0) {
+                verify++;
+                skipped++;
+                continue;
+            }
+            verify = total;     // Diverged: everything from here on is new
+        }
+
+        if (!AppendRecord(stream, record)) {
+            fclose(f);
+            return -1;
+        }
+        imported++;
     }
 
     fclose(f);
+    if (skipped > 0) {
+        ESP_LOGI(TAG, "Skipped %d %s records already imported from %s", skipped, stream.name, path);
+    }
+    ESP_LOGI(TAG, "Imported %d %s records from %s", imported, stream.name, path);
+    return imported + skipped;
+}
 
-    if (truncated_lines > 0) {
-        ESP_LOGW(TAG, "Skipped %d truncated lines", truncated_lines);
+bool MemoryArchive::ParseJsonlRecord(const char* line, int kind, ArchiveRecord& record) {
+    cJSON* root = cJSON_Parse(line);
+    if (!root) {
+        return false;
     }
 
-    // Take the last N lines (most recent)
-    int start_idx = (int)all_lines.size() - limit;
-    if (start_idx < 0) {
-        start_idx = 0;
+    memset(&record, 0, sizeof(record));
+    record.kind = kind;
+
+    cJSON* item = cJSON_GetObjectItem(root, "timestamp");
+    if (cJSON_IsString(item)) {
+        struct tm tm_info;
+        memset(&tm_info, 0, sizeof(tm_info));
+        if (sscanf(item->valuestring, "%4d-%2d-%2dT%2d:%2d:%2d",
+                   &tm_info.tm_year, &tm_info.tm_mon, &tm_info.tm_mday,
+                   &tm_info.tm_hour, &tm_info.tm_min, &tm_info.tm_sec) >= 3) {
+            tm_info.tm_year -= 1900;
+            tm_info.tm_mon -= 1;
+            tm_info.tm_isdst = -1;
+            record.timestamp = mktime(&tm_info);
+        }
     }
+    record.date_key = DateKeyFromTime(record.timestamp);
 
-    for (int i = start_idx; i < (int)all_lines.size(); i++) {
-        ArchivedItem item;
-        if (ParseArchivedItem(all_lines[i].c_str(), item)) {
-            results.push_back(item);
+    const char* label_key = (ArchiveKind)kind == ArchiveKind::MOMENT ? "topic" : "event_type";
+    const char* importance_key = (ArchiveKind)kind == ArchiveKind::MOMENT ? "importance" : "significance";
+
+    if ((item = cJSON_GetObjectItem(root, "content")) && cJSON_IsString(item)) {
+        strncpy(record.content, item->valuestring, sizeof(record.content) - 1);
+    }
+    if ((item = cJSON_GetObjectItem(root, label_key)) && cJSON_IsString(item)) {
+        strncpy(record.label, item->valuestring, sizeof(record.label) - 1);
+    }
+    if ((item = cJSON_GetObjectItem(root, "date")) && cJSON_IsString(item)) {
+        strncpy(record.date, item->valuestring, sizeof(record.date) - 1);
+    }
+    if ((item = cJSON_GetObjectItem(root, "emotion_type")) && cJSON_IsNumber(item)) {
+        record.emotion_type = item->valueint;
+    }
+    if ((item = cJSON_GetObjectItem(root, "emotion_intensity")) && cJSON_IsNumber(item)) {
+        record.emotion_intensity = item->valueint;
+    }
+    if ((item = cJSON_GetObjectItem(root, importance_key)) && cJSON_IsNumber(item)) {
+        record.importance = item->valueint;
+    }
+    cJSON_Delete(root);
+    return true;
+}
+
+int MemoryArchive::ExportJsonl(const char* type, const char* path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ArchiveStream* stream = GetStream(type);
+    if (!initialized_ || !stream) {
+        return -1;
+    }
+
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        ESP_LOGE(TAG, "Failed to open file for export: %s (errno: %d)", path, errno);
+        return -1;
+    }
+
+    std::unique_ptr<ArchiveRecord[]> batch(new ArchiveRecord[RECALL_BATCH]);
+    int exported = 0;
+    for (const auto& seg : stream->segments) {
+        char seg_path[48];
+        SegmentPath(*stream, seg.segment, seg_path, sizeof(seg_path));
+        FILE* f = fopen(seg_path, "rb");
+        if (!f) {
+            continue;
         }
+        for (int pos = 0; pos < seg.count; pos += RECALL_BATCH) {
+            int n = std::min(RECALL_BATCH, seg.count - pos);
+            if (!ReadRecords(f, pos, n, batch.get())) {
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                fprintf(out, "%s\n", SerializeRecord(batch[i]).c_str());
+                exported++;
+            }
+        }
+        fclose(f);
     }
 
-    ESP_LOGI(TAG, "Recalled %d recent items (total archived: %d)",
-             (int)results.size(), (int)all_lines.size());
+    fclose(out);
+    ESP_LOGI(TAG, "Exported %d %s records to %s", exported, type, path);
+    return exported;
+}
 
-    return results;
+void MemoryArchive::MigrateLegacyJsonl(ArchiveStream& stream) {
+    // The marker holds the record count the stream had when the migration started.
+    // It is written before the first record is appended and removed after the JSONL,
+    // so a reset or a failed append at any point is resumed by the next boot without
+    // duplicating records (see ImportJsonlLocked)
+    char marker_path[48];
+    snprintf(marker_path, sizeof(marker_path), "%s/%s.mig", ARCHIVE_BASE_PATH, stream.name);
+
+    struct stat st;
+    if (stat(stream.legacy_jsonl, &st) != 0) {
+        remove(marker_path);    // Reset after the JSONL was removed, or nothing to do
+        return;
+    }
+
+    uint32_t resume_from;
+    FILE* marker = fopen(marker_path, "rb");
+    bool resuming = marker && fread(&resume_from, sizeof(resume_from), 1, marker) == 1;
+    if (marker) {
+        fclose(marker);
+    }
+    if (resuming) {
+        ESP_LOGI(TAG, "Resuming migration of %s from record %u", stream.legacy_jsonl, (unsigned)resume_from);
+    } else {
+        ESP_LOGI(TAG, "Migrating legacy archive %s (%d bytes)", stream.legacy_jsonl, (int)st.st_size);
+        resume_from = GetRecordCount(stream);
+        marker = fopen(marker_path, "wb");
+        bool ok = marker && fwrite(&resume_from, sizeof(resume_from), 1, marker) == 1;
+        if (marker && fclose(marker) != 0) {
+            ok = false;
+        }
+        if (!ok) {
+            ESP_LOGW(TAG, "Failed to write %s, will retry on next boot", marker_path);
+            remove(marker_path);
+            return;
+        }
+    }
+
+    int imported = ImportJsonlLocked(stream, stream.legacy_jsonl, resume_from);
+    if (imported < 0) {
+        ESP_LOGW(TAG, "Migration of %s failed, will resume on next boot", stream.legacy_jsonl);
+        return;
+    }
+
+    if (remove(stream.legacy_jsonl) != 0) {
+        ESP_LOGW(TAG, "Failed to remove %s (errno: %d)", stream.legacy_jsonl, errno);
+        return;
+    }
+    remove(marker_path);
+    ESP_LOGI(TAG, "Migrated %d records from %s", imported, stream.legacy_jsonl);
 }
@@ -2,32 +2,100 @@
 #define MEMORY_ARCHIVE_H
 
 #include "memory_types.h"
+#include "keyword_index.h"
 #include <string>
 #include <vector>
 #include <mutex>
 #include <cstdio>
+#include <functional>
+#include <ctime>
 
 // Archived item structure for retrieval (Stage 2)
 struct ArchivedItem {
     char timestamp[20];    // ISO 8601 format: YYYY-MM-DDTHH:MM:SS
     char type[16];         // fact, moment, event, etc.
-    char content[256];     // JSON serialized content
+    char content[384];     // JSON serialized content
+};
+
+// ========== Segment format ==========
+// Each archive type is stored as a series of segment files with fixed-size
+// binary records. A segment is sealed with a footer once it holds
+// ARCHIVE_RECORDS_PER_SEGMENT records, and its date range is copied into a
+// small sidecar index so range recalls only open the matching segments.
+
+#define ARCHIVE_MAGIC_SEGMENT       "XZSG"
+#define ARCHIVE_MAGIC_INDEX         "XZAI"
+#define ARCHIVE_FORMAT_VERSION      1
+#define ARCHIVE_RECORDS_PER_SEGMENT 128     // 24KB per sealed segment
+
+enum class ArchiveKind : uint8_t {
+    FACT = 0,
+    MOMENT = 1,
+    EVENT = 2,
+    COUNT
+};
+
+// Binary archive record (192 bytes)
+struct ArchiveRecord {
+    uint32_t timestamp;         // Archive time (epoch seconds)
+    uint32_t date_key;          // YYYYMMDD of timestamp (local time)
+    uint8_t kind;               // ArchiveKind
+    uint8_t emotion_type;
+    uint8_t emotion_intensity;
+    uint8_t importance;         // importance (moment) / significance (event)
+    char label[32];             // moment topic / event type
+    char date[12];              // event date (YYYY-MM-DD or MM-DD)
+    char content[128];
+    uint8_t reserved[8];
+};
+static_assert(sizeof(ArchiveRecord) == 192, "ArchiveRecord must stay 192 bytes");
+
+// Footer appended to a sealed segment (24 bytes)
+struct ArchiveSegmentFooter {
+    char magic[4];              // XZSG
+    uint16_t version;
+    uint16_t count;
+    uint32_t first_date;
+    uint32_t last_date;
+    uint32_t first_ts;
+    uint32_t last_ts;
+};
+
+// Sidecar index entry, one per segment (20 bytes)
+struct ArchiveIndexEntry {
+    uint16_t segment;           // Segment number (1-based)
+    uint16_t count;             // Records in segment
+    uint32_t first_date;
+    uint32_t last_date;
+    uint32_t first_ts;
+    uint32_t last_ts;
+};
+
+struct ArchiveIndexHeader {
+    char magic[4];              // XZAI
+    uint16_t version;
+    uint16_t entry_count;
 };
 
 /**
  * Memory Archive Manager
  *
- * Manages long-term memory storage in SPIFFS (Asset partition)
- * - Stage 1: Archive old memories to JSONL files
- * - Stage 2: Recall/search archived memories (future)
+ * Manages long-term memory storage in SPIFFS (memory partition)
+ * - Stage 1: Archive old memories to binary segment files
+ * - Stage 2: Recall/search archived memories via the segment time index
+ *   and the per-type inverted keyword index (CJK bigrams + ASCII words)
+ * - JSONL import/export is kept for debugging and legacy migration
  */
 class MemoryArchive {
 public:
     static MemoryArchive& GetInstance();
 
-    // Initialization - mount SPIFFS and create directory
+    // Initialization - mount SPIFFS, load indexes, migrate legacy JSONL
     bool Init();
 
+    // Flush buffered keyword postings and unmount; Init() loads everything again
+    void Deinit();
+
     // Archive operations (Stage 1)
     bool ArchiveFacts(const std::vector<Fact>& facts);
     bool ArchiveMoments(const std::vector<SpecialMoment>& moments);
@@ -44,34 +112,73 @@ public:
         const char* keyword, int limit = 10);
     std::vector<ArchivedItem> RecallRecent(const char* type, int limit = 10);
 
+    // JSONL import/export (debugging and migration)
+    int ImportJsonl(const char* type, const char* path);
+    int ExportJsonl(const char* type, const char* path);
+
 private:
     MemoryArchive() = default;
     ~MemoryArchive();
 
-    // File operations
-    bool AppendToFile(const char* filename, const char* json_line);
+    // Per-type segment state; the last entry is the active (unsealed) segment
+    struct ArchiveStream {
+        const char* name;
+        const char* legacy_jsonl;
+        std::vector<ArchiveIndexEntry> segments;
+        KeywordIndex keywords;
+    };
+
     bool CreateDirectoryIfNotExists();
 
-    // JSON serialization helpers
-    std::string SerializeFact(const Fact& fact);
-    std::string SerializeMoment(const SpecialMoment& moment);
-    std::string SerializeEvent(const Event& event);
+    // Record builders
+    ArchiveRecord MakeFactRecord(const Fact& fact);
+    ArchiveRecord MakeMomentRecord(const SpecialMoment& moment);
+    ArchiveRecord MakeEventRecord(const Event& event);
+    std::string SerializeRecord(const ArchiveRecord& record);
+    void RecordToItem(const ArchiveRecord& record, ArchivedItem& item);
+
+    // Segment/index operations
+    ArchiveStream* GetStream(const char* type);
+    void SegmentPath(const ArchiveStream& stream, uint16_t segment, char* path, size_t size);
+    void IndexPath(const ArchiveStream& stream, char* path, size_t size);
+    bool LoadIndex(ArchiveStream& stream);
+    bool SaveIndex(const ArchiveStream& stream);
+    bool ScanSegment(const ArchiveStream& stream, uint16_t segment, ArchiveIndexEntry& entry);
+    bool AppendRecord(ArchiveStream& stream, const ArchiveRecord& record);
+    bool ReadRecords(FILE* f, int first, int count, ArchiveRecord* records);
+    bool ReadRecordAt(const ArchiveStream& stream, uint32_t record_id, ArchiveRecord& record);
+    int LowerBoundDate(FILE* f, int count, uint32_t date_key);
+    int ReadTail(ArchiveStream& stream, int max_records,
+                 const std::function<void(const ArchiveRecord&)>& visit);
+    uint32_t GetRecordCount(const ArchiveStream& stream);
+    bool IndexRecord(ArchiveStream& stream, uint32_t record_id, const ArchiveRecord& record);
+    void SyncKeywordIndex(ArchiveStream& stream);
+    void ScanByKeyword(ArchiveStream& stream, const char* keyword_lower, int limit,
+                       std::vector<ArchivedItem>& results);
+    // resume_from: first record an earlier, interrupted import of path may have appended
+    int ImportJsonlLocked(ArchiveStream& stream, const char* path, uint32_t resume_from);
+    bool ParseJsonlRecord(const char* line, int kind, ArchiveRecord& record);
+    void MigrateLegacyJsonl(ArchiveStream& stream);
 
     // Recall helpers (Stage 2)
-    const char* GetArchiveFilename(const char* type);
-    bool ParseArchivedItem(const char* json_line, ArchivedItem& item);
-    bool MatchesTimeRange(const char* timestamp, const char* start_date, const char* end_date);
-    bool ContainsKeyword(const char* content, const char* keyword);
+    static uint32_t DateKeyFromTime(time_t t);
+    static uint32_t DateKeyFromString(const char* date);
+    int CountKeyword(const ArchiveRecord& record, const char* keyword_lower);
 
     std::mutex mutex_;
     bool initialized_ = false;
     bool spiffs_mounted_ = false;
 
+    ArchiveStream streams_[(int)ArchiveKind::COUNT] = {
+        {"fact", "/spiffs/memory/facts_archive.jsonl", {}, {}},
+        {"moment", "/spiffs/memory/moments_archive.jsonl", {}, {}},
+        {"event", "/spiffs/memory/events_archive.jsonl", {}, {}},
+    };
+
     // Archive file paths
     static constexpr const char* ARCHIVE_BASE_PATH = "/spiffs/memory";
-    static constexpr const char* FACTS_ARCHIVE = "/spiffs/memory/facts_archive.jsonl";
-    static constexpr const char* MOMENTS_ARCHIVE = "/spiffs/memory/moments_archive.jsonl";
-    static constexpr const char* EVENTS_ARCHIVE = "/spiffs/memory/events_archive.jsonl";
+    static constexpr int RECALL_BATCH = 8;      // Records per read during scans
+    static constexpr int MAX_KEYWORD_CANDIDATES = 256;  // Newest candidates verified per query
 };
 
 #endif // MEMORY_ARCHIVE_H
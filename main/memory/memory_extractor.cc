@@ -1,5 +1,6 @@
 #include "memory_extractor.h"
 #include "memory_storage.h"
+#include "keyword_automaton.h"
 #include <esp_log.h>
 #include <cstring>
 #include <algorithm>
@@ -9,25 +10,25 @@
 namespace {
 
 // Negation words (Chinese)
-const char* NEGATION_WORDS[] = {
+constexpr const char* NEGATION_WORDS[] = {
     "不是", "不叫", "没有", "不", "别", "没",
     "非", "未", "不再", "不想", "不要", "并非",
     "绝非", "从不", "不会"
 };
-const int NEGATION_COUNT = sizeof(NEGATION_WORDS) / sizeof(NEGATION_WORDS[0]);
+constexpr int NEGATION_COUNT = sizeof(NEGATION_WORDS) / sizeof(NEGATION_WORDS[0]);
 
 // Question markers
-const char* QUESTION_MARKERS[] = {
+constexpr const char* QUESTION_MARKERS[] = {
     "吗", "？", "?", "什么", "谁", "哪", "怎么",
     "为什么", "多少", "几"
 };
-const int QUESTION_COUNT = sizeof(QUESTION_MARKERS) / sizeof(QUESTION_MARKERS[0]);
+constexpr int QUESTION_COUNT = sizeof(QUESTION_MARKERS) / sizeof(QUESTION_MARKERS[0]);
 
 // Hypothetical markers
-const char* HYPOTHETICAL_MARKERS[] = {
+constexpr const char* HYPOTHETICAL_MARKERS[] = {
     "如果", "假如", "要是", "假设", "倘若", "万一"
 };
-const int HYPOTHETICAL_COUNT = sizeof(HYPOTHETICAL_MARKERS) / sizeof(HYPOTHETICAL_MARKERS[0]);
+constexpr int HYPOTHETICAL_COUNT = sizeof(HYPOTHETICAL_MARKERS) / sizeof(HYPOTHETICAL_MARKERS[0]);
 
 // Identity patterns
 struct IdentityPattern {
@@ -36,7 +37,7 @@ struct IdentityPattern {
     int confidence;
 };
 
-const IdentityPattern IDENTITY_PATTERNS[] = {
+constexpr IdentityPattern IDENTITY_PATTERNS[] = {
     {"我叫", "name", 5},
     {"我的名字是", "name", 5},
     {"我名叫", "name", 5},
@@ -51,7 +52,7 @@ const IdentityPattern IDENTITY_PATTERNS[] = {
     {"我是男", "gender", 4},
     {"我是女", "gender", 4},
 };
-const int IDENTITY_PATTERN_COUNT = sizeof(IDENTITY_PATTERNS) / sizeof(IDENTITY_PATTERNS[0]);
+constexpr int IDENTITY_PATTERN_COUNT = sizeof(IDENTITY_PATTERNS) / sizeof(IDENTITY_PATTERNS[0]);
 
 // Preference patterns
 struct PreferencePattern {
@@ -60,7 +61,7 @@ struct PreferencePattern {
     int confidence;
 };
 
-const PreferencePattern PREFERENCE_PATTERNS[] = {
+constexpr PreferencePattern PREFERENCE_PATTERNS[] = {
     {"我喜欢", true, 5},
     {"我爱", true, 5},
     {"我最喜欢", true, 5},
@@ -73,7 +74,7 @@ const PreferencePattern PREFERENCE_PATTERNS[] = {
     {"我最讨厌", false, 5},
     {"我不爱", false, 4},
 };
-const int PREFERENCE_PATTERN_COUNT = sizeof(PREFERENCE_PATTERNS) / sizeof(PREFERENCE_PATTERNS[0]);
+constexpr int PREFERENCE_PATTERN_COUNT = sizeof(PREFERENCE_PATTERNS) / sizeof(PREFERENCE_PATTERNS[0]);
 
 // Family relation mapping
 struct RelationMapping {
@@ -81,7 +82,7 @@ struct RelationMapping {
     const char* relation;
 };
 
-const RelationMapping RELATION_MAPPINGS[] = {
+constexpr RelationMapping RELATION_MAPPINGS[] = {
     {"爸爸", "父亲"}, {"父亲", "父亲"}, {"老爸", "父亲"}, {"爹", "父亲"},
     {"妈妈", "母亲"}, {"母亲", "母亲"}, {"老妈", "母亲"}, {"娘", "母亲"},
     {"爷爷", "爷爷"}, {"奶奶", "奶奶"},
@@ -92,81 +93,168 @@ const RelationMapping RELATION_MAPPINGS[] = {
     {"朋友", "朋友"}, {"同事", "同事"}, {"同学", "同学"},
     {"宠物", "宠物"}, {"狗狗", "宠物"}, {"猫咪", "宠物"}, {"猫", "宠物"}, {"狗", "宠物"},
 };
-const int RELATION_COUNT = sizeof(RELATION_MAPPINGS) / sizeof(RELATION_MAPPINGS[0]);
+constexpr int RELATION_COUNT = sizeof(RELATION_MAPPINGS) / sizeof(RELATION_MAPPINGS[0]);
 
 // Fact patterns
-const char* FACT_PATTERNS[] = {
+constexpr const char* FACT_PATTERNS[] = {
     "我有", "我会", "我能", "我学", "我正在",
     "我在学", "我喜欢做", "我经常", "我每天"
 };
-const int FACT_PATTERN_COUNT = sizeof(FACT_PATTERNS) / sizeof(FACT_PATTERNS[0]);
+constexpr int FACT_PATTERN_COUNT = sizeof(FACT_PATTERNS) / sizeof(FACT_PATTERNS[0]);
+
+// Event types
+constexpr const char* EVENT_PATTERNS[] = {
+    "生日", "纪念日", "考试", "面试", "约会", "会议",
+    "旅行", "出差", "婚礼", "聚会"
+};
+constexpr int EVENT_PATTERN_COUNT = sizeof(EVENT_PATTERNS) / sizeof(EVENT_PATTERNS[0]);
+
+// Content terminators (punctuation and sentence-final particles)
+constexpr const char* TERMINATORS[] = {
+    "，", "。", "！", "？", "、", ",", ".", "!", "?",
+    "吗", "呢", "吧", "啊", "哦", "嘛"
+};
+constexpr int TERMINATOR_COUNT = sizeof(TERMINATORS) / sizeof(TERMINATORS[0]);
+
+// Quick check patterns for HasPatterns()
+constexpr const char* QUICK_PATTERNS[] = {
+    "我叫", "我是", "我的", "我喜欢", "我讨厌", "我爱",
+    "我有", "我住", "爸爸", "妈妈", "我今年"
+};
+constexpr int QUICK_PATTERN_COUNT = sizeof(QUICK_PATTERNS) / sizeof(QUICK_PATTERNS[0]);
+
+constexpr const char* GENDER_WORDS[] = {"男", "女"};
+constexpr int GENDER_COUNT = sizeof(GENDER_WORDS) / sizeof(GENDER_WORDS[0]);
+
+// Family patterns: "我的XX叫YY", "我XX叫YY" (or 是)
+constexpr const char* FAMILY_PREFIXES[] = {"我的", "我"};
+constexpr const char* FAMILY_SUFFIXES[] = {"叫", "是"};
+
+// All tables above are merged into one keyword table, one range per table,
+// and compiled into a single Aho-Corasick automaton at build time.
+constexpr int NEGATION_BASE = 0;
+constexpr int QUESTION_BASE = NEGATION_BASE + NEGATION_COUNT;
+constexpr int HYPOTHETICAL_BASE = QUESTION_BASE + QUESTION_COUNT;
+constexpr int IDENTITY_BASE = HYPOTHETICAL_BASE + HYPOTHETICAL_COUNT;
+constexpr int PREFERENCE_BASE = IDENTITY_BASE + IDENTITY_PATTERN_COUNT;
+constexpr int RELATION_BASE = PREFERENCE_BASE + PREFERENCE_PATTERN_COUNT;
+constexpr int EVENT_BASE = RELATION_BASE + RELATION_COUNT;
+constexpr int FACT_BASE = EVENT_BASE + EVENT_PATTERN_COUNT;
+constexpr int TERMINATOR_BASE = FACT_BASE + FACT_PATTERN_COUNT;
+constexpr int QUICK_BASE = TERMINATOR_BASE + TERMINATOR_COUNT;
+constexpr int GENDER_BASE = QUICK_BASE + QUICK_PATTERN_COUNT;
+constexpr int KEYWORD_COUNT = GENDER_BASE + GENDER_COUNT;
+
+constexpr std::array<const char*, KEYWORD_COUNT> BuildKeywordTable() {
+    std::array<const char*, KEYWORD_COUNT> table = {};
+    for (int i = 0; i < NEGATION_COUNT; i++) table[NEGATION_BASE + i] = NEGATION_WORDS[i];
+    for (int i = 0; i < QUESTION_COUNT; i++) table[QUESTION_BASE + i] = QUESTION_MARKERS[i];
+    for (int i = 0; i < HYPOTHETICAL_COUNT; i++) table[HYPOTHETICAL_BASE + i] = HYPOTHETICAL_MARKERS[i];
+    for (int i = 0; i < IDENTITY_PATTERN_COUNT; i++) table[IDENTITY_BASE + i] = IDENTITY_PATTERNS[i].pattern;
+    for (int i = 0; i < PREFERENCE_PATTERN_COUNT; i++) table[PREFERENCE_BASE + i] = PREFERENCE_PATTERNS[i].pattern;
+    for (int i = 0; i < RELATION_COUNT; i++) table[RELATION_BASE + i] = RELATION_MAPPINGS[i].keyword;
+    for (int i = 0; i < EVENT_PATTERN_COUNT; i++) table[EVENT_BASE + i] = EVENT_PATTERNS[i];
+    for (int i = 0; i < FACT_PATTERN_COUNT; i++) table[FACT_BASE + i] = FACT_PATTERNS[i];
+    for (int i = 0; i < TERMINATOR_COUNT; i++) table[TERMINATOR_BASE + i] = TERMINATORS[i];
+    for (int i = 0; i < QUICK_PATTERN_COUNT; i++) table[QUICK_BASE + i] = QUICK_PATTERNS[i];
+    for (int i = 0; i < GENDER_COUNT; i++) table[GENDER_BASE + i] = GENDER_WORDS[i];
+    return table;
+}
+
+constexpr std::array<const char*, KEYWORD_COUNT> KEYWORD_TABLE = BuildKeywordTable();
+constexpr size_t KEYWORD_NODE_COUNT = KeywordAutomaton<KEYWORD_COUNT,
+    KeywordAutomatonMaxNodes(KEYWORD_TABLE)>(KEYWORD_TABLE).GetNodeCount();
+constexpr KeywordAutomaton<KEYWORD_COUNT, KEYWORD_NODE_COUNT> KEYWORD_AUTOMATON(KEYWORD_TABLE);
+static_assert(!KEYWORD_AUTOMATON.Overflowed(), "keyword automaton overflow");
+
+inline bool StartsWithAt(const std::string& text, size_t pos, const char* word) {
+    size_t len = strlen(word);
+    return pos + len <= text.length() && text.compare(pos, len, word) == 0;
+}
 
 }  // namespace
 
-bool MemoryExtractor::HasPatterns(const std::string& text) {
-    // Quick check for common patterns
-    const char* quick_patterns[] = {
-        "我叫", "我是", "我的", "我喜欢", "我讨厌", "我爱",
-        "我有", "我住", "爸爸", "妈妈", "我今年"
+// Every keyword occurrence in one utterance, in order of end offset. For a
+// given keyword this is also start order, so the first hit at or after an
+// offset is what std::string::find would have returned.
+struct MemoryExtractor::Scan {
+    struct Hit {
+        uint16_t keyword;
+        uint32_t start;
+        uint32_t end;
     };
 
-    for (const auto& pattern : quick_patterns) {
-        if (text.find(pattern) != std::string::npos) {
-            return true;
+    const std::string& text;
+    std::vector<Hit> hits;
+
+    explicit Scan(const std::string& input) : text(input) {
+        hits.reserve(16);
+        KEYWORD_AUTOMATON.Scan(text.data(), text.length(), [this](uint16_t keyword, size_t end) {
+            size_t start = end - KEYWORD_AUTOMATON.GetLength(keyword);
+            hits.push_back({keyword, (uint32_t)start, (uint32_t)end});
+        });
+    }
+
+    size_t Find(int keyword, size_t from = 0) const {
+        for (const auto& hit : hits) {
+            if (hit.keyword == keyword && hit.start >= from) {
+                return hit.start;
+            }
         }
+        return std::string::npos;
     }
-    return false;
+
+    bool Contains(int base, int count) const {
+        for (const auto& hit : hits) {
+            if (hit.keyword >= base && hit.keyword < base + count) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+bool MemoryExtractor::HasPatterns(const std::string& text) {
+    // Quick check for common patterns
+    Scan scan(text);
+    return scan.Contains(QUICK_BASE, QUICK_PATTERN_COUNT);
 }
 
-bool MemoryExtractor::IsNegated(const std::string& text, size_t pattern_pos) {
+bool MemoryExtractor::IsNegated(const Scan& scan, size_t pattern_pos) {
     if (pattern_pos == 0) return false;
 
     // Check 6-12 bytes before pattern (2-4 Chinese chars)
     size_t check_start = (pattern_pos > 12) ? pattern_pos - 12 : 0;
-    std::string prefix = text.substr(check_start, pattern_pos - check_start);
 
-    for (int i = 0; i < NEGATION_COUNT; i++) {
-        if (prefix.find(NEGATION_WORDS[i]) != std::string::npos) {
+    for (const auto& hit : scan.hits) {
+        if (hit.keyword >= NEGATION_BASE && hit.keyword < NEGATION_BASE + NEGATION_COUNT &&
+            hit.start >= check_start && hit.end <= pattern_pos) {
             return true;
         }
     }
     return false;
 }
 
-bool MemoryExtractor::IsQuestion(const std::string& text) {
-    for (int i = 0; i < QUESTION_COUNT; i++) {
-        if (text.find(QUESTION_MARKERS[i]) != std::string::npos) {
-            return true;
-        }
-    }
-    return false;
+bool MemoryExtractor::IsQuestion(const Scan& scan) {
+    return scan.Contains(QUESTION_BASE, QUESTION_COUNT);
 }
 
-bool MemoryExtractor::IsHypothetical(const std::string& text) {
-    for (int i = 0; i < HYPOTHETICAL_COUNT; i++) {
-        if (text.find(HYPOTHETICAL_MARKERS[i]) != std::string::npos) {
-            return true;
-        }
-    }
-    return false;
+bool MemoryExtractor::IsHypothetical(const Scan& scan) {
+    return scan.Contains(HYPOTHETICAL_BASE, HYPOTHETICAL_COUNT);
 }
 
-std::string MemoryExtractor::ExtractContent(const std::string& text, size_t start_pos,
+std::string MemoryExtractor::ExtractContent(const Scan& scan, size_t start_pos,
                                              size_t max_len) {
+    const std::string& text = scan.text;
     if (start_pos >= text.length()) return "";
 
     // Find end position (punctuation or max length)
-    const char* terminators[] = {
-        "，", "。", "！", "？", "、", ",", ".", "!", "?",
-        "吗", "呢", "吧", "啊", "哦", "嘛"
-    };
-
     size_t end_pos = std::min(start_pos + max_len * 3, text.length());  // *3 for UTF-8
 
-    for (const auto& term : terminators) {
-        size_t pos = text.find(term, start_pos);
-        if (pos != std::string::npos && pos < end_pos) {
-            end_pos = pos;
+    for (const auto& hit : scan.hits) {
+        if (hit.keyword >= TERMINATOR_BASE && hit.keyword < TERMINATOR_BASE + TERMINATOR_COUNT &&
+            hit.start >= start_pos && hit.start < end_pos) {
+            end_pos = hit.start;
         }
     }
 
@@ -183,19 +271,19 @@ std::string MemoryExtractor::ExtractContent(const std::string& text, size_t star
     return content;
 }
 
-void MemoryExtractor::ExtractIdentity(const std::string& text,
+void MemoryExtractor::ExtractIdentity(const Scan& scan,
                                        std::vector<ExtractedMemory>& memories) {
     for (int i = 0; i < IDENTITY_PATTERN_COUNT; i++) {
         const auto& pattern = IDENTITY_PATTERNS[i];
-        size_t pos = text.find(pattern.pattern);
+        size_t pos = scan.Find(IDENTITY_BASE + i);
         if (pos == std::string::npos) continue;
 
         // Check negation
-        if (IsNegated(text, pos)) continue;
+        if (IsNegated(scan, pos)) continue;
 
         // Extract content
         size_t content_start = pos + strlen(pattern.pattern);
-        std::string content = ExtractContent(text, content_start, 24);
+        std::string content = ExtractContent(scan, content_start, 24);
 
         if (content.empty()) continue;
 
@@ -218,9 +306,9 @@ void MemoryExtractor::ExtractIdentity(const std::string& text,
 
         // For gender
         if (strcmp(pattern.category, "gender") == 0) {
-            if (text.find("男") != std::string::npos) {
+            if (scan.Find(GENDER_BASE + 0) != std::string::npos) {
                 content = "male";
-            } else if (text.find("女") != std::string::npos) {
+            } else if (scan.Find(GENDER_BASE + 1) != std::string::npos) {
                 content = "female";
             } else {
                 continue;
@@ -239,18 +327,18 @@ void MemoryExtractor::ExtractIdentity(const std::string& text,
     }
 }
 
-void MemoryExtractor::ExtractPreferences(const std::string& text,
+void MemoryExtractor::ExtractPreferences(const Scan& scan,
                                           std::vector<ExtractedMemory>& memories) {
     for (int i = 0; i < PREFERENCE_PATTERN_COUNT; i++) {
         const auto& pattern = PREFERENCE_PATTERNS[i];
-        size_t pos = text.find(pattern.pattern);
+        size_t pos = scan.Find(PREFERENCE_BASE + i);
         if (pos == std::string::npos) continue;
 
         // For negative patterns, don't check negation
-        if (pattern.is_like && IsNegated(text, pos)) continue;
+        if (pattern.is_like && IsNegated(scan, pos)) continue;
 
         size_t content_start = pos + strlen(pattern.pattern);
-        std::string content = ExtractContent(text, content_start, 20);
+        std::string content = ExtractContent(scan, content_start, 20);
 
         if (content.empty()) continue;
 
@@ -266,30 +354,40 @@ void MemoryExtractor::ExtractPreferences(const std::string& text,
     }
 }
 
-void MemoryExtractor::ExtractFamily(const std::string& text,
+size_t MemoryExtractor::FindFamilyPattern(const Scan& scan, int relation,
+                                           const char* prefix, const char* suffix,
+                                           size_t& content_start) {
+    // Anchor on the relation keyword, then check the prefix/suffix around it
+    size_t prefix_len = strlen(prefix);
+    for (const auto& hit : scan.hits) {
+        if (hit.keyword != RELATION_BASE + relation || hit.start < prefix_len) continue;
+        size_t pos = hit.start - prefix_len;
+        if (StartsWithAt(scan.text, pos, prefix) && StartsWithAt(scan.text, hit.end, suffix)) {
+            content_start = hit.end + strlen(suffix);
+            return pos;
+        }
+    }
+    return std::string::npos;
+}
+
+void MemoryExtractor::ExtractFamily(const Scan& scan,
                                      std::vector<ExtractedMemory>& memories) {
     // Patterns: "我的XX叫YY", "我XX叫YY", "XX叫YY"
-    const char* family_patterns[] = {
-        "我的", "我"
-    };
-
     for (int i = 0; i < RELATION_COUNT; i++) {
         const auto& rel = RELATION_MAPPINGS[i];
 
         // Try different patterns
-        for (const auto& prefix : family_patterns) {
-            std::string pattern = std::string(prefix) + rel.keyword + "叫";
-            size_t pos = text.find(pattern);
+        for (const auto& prefix : FAMILY_PREFIXES) {
+            size_t content_start = 0;
+            size_t pos = FindFamilyPattern(scan, i, prefix, FAMILY_SUFFIXES[0], content_start);
             if (pos == std::string::npos) {
-                pattern = std::string(prefix) + rel.keyword + "是";
-                pos = text.find(pattern);
+                pos = FindFamilyPattern(scan, i, prefix, FAMILY_SUFFIXES[1], content_start);
             }
 
             if (pos != std::string::npos) {
-                if (IsNegated(text, pos)) continue;
+                if (IsNegated(scan, pos)) continue;
 
-                size_t content_start = pos + pattern.length();
-                std::string name = ExtractContent(text, content_start, 16);
+                std::string name = ExtractContent(scan, content_start, 16);
 
                 if (name.empty()) continue;
 
@@ -307,22 +405,16 @@ void MemoryExtractor::ExtractFamily(const std::string& text,
     }
 }
 
-void MemoryExtractor::ExtractEvents(const std::string& text,
+void MemoryExtractor::ExtractEvents(const Scan& scan,
                                      std::vector<ExtractedMemory>& memories) {
-    // Event patterns
-    const char* event_patterns[] = {
-        "生日", "纪念日", "考试", "面试", "约会", "会议",
-        "旅行", "出差", "婚礼", "聚会"
-    };
-
-    for (const auto& event_type : event_patterns) {
-        if (text.find(event_type) != std::string::npos) {
+    for (int i = 0; i < EVENT_PATTERN_COUNT; i++) {
+        if (scan.Find(EVENT_BASE + i) != std::string::npos) {
             // Look for date patterns nearby
             // Simple: just note the event type for now
             ExtractedMemory mem;
             mem.type = ExtractedType::EVENT;
             strncpy(mem.category, "event", sizeof(mem.category) - 1);
-            strncpy(mem.content, event_type, sizeof(mem.content) - 1);
+            strncpy(mem.content, EVENT_PATTERNS[i], sizeof(mem.content) - 1);
             mem.confidence = 3;
 
             memories.push_back(mem);
@@ -331,16 +423,16 @@ void MemoryExtractor::ExtractEvents(const std::string& text,
     }
 }
 
-void MemoryExtractor::ExtractFacts(const std::string& text,
+void MemoryExtractor::ExtractFacts(const Scan& scan,
                                     std::vector<ExtractedMemory>& memories) {
     for (int i = 0; i < FACT_PATTERN_COUNT; i++) {
-        size_t pos = text.find(FACT_PATTERNS[i]);
+        size_t pos = scan.Find(FACT_BASE + i);
         if (pos == std::string::npos) continue;
 
-        if (IsNegated(text, pos)) continue;
+        if (IsNegated(scan, pos)) continue;
 
         size_t content_start = pos + strlen(FACT_PATTERNS[i]);
-        std::string content = ExtractContent(text, content_start, 40);
+        std::string content = ExtractContent(scan, content_start, 40);
 
         if (content.empty() || content.length() < 2) continue;
 
@@ -361,22 +453,25 @@ void MemoryExtractor::ExtractFacts(const std::string& text,
 std::vector<ExtractedMemory> MemoryExtractor::Extract(const std::string& user_text) {
     std::vector<ExtractedMemory> memories;
 
+    // One pass finds every trigger, negation, question and terminator
+    Scan scan(user_text);
+
     // Skip questions and hypothetical statements
-    if (IsQuestion(user_text)) {
+    if (IsQuestion(scan)) {
         ESP_LOGD(TAG, "Skipping question");
         return memories;
     }
-    if (IsHypothetical(user_text)) {
+    if (IsHypothetical(scan)) {
         ESP_LOGD(TAG, "Skipping hypothetical");
         return memories;
     }
 
     // Extract different types
-    ExtractIdentity(user_text, memories);
-    ExtractPreferences(user_text, memories);
-    ExtractFamily(user_text, memories);
-    ExtractEvents(user_text, memories);
-    ExtractFacts(user_text, memories);
+    ExtractIdentity(scan, memories);
+    ExtractPreferences(scan, memories);
+    ExtractFamily(scan, memories);
+    ExtractEvents(scan, memories);
+    ExtractFacts(scan, memories);
 
     return memories;
 }
@@ -17,37 +17,45 @@ public:
     static int Apply(const std::vector<ExtractedMemory>& memories);
 
 private:
+    // Keyword hits for one utterance from the compiled keyword automaton
+    struct Scan;
+
     // Check if pattern is negated
-    static bool IsNegated(const std::string& text, size_t pattern_pos);
+    static bool IsNegated(const Scan& scan, size_t pattern_pos);
 
     // Check if text is a question
-    static bool IsQuestion(const std::string& text);
+    static bool IsQuestion(const Scan& scan);
 
     // Check if text is hypothetical
-    static bool IsHypothetical(const std::string& text);
+    static bool IsHypothetical(const Scan& scan);
 
     // Extract content after pattern
-    static std::string ExtractContent(const std::string& text, size_t start_pos,
+    static std::string ExtractContent(const Scan& scan, size_t start_pos,
                                        size_t max_len = 32);
 
+    // Find "<prefix><relation keyword><suffix>", returns its start or npos
+    static size_t FindFamilyPattern(const Scan& scan, int relation,
+                                    const char* prefix, const char* suffix,
+                                    size_t& content_start);
+
     // Extract identity info (name, age, location, etc.)
-    static void ExtractIdentity(const std::string& text,
+    static void ExtractIdentity(const Scan& scan,
                                  std::vector<ExtractedMemory>& memories);
 
     // Extract preferences (likes/dislikes)
-    static void ExtractPreferences(const std::string& text,
+    static void ExtractPreferences(const Scan& scan,
                                     std::vector<ExtractedMemory>& memories);
 
     // Extract family members
-    static void ExtractFamily(const std::string& text,
+    static void ExtractFamily(const Scan& scan,
                                std::vector<ExtractedMemory>& memories);
 
     // Extract events
-    static void ExtractEvents(const std::string& text,
+    static void ExtractEvents(const Scan& scan,
                                std::vector<ExtractedMemory>& memories);
 
     // Extract facts
-    static void ExtractFacts(const std::string& text,
+    static void ExtractFacts(const Scan& scan,
                               std::vector<ExtractedMemory>& memories);
 };
 
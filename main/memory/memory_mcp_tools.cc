@@ -638,7 +638,7 @@ void RegisterMemoryMcpTools(McpServer& mcp_server) {
             Property("keyword", kPropertyTypeString, std::string("")),
             Property("start_date", kPropertyTypeString, std::string("")),
             Property("end_date", kPropertyTypeString, std::string("")),
-            Property("limit", kPropertyTypeInteger, 10)
+            Property("limit", kPropertyTypeInteger, 10, 1, 50)
         }),
         [](const PropertyList& props) -> ReturnValue {
             std::string action = props["action"].value<std::string>();
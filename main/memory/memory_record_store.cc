@@ -0,0 +1,445 @@
+#include "memory_record_store.h"
+#include <esp_log.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#define TAG "MemoryStore"
+
+// ============== Blob layout ==============
+
+bool BlobRecordStore::Exists(const char* key) {
+    size_t size = 0;
+    return nvs_get_blob(handle_, key, nullptr, &size) == ESP_OK && size > 0;
+}
+
+int BlobRecordStore::Load(const char* key, void* records, size_t record_size, int max_count) {
+    size_t size = record_size * max_count;
+    esp_err_t err = nvs_get_blob(handle_, key, records, &size);
+    if (err != ESP_OK) {
+        return 0;
+    }
+    return size / record_size;
+}
+
+esp_err_t BlobRecordStore::Save(const char* key, const void* records, size_t record_size,
+                                int count, int max_count) {
+    (void)max_count;
+    if (count == 0) {
+        return Erase(key);
+    }
+    esp_err_t err = nvs_set_blob(handle_, key, records, record_size * count);
+    if (err == ESP_OK) {
+        bytes_written_ += record_size * count;
+    }
+    return err;
+}
+
+esp_err_t BlobRecordStore::Erase(const char* key) {
+    esp_err_t err = nvs_erase_key(handle_, key);
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+// ============== Slot layout ==============
+
+void SlotRecordStore::HeaderKey(const char* key, char* out, size_t size) {
+    snprintf(out, size, "%s_h", key);
+}
+
+void SlotRecordStore::JournalKey(const char* key, char* out, size_t size) {
+    snprintf(out, size, "%s_j", key);
+}
+
+void SlotRecordStore::SlotKey(const char* key, int slot, char* out, size_t size) {
+    snprintf(out, size, "%s_%02d", key, slot);
+}
+
+uint32_t SlotRecordStore::HashRecord(const void* record, size_t size) {
+    // FNV-1a; 0 is reserved for "unknown", so force the low bit
+    const uint8_t* p = static_cast<const uint8_t*>(record);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h | 1;
+}
+
+bool SlotRecordStore::ReadHeader(const char* key, MemorySlotHeader& header) {
+    char hkey[16];
+    HeaderKey(key, hkey, sizeof(hkey));
+    size_t size = sizeof(header);
+    if (nvs_get_blob(handle_, hkey, &header, &size) != ESP_OK ||
+        size != sizeof(header) ||
+        memcmp(header.magic, MEMORY_SLOT_MAGIC, 4) != 0 ||
+        header.count > MEMORY_SLOT_MAX) {
+        return false;
+    }
+    return true;
+}
+
+SlotRecordStore::SlotState& SlotRecordStore::GetState(const char* key) {
+    for (auto& state : states_) {
+        if (strcmp(state.key, key) == 0) {
+            return state;
+        }
+    }
+
+    // First use of this category: pick up the stored header so its slots
+    // are not overwritten, but content hashes stay unknown until Load()
+    SlotState state = {};
+    state.key = key;
+    if (!ReadHeader(key, state.header)) {
+        memset(&state.header, 0, sizeof(state.header));
+        memcpy(state.header.magic, MEMORY_SLOT_MAGIC, 4);
+    }
+    char jkey[16];
+    JournalKey(key, jkey, sizeof(jkey));
+    size_t size = 0;
+    state.journal = nvs_get_blob(handle_, jkey, nullptr, &size) == ESP_OK;
+    states_.push_back(state);
+    return states_.back();
+}
+
+bool SlotRecordStore::SlotMatches(const char* key, int slot, const void* record, size_t record_size,
+                                  uint8_t* scratch) {
+    char skey[16];
+    SlotKey(key, slot, skey, sizeof(skey));
+    size_t size = record_size;
+    return nvs_get_blob(handle_, skey, scratch, &size) == ESP_OK && size == record_size &&
+           memcmp(scratch, record, record_size) == 0;
+}
+
+bool SlotRecordStore::Exists(const char* key) {
+    MemorySlotHeader header;
+    if (ReadHeader(key, header)) {
+        return true;
+    }
+    char jkey[16];
+    JournalKey(key, jkey, sizeof(jkey));
+    size_t size = 0;
+    return nvs_get_blob(handle_, jkey, nullptr, &size) == ESP_OK && size > 0;
+}
+
+int SlotRecordStore::LoadJournal(const char* key, void* records, size_t record_size, int max_count) {
+    char jkey[16];
+    JournalKey(key, jkey, sizeof(jkey));
+    size_t size = 0;
+    if (nvs_get_blob(handle_, jkey, nullptr, &size) != ESP_OK) {
+        return -1;
+    }
+
+    // New header, then (slot, record) for each slot the interrupted save overwrote
+    size_t entry_size = 1 + record_size;
+    std::vector<uint8_t> journal(size);
+    MemorySlotHeader header;
+    bool valid = size >= sizeof(header) && (size - sizeof(header)) % entry_size == 0 &&
+                 nvs_get_blob(handle_, jkey, journal.data(), &size) == ESP_OK;
+    if (valid) {
+        memcpy(&header, journal.data(), sizeof(header));
+        valid = memcmp(header.magic, MEMORY_SLOT_MAGIC, 4) == 0 && header.record_size == record_size &&
+                header.count <= max_count;
+    }
+    int entries = valid ? (size - sizeof(header)) / entry_size : 0;
+    const uint8_t* entry = journal.data() + sizeof(header);
+    for (int e = 0; e < entries && valid; e++) {
+        valid = entry[e * entry_size] < MEMORY_SLOT_MAX;
+    }
+    if (!valid) {
+        ESP_LOGW(TAG, "%s: discarding unusable journal (%u bytes)", key, (unsigned)size);
+        nvs_erase_key(handle_, jkey);
+        return -1;
+    }
+
+    // The previous save was interrupted after the journal was written: slots the
+    // old header referenced may be half overwritten, so write them all again
+    ESP_LOGW(TAG, "%s: completing interrupted save (%d journaled slots)", key, entries);
+    bool ok = true;
+    for (int e = 0; e < entries && ok; e++) {
+        char skey[16];
+        SlotKey(key, entry[e * entry_size], skey, sizeof(skey));
+        ok = nvs_set_blob(handle_, skey, entry + e * entry_size + 1, record_size) == ESP_OK;
+    }
+    char hkey[16];
+    HeaderKey(key, hkey, sizeof(hkey));
+    ok = ok && nvs_set_blob(handle_, hkey, &header, sizeof(header)) == ESP_OK;
+    ok = ok && nvs_erase_key(handle_, jkey) == ESP_OK;
+    if (ok) {
+        nvs_commit(handle_);
+    } else {
+        ESP_LOGE(TAG, "%s: failed to complete the save, journal kept", key);
+    }
+
+    SlotState& state = GetState(key);
+    state.header = header;
+    state.journal = !ok;
+    memset(state.hash, 0, sizeof(state.hash));
+
+    // Journaled slots come from the journal itself, so the result is right even
+    // if the writes above failed
+    uint8_t* out = static_cast<uint8_t*>(records);
+    int loaded = 0;
+    for (int i = 0; i < header.count; i++) {
+        int slot = header.order[i];
+        uint8_t* dst = out + loaded * record_size;
+        const uint8_t* journaled = nullptr;
+        for (int e = 0; e < entries && !journaled; e++) {
+            if (entry[e * entry_size] == slot) {
+                journaled = entry + e * entry_size + 1;
+            }
+        }
+        if (journaled) {
+            memcpy(dst, journaled, record_size);
+        } else {
+            char skey[16];
+            SlotKey(key, slot, skey, sizeof(skey));
+            size_t slot_size = record_size;
+            if (slot >= MEMORY_SLOT_MAX || nvs_get_blob(handle_, skey, dst, &slot_size) != ESP_OK ||
+                slot_size != record_size) {
+                ESP_LOGW(TAG, "%s: slot %d missing", key, slot);
+                continue;
+            }
+        }
+        if (ok) {
+            state.hash[slot] = HashRecord(dst, record_size);
+        }
+        loaded++;
+    }
+    return loaded;
+}
+
+int SlotRecordStore::Load(const char* key, void* records, size_t record_size, int max_count) {
+    int journaled = LoadJournal(key, records, record_size, max_count);
+    if (journaled >= 0) {
+        return journaled;
+    }
+
+    SlotState& state = GetState(key);
+    MemorySlotHeader& header = state.header;
+    if (header.count == 0) {
+        return 0;
+    }
+    if (header.record_size != record_size) {
+        ESP_LOGW(TAG, "%s: record size %u != %u, ignoring stored slots",
+                 key, (unsigned)header.record_size, (unsigned)record_size);
+        return 0;
+    }
+
+    uint8_t* out = static_cast<uint8_t*>(records);
+    int loaded = 0;
+    int count = std::min((int)header.count, max_count);
+    for (int i = 0; i < count; i++) {
+        int slot = header.order[i];
+        if (slot >= MEMORY_SLOT_MAX) {
+            continue;
+        }
+        char skey[16];
+        SlotKey(key, slot, skey, sizeof(skey));
+        size_t size = record_size;
+        uint8_t* dst = out + loaded * record_size;
+        if (nvs_get_blob(handle_, skey, dst, &size) != ESP_OK || size != record_size) {
+            ESP_LOGW(TAG, "%s: slot %d missing", key, slot);
+            continue;
+        }
+        state.hash[slot] = HashRecord(dst, record_size);
+        loaded++;
+    }
+    return loaded;
+}
+
+esp_err_t SlotRecordStore::Save(const char* key, const void* records, size_t record_size,
+                                int count, int max_count) {
+    SlotState& state = GetState(key);
+    MemorySlotHeader& old_header = state.header;
+    int capacity = std::min(max_count + MEMORY_SLOT_SPARE, MEMORY_SLOT_MAX);
+    if (count > capacity - MEMORY_SLOT_SPARE) {
+        count = capacity - MEMORY_SLOT_SPARE;
+    }
+    if (old_header.record_size != record_size) {
+        // Layout of the record changed (or first save): nothing is reusable
+        old_header.count = 0;
+        memset(state.hash, 0, sizeof(state.hash));
+    }
+
+    bool referenced[MEMORY_SLOT_MAX] = {};
+    for (int i = 0; i < old_header.count; i++) {
+        if (old_header.order[i] < MEMORY_SLOT_MAX) {
+            referenced[old_header.order[i]] = true;
+        }
+    }
+
+    const uint8_t* in = static_cast<const uint8_t*>(records);
+    uint8_t order[MEMORY_SLOT_MAX];
+    uint32_t hashes[MEMORY_SLOT_MAX];
+    bool claimed[MEMORY_SLOT_MAX] = {};
+    memset(order, 0xFF, sizeof(order));
+    std::vector<uint8_t> scratch(record_size);
+
+    // Keep records whose content is already stored in a referenced slot; the
+    // hash only picks the candidate, the stored bytes decide
+    bool write[MEMORY_SLOT_MAX] = {};
+    for (int i = 0; i < count; i++) {
+        hashes[i] = HashRecord(in + i * record_size, record_size);
+        for (int s = 0; s < capacity; s++) {
+            if (referenced[s] && !claimed[s] && state.hash[s] == hashes[i] &&
+                SlotMatches(key, s, in + i * record_size, record_size, scratch.data())) {
+                order[i] = s;
+                claimed[s] = true;
+                break;
+            }
+        }
+        write[i] = order[i] == 0xFF;
+    }
+
+    // Changed records get slots the old header does not reference first, then
+    // slots whose old records are being dropped
+    int overwrites = 0;
+    for (int i = 0; i < count; i++) {
+        if (!write[i]) {
+            continue;
+        }
+        int slot = -1;
+        for (int s = 0; s < capacity && slot < 0; s++) {
+            if (!claimed[s] && !referenced[s]) slot = s;
+        }
+        for (int s = 0; s < capacity && slot < 0; s++) {
+            if (!claimed[s]) slot = s;
+        }
+        if (slot < 0) {
+            return ESP_ERR_NO_MEM;
+        }
+        order[i] = slot;
+        claimed[slot] = true;
+        if (referenced[slot]) {
+            overwrites++;
+        }
+    }
+
+    MemorySlotHeader header = old_header;
+    header.record_size = record_size;
+    header.count = count;
+    header.generation++;
+    memcpy(header.order, order, sizeof(header.order));
+
+    auto write_slot = [&](int i) {
+        int slot = order[i];
+        char skey[16];
+        SlotKey(key, slot, skey, sizeof(skey));
+        esp_err_t err = nvs_set_blob(handle_, skey, in + i * record_size, record_size);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "%s: failed to write slot %d: %s", key, slot, esp_err_to_name(err));
+            state.hash[slot] = 0;
+            return err;
+        }
+        bytes_written_ += record_size;
+        state.hash[slot] = hashes[i];
+        return ESP_OK;
+    };
+
+    // Until the new header is written the old one stays valid, so slots it does
+    // not reference are written directly. Slots it does reference are journaled
+    // first, together with the new header, and Load() completes the save from
+    // the journal if it is interrupted. A journal left by a failed save is
+    // replaced rather than erased, and then holds every changed record: the
+    // slots it describes may be reused by this save
+    char jkey[16];
+    JournalKey(key, jkey, sizeof(jkey));
+    bool journal_all = state.journal;
+    bool journaled = overwrites > 0 || journal_all;
+    auto journaled_record = [&](int i) { return journal_all || referenced[order[i]]; };
+
+    for (int i = 0; i < count; i++) {
+        if (write[i] && !journaled_record(i)) {
+            esp_err_t err = write_slot(i);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+
+    if (journaled) {
+        std::vector<uint8_t> journal(reinterpret_cast<const uint8_t*>(&header),
+                                     reinterpret_cast<const uint8_t*>(&header) + sizeof(header));
+        for (int i = 0; i < count; i++) {
+            if (write[i] && journaled_record(i)) {
+                journal.push_back(order[i]);
+                journal.insert(journal.end(), in + i * record_size, in + (i + 1) * record_size);
+            }
+        }
+        esp_err_t err = nvs_set_blob(handle_, jkey, journal.data(), journal.size());
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "%s: failed to write journal: %s", key, esp_err_to_name(err));
+            return err;
+        }
+        state.journal = true;
+        bytes_written_ += journal.size();
+
+        for (int i = 0; i < count; i++) {
+            if (write[i] && journaled_record(i)) {
+                esp_err_t err = write_slot(i);
+                if (err != ESP_OK) {
+                    return err;
+                }
+            }
+        }
+    }
+
+    bool header_changed = old_header.record_size != record_size ||
+                          old_header.count != count ||
+                          memcmp(old_header.order, order, count) != 0;
+    if (header_changed) {
+        char hkey[16];
+        HeaderKey(key, hkey, sizeof(hkey));
+        esp_err_t err = nvs_set_blob(handle_, hkey, &header, sizeof(header));
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "%s: failed to write header: %s", key, esp_err_to_name(err));
+            return err;
+        }
+        bytes_written_ += sizeof(header);
+        old_header = header;
+
+        // Erase slots dropped from the header, so spares hold no stale records
+        for (int s = 0; s < MEMORY_SLOT_MAX; s++) {
+            if (claimed[s]) {
+                continue;
+            }
+            state.hash[s] = 0;
+            if (referenced[s]) {
+                char skey[16];
+                SlotKey(key, s, skey, sizeof(skey));
+                nvs_erase_key(handle_, skey);
+            }
+        }
+    }
+
+    if (journaled) {
+        // If this fails the journal matches the slots; the next save replaces it
+        esp_err_t err = nvs_erase_key(handle_, jkey);
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "%s: failed to erase journal: %s", key, esp_err_to_name(err));
+            return err;
+        }
+        state.journal = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t SlotRecordStore::Erase(const char* key) {
+    char nkey[16];
+    HeaderKey(key, nkey, sizeof(nkey));
+    esp_err_t err = nvs_erase_key(handle_, nkey);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+    JournalKey(key, nkey, sizeof(nkey));
+    nvs_erase_key(handle_, nkey);
+    for (int s = 0; s < MEMORY_SLOT_MAX; s++) {
+        SlotKey(key, s, nkey, sizeof(nkey));
+        nvs_erase_key(handle_, nkey);
+    }
+
+    states_.erase(std::remove_if(states_.begin(), states_.end(),
+        [key](const SlotState& state) { return strcmp(state.key, key) == 0; }),
+        states_.end());
+    return ESP_OK;
+}
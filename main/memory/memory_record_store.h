@@ -0,0 +1,117 @@
+#ifndef MEMORY_RECORD_STORE_H
+#define MEMORY_RECORD_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <nvs.h>
+
+/**
+ * NVS backends for the fixed-size record arrays held by MemoryStorage
+ * (facts, events, family, ...).
+ *
+ * - BlobRecordStore: the original layout, one blob per category holding the
+ *   whole array. Every save rewrites all records.
+ * - SlotRecordStore: one key per record slot plus a small header that maps
+ *   logical positions to slots. Unchanged records keep their slot, so a save
+ *   only writes the slots whose content changed and, if the order changed,
+ *   the header. A record counts as unchanged only if its stored bytes match,
+ *   not just its hash. Changed records go to a slot the previous header does
+ *   not reference, so an interrupted save leaves the old header valid. When
+ *   more records changed than there are such slots (more than
+ *   MEMORY_SLOT_SPARE changes to a full category), the records that must
+ *   overwrite slots of dropped records are first written to a journal key
+ *   together with the new header; Load() completes the save from the journal
+ *   if it was interrupted.
+ *
+ * The active backend is chosen with CONFIG_MEMORY_STORAGE_LAYOUT_*; data in
+ * the other layout is migrated by MemoryStorage::Init().
+ */
+class MemoryRecordStore {
+public:
+    virtual ~MemoryRecordStore() = default;
+
+    void Bind(nvs_handle_t handle) { handle_ = handle; }
+    virtual const char* GetName() const = 0;
+
+    // True if the category has data in this layout
+    virtual bool Exists(const char* key) = 0;
+    // Returns the number of records read into records (0 if none)
+    virtual int Load(const char* key, void* records, size_t record_size, int max_count) = 0;
+    // Writes count records; count == 0 clears the category
+    virtual esp_err_t Save(const char* key, const void* records, size_t record_size,
+                           int count, int max_count) = 0;
+    virtual esp_err_t Erase(const char* key) = 0;
+    // Forget cached layout state (after nvs_erase_all)
+    virtual void Reset() {}
+
+    // Payload bytes handed to nvs_set_blob since boot
+    uint32_t GetBytesWritten() const { return bytes_written_; }
+
+protected:
+    nvs_handle_t handle_ = 0;
+    uint32_t bytes_written_ = 0;
+};
+
+class BlobRecordStore : public MemoryRecordStore {
+public:
+    const char* GetName() const override { return "blob"; }
+    bool Exists(const char* key) override;
+    int Load(const char* key, void* records, size_t record_size, int max_count) override;
+    esp_err_t Save(const char* key, const void* records, size_t record_size,
+                   int count, int max_count) override;
+    esp_err_t Erase(const char* key) override;
+};
+
+// ========== Slot layout ==========
+// Keys: "<key>_h" for the header, "<key>_NN" for slot NN, "<key>_j" for the
+// journal (the new header, then a slot number and record for each slot of the
+// old header being overwritten; only present while a save is in progress).
+
+#define MEMORY_SLOT_MAGIC   "XZSL"
+#define MEMORY_SLOT_MAX     32      // Slots per category, including spares
+#define MEMORY_SLOT_SPARE   8       // Free slots kept beyond max_count (one write-behind batch)
+
+// Category header (44 bytes)
+struct MemorySlotHeader {
+    char magic[4];                      // XZSL
+    uint16_t record_size;
+    uint8_t count;
+    uint8_t reserved;
+    uint32_t generation;                // Bumped on every header write
+    uint8_t order[MEMORY_SLOT_MAX];     // Logical position -> slot number
+};
+
+class SlotRecordStore : public MemoryRecordStore {
+public:
+    const char* GetName() const override { return "slot"; }
+    bool Exists(const char* key) override;
+    int Load(const char* key, void* records, size_t record_size, int max_count) override;
+    esp_err_t Save(const char* key, const void* records, size_t record_size,
+                   int count, int max_count) override;
+    esp_err_t Erase(const char* key) override;
+    void Reset() override { states_.clear(); }
+
+private:
+    // Cached header and slot content hashes (0 = unknown/free) per category
+    struct SlotState {
+        const char* key;
+        MemorySlotHeader header;
+        uint32_t hash[MEMORY_SLOT_MAX];
+        bool journal;       // Journal key may still be present
+    };
+
+    SlotState& GetState(const char* key);
+    bool ReadHeader(const char* key, MemorySlotHeader& header);
+    bool SlotMatches(const char* key, int slot, const void* record, size_t record_size,
+                     uint8_t* scratch);
+    int LoadJournal(const char* key, void* records, size_t record_size, int max_count);
+    static void HeaderKey(const char* key, char* out, size_t size);
+    static void JournalKey(const char* key, char* out, size_t size);
+    static void SlotKey(const char* key, int slot, char* out, size_t size);
+    static uint32_t HashRecord(const void* record, size_t size);
+
+    std::vector<SlotState> states_;
+};
+
+#endif // MEMORY_RECORD_STORE_H
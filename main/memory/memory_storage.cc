@@ -1,6 +1,7 @@
 #include "memory_storage.h"
 #include "memory_archive.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <cstring>
 #include <ctime>
 #include <algorithm>
@@ -46,13 +47,118 @@ int MemoryStorage::Init() {
         return -1;
     }
 
+    blob_store_.Bind(nvs_handle_);
+    slot_store_.Bind(nvs_handle_);
+#if CONFIG_MEMORY_STORAGE_LAYOUT_BLOB
+    store_ = &blob_store_;
+#else
+    store_ = &slot_store_;
+#endif
+    MigrateLayout();
+
     initialized_ = true;
-    ESP_LOGI(TAG, "Memory storage initialized");
+    ESP_LOGI(TAG, "Memory storage initialized (%s layout)", store_->GetName());
     return 0;
 }
 
+void MemoryStorage::MigrateLayout() {
+    // Move each record category written by the other backend into the active
+    // one. The old keys are only erased after the new copy is written.
+    MemoryRecordStore* from = (store_ == &slot_store_) ? (MemoryRecordStore*)&blob_store_
+                                                        : (MemoryRecordStore*)&slot_store_;
+    struct Category {
+        const char* key;
+        size_t record_size;
+        int max_count;
+    };
+    const Category categories[] = {
+        {KEY_FAMILY, sizeof(FamilyMember), MAX_FAMILY_MEMBERS},
+        {KEY_EVENTS, sizeof(Event), MAX_EVENTS},
+        {KEY_FACTS, sizeof(Fact), MAX_FACTS},
+        {KEY_TRAITS, sizeof(Trait), MAX_TRAITS},
+        {KEY_HABITS, sizeof(Habit), MAX_HABITS},
+        {KEY_MOMENTS, sizeof(SpecialMoment), MAX_MOMENTS},
+        {KEY_GOALS, sizeof(PersonalGoal), MAX_GOALS},
+    };
+
+    size_t buffer_size = 0;
+    for (const auto& category : categories) {
+        buffer_size = std::max(buffer_size, category.record_size * category.max_count);
+    }
+    std::vector<uint8_t> buffer;
+
+    int migrated = 0;
+    for (const auto& category : categories) {
+        if (!from->Exists(category.key)) {
+            continue;
+        }
+        if (store_->Exists(category.key)) {
+            ESP_LOGW(TAG, "%s exists in both layouts, keeping %s", category.key, store_->GetName());
+            from->Erase(category.key);
+            continue;
+        }
+        if (buffer.empty()) {
+            buffer.resize(buffer_size);
+        }
+        int count = from->Load(category.key, buffer.data(), category.record_size, category.max_count);
+        esp_err_t err = store_->Save(category.key, buffer.data(), category.record_size,
+                                     count, category.max_count);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to migrate %s: %s", category.key, esp_err_to_name(err));
+            continue;
+        }
+        from->Erase(category.key);
+        ESP_LOGI(TAG, "Migrated %d %s records from %s to %s layout",
+                 count, category.key, from->GetName(), store_->GetName());
+        migrated++;
+    }
+    if (migrated > 0) {
+        nvs_commit(nvs_handle_);
+    }
+}
+
 void MemoryStorage::Flush() {
     std::lock_guard<std::mutex> lock(mutex_);
+    FlushLocked();
+}
+
+void MemoryStorage::FlushIfDue() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_mutations_ > 0 && esp_timer_get_time() >= flush_deadline_us_) {
+        FlushLocked();
+    }
+}
+
+void MemoryStorage::ScheduleFlush() {
+    // Caller holds mutex_ and calls this after its change. The dirty flags already
+    // record what changed; just arm the deadline on the first mutation so the
+    // batch is bounded in time, and flush once it is bounded in size.
+    if (pending_mutations_ == 0) {
+        flush_deadline_us_ = esp_timer_get_time() + WRITE_BEHIND_DELAY_MS * 1000LL;
+    }
+    pending_mutations_++;
+    write_stats_.mutations++;
+    if (pending_mutations_ >= WRITE_BEHIND_MAX_MUTATIONS) {
+        FlushLocked();
+    }
+}
+
+bool MemoryStorage::HasPendingWrites() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_mutations_ > 0;
+}
+
+void MemoryStorage::FlushLocked() {
+    if (!initialized_) {
+        return;
+    }
+    // Nothing changed since the last flush: no commit, and nothing to count
+    if (pending_mutations_ == 0 && !AnyDirty()) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    uint32_t store_bytes = store_->GetBytesWritten();
 
     if (profile_dirty_) SaveProfile();
     if (family_dirty_) SaveFamily();
@@ -64,7 +170,47 @@ void MemoryStorage::Flush() {
     if (moments_dirty_) SaveMoments();
     if (goals_dirty_) SaveGoals();
 
-    nvs_commit(nvs_handle_);
+    esp_err_t err = nvs_commit(nvs_handle_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit: %s", esp_err_to_name(err));
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start);
+    write_stats_.bytes_written += store_->GetBytesWritten() - store_bytes;
+    if (err == ESP_OK) {
+        write_stats_.commits++;
+        if (pending_mutations_ > 1) {
+            write_stats_.commits_avoided += pending_mutations_ - 1;
+        }
+    }
+    write_stats_.last_flush_us = elapsed_us;
+    if (elapsed_us > write_stats_.max_flush_us) {
+        write_stats_.max_flush_us = elapsed_us;
+    }
+
+    ESP_LOGI(TAG, "Flushed %u mutations in %u us (commits: %u, avoided: %u, bytes: %u)",
+             (unsigned)pending_mutations_, (unsigned)elapsed_us,
+             (unsigned)write_stats_.commits, (unsigned)write_stats_.commits_avoided,
+             (unsigned)write_stats_.bytes_written);
+
+    // A failed save keeps its dirty flag and a failed commit leaves the batch
+    // unconfirmed: keep it pending and retry once the delay passes again
+    if (err != ESP_OK || AnyDirty()) {
+        pending_mutations_ = 1;
+        flush_deadline_us_ = esp_timer_get_time() + WRITE_BEHIND_DELAY_MS * 1000LL;
+    } else {
+        pending_mutations_ = 0;
+    }
+}
+
+bool MemoryStorage::AnyDirty() const {
+    return profile_dirty_ || family_dirty_ || prefs_dirty_ || events_dirty_ || facts_dirty_ ||
+           traits_dirty_ || habits_dirty_ || moments_dirty_ || goals_dirty_;
+}
+
+MemoryStorage::WriteBehindStats MemoryStorage::GetWriteBehindStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_stats_;
 }
 
 // ============== Profile ==============
@@ -88,6 +234,7 @@ void MemoryStorage::SaveProfile() {
 
     esp_err_t err = nvs_set_blob(nvs_handle_, KEY_PROFILE, &profile_cache_, sizeof(UserProfile));
     if (err == ESP_OK) {
+        write_stats_.bytes_written += sizeof(UserProfile);
         profile_dirty_ = false;
         ESP_LOGI(TAG, "Profile saved");
     } else {
@@ -143,8 +290,7 @@ AUDNAction MemoryStorage::UpdateProfile(const char* name, const char* birthday,
 
     if (changed) {
         profile_dirty_ = true;
-        SaveProfile();
-        nvs_commit(nvs_handle_);
+        ScheduleFlush();
         return AUDNAction::UPDATED;
     }
     return AUDNAction::NOOP;
@@ -166,10 +312,8 @@ void MemoryStorage::LoadFamily() {
     if (family_loaded_) return;
 
     FamilyMember members[MAX_FAMILY_MEMBERS];
-    size_t size = sizeof(members);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_FAMILY, members, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(FamilyMember);
+    int count = store_->Load(KEY_FAMILY, members, sizeof(FamilyMember), MAX_FAMILY_MEMBERS);
+    if (count > 0) {
         family_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(members[i].name) > 0) {
@@ -183,15 +327,10 @@ void MemoryStorage::LoadFamily() {
 void MemoryStorage::SaveFamily() {
     if (!family_dirty_) return;
 
-    if (family_cache_.empty()) {
-        nvs_erase_key(nvs_handle_, KEY_FAMILY);
-    } else {
-        esp_err_t err = nvs_set_blob(nvs_handle_, KEY_FAMILY,
-                                      family_cache_.data(),
-                                      family_cache_.size() * sizeof(FamilyMember));
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to save family: %s", esp_err_to_name(err));
-        }
+    esp_err_t err = store_->Save(KEY_FAMILY, family_cache_.data(), sizeof(FamilyMember),
+                                 family_cache_.size(), MAX_FAMILY_MEMBERS);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save family: %s", esp_err_to_name(err));
     }
     family_dirty_ = false;
 }
@@ -230,8 +369,7 @@ AUDNAction MemoryStorage::AddFamilyMember(const char* relation, const char* name
             if (closeness > 0) member.closeness = closeness;
             if (shared_memory) strncpy(member.shared_memory, shared_memory, sizeof(member.shared_memory) - 1);
             family_dirty_ = true;
-            SaveFamily();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             return AUDNAction::UPDATED;
         }
     }
@@ -252,8 +390,7 @@ AUDNAction MemoryStorage::AddFamilyMember(const char* relation, const char* name
 
     family_cache_.push_back(member);
     family_dirty_ = true;
-    SaveFamily();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added family member: %s (%s)", name, relation);
     return AUDNAction::ADDED;
@@ -269,8 +406,7 @@ AUDNAction MemoryStorage::UpdateFamilyMember(const char* name, uint8_t closeness
             if (closeness > 0) member.closeness = closeness;
             if (shared_memory) strncpy(member.shared_memory, shared_memory, sizeof(member.shared_memory) - 1);
             family_dirty_ = true;
-            SaveFamily();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             return AUDNAction::UPDATED;
         }
     }
@@ -285,8 +421,7 @@ AUDNAction MemoryStorage::RemoveFamilyMember(const char* name) {
         if (strcmp(it->name, name) == 0) {
             family_cache_.erase(it);
             family_dirty_ = true;
-            SaveFamily();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             ESP_LOGI(TAG, "Removed family member: %s", name);
             return AUDNAction::DELETED;
         }
@@ -313,6 +448,7 @@ void MemoryStorage::SavePrefs() {
 
     esp_err_t err = nvs_set_blob(nvs_handle_, KEY_PREFS, &prefs_cache_, sizeof(Preferences));
     if (err == ESP_OK) {
+        write_stats_.bytes_written += sizeof(Preferences);
         prefs_dirty_ = false;
     } else {
         ESP_LOGE(TAG, "Failed to save preferences: %s", esp_err_to_name(err));
@@ -358,8 +494,7 @@ AUDNAction MemoryStorage::AddPreference(const char* item, bool is_like) {
     }
 
     prefs_dirty_ = true;
-    SavePrefs();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
     ESP_LOGI(TAG, "Added preference: %s (%s)", item, is_like ? "like" : "dislike");
     return AUDNAction::ADDED;
 }
@@ -377,8 +512,7 @@ AUDNAction MemoryStorage::RemovePreference(const char* item, bool is_like) {
                 }
                 prefs_cache_.likes_count--;
                 prefs_dirty_ = true;
-                SavePrefs();
-                nvs_commit(nvs_handle_);
+                ScheduleFlush();
                 return AUDNAction::DELETED;
             }
         }
@@ -390,8 +524,7 @@ AUDNAction MemoryStorage::RemovePreference(const char* item, bool is_like) {
                 }
                 prefs_cache_.dislikes_count--;
                 prefs_dirty_ = true;
-                SavePrefs();
-                nvs_commit(nvs_handle_);
+                ScheduleFlush();
                 return AUDNAction::DELETED;
             }
         }
@@ -405,10 +538,8 @@ void MemoryStorage::LoadEvents() {
     if (events_loaded_) return;
 
     Event events[MAX_EVENTS];
-    size_t size = sizeof(events);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_EVENTS, events, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(Event);
+    int count = store_->Load(KEY_EVENTS, events, sizeof(Event), MAX_EVENTS);
+    if (count > 0) {
         events_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(events[i].content) > 0) {
@@ -498,8 +629,7 @@ AUDNAction MemoryStorage::AddEvent(const char* date, const char* event_type,
 
     events_cache_.push_back(event);
     events_dirty_ = true;
-    SaveEvents();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added event: %s - %s", date, event_type);
     return AUDNAction::ADDED;
@@ -513,8 +643,7 @@ AUDNAction MemoryStorage::MarkEventReminded(const char* date, const char* event_
         if (strcmp(event.date, date) == 0 && strcmp(event.event_type, event_type) == 0) {
             event.reminded = 1;
             events_dirty_ = true;
-            SaveEvents();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             return AUDNAction::UPDATED;
         }
     }
@@ -527,10 +656,8 @@ void MemoryStorage::LoadFacts() {
     if (facts_loaded_) return;
 
     Fact facts[MAX_FACTS];
-    size_t size = sizeof(facts);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_FACTS, facts, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(Fact);
+    int count = store_->Load(KEY_FACTS, facts, sizeof(Fact), MAX_FACTS);
+    if (count > 0) {
         facts_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(facts[i].content) > 0) {
@@ -544,15 +671,9 @@ void MemoryStorage::LoadFacts() {
 void MemoryStorage::SaveFacts() {
     if (!facts_dirty_) return;
 
-    esp_err_t err;
-    if (facts_cache_.empty()) {
-        err = nvs_erase_key(nvs_handle_, KEY_FACTS);
-    } else {
-        err = nvs_set_blob(nvs_handle_, KEY_FACTS,
-                           facts_cache_.data(),
-                           facts_cache_.size() * sizeof(Fact));
-    }
-    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+    esp_err_t err = store_->Save(KEY_FACTS, facts_cache_.data(), sizeof(Fact),
+                                 facts_cache_.size(), MAX_FACTS);
+    if (err == ESP_OK) {
         facts_dirty_ = false;
     } else {
         ESP_LOGE(TAG, "Failed to save facts: %s", esp_err_to_name(err));
@@ -622,8 +743,7 @@ AUDNAction MemoryStorage::AddFact(const char* content) {
 
     facts_cache_.push_back(fact);
     facts_dirty_ = true;
-    SaveFacts();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added fact: %s", content);
     return AUDNAction::ADDED;
@@ -635,10 +755,8 @@ void MemoryStorage::LoadTraits() {
     if (traits_loaded_) return;
 
     Trait traits[MAX_TRAITS];
-    size_t size = sizeof(traits);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_TRAITS, traits, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(Trait);
+    int count = store_->Load(KEY_TRAITS, traits, sizeof(Trait), MAX_TRAITS);
+    if (count > 0) {
         traits_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(traits[i].content) > 0) {
@@ -652,15 +770,9 @@ void MemoryStorage::LoadTraits() {
 void MemoryStorage::SaveTraits() {
     if (!traits_dirty_) return;
 
-    esp_err_t err;
-    if (traits_cache_.empty()) {
-        err = nvs_erase_key(nvs_handle_, KEY_TRAITS);
-    } else {
-        err = nvs_set_blob(nvs_handle_, KEY_TRAITS,
-                           traits_cache_.data(),
-                           traits_cache_.size() * sizeof(Trait));
-    }
-    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+    esp_err_t err = store_->Save(KEY_TRAITS, traits_cache_.data(), sizeof(Trait),
+                                 traits_cache_.size(), MAX_TRAITS);
+    if (err == ESP_OK) {
         traits_dirty_ = false;
     } else {
         ESP_LOGE(TAG, "Failed to save traits: %s", esp_err_to_name(err));
@@ -718,8 +830,7 @@ AUDNAction MemoryStorage::AddTrait(const char* category, const char* content) {
 
     traits_cache_.push_back(trait);
     traits_dirty_ = true;
-    SaveTraits();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added trait: %s - %s", category, content);
     return AUDNAction::ADDED;
@@ -733,8 +844,7 @@ AUDNAction MemoryStorage::RemoveTrait(const char* content) {
         if (strcmp(it->content, content) == 0) {
             traits_cache_.erase(it);
             traits_dirty_ = true;
-            SaveTraits();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             return AUDNAction::DELETED;
         }
     }
@@ -747,10 +857,8 @@ void MemoryStorage::LoadHabits() {
     if (habits_loaded_) return;
 
     Habit habits[MAX_HABITS];
-    size_t size = sizeof(habits);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_HABITS, habits, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(Habit);
+    int count = store_->Load(KEY_HABITS, habits, sizeof(Habit), MAX_HABITS);
+    if (count > 0) {
         habits_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(habits[i].content) > 0) {
@@ -764,15 +872,9 @@ void MemoryStorage::LoadHabits() {
 void MemoryStorage::SaveHabits() {
     if (!habits_dirty_) return;
 
-    esp_err_t err;
-    if (habits_cache_.empty()) {
-        err = nvs_erase_key(nvs_handle_, KEY_HABITS);
-    } else {
-        err = nvs_set_blob(nvs_handle_, KEY_HABITS,
-                           habits_cache_.data(),
-                           habits_cache_.size() * sizeof(Habit));
-    }
-    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+    esp_err_t err = store_->Save(KEY_HABITS, habits_cache_.data(), sizeof(Habit),
+                                 habits_cache_.size(), MAX_HABITS);
+    if (err == ESP_OK) {
         habits_dirty_ = false;
     } else {
         ESP_LOGE(TAG, "Failed to save habits: %s", esp_err_to_name(err));
@@ -813,8 +915,7 @@ AUDNAction MemoryStorage::AddHabit(const char* content, const char* frequency) {
 
     habits_cache_.push_back(habit);
     habits_dirty_ = true;
-    SaveHabits();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added habit: %s", content);
     return AUDNAction::ADDED;
@@ -828,8 +929,7 @@ AUDNAction MemoryStorage::RemoveHabit(const char* content) {
         if (strcmp(it->content, content) == 0) {
             habits_cache_.erase(it);
             habits_dirty_ = true;
-            SaveHabits();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             return AUDNAction::DELETED;
         }
     }
@@ -842,10 +942,8 @@ void MemoryStorage::LoadMoments() {
     if (moments_loaded_) return;
 
     SpecialMoment moments[MAX_MOMENTS];
-    size_t size = sizeof(moments);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_MOMENTS, moments, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(SpecialMoment);
+    int count = store_->Load(KEY_MOMENTS, moments, sizeof(SpecialMoment), MAX_MOMENTS);
+    if (count > 0) {
         moments_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(moments[i].content) > 0) {
@@ -859,15 +957,9 @@ void MemoryStorage::LoadMoments() {
 void MemoryStorage::SaveMoments() {
     if (!moments_dirty_) return;
 
-    esp_err_t err;
-    if (moments_cache_.empty()) {
-        err = nvs_erase_key(nvs_handle_, KEY_MOMENTS);
-    } else {
-        err = nvs_set_blob(nvs_handle_, KEY_MOMENTS,
-                           moments_cache_.data(),
-                           moments_cache_.size() * sizeof(SpecialMoment));
-    }
-    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+    esp_err_t err = store_->Save(KEY_MOMENTS, moments_cache_.data(), sizeof(SpecialMoment),
+                                 moments_cache_.size(), MAX_MOMENTS);
+    if (err == ESP_OK) {
         moments_dirty_ = false;
     } else {
         ESP_LOGE(TAG, "Failed to save moments: %s", esp_err_to_name(err));
@@ -936,8 +1028,7 @@ AUDNAction MemoryStorage::AddMoment(const char* topic, const char* content,
 
     moments_cache_.push_back(moment);
     moments_dirty_ = true;
-    SaveMoments();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added moment: %s", topic);
     return AUDNAction::ADDED;
@@ -949,10 +1040,8 @@ void MemoryStorage::LoadGoals() {
     if (goals_loaded_) return;
 
     PersonalGoal goals[MAX_GOALS];
-    size_t size = sizeof(goals);
-    esp_err_t err = nvs_get_blob(nvs_handle_, KEY_GOALS, goals, &size);
-    if (err == ESP_OK) {
-        int count = size / sizeof(PersonalGoal);
+    int count = store_->Load(KEY_GOALS, goals, sizeof(PersonalGoal), MAX_GOALS);
+    if (count > 0) {
         goals_cache_.clear();
         for (int i = 0; i < count; i++) {
             if (strlen(goals[i].content) > 0) {
@@ -966,15 +1055,9 @@ void MemoryStorage::LoadGoals() {
 void MemoryStorage::SaveGoals() {
     if (!goals_dirty_) return;
 
-    esp_err_t err;
-    if (goals_cache_.empty()) {
-        err = nvs_erase_key(nvs_handle_, KEY_GOALS);
-    } else {
-        err = nvs_set_blob(nvs_handle_, KEY_GOALS,
-                           goals_cache_.data(),
-                           goals_cache_.size() * sizeof(PersonalGoal));
-    }
-    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+    esp_err_t err = store_->Save(KEY_GOALS, goals_cache_.data(), sizeof(PersonalGoal),
+                                 goals_cache_.size(), MAX_GOALS);
+    if (err == ESP_OK) {
         goals_dirty_ = false;
     } else {
         ESP_LOGE(TAG, "Failed to save goals: %s", esp_err_to_name(err));
@@ -1037,8 +1120,7 @@ AUDNAction MemoryStorage::AddGoal(const char* content, uint8_t category, uint8_t
 
     goals_cache_.push_back(goal);
     goals_dirty_ = true;
-    SaveGoals();
-    nvs_commit(nvs_handle_);
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added goal: %s", content);
     return AUDNAction::ADDED;
@@ -1054,8 +1136,7 @@ AUDNAction MemoryStorage::UpdateGoal(const char* content, uint8_t progress, uint
             goal.status = status;
             goal.updated = time(nullptr);
             goals_dirty_ = true;
-            SaveGoals();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             return AUDNAction::UPDATED;
         }
     }
@@ -1167,6 +1248,7 @@ bool MemoryStorage::EraseAll() {
         return false;
     }
     nvs_commit(nvs_handle_);
+    store_->Reset();
 
     // Clear cache
     memset(&profile_cache_, 0, sizeof(profile_cache_));
@@ -1199,6 +1281,8 @@ bool MemoryStorage::EraseAll() {
     goals_loaded_ = false;
     goals_dirty_ = false;
 
+    pending_mutations_ = 0;
+
     ESP_LOGI(TAG, "All memory data erased");
     return true;
 }
@@ -1216,8 +1300,8 @@ bool MemoryStorage::AddEvent(const Event& event) {
     events_cache_.push_back(event);
     events_dirty_ = true;
 
-    // 立即保存
-    SaveEvents();
+    // 延迟写回，由 FlushIfDue()/Flush() 合并提交
+    ScheduleFlush();
 
     ESP_LOGI(TAG, "Added %s: %s at %s %s",
              IsSchedule(event) ? "schedule" : "event",
@@ -1243,7 +1327,7 @@ bool MemoryStorage::DeleteSchedule(const std::string& content) {
     if (it != events_cache_.end()) {
         events_cache_.erase(it, events_cache_.end());
         events_dirty_ = true;
-        SaveEvents();
+        ScheduleFlush();
         ESP_LOGI(TAG, "Deleted schedule: %s", content.c_str());
         return true;
     }
@@ -1256,16 +1340,9 @@ void MemoryStorage::SaveEvents() {
 
     // NOTE: Caller must hold mutex_! This method uses the class nvs_handle_.
 
-    esp_err_t err;
-
-    // 保存 events 数组
-    if (!events_cache_.empty()) {
-        err = nvs_set_blob(nvs_handle_, KEY_EVENTS, events_cache_.data(),
-                           events_cache_.size() * sizeof(Event));
-    } else {
-        // 清空数据
-        err = nvs_erase_key(nvs_handle_, KEY_EVENTS);
-    }
+    // 保存 events 数组（为空时清空数据）
+    esp_err_t err = store_->Save(KEY_EVENTS, events_cache_.data(), sizeof(Event),
+                                 events_cache_.size(), MAX_EVENTS);
 
     if (err == ESP_OK) {
         events_dirty_ = false;
@@ -1306,7 +1383,7 @@ void MemoryStorage::AutoCleanCompletedSchedules() {
         size_t removed = std::distance(it, events_cache_.end());
         events_cache_.erase(it, events_cache_.end());
         events_dirty_ = true;
-        SaveEvents();
+        ScheduleFlush();
         ESP_LOGI(TAG, "Auto-cleaned %d completed schedules", (int)removed);
     }
 }
@@ -1358,7 +1435,7 @@ bool MemoryStorage::MarkScheduleReminded(const std::string& content) {
             strcmp(event.content, content.c_str()) == 0) {
             event.reminded = 1;
             events_dirty_ = true;
-            SaveEvents();
+            ScheduleFlush();
             ESP_LOGI(TAG, "Marked schedule as reminded: %s", content.c_str());
             return true;
         }
@@ -1381,8 +1458,7 @@ bool MemoryStorage::CompleteSchedule(const std::string& content) {
 
             SetCompleted(event, true);
             events_dirty_ = true;
-            SaveEvents();
-            nvs_commit(nvs_handle_);
+            ScheduleFlush();
             ESP_LOGI(TAG, "Completed schedule: %s", content.c_str());
             return true;
         }
@@ -1456,7 +1532,7 @@ void MemoryStorage::GenerateNextRepeatSchedule(const Event& completed_event) {
     if (events_cache_.size() < MAX_EVENTS) {
         events_cache_.push_back(next_event);
         events_dirty_ = true;
-        SaveEvents();
+        ScheduleFlush();
         ESP_LOGI(TAG, "Generated next repeat schedule: '%s' at %s %s",
                  next_event.content, next_event.date, next_event.time);
     } else {
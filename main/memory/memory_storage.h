@@ -2,6 +2,7 @@
 #define MEMORY_STORAGE_H
 
 #include "memory_types.h"
+#include "memory_record_store.h"
 #include <string>
 #include <vector>
 #include <mutex>
@@ -103,7 +104,26 @@ public:
 
     // Data management
     bool EraseAll();
+
+    // Write-behind: mutators only update the cache and mark categories dirty;
+    // the dirty blobs are written and committed together by Flush().
+    // FlushIfDue() flushes once WRITE_BEHIND_DELAY_MS has passed since the
+    // first pending mutation, and a batch is flushed early once it reaches
+    // WRITE_BEHIND_MAX_MUTATIONS. A flush that fails to save or commit stays
+    // pending and is retried after another delay. Call Flush() before sleep,
+    // reboot or OTA.
+    struct WriteBehindStats {
+        uint32_t mutations;         // Mutations that requested a save
+        uint32_t commits;           // Successful flushes (nvs_commit calls)
+        uint32_t commits_avoided;   // Mutations coalesced into another flush
+        uint32_t last_flush_us;
+        uint32_t max_flush_us;
+        uint32_t bytes_written;     // Payload bytes written to NVS
+    };
     void Flush();
+    void FlushIfDue();
+    bool HasPendingWrites();
+    WriteBehindStats GetWriteBehindStats();
 
 private:
     MemoryStorage() = default;
@@ -113,6 +133,11 @@ private:
     std::mutex mutex_;
     bool initialized_ = false;
 
+    // Record array backends; store_ points at the one selected in Kconfig
+    BlobRecordStore blob_store_;
+    SlotRecordStore slot_store_;
+    MemoryRecordStore* store_ = &blob_store_;
+
     // Cache
     UserProfile profile_cache_;
     std::vector<FamilyMember> family_cache_;
@@ -144,7 +169,20 @@ private:
     bool goals_loaded_ = false;
     bool goals_dirty_ = false;
 
+    // Write-behind state
+    static constexpr int WRITE_BEHIND_DELAY_MS = 5000;
+    // At most one record changes per mutation, so a batch fits the slot layout's
+    // spare slots and is saved without a journal
+    static constexpr uint32_t WRITE_BEHIND_MAX_MUTATIONS = MEMORY_SLOT_SPARE;
+    uint32_t pending_mutations_ = 0;
+    int64_t flush_deadline_us_ = 0;
+    WriteBehindStats write_stats_ = {};
+
     // Internal methods
+    void MigrateLayout();
+    void ScheduleFlush();
+    void FlushLocked();
+    bool AnyDirty() const;
     void LoadProfile();
     void SaveProfile();
     void LoadFamily();
@@ -183,7 +183,8 @@ uint32_t ScheduleManager::AddSchedule(const char* time_str, const char* content,
     dirty_ = true;
 
     // Format time for logging
-    struct tm* tm_info = localtime((time_t*)&trigger_time);
+    time_t trigger = trigger_time;
+    struct tm* tm_info = localtime(&trigger);
     char time_buf[32];
     strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M", tm_info);
 
@@ -0,0 +1,155 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Wire formats of binary audio frames (all fields big-endian):
+ * - WebSocket protocol version 2 and 3: BinaryProtocol2 / BinaryProtocol3 header + Opus
+ * - MQTT + UDP: 16-byte header (also the AES-CTR nonce) + encrypted Opus
+ *   |type 1u|flags 1u|payload_len 2u|ssrc 4u|timestamp 4u|sequence 4u|payload|
+ *
+ * The parsers below read a received frame where the transport left it: header
+ * fields are decoded into an AudioFrameView and the payload is a pointer into the
+ * same buffer, so the only copy left is the one into the pooled packet (for UDP,
+ * AES-CTR writes the plaintext straight there). The buffer is never modified; it
+ * belongs to the transport and is only valid during the receive callback.
+ */
+
+struct BinaryProtocol2 {
+    uint16_t version;
+    uint16_t type;          // Message type (0: OPUS, 1: JSON)
+    uint32_t reserved;      // Reserved for future use
+    uint32_t timestamp;     // Timestamp in milliseconds (used for server-side AEC)
+    uint32_t payload_size;  // Payload size in bytes
+    uint8_t payload[];      // Payload data
+} __attribute__((packed));
+
+struct BinaryProtocol3 {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t payload_size;
+    uint8_t payload[];
+} __attribute__((packed));
+
+#define UDP_AUDIO_HEADER_SIZE   16
+#define UDP_AUDIO_PACKET_TYPE   0x01
+
+/*
+ * Uplink audio batching, negotiated in the hello messages: the device offers
+ * features.audio_batch = AUDIO_BATCH_MAX_FRAMES, the server turns it on by
+ * answering with the most frames it accepts per message. Consecutive frames that
+ * queued up are then sent as one message: BinaryProtocol2/3 type AUDIO_BATCH_TYPE,
+ * or a UDP packet of type UDP_AUDIO_BATCH_PACKET_TYPE whose sequence number is the
+ * first frame's (each frame still uses one). The outer timestamp is the first
+ * frame's. Payload:
+ *   |count 1u|count x (timestamp 4u|length 2u)|frame 1|frame 2|...|
+ */
+#define AUDIO_BATCH_MAX_FRAMES          8
+#define AUDIO_BATCH_MAX_BYTES           1200    // Keeps a UDP datagram below the path MTU
+#define AUDIO_BATCH_TYPE                2
+#define UDP_AUDIO_BATCH_PACKET_TYPE     0x02
+#define AUDIO_BATCH_ENTRY_SIZE          6
+
+// One received audio frame: header fields in host order, payload inside the receive buffer
+struct AudioFrameView {
+    uint32_t timestamp = 0;
+    uint32_t sequence = 0;              // UDP only
+    const uint8_t* payload = nullptr;
+    size_t payload_size = 0;
+};
+
+static inline uint16_t ReadBigEndian16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t ReadBigEndian32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void WriteBigEndian16(uint8_t* p, uint16_t value) {
+    p[0] = value >> 8;
+    p[1] = value;
+}
+
+static inline void WriteBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+static inline size_t GetAudioBatchHeaderSize(size_t count) {
+    return 1 + AUDIO_BATCH_ENTRY_SIZE * count;
+}
+
+// Bytes needed for packets[0, count) as one batch payload
+template <typename PacketPtr>
+static inline size_t GetAudioBatchSize(const PacketPtr* packets, size_t count) {
+    size_t size = GetAudioBatchHeaderSize(count);
+    for (size_t i = 0; i < count; i++) {
+        size += packets[i]->payload.size();
+    }
+    return size;
+}
+
+// Write packets[0, count) (anything with timestamp and payload) as a batch payload at out,
+// which has GetAudioBatchSize() bytes; returns that size
+template <typename PacketPtr>
+static inline size_t WriteAudioBatch(uint8_t* out, const PacketPtr* packets, size_t count) {
+    uint8_t* entry = out + 1;
+    uint8_t* frame = out + GetAudioBatchHeaderSize(count);
+    out[0] = count;
+    for (size_t i = 0; i < count; i++) {
+        const auto& payload = packets[i]->payload;
+        WriteBigEndian32(entry, packets[i]->timestamp);
+        WriteBigEndian16(entry + 4, payload.size());
+        entry += AUDIO_BATCH_ENTRY_SIZE;
+        memcpy(frame, payload.data(), payload.size());
+        frame += payload.size();
+    }
+    return frame - out;
+}
+
+// WebSocket binary frame; versions other than 2 and 3 carry bare Opus
+// Returns false when the header is truncated or claims more payload than was received
+static inline bool ParseWebsocketAudioFrame(int version, const uint8_t* data, size_t size, AudioFrameView& frame) {
+    frame = AudioFrameView();
+    if (version == 2) {
+        if (size < sizeof(BinaryProtocol2)) {
+            return false;
+        }
+        frame.timestamp = ReadBigEndian32(data + offsetof(BinaryProtocol2, timestamp));
+        frame.payload_size = ReadBigEndian32(data + offsetof(BinaryProtocol2, payload_size));
+        frame.payload = data + sizeof(BinaryProtocol2);
+        return frame.payload_size <= size - sizeof(BinaryProtocol2);
+    } else if (version == 3) {
+        if (size < sizeof(BinaryProtocol3)) {
+            return false;
+        }
+        frame.payload_size = ReadBigEndian16(data + offsetof(BinaryProtocol3, payload_size));
+        frame.payload = data + sizeof(BinaryProtocol3);
+        return frame.payload_size <= size - sizeof(BinaryProtocol3);
+    }
+    frame.payload = data;
+    frame.payload_size = size;
+    return true;
+}
+
+// UDP audio packet; the payload is still encrypted, with the header as the nonce
+// The payload runs to the end of the datagram (payload_len is not relied on)
+static inline bool ParseUdpAudioPacket(const uint8_t* data, size_t size, AudioFrameView& frame) {
+    frame = AudioFrameView();
+    if (size < UDP_AUDIO_HEADER_SIZE || data[0] != UDP_AUDIO_PACKET_TYPE) {
+        return false;
+    }
+    frame.timestamp = ReadBigEndian32(data + 8);
+    frame.sequence = ReadBigEndian32(data + 12);
+    frame.payload = data + UDP_AUDIO_HEADER_SIZE;
+    frame.payload_size = size - UDP_AUDIO_HEADER_SIZE;
+    return true;
+}
+
+#endif // BINARY_PROTOCOL_H
@@ -2,18 +2,15 @@
 #include "board.h"
 #include "application.h"
 #include "settings.h"
+#include "audio_buffer_pool.h"
 
 #include <esp_log.h>
 #include <cstring>
-#include <arpa/inet.h>
+#include <algorithm>
 #include "assets/lang_config.h"
 
 #define TAG "MQTT"
 
-// Sequence number validation constants
-#define MAX_ACCEPTABLE_SEQUENCE_GAP 5      // 允许的小间隙（UDP 丢包/乱序是正常的）
-#define MAX_SEQUENCE_GAP_FOR_RESET 100     // 超过此值认为是会话重启或严重网络问题
-
 // Valid audio sample rates
 static const uint32_t VALID_SAMPLE_RATES[] = {8000, 12000, 16000, 24000, 48000};
 
@@ -45,6 +42,16 @@ MqttProtocol::MqttProtocol() {
         .arg = this,
     };
     esp_timer_create(&reconnect_timer_args, &reconnect_timer_);
+
+    // 抖动缓冲区等待超时：放行已到期的音频包
+    esp_timer_create_args_t jitter_timer_args = {
+        .callback = [](void* arg) {
+            ((MqttProtocol*)arg)->PollJitterBuffer();
+        },
+        .arg = this,
+        .name = "jitter_buffer",
+    };
+    esp_timer_create(&jitter_timer_args, &jitter_timer_);
 }
 
 MqttProtocol::~MqttProtocol() {
@@ -57,6 +64,10 @@ MqttProtocol::~MqttProtocol() {
         esp_timer_stop(reconnect_timer_);
         esp_timer_delete(reconnect_timer_);
     }
+    if (jitter_timer_ != nullptr) {
+        esp_timer_stop(jitter_timer_);
+        esp_timer_delete(jitter_timer_);
+    }
 
     udp_.reset();
     mqtt_.reset();
@@ -112,24 +123,28 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
     });
 
     mqtt_->OnMessage([this](const std::string& topic, const std::string& payload) {
-        cJSON* root = cJSON_Parse(payload.c_str());
-        if (root == nullptr) {
+        // Flat control messages are read without building a DOM
+        if (!ParseServerMessage(payload.data(), payload.size(), server_message_)) {
             ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
             return;
         }
-        cJSON* type = cJSON_GetObjectItem(root, "type");
-        if (!cJSON_IsString(type)) {
-            ESP_LOGE(TAG, "Message type is invalid");
-            cJSON_Delete(root);
-            return;
-        }
 
-        if (strcmp(type->valuestring, "hello") == 0) {
-            ParseServerHello(root);
-        } else if (strcmp(type->valuestring, "goodbye") == 0) {
-            auto session_id = cJSON_GetObjectItem(root, "session_id");
-            ESP_LOGI(TAG, "Received goodbye message, session_id: %s", session_id ? session_id->valuestring : "null");
-            if (session_id == nullptr || session_id_ == session_id->valuestring) {
+        if (server_message_.needs_json) {
+            cJSON* root = cJSON_ParseWithLength(payload.data(), payload.size());
+            if (root == nullptr) {
+                ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
+                return;
+            }
+            if (server_message_.type == kServerMessageHello) {
+                ParseServerHello(root);
+            } else if (on_incoming_json_ != nullptr) {
+                on_incoming_json_(root);
+            }
+            cJSON_Delete(root);
+        } else if (server_message_.type == kServerMessageGoodbye) {
+            const auto& session_id = server_message_.session_id;
+            ESP_LOGI(TAG, "Received goodbye message, session_id: %s", session_id.empty() ? "null" : session_id.c_str());
+            if (session_id.empty() || session_id_ == session_id) {
                 auto alive = alive_;  // Capture alive flag
                 Application::GetInstance().Schedule([this, alive]() {
                     if (*alive) {
@@ -137,10 +152,9 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
                     }
                 });
             }
-        } else if (on_incoming_json_ != nullptr) {
-            on_incoming_json_(root);
+        } else if (on_incoming_message_ != nullptr) {
+            on_incoming_message_(server_message_);
         }
-        cJSON_Delete(root);
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
 
@@ -182,30 +196,80 @@ bool MqttProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
         return false;
     }
 
-    std::string nonce(aes_nonce_);
-    *(uint16_t*)&nonce[2] = htons(packet->payload.size());
-    *(uint32_t*)&nonce[8] = htonl(packet->timestamp);
-    *(uint32_t*)&nonce[12] = htonl(++local_sequence_);
+    // Header written in place, payload encrypted straight behind it: no allocation per packet
+    size_t payload_size = packet->payload.size();
+    send_buffer_.resize(UDP_AUDIO_HEADER_SIZE + payload_size);
+    return EncryptAndSend(UDP_AUDIO_PACKET_TYPE, packet->timestamp, 1, packet->payload.data(), payload_size);
+}
 
-    std::string encrypted;
-    encrypted.resize(aes_nonce_.size() + packet->payload.size());
-    memcpy(encrypted.data(), nonce.data(), nonce.size());
+bool MqttProtocol::SendAudioBatch(std::unique_ptr<AudioStreamPacket>* packets, size_t count) {
+    if (count == 1 || audio_batch_frames_ <= 1) {
+        return Protocol::SendAudioBatch(packets, count);
+    }
+    std::lock_guard<std::mutex> lock(channel_mutex_);
+    if (udp_ == nullptr) {
+        return false;
+    }
 
+    // All frames in one datagram; the batch is assembled behind the header and encrypted in place
+    size_t payload_size = GetAudioBatchSize(packets, count);
+    send_buffer_.resize(UDP_AUDIO_HEADER_SIZE + payload_size);
+    auto payload = (uint8_t*)send_buffer_.data() + UDP_AUDIO_HEADER_SIZE;
+    WriteAudioBatch(payload, packets, count);
+    return EncryptAndSend(UDP_AUDIO_BATCH_PACKET_TYPE, packets[0]->timestamp, count, payload, payload_size);
+}
+
+// Fill in the header of send_buffer_ (already sized), encrypt input behind it and send
+// input may be the payload area itself. Called with channel_mutex_ held
+bool MqttProtocol::EncryptAndSend(uint8_t type, uint32_t timestamp, size_t frames, const uint8_t* input, size_t size) {
+    auto header = (uint8_t*)send_buffer_.data();
+    memcpy(header, aes_nonce_.data(), UDP_AUDIO_HEADER_SIZE);
+    header[0] = type;
+    WriteBigEndian16(header + 2, size);
+    WriteBigEndian32(header + 8, timestamp);
+    WriteBigEndian32(header + 12, local_sequence_ + 1);
+    local_sequence_ += frames;  // Every frame keeps its own sequence number
+
+    // mbedtls advances the counter in the nonce it is given, so the header keeps a copy
     size_t nc_off = 0;
+    uint8_t nonce[UDP_AUDIO_HEADER_SIZE];
     uint8_t stream_block[16] = {0};
-    if (mbedtls_aes_crypt_ctr(&aes_ctx_, packet->payload.size(), &nc_off, (uint8_t*)nonce.c_str(), stream_block,
-        (uint8_t*)packet->payload.data(), (uint8_t*)&encrypted[nonce.size()]) != 0) {
+    memcpy(nonce, header, sizeof(nonce));
+    int64_t start_time = esp_timer_get_time();
+    if (mbedtls_aes_crypt_ctr(&aes_ctx_, size, &nc_off, nonce, stream_block,
+        input, header + UDP_AUDIO_HEADER_SIZE) != 0) {
         ESP_LOGE(TAG, "Failed to encrypt audio data");
         return false;
     }
+    uint32_t encrypt_us = esp_timer_get_time() - start_time;
+    encrypt_packets_++;
+    encrypt_total_us_ += encrypt_us;
+    encrypt_max_us_ = std::max(encrypt_max_us_, encrypt_us);
 
-    return udp_->Send(encrypted) > 0;
+    return udp_->Send(send_buffer_) > 0;
 }
 
 void MqttProtocol::CloseAudioChannel() {
     {
         std::lock_guard<std::mutex> lock(channel_mutex_);
         udp_.reset();
+        if (encrypt_packets_ > 0) {
+            ESP_LOGI(TAG, "Uplink encrypt: %lu packets, avg %lu us, max %lu us", encrypt_packets_,
+                     (uint32_t)(encrypt_total_us_ / encrypt_packets_), encrypt_max_us_);
+        }
+        // Give the send buffer back until the next session
+        std::string().swap(send_buffer_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(jitter_mutex_);
+        esp_timer_stop(jitter_timer_);
+        auto& stats = jitter_buffer_.GetStats();
+        if (stats.received > 0) {
+            ESP_LOGI(TAG, "Jitter buffer: received=%lu reordered=%lu late=%lu dup=%lu concealed=%lu fec=%lu skipped=%lu resets=%lu jitter=%lums",
+                     stats.received, stats.reordered, stats.late, stats.duplicates, stats.concealed,
+                     stats.recovered, stats.skipped, stats.resets, jitter_buffer_.GetJitterMs());
+        }
+        jitter_buffer_.Reset();
     }
 
     std::string message = "{";
@@ -244,7 +308,17 @@ bool MqttProtocol::OpenAudioChannel() {
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(jitter_mutex_);
+        jitter_buffer_.Reset();
+        jitter_buffer_.Configure(server_frame_duration_, server_fec_);
+    }
+
     std::lock_guard<std::mutex> lock(channel_mutex_);
+    send_buffer_.reserve(MQTT_SEND_BUFFER_SIZE);
+    encrypt_packets_ = 0;
+    encrypt_total_us_ = 0;
+    encrypt_max_us_ = 0;
     auto network = Board::GetInstance().GetNetwork();
     udp_ = network->CreateUdp(2);
     udp_->OnMessage([this](const std::string& data) {
@@ -253,63 +327,32 @@ bool MqttProtocol::OpenAudioChannel() {
          * |type 1u|flags 1u|payload_len 2u|ssrc 4u|timestamp 4u|sequence 4u|
          * |payload payload_len|
          */
-        if (data.size() < sizeof(aes_nonce_)) {
-            ESP_LOGE(TAG, "Invalid audio packet size: %u", data.size());
-            return;
-        }
-        if (data[0] != 0x01) {
-            ESP_LOGE(TAG, "Invalid audio packet type: %x", data[0]);
-            return;
-        }
-        uint32_t timestamp = ntohl(*(uint32_t*)&data[8]);
-        uint32_t sequence = ntohl(*(uint32_t*)&data[12]);
-
-        // 处理旧的/重复的包
-        if (sequence <= remote_sequence_) {
-            ESP_LOGD(TAG, "Received duplicate/old audio packet: seq=%lu, current=%lu (ignored)",
-                     sequence, remote_sequence_);
+        AudioFrameView frame;
+        if (!ParseUdpAudioPacket((const uint8_t*)data.data(), data.size(), frame)) {
+            ESP_LOGE(TAG, "Invalid audio packet: %u bytes, type %x", data.size(), data.empty() ? 0 : (uint8_t)data[0]);
             return;
         }
 
-        // 计算序列号间隙
-        uint32_t gap = sequence - remote_sequence_;
-
-        // 处理序列号间隙
-        if (gap > 1) {
-            if (gap <= MAX_ACCEPTABLE_SEQUENCE_GAP) {
-                // 小间隙：可能是 UDP 丢包或乱序 - 接受包
-                ESP_LOGD(TAG, "Small sequence gap detected: expected=%lu, received=%lu, gap=%lu (accepted)",
-                         remote_sequence_ + 1, sequence, gap - 1);
-            } else if (gap <= MAX_SEQUENCE_GAP_FOR_RESET) {
-                // 中等间隙：明显的丢包 - 警告但继续
-                ESP_LOGW(TAG, "Significant sequence gap: expected=%lu, received=%lu, gap=%lu (may cause audio glitch)",
-                         remote_sequence_ + 1, sequence, gap - 1);
-            } else {
-                // 大间隙：可能是会话重启或严重网络问题 - 重置序列号跟踪
-                ESP_LOGW(TAG, "Very large sequence gap: expected=%lu, received=%lu, gap=%lu (sequence tracking reset)",
-                         remote_sequence_ + 1, sequence, gap - 1);
-            }
-        }
-
-        size_t decrypted_size = data.size() - aes_nonce_.size();
+        // Decrypt straight from the datagram into the pooled payload: the only pass over the data
+        // The header is the nonce; mbedtls advances the counter in it, so it gets a copy
+        // (the datagram belongs to the transport)
         size_t nc_off = 0;
+        uint8_t nonce[UDP_AUDIO_HEADER_SIZE];
         uint8_t stream_block[16] = {0};
-        auto nonce = (uint8_t*)data.data();
-        auto encrypted = (uint8_t*)data.data() + aes_nonce_.size();
-        auto packet = std::make_unique<AudioStreamPacket>();
+        memcpy(nonce, data.data(), sizeof(nonce));
+        auto packet = AudioBufferPool::GetInstance().AcquirePacket();
         packet->sample_rate = server_sample_rate_;
         packet->frame_duration = server_frame_duration_;
-        packet->timestamp = timestamp;
-        packet->payload.resize(decrypted_size);
-        int ret = mbedtls_aes_crypt_ctr(&aes_ctx_, decrypted_size, &nc_off, nonce, stream_block, encrypted, (uint8_t*)packet->payload.data());
+        packet->timestamp = frame.timestamp;
+        packet->payload.resize(frame.payload_size);
+        int ret = mbedtls_aes_crypt_ctr(&aes_ctx_, frame.payload_size, &nc_off, nonce, stream_block,
+                                        frame.payload, packet->payload.data());
         if (ret != 0) {
             ESP_LOGE(TAG, "Failed to decrypt audio data, ret: %d", ret);
             return;
         }
-        if (on_incoming_audio_ != nullptr) {
-            on_incoming_audio_(std::move(packet));
-        }
-        remote_sequence_ = sequence;
+        // 乱序、丢包由抖动缓冲区处理
+        PushToJitterBuffer(frame.sequence, std::move(packet));
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
 
@@ -321,6 +364,52 @@ bool MqttProtocol::OpenAudioChannel() {
     return true;
 }
 
+void MqttProtocol::PushToJitterBuffer(uint32_t sequence, std::unique_ptr<AudioStreamPacket> packet) {
+    std::lock_guard<std::mutex> lock(jitter_mutex_);
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    auto result = jitter_buffer_.Push(sequence, std::move(packet), now_ms,
+        [this](std::unique_ptr<AudioStreamPacket> p) { EmitAudioPacket(std::move(p)); },
+        [this]() { return MakeLostAudioPacket(); });
+    if (result == JitterBuffer<AudioStreamPacket>::kPushLate) {
+        ESP_LOGD(TAG, "Late audio packet dropped: seq=%lu", sequence);
+    } else if (result == JitterBuffer<AudioStreamPacket>::kPushReset) {
+        ESP_LOGW(TAG, "Very large sequence gap: seq=%lu (sequence tracking reset)", sequence);
+    }
+    ScheduleJitterPoll(now_ms);
+}
+
+void MqttProtocol::PollJitterBuffer() {
+    std::lock_guard<std::mutex> lock(jitter_mutex_);
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    jitter_buffer_.Poll(now_ms,
+        [this](std::unique_ptr<AudioStreamPacket> p) { EmitAudioPacket(std::move(p)); },
+        [this]() { return MakeLostAudioPacket(); });
+    ScheduleJitterPoll(now_ms);
+}
+
+// Called with jitter_mutex_ held
+void MqttProtocol::ScheduleJitterPoll(uint32_t now_ms) {
+    esp_timer_stop(jitter_timer_);
+    int32_t wait_ms = jitter_buffer_.GetTimeToDeadline(now_ms);
+    if (wait_ms >= 0) {
+        esp_timer_start_once(jitter_timer_, (wait_ms > 0 ? wait_ms : 1) * 1000);
+    }
+}
+
+void MqttProtocol::EmitAudioPacket(std::unique_ptr<AudioStreamPacket> packet) {
+    if (on_incoming_audio_ != nullptr) {
+        on_incoming_audio_(std::move(packet));
+    }
+}
+
+std::unique_ptr<AudioStreamPacket> MqttProtocol::MakeLostAudioPacket() {
+    // Empty payload: the decoder conceals the frame
+    auto packet = AudioBufferPool::GetInstance().AcquirePacket();
+    packet->sample_rate = server_sample_rate_;
+    packet->frame_duration = server_frame_duration_;
+    return packet;
+}
+
 std::string MqttProtocol::GetHelloMessage() {
     // 发送 hello 消息申请 UDP 通道
     cJSON* root = cJSON_CreateObject();
@@ -332,6 +421,7 @@ std::string MqttProtocol::GetHelloMessage() {
     cJSON_AddBoolToObject(features, "aec", true);
 #endif
     cJSON_AddBoolToObject(features, "mcp", true);
+    AddAudioBatchFeature(features);
     cJSON_AddItemToObject(root, "features", features);
     cJSON* audio_params = cJSON_CreateObject();
     cJSON_AddStringToObject(audio_params, "format", "opus");
@@ -377,6 +467,9 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
             server_frame_duration_ = frame_duration->valueint;
             ESP_LOGI(TAG, "Server frame_duration set to %d ms", server_frame_duration_);
         }
+        // 服务器开启 Opus 带内 FEC 时，丢失的帧可以从下一个包恢复
+        auto fec = cJSON_GetObjectItem(audio_params, "fec");
+        server_fec_ = cJSON_IsTrue(fec);
     }
 
     auto udp = cJSON_GetObjectItem(root, "udp");
@@ -407,7 +500,7 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
     mbedtls_aes_init(&aes_ctx_);
     mbedtls_aes_setkey_enc(&aes_ctx_, (const unsigned char*)DecodeHexString(key).c_str(), 128);
     local_sequence_ = 0;
-    remote_sequence_ = 0;
+    ParseAudioBatchFeature(root);
     xEventGroupSetBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
 }
 
@@ -3,6 +3,7 @@
 
 
 #include "protocol.h"
+#include "jitter_buffer.h"
 #include <mqtt.h>
 #include <udp.h>
 #include <cJSON.h>
@@ -23,6 +24,8 @@
 
 #define MQTT_PROTOCOL_SERVER_HELLO_EVENT (1 << 0)
 
+#define MQTT_SEND_BUFFER_SIZE 512   // Header + one 60 ms Opus packet; grows if a packet is larger
+
 class MqttProtocol : public Protocol {
 public:
     MqttProtocol();
@@ -30,6 +33,7 @@ public:
 
     bool Start() override;
     bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) override;
+    bool SendAudioBatch(std::unique_ptr<AudioStreamPacket>* packets, size_t count) override;
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
@@ -50,13 +54,31 @@ private:
     std::string udp_server_;
     int udp_port_;
     uint32_t local_sequence_;
-    uint32_t remote_sequence_;
     esp_timer_handle_t reconnect_timer_;
 
+    // Uplink datagram (header + encrypted payload), reused for every packet while the channel is open
+    std::string send_buffer_;
+    uint32_t encrypt_packets_ = 0;
+    uint32_t encrypt_max_us_ = 0;
+    uint64_t encrypt_total_us_ = 0;
+
+    // Downlink reordering; the timer releases held packets once their wait is over
+    std::mutex jitter_mutex_;
+    JitterBuffer<AudioStreamPacket> jitter_buffer_;
+    esp_timer_handle_t jitter_timer_ = nullptr;
+    bool server_fec_ = false;
+
     bool StartMqttClient(bool report_error=false);
     void ParseServerHello(const cJSON* root);
     std::string DecodeHexString(const std::string& hex_string);
 
+    void PushToJitterBuffer(uint32_t sequence, std::unique_ptr<AudioStreamPacket> packet);
+    void PollJitterBuffer();
+    void ScheduleJitterPoll(uint32_t now_ms);
+    void EmitAudioPacket(std::unique_ptr<AudioStreamPacket> packet);
+    std::unique_ptr<AudioStreamPacket> MakeLostAudioPacket();
+
+    bool EncryptAndSend(uint8_t type, uint32_t timestamp, size_t frames, const uint8_t* input, size_t size);
     bool SendText(const std::string& text) override;
     std::string GetHelloMessage();
 };
@@ -1,6 +1,7 @@
 #include "protocol.h"
 
 #include <esp_log.h>
+#include <algorithm>
 
 #define TAG "Protocol"
 
@@ -8,6 +9,10 @@ void Protocol::OnIncomingJson(std::function<void(const cJSON* root)> callback) {
     on_incoming_json_ = callback;
 }
 
+void Protocol::OnIncomingMessage(std::function<void(const ServerMessage& message)> callback) {
+    on_incoming_message_ = callback;
+}
+
 void Protocol::OnIncomingAudio(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> callback) {
     on_incoming_audio_ = callback;
 }
@@ -99,3 +104,27 @@ bool Protocol::IsTimeout() const {
     }
     return timeout;
 }
+
+bool Protocol::SendAudioBatch(std::unique_ptr<AudioStreamPacket>* packets, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (!SendAudio(std::move(packets[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Protocol::AddAudioBatchFeature(cJSON* features) {
+    cJSON_AddNumberToObject(features, "audio_batch", AUDIO_BATCH_MAX_FRAMES);
+}
+
+void Protocol::ParseAudioBatchFeature(const cJSON* root) {
+    // Off unless the server answers with the most frames it accepts per message
+    audio_batch_frames_ = 1;
+    auto features = cJSON_GetObjectItem(root, "features");
+    auto audio_batch = cJSON_GetObjectItem(features, "audio_batch");
+    if (cJSON_IsNumber(audio_batch) && audio_batch->valueint > 1) {
+        audio_batch_frames_ = std::min(audio_batch->valueint, AUDIO_BATCH_MAX_FRAMES);
+        ESP_LOGI(TAG, "Audio batching enabled, up to %u frames per message", (unsigned)audio_batch_frames_);
+    }
+}
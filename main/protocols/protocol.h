@@ -7,28 +7,22 @@
 #include <chrono>
 #include <vector>
 
+#include "binary_protocol.h"
+#include "server_message.h"
+
+// Packets and their payload buffers are recycled by AudioBufferPool; create
+// them with AudioBufferPool::GetInstance().AcquirePacket()
 struct AudioStreamPacket {
     int sample_rate = 0;
     int frame_duration = 0;
     uint32_t timestamp = 0;
-    std::vector<uint8_t> payload;
-};
-
-struct BinaryProtocol2 {
-    uint16_t version;
-    uint16_t type;          // Message type (0: OPUS, 1: JSON)
-    uint32_t reserved;      // Reserved for future use
-    uint32_t timestamp;     // Timestamp in milliseconds (used for server-side AEC)
-    uint32_t payload_size;  // Payload size in bytes
-    uint8_t payload[];      // Payload data
-} __attribute__((packed));
+    std::vector<uint8_t> payload;   // Empty on the downlink: frame lost, conceal it
+    bool fec = false;               // Downlink: payload is the next packet, rebuild this frame from its FEC data
 
-struct BinaryProtocol3 {
-    uint8_t type;
-    uint8_t reserved;
-    uint16_t payload_size;
-    uint8_t payload[];
-} __attribute__((packed));
+    ~AudioStreamPacket();
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+};
 
 enum AbortReason {
     kAbortReasonNone,
@@ -56,7 +50,9 @@ public:
     }
 
     void OnIncomingAudio(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> callback);
+    // Messages that carry nested JSON (mcp, custom); the rest arrive through OnIncomingMessage()
     void OnIncomingJson(std::function<void(const cJSON* root)> callback);
+    void OnIncomingMessage(std::function<void(const ServerMessage& message)> callback);
     void OnAudioChannelOpened(std::function<void()> callback);
     void OnAudioChannelClosed(std::function<void()> callback);
     void OnNetworkError(std::function<void(const std::string& message)> callback);
@@ -68,6 +64,12 @@ public:
     virtual void CloseAudioChannel() = 0;
     virtual bool IsAudioChannelOpened() const = 0;
     virtual bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) = 0;
+    // Send consecutive uplink frames, as one message when the server accepted audio batching
+    virtual bool SendAudioBatch(std::unique_ptr<AudioStreamPacket>* packets, size_t count);
+    // Most frames SendAudioBatch() packs into one message (1 = batching off)
+    inline size_t audio_batch_frames() const {
+        return audio_batch_frames_;
+    }
     virtual void SendWakeWordDetected(const std::string& wake_word);
     virtual void SendStartListening(ListeningMode mode);
     virtual void SendStopListening();
@@ -77,6 +79,7 @@ public:
 
 protected:
     std::function<void(const cJSON* root)> on_incoming_json_;
+    std::function<void(const ServerMessage& message)> on_incoming_message_;
     std::function<void(std::unique_ptr<AudioStreamPacket> packet)> on_incoming_audio_;
     std::function<void()> on_audio_channel_opened_;
     std::function<void()> on_audio_channel_closed_;
@@ -86,13 +89,17 @@ protected:
 
     int server_sample_rate_ = 24000;
     int server_frame_duration_ = 60;
+    size_t audio_batch_frames_ = 1;
     bool error_occurred_ = false;
     std::string session_id_;
+    ServerMessage server_message_;  // Reused for every text message, on the transport's task
     std::chrono::time_point<std::chrono::steady_clock> last_incoming_time_;
 
     virtual bool SendText(const std::string& text) = 0;
     virtual void SetError(const std::string& message);
     virtual bool IsTimeout() const;
+    void AddAudioBatchFeature(cJSON* features);
+    void ParseAudioBatchFeature(const cJSON* root);
 };
 
 #endif // PROTOCOL_H
@@ -0,0 +1,356 @@
+#include "server_message.h"
+
+#include <cstring>
+
+namespace {
+
+// Collision-free over both tables below; a name shorter than 2 bytes is never one of ours
+inline size_t PerfectHash(const char* name, size_t length) {
+    return ((uint8_t)name[0] * 10 + (uint8_t)name[1] + length) & 15;
+}
+
+struct TypeEntry {
+    const char* name;
+    ServerMessageType type;
+    bool needs_json;
+};
+
+const TypeEntry kTypeTable[16] = {
+    { nullptr,   kServerMessageUnknown, false },    // 0
+    { nullptr,   kServerMessageUnknown, false },    // 1
+    { nullptr,   kServerMessageUnknown, false },    // 2
+    { nullptr,   kServerMessageUnknown, false },    // 3
+    { nullptr,   kServerMessageUnknown, false },    // 4
+    { "stt",     kServerMessageStt,     false },    // 5
+    { nullptr,   kServerMessageUnknown, false },    // 6
+    { "llm",     kServerMessageLlm,     false },    // 7
+    { "mcp",     kServerMessageMcp,     true  },    // 8
+    { "custom",  kServerMessageCustom,  true  },    // 9
+    { "hello",   kServerMessageHello,   true  },    // 10
+    { "alert",   kServerMessageAlert,   false },    // 11
+    { "goodbye", kServerMessageGoodbye, false },    // 12
+    { "system",  kServerMessageSystem,  false },    // 13
+    { nullptr,   kServerMessageUnknown, false },    // 14
+    { "tts",     kServerMessageTts,     false },    // 15
+};
+
+struct FieldEntry {
+    const char* name;
+    std::string ServerMessage::* field;
+};
+
+const FieldEntry kFieldTable[16] = {
+    { nullptr,      nullptr },                          // 0
+    { "text",       &ServerMessage::text },             // 1
+    { nullptr,      nullptr },                          // 2
+    { nullptr,      nullptr },                          // 3
+    { "command",    &ServerMessage::command },          // 4
+    { "type",       &ServerMessage::type_name },        // 5
+    { "emotion",    &ServerMessage::emotion },          // 6
+    { "state",      &ServerMessage::state },            // 7
+    { "status",     &ServerMessage::status },           // 8
+    { nullptr,      nullptr },                          // 9
+    { nullptr,      nullptr },                          // 10
+    { nullptr,      nullptr },                          // 11
+    { nullptr,      nullptr },                          // 12
+    { "session_id", &ServerMessage::session_id },       // 13
+    { "message",    &ServerMessage::message },          // 14
+    { nullptr,      nullptr },                          // 15
+};
+
+inline bool NameEquals(const char* entry, const char* name, size_t length) {
+    return entry != nullptr && strncmp(entry, name, length) == 0 && entry[length] == '\0';
+}
+
+const TypeEntry* LookupType(const char* name, size_t length) {
+    if (length < 2) {
+        return nullptr;
+    }
+    const TypeEntry& entry = kTypeTable[PerfectHash(name, length)];
+    return NameEquals(entry.name, name, length) ? &entry : nullptr;
+}
+
+std::string ServerMessage::* LookupField(const char* name, size_t length) {
+    if (length < 2) {
+        return nullptr;
+    }
+    const FieldEntry& entry = kFieldTable[PerfectHash(name, length)];
+    return NameEquals(entry.name, name, length) ? entry.field : nullptr;
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void AppendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out.push_back((char)code);
+    } else if (code < 0x800) {
+        out.push_back((char)(0xC0 | (code >> 6)));
+        out.push_back((char)(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back((char)(0xE0 | (code >> 12)));
+        out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back((char)(0xF0 | (code >> 18)));
+        out.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (code & 0x3F)));
+    }
+}
+
+class Reader {
+public:
+    Reader(const char* json, size_t length) : p_(json), end_(json + length) {}
+
+    bool AtEnd() const { return p_ >= end_; }
+    char Peek() const { return p_ < end_ ? *p_ : '\0'; }
+    void Advance() { p_++; }
+
+    void SkipSpace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            p_++;
+        }
+    }
+
+    // Raw span of a key without escapes; keys with escapes are never ours, so they come
+    // back as an empty span and the value is skipped
+    bool ReadKey(const char*& name, size_t& length) {
+        const char* start = ++p_;
+        bool escaped = false;
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ == '\\') {
+                escaped = true;
+                p_++;
+            }
+            p_++;
+        }
+        if (p_ >= end_) {
+            return false;
+        }
+        name = start;
+        length = escaped ? 0 : p_ - start;
+        p_++;
+        return true;
+    }
+
+    // Unescape the string at p_ into out, or just skip it when out is null
+    bool ReadString(std::string* out) {
+        p_++;
+        if (out != nullptr) {
+            out->clear();
+        }
+        while (p_ < end_) {
+            const char* run = p_;
+            while (p_ < end_ && *p_ != '"' && *p_ != '\\') {
+                p_++;
+            }
+            if (out != nullptr && p_ > run) {
+                out->append(run, p_ - run);
+            }
+            if (p_ >= end_) {
+                return false;
+            }
+            if (*p_ == '"') {
+                p_++;
+                return true;
+            }
+            if (++p_ >= end_) {
+                return false;
+            }
+            char c = *p_++;
+            if (out == nullptr) {
+                continue;
+            }
+            switch (c) {
+            case 'b': out->push_back('\b'); break;
+            case 'f': out->push_back('\f'); break;
+            case 'n': out->push_back('\n'); break;
+            case 'r': out->push_back('\r'); break;
+            case 't': out->push_back('\t'); break;
+            case 'u': {
+                uint32_t code;
+                if (!ReadHex4(code)) {
+                    return false;
+                }
+                // A surrogate pair is two escapes
+                if (code >= 0xD800 && code < 0xDC00 && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+                    const char* pair = p_;
+                    uint32_t low;
+                    p_ += 2;
+                    if (ReadHex4(low) && low >= 0xDC00 && low < 0xE000) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        p_ = pair;
+                    }
+                }
+                AppendUtf8(*out, code);
+                break;
+            }
+            default:    // '"', '\\', '/'
+                out->push_back(c);
+                break;
+            }
+        }
+        return false;
+    }
+
+    // Skip a value we do not read; nested objects and arrays only need balanced brackets
+    bool SkipValue() {
+        char c = Peek();
+        if (c == '"') {
+            return ReadString(nullptr);
+        }
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while (p_ < end_) {
+                c = *p_;
+                if (c == '"') {
+                    if (!ReadString(nullptr)) {
+                        return false;
+                    }
+                    continue;
+                }
+                p_++;
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if ((c == '}' || c == ']') && --depth == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        const char* start = p_;
+        while (p_ < end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' &&
+               *p_ != ' ' && *p_ != '\t' && *p_ != '\n' && *p_ != '\r') {
+            p_++;
+        }
+        return p_ > start;
+    }
+
+private:
+    bool ReadHex4(uint32_t& code) {
+        if (end_ - p_ < 4) {
+            return false;
+        }
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            int digit = HexValue(*p_++);
+            if (digit < 0) {
+                return false;
+            }
+            code = (code << 4) | digit;
+        }
+        return true;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+} // namespace
+
+ServerMessage::ServerMessage() {
+    text.reserve(SERVER_MESSAGE_TEXT_RESERVE);
+    for (auto field : { &ServerMessage::type_name, &ServerMessage::state, &ServerMessage::emotion,
+                        &ServerMessage::session_id, &ServerMessage::command, &ServerMessage::status,
+                        &ServerMessage::message }) {
+        (this->*field).reserve(SERVER_MESSAGE_FIELD_RESERVE);
+    }
+}
+
+void ServerMessage::Clear() {
+    type = kServerMessageUnknown;
+    needs_json = false;
+    type_name.clear();
+    state.clear();
+    text.clear();
+    emotion.clear();
+    session_id.clear();
+    command.clear();
+    status.clear();
+    message.clear();
+}
+
+ServerMessageType LookupServerMessageType(const char* name, size_t length) {
+    auto entry = LookupType(name, length);
+    return entry != nullptr ? entry->type : kServerMessageUnknown;
+}
+
+const char* GetServerMessageTypeName(ServerMessageType type) {
+    for (const auto& entry : kTypeTable) {
+        if (entry.name != nullptr && entry.type == type) {
+            return entry.name;
+        }
+    }
+    return "unknown";
+}
+
+bool ParseServerMessage(const char* json, size_t length, ServerMessage& message) {
+    message.Clear();
+    Reader reader(json, length);
+    reader.SkipSpace();
+    if (reader.Peek() != '{') {
+        return false;
+    }
+    reader.Advance();
+    reader.SkipSpace();
+
+    bool has_type = false;
+    if (reader.Peek() == '}') {
+        reader.Advance();
+    } else {
+        while (true) {
+            const char* name;
+            size_t name_length;
+            if (reader.Peek() != '"' || !reader.ReadKey(name, name_length)) {
+                return false;
+            }
+            reader.SkipSpace();
+            if (reader.Peek() != ':') {
+                return false;
+            }
+            reader.Advance();
+            reader.SkipSpace();
+
+            auto field = LookupField(name, name_length);
+            if (field != nullptr && reader.Peek() == '"') {
+                if (!reader.ReadString(&(message.*field))) {
+                    return false;
+                }
+                has_type = has_type || field == &ServerMessage::type_name;
+            } else if (!reader.SkipValue()) {
+                return false;
+            }
+
+            reader.SkipSpace();
+            if (reader.Peek() == ',') {
+                reader.Advance();
+                reader.SkipSpace();
+            } else if (reader.Peek() == '}') {
+                reader.Advance();
+                break;
+            } else {
+                return false;
+            }
+        }
+    }
+    reader.SkipSpace();
+    if (!reader.AtEnd() && reader.Peek() != '\0') {
+        return false;
+    }
+    if (!has_type) {
+        return false;
+    }
+
+    auto entry = LookupType(message.type_name.data(), message.type_name.size());
+    if (entry != nullptr) {
+        message.type = entry->type;
+        message.needs_json = entry->needs_json;
+    }
+    return true;
+}
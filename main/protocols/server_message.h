@@ -0,0 +1,67 @@
+#ifndef SERVER_MESSAGE_H
+#define SERVER_MESSAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Streaming reader for the JSON control messages the server sends on the text channel.
+ *
+ * Most of them are small, frequent and flat ({"type":"tts","state":"sentence_start",
+ * "text":"..."}), and only a couple of string fields are ever read. ParseServerMessage()
+ * walks the text once, unescapes the known top-level string fields into a ServerMessage
+ * whose buffers are reserved up front and reused, and skips everything else; no DOM is
+ * built and nothing is allocated once the buffers have grown to the messages seen.
+ *
+ * The message type and field names are looked up in perfect-hash tables. Types whose
+ * content is nested JSON (hello, mcp, custom) are marked as needing the DOM: for those the
+ * caller parses the text with cJSON as before.
+ *
+ * Nested values that are skipped are only checked for balanced brackets and strings.
+ * Portable, no ESP-IDF dependency (built on the host by scripts/json_dispatch_bench.cc).
+ */
+
+#define SERVER_MESSAGE_TEXT_RESERVE     512     // tts / stt sentences
+#define SERVER_MESSAGE_FIELD_RESERVE    32
+
+enum ServerMessageType : uint8_t {
+    kServerMessageUnknown,
+    kServerMessageHello,
+    kServerMessageGoodbye,
+    kServerMessageTts,
+    kServerMessageStt,
+    kServerMessageLlm,
+    kServerMessageMcp,
+    kServerMessageSystem,
+    kServerMessageAlert,
+    kServerMessageCustom,
+    kServerMessageTypeCount
+};
+
+struct ServerMessage {
+    ServerMessageType type = kServerMessageUnknown;
+    bool needs_json = false;    // Content is nested JSON: parse the text with cJSON
+    std::string type_name;
+    std::string state;
+    std::string text;
+    std::string emotion;
+    std::string session_id;
+    std::string command;
+    std::string status;
+    std::string message;
+
+    ServerMessage();
+    // Empty every field, keeping the buffers
+    void Clear();
+};
+
+// Type for a "type" string, kServerMessageUnknown if it is not one of ours
+ServerMessageType LookupServerMessageType(const char* name, size_t length);
+const char* GetServerMessageTypeName(ServerMessageType type);
+
+// Read json (length bytes, need not be NUL-terminated) into message. Returns false if it
+// is not a JSON object or has no string "type"
+bool ParseServerMessage(const char* json, size_t length, ServerMessage& message);
+
+#endif // SERVER_MESSAGE_H
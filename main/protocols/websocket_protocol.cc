@@ -3,6 +3,7 @@
 #include "system_info.h"
 #include "application.h"
 #include "settings.h"
+#include "audio_buffer_pool.h"
 
 #include <cstring>
 #include <cJSON.h>
@@ -67,6 +68,37 @@ bool WebsocketProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
     }
 }
 
+bool WebsocketProtocol::SendAudioBatch(std::unique_ptr<AudioStreamPacket>* packets, size_t count) {
+    if (count == 1 || audio_batch_frames_ <= 1) {
+        return Protocol::SendAudioBatch(packets, count);
+    }
+    if (websocket_ == nullptr || !websocket_->IsConnected()) {
+        return false;
+    }
+
+    // One binary message for all frames: a single TLS record and socket write
+    size_t batch_size = GetAudioBatchSize(packets, count);
+    std::string serialized;
+    if (version_ == 2) {
+        serialized.resize(sizeof(BinaryProtocol2) + batch_size);
+        auto bp2 = (BinaryProtocol2*)serialized.data();
+        bp2->version = htons(version_);
+        bp2->type = htons(AUDIO_BATCH_TYPE);
+        bp2->reserved = 0;
+        bp2->timestamp = htonl(packets[0]->timestamp);
+        bp2->payload_size = htonl(batch_size);
+        WriteAudioBatch(bp2->payload, packets, count);
+    } else {
+        serialized.resize(sizeof(BinaryProtocol3) + batch_size);
+        auto bp3 = (BinaryProtocol3*)serialized.data();
+        bp3->type = AUDIO_BATCH_TYPE;
+        bp3->reserved = 0;
+        bp3->payload_size = htons(batch_size);
+        WriteAudioBatch(bp3->payload, packets, count);
+    }
+    return websocket_->Send(serialized.data(), serialized.size(), true);
+}
+
 bool WebsocketProtocol::SendText(const std::string& text) {
     if (websocket_ == nullptr || !websocket_->IsConnected()) {
         return false;
@@ -121,59 +153,40 @@ bool WebsocketProtocol::OpenAudioChannel() {
     websocket_->OnData([this](const char* data, size_t len, bool binary) {
         if (binary) {
             if (on_incoming_audio_ != nullptr) {
-                if (version_ == 2) {
-                    BinaryProtocol2* bp2 = (BinaryProtocol2*)data;
-                    bp2->version = ntohs(bp2->version);
-                    bp2->type = ntohs(bp2->type);
-                    bp2->timestamp = ntohl(bp2->timestamp);
-                    bp2->payload_size = ntohl(bp2->payload_size);
-                    auto payload = (uint8_t*)bp2->payload;
-                    on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
-                        .sample_rate = server_sample_rate_,
-                        .frame_duration = server_frame_duration_,
-                        .timestamp = bp2->timestamp,
-                        .payload = std::vector<uint8_t>(payload, payload + bp2->payload_size)
-                    }));
-                } else if (version_ == 3) {
-                    BinaryProtocol3* bp3 = (BinaryProtocol3*)data;
-                    bp3->type = bp3->type;
-                    bp3->payload_size = ntohs(bp3->payload_size);
-                    auto payload = (uint8_t*)bp3->payload;
-                    on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
-                        .sample_rate = server_sample_rate_,
-                        .frame_duration = server_frame_duration_,
-                        .timestamp = 0,
-                        .payload = std::vector<uint8_t>(payload, payload + bp3->payload_size)
-                    }));
-                } else {
-                    on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
-                        .sample_rate = server_sample_rate_,
-                        .frame_duration = server_frame_duration_,
-                        .timestamp = 0,
-                        .payload = std::vector<uint8_t>((uint8_t*)data, (uint8_t*)data + len)
-                    }));
+                // Header read in place; the payload is copied once, into a pooled buffer
+                AudioFrameView frame;
+                if (!ParseWebsocketAudioFrame(version_, (const uint8_t*)data, len, frame)) {
+                    ESP_LOGE(TAG, "Invalid audio frame: %u bytes, version %d", len, version_);
+                    return;
                 }
+                auto packet = AudioBufferPool::GetInstance().AcquirePacket();
+                packet->sample_rate = server_sample_rate_;
+                packet->frame_duration = server_frame_duration_;
+                packet->timestamp = frame.timestamp;
+                packet->payload.assign(frame.payload, frame.payload + frame.payload_size);
+                on_incoming_audio_(std::move(packet));
             }
         } else {
-            // Parse JSON data
-            auto root = cJSON_Parse(data);
-            if (root == nullptr) {
-                ESP_LOGE(TAG, "Failed to parse JSON: %s", data);
+            // Flat control messages are read without building a DOM
+            if (!ParseServerMessage(data, len, server_message_)) {
+                ESP_LOGE(TAG, "Invalid message or missing type, data: %.*s", (int)len, data);
                 return;
             }
-            auto type = cJSON_GetObjectItem(root, "type");
-            if (cJSON_IsString(type)) {
-                if (strcmp(type->valuestring, "hello") == 0) {
+            if (server_message_.needs_json) {
+                auto root = cJSON_ParseWithLength(data, len);
+                if (root == nullptr) {
+                    ESP_LOGE(TAG, "Failed to parse JSON: %.*s", (int)len, data);
+                    return;
+                }
+                if (server_message_.type == kServerMessageHello) {
                     ParseServerHello(root);
-                } else {
-                    if (on_incoming_json_ != nullptr) {
-                        on_incoming_json_(root);
-                    }
+                } else if (on_incoming_json_ != nullptr) {
+                    on_incoming_json_(root);
                 }
-            } else {
-                ESP_LOGE(TAG, "Missing message type, data: %s", data);
+                cJSON_Delete(root);
+            } else if (on_incoming_message_ != nullptr) {
+                on_incoming_message_(server_message_);
             }
-            cJSON_Delete(root);
         }
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
@@ -223,6 +236,9 @@ std::string WebsocketProtocol::GetHelloMessage() {
     cJSON_AddBoolToObject(features, "aec", true);
 #endif
     cJSON_AddBoolToObject(features, "mcp", true);
+    if (version_ == 2 || version_ == 3) {
+        AddAudioBatchFeature(features);  // Needs a binary header to tell batches apart
+    }
     cJSON_AddItemToObject(root, "features", features);
     cJSON_AddStringToObject(root, "transport", "websocket");
     cJSON* audio_params = cJSON_CreateObject();
@@ -270,5 +286,10 @@ void WebsocketProtocol::ParseServerHello(const cJSON* root) {
         }
     }
 
+    ParseAudioBatchFeature(root);
+    if (version_ != 2 && version_ != 3) {
+        audio_batch_frames_ = 1;
+    }
+
     xEventGroupSetBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
 }
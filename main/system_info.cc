@@ -1,7 +1,9 @@
 #include "system_info.h"
+#include "audio_buffer_pool.h"
 
 #include <freertos/task.h>
 #include <esp_log.h>
+#include <cinttypes>
 #include <esp_flash.h>
 #include <esp_mac.h>
 #include <esp_system.h>
@@ -148,4 +150,13 @@ void SystemInfo::PrintHeapStats() {
     int free_sram = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
     int min_free_sram = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
     ESP_LOGI(TAG, "free sram: %u minimal sram: %u", free_sram, min_free_sram);
+
+    auto stats = AudioBufferPool::GetInstance().GetStats();
+    ESP_LOGI(TAG, "audio pool: %" PRIu32 " allocs, free pcm %" PRIu32 " opus %" PRIu32
+        ", in use packets %" PRIu32 " tasks %" PRIu32,
+        stats.allocations, stats.pcm_free, stats.opus_free, stats.packets_in_use, stats.tasks_in_use);
+}
+
+uint32_t SystemInfo::GetAudioAllocCount() {
+    return AudioBufferPool::GetInstance().GetStats().allocations;
 }
@@ -17,6 +17,7 @@ public:
     static esp_err_t PrintTaskCpuUsage(TickType_t xTicksToWait);
     static void PrintTaskList();
     static void PrintHeapStats();
+    static uint32_t GetAudioAllocCount();  // Audio buffer pool heap fallbacks since boot
 };
 
 #endif // _SYSTEM_INFO_H_
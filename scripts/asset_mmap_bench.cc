@@ -0,0 +1,354 @@
+/*
+ * 资源读取方式对比: esp_partition_read 拷贝 vs mmap 原地读取 (main/images/asset_map.h)
+ *
+ * 在主机上用真实的 assets 分区镜像 (v1 无头格式或 scripts/pack_assets_v2.py 生成的 v2),
+ * 按设备端加载器的访问方式分别测试两种模式:
+ * 1. read: 与 CONFIG_ANIM_ASSETS_MMAP 关闭时相同, 调色板 / 索引 / 编码数据先用 pread
+ *          (每次最多 512 字节, 对应 esp_partition_read 与 ASSET_PACK_CHUNK_SIZE) 拷贝到 RAM 再解码
+ * 2. mmap: 映射整个镜像, 调色板和索引按存储顺序原地读取, 不经过中间缓冲
+ * 每种模式给出:
+ * - 动画顺序播放 fps (每帧展开为 160x160 RGB565, 即 AnimationLoader::ExpandFrame)
+ * - 背景逐行解码 fps (280x240, 每行一次 BackgroundLoader::DecodeRow)
+ * - 加载器在该模式下占用的内部 RAM, 以及 mmap 模式节省的字节数
+ *   (ESP32-C6 没有 PSRAM, 帧缓存与预取块都在内部 RAM)
+ *
+ * 编译 (在仓库根目录):
+ *   g++ -O2 -std=c++17 -Imain/images scripts/asset_mmap_bench.cc -o asset_mmap_bench
+ *
+ * 使用方法:
+ *   ./asset_mmap_bench assets.bin [rounds] [frame_cache_kb]
+ *
+ * 主机上 read 模式的开销来自系统调用和拷贝, 设备上则是 SPI 读取期间 flash cache 被关闭;
+ * 设备实测值见板级渲染日志 "Render: ... fps ... assets mmap/read, internal free ... KB"。
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "asset_rle.h"
+
+// Kept in sync with animation_loader.h / background_loader.h / asset_pack.h
+#define ANIM_WIDTH          160
+#define ANIM_HEIGHT         160
+#define ANIM_FRAMES         104
+#define ANIM_PALETTE_SIZE   768
+#define ANIM_FRAME_SIZE_RAW (ANIM_PALETTE_SIZE + ANIM_WIDTH * ANIM_HEIGHT)
+#define ANIM_FRAME_BLOCK    (ANIM_WIDTH * ANIM_HEIGHT + 256 * 2)
+#define BG_WIDTH            280
+#define BG_HEIGHT           240
+#define BG_COUNT            16
+#define BG_FRAME_SIZE_RAW   (768 + BG_WIDTH * BG_HEIGHT)
+#define CHUNK_SIZE          512
+#define FLAG_DELTA          0x01
+#define NO_FRAME            0xFFFF
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Either the mapped image or copies made with pread
+struct Source {
+    int fd;
+    const uint8_t* map;     // nullptr in read mode
+    std::vector<uint8_t> stage;
+
+    // [pos, pos + len) of the image, in place or copied into stage in CHUNK_SIZE reads
+    const uint8_t* Get(size_t pos, size_t len) {
+        if (map != nullptr) {
+            return map + pos;
+        }
+        if (stage.size() < len) {
+            stage.resize(len);
+        }
+        for (size_t done = 0; done < len; done += CHUNK_SIZE) {
+            size_t count = len - done < CHUNK_SIZE ? len - done : CHUNK_SIZE;
+            if (pread(fd, stage.data() + done, count, pos + done) != (ssize_t)count) {
+                return nullptr;
+            }
+        }
+        return stage.data();
+    }
+};
+
+struct Section {
+    size_t base;
+    uint8_t compression;
+    uint8_t flags;
+    uint16_t width, height, frame_count, colors;
+    uint32_t palette_offset, frame_offset, data_size;
+
+    bool Open(const uint8_t* image, size_t size, size_t offset) {
+        if (offset + 32 > size || memcmp(image + offset, "APK2", 4) != 0) {
+            return false;
+        }
+        const uint8_t* h = image + offset;
+        base = offset;
+        compression = h[6];
+        flags = h[7];
+        width = rd16(h + 8);
+        height = rd16(h + 10);
+        frame_count = rd16(h + 12);
+        colors = rd16(h + 16);
+        palette_offset = rd32(h + 20);
+        frame_offset = rd32(h + 24);
+        data_size = rd32(h + 28);
+        return true;
+    }
+    const uint8_t* Entry(const uint8_t* image, uint16_t f) const { return image + base + frame_offset + f * 12; }
+    uint16_t Base(const uint8_t* image, uint16_t f) const {
+        return (flags & FLAG_DELTA) ? rd16(Entry(image, f) + 10) : NO_FRAME;
+    }
+};
+
+static size_t decode_pixels(const Section& s, const uint8_t* src, size_t len, uint8_t* out, size_t width) {
+    if (s.compression == 1) {
+        return asset_rle_decode_row(src, len, out, width);
+    }
+    if (len < width) {
+        return 0;
+    }
+    memcpy(out, src, width);
+    return width;
+}
+
+// v2 frame into indices: key frame rows, or the delta applied to the indices already there
+static bool decode_v2(const uint8_t* image, const Section& s, Source& src, uint16_t f, uint8_t* indices) {
+    const uint8_t* entry = s.Entry(image, f);
+    uint32_t size = rd32(entry + 4);
+    const uint8_t* data = src.Get(s.base + rd32(entry), size);
+    if (data == nullptr) {
+        return false;
+    }
+    size_t pos;
+    if (s.Base(image, f) == NO_FRAME) {
+        pos = (s.height + 1) * 4;
+        for (uint16_t y = 0; y < s.height; y++) {
+            size_t used = decode_pixels(s, data + pos, size - pos, indices + (size_t)y * s.width, s.width);
+            if (used == 0) {
+                return false;
+            }
+            pos += used;
+        }
+        return true;
+    }
+    uint16_t spans = rd16(data);
+    pos = 4;
+    for (uint16_t i = 0; i < spans; i++) {
+        uint16_t y = rd16(data + pos);
+        uint16_t x = rd16(data + pos + 2);
+        uint16_t length = rd16(data + pos + 4);
+        pos += 6;
+        size_t used = decode_pixels(s, data + pos, size - pos, indices + (size_t)y * s.width + x, length);
+        if (used == 0) {
+            return false;
+        }
+        pos += used;
+    }
+    return pos == size;
+}
+
+// Any v2 frame: its key frame, then the chain of deltas (AssetPack::ReadFrame)
+static bool rebuild_v2(const uint8_t* image, const Section& s, Source& src, uint16_t f, uint8_t* indices) {
+    uint16_t base = s.Base(image, f);
+    if (base != NO_FRAME && !rebuild_v2(image, s, src, base, indices)) {
+        return false;
+    }
+    return decode_v2(image, s, src, f, indices);
+}
+
+// Sequential playback of every animation frame, expanded to RGB565; returns fps
+static double play_animation(const uint8_t* image, const Section* pack, Source& src, int rounds, uint32_t* checksum) {
+    std::vector<uint8_t> indices(ANIM_WIDTH * ANIM_HEIGHT);
+    std::vector<uint16_t> out(ANIM_WIDTH * ANIM_HEIGHT);
+    uint16_t palette[256];
+    uint32_t sum = 0;
+    double t0 = now_ms();
+    for (int r = 0; r < rounds; r++) {
+        uint16_t prev = NO_FRAME;
+        for (uint16_t f = 0; f < ANIM_FRAMES; f++) {
+            const uint8_t* pixels;
+            if (pack != nullptr) {
+                // A delta from the previous frame is patched in place, anything else rebuilt
+                bool ok = pack->Base(image, f) == prev ? decode_v2(image, *pack, src, f, indices.data())
+                                                        : rebuild_v2(image, *pack, src, f, indices.data());
+                if (!ok) {
+                    return -1;
+                }
+                uint16_t palette_idx = rd16(pack->Entry(image, f) + 8);
+                const uint8_t* p = src.Get(pack->base + pack->palette_offset + (size_t)palette_idx * pack->colors * 2,
+                                           pack->colors * 2);
+                memcpy(palette, p, pack->colors * 2);
+                pixels = indices.data();
+            } else {
+                // v1: palette converted, indices used from wherever they are
+                size_t offset = (size_t)f * ANIM_FRAME_SIZE_RAW;
+                const uint8_t* p = src.Get(offset, ANIM_PALETTE_SIZE);
+                for (int i = 0; i < 256; i++) {
+                    palette[i] = ((p[i * 3] & 0xF8) << 8) | ((p[i * 3 + 1] & 0xFC) << 3) | (p[i * 3 + 2] >> 3);
+                }
+                pixels = src.Get(offset + ANIM_PALETTE_SIZE, ANIM_WIDTH * ANIM_HEIGHT);
+                if (src.map == nullptr) {
+                    memcpy(indices.data(), pixels, indices.size());   // Into the frame block
+                    pixels = indices.data();
+                }
+            }
+            for (size_t i = 0; i < out.size(); i++) {
+                out[i] = palette[pixels[i]];
+            }
+            sum += out[(f * 7919) % out.size()];
+            prev = f;
+        }
+    }
+    *checksum = sum;
+    return rounds * ANIM_FRAMES / ((now_ms() - t0) / 1000.0);
+}
+
+// Every background decoded one row at a time; returns backgrounds per second
+static double decode_backgrounds(const uint8_t* image, size_t bg_offset, uint16_t count, const Section* pack,
+                                 Source& src, int rounds, uint32_t* checksum) {
+    std::vector<uint8_t> row(BG_WIDTH);
+    std::vector<uint16_t> out(BG_WIDTH);
+    uint16_t palette[256];
+    uint32_t sum = 0;
+    double t0 = now_ms();
+    for (int r = 0; r < rounds; r++) {
+        for (uint16_t b = 0; b < count; b++) {
+            size_t frame_offset;
+            if (pack != nullptr) {
+                uint16_t palette_idx = rd16(pack->Entry(image, b) + 8);
+                memcpy(palette, src.Get(pack->base + pack->palette_offset + (size_t)palette_idx * pack->colors * 2,
+                                        pack->colors * 2), pack->colors * 2);
+                frame_offset = pack->base + rd32(pack->Entry(image, b));
+            } else {
+                frame_offset = bg_offset + (size_t)b * BG_FRAME_SIZE_RAW;
+                const uint8_t* p = src.Get(frame_offset, 768);
+                for (int i = 0; i < 256; i++) {
+                    palette[i] = ((p[i * 3] & 0xF8) << 8) | ((p[i * 3 + 1] & 0xFC) << 3) | (p[i * 3 + 2] >> 3);
+                }
+            }
+            // The row table is read once per background, as AssetPack::ReadRow keeps it
+            std::vector<uint8_t> table;
+            if (pack != nullptr) {
+                const uint8_t* t = src.Get(frame_offset, (BG_HEIGHT + 1) * 4);
+                table.assign(t, t + (BG_HEIGHT + 1) * 4);
+            }
+            for (uint16_t y = 0; y < BG_HEIGHT; y++) {
+                const uint8_t* indices;
+                if (pack != nullptr) {
+                    uint32_t start = rd32(table.data() + y * 4);
+                    uint32_t size = rd32(table.data() + (y + 1) * 4) - start;
+                    const uint8_t* data = src.Get(frame_offset + start, size);
+                    if (decode_pixels(*pack, data, size, row.data(), BG_WIDTH) != size) {
+                        return -1;
+                    }
+                    indices = row.data();
+                } else {
+                    indices = src.Get(frame_offset + 768 + (size_t)y * BG_WIDTH, BG_WIDTH);
+                }
+                for (int x = 0; x < BG_WIDTH; x++) {
+                    out[x] = palette[indices[x]];
+                }
+                sum += out[y % BG_WIDTH];
+            }
+        }
+    }
+    *checksum = sum;
+    return rounds * count / ((now_ms() - t0) / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s assets.bin [rounds] [frame_cache_kb]\n", argv[0]);
+        return 1;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 10;
+    size_t cache_bytes = (size_t)(argc > 3 ? atoi(argv[3]) : 160) * 1024;
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    size_t size = st.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    const uint8_t* image = (const uint8_t*)mapping;
+
+    // Layout: animations | backgrounds | items, as the board initializes the loaders
+    Section anim_pack;
+    Section bg_pack;
+    const Section* anim = anim_pack.Open(image, size, 0) ? &anim_pack : nullptr;
+    size_t bg_offset = anim != nullptr ? anim->data_size : (size_t)ANIM_FRAMES * ANIM_FRAME_SIZE_RAW;
+    const Section* bg = bg_pack.Open(image, size, bg_offset) ? &bg_pack : nullptr;
+    // v1 backgrounds.bin has no header: up to BG_COUNT frames, as many as the image holds
+    size_t bg_count = 0;
+    if (bg != nullptr) {
+        bg_count = bg->data_size <= size - bg_offset ? bg->frame_count : 0;
+    } else if (bg_offset < size) {
+        bg_count = (size - bg_offset) / BG_FRAME_SIZE_RAW < BG_COUNT ? (size - bg_offset) / BG_FRAME_SIZE_RAW : BG_COUNT;
+    }
+    if (bg_offset > size || bg_count == 0 ||
+        (anim != nullptr && (anim->width != ANIM_WIDTH || anim->frame_count < ANIM_FRAMES))) {
+        fprintf(stderr, "%s: not an assets image (animations and backgrounds)\n", argv[1]);
+        return 1;
+    }
+    printf("%s: animations %s, %zu backgrounds %s\n", argv[1], anim != nullptr ? "v2" : "v1", bg_count,
+           bg != nullptr ? "v2" : "v1");
+
+    Source modes[2] = {{fd, nullptr, {}}, {fd, image, {}}};
+    const char* names[2] = {"read", "mmap"};
+    double anim_fps[2];
+    double bg_fps[2];
+    uint32_t anim_sum[2];
+    uint32_t bg_sum[2];
+    for (int m = 0; m < 2; m++) {
+        anim_fps[m] = play_animation(image, anim, modes[m], rounds, &anim_sum[m]);
+        bg_fps[m] = decode_backgrounds(image, bg_offset, bg_count, bg, modes[m], rounds, &bg_sum[m]);
+        if (anim_fps[m] < 0 || bg_fps[m] < 0) {
+            fprintf(stderr, "corrupt data in %s mode\n", names[m]);
+            return 1;
+        }
+    }
+    if (anim_sum[0] != anim_sum[1] || bg_sum[0] != bg_sum[1]) {
+        fprintf(stderr, "read and mmap output differ\n");
+        return 1;
+    }
+
+    // Internal RAM held by the loaders (what differs between the modes)
+    //   AnimationLoader: frame block, frame cache, prefetch block; v1 mapped keeps only a palette
+    //   AssetPack::ReadRow: row table + row buffer for v2 backgrounds and items (read mode only)
+    size_t ram[2];
+    size_t frames_ram = ANIM_FRAME_BLOCK + cache_bytes + ANIM_FRAME_BLOCK;
+    size_t row_ram = bg != nullptr ? (BG_HEIGHT + 1) * 4 + ASSET_RLE_MAX_ROW_BYTES(BG_WIDTH) + 41 * 4 + ASSET_RLE_MAX_ROW_BYTES(40)
+                                   : 0;
+    ram[0] = frames_ram + row_ram;
+    ram[1] = anim != nullptr ? frames_ram : 256 * 2;
+
+    for (int m = 0; m < 2; m++) {
+        printf("  %s: animation %.0f fps, background rows %.1f backgrounds/s, loader RAM %zu bytes\n",
+               names[m], anim_fps[m], bg_fps[m], ram[m]);
+    }
+    printf("  mmap: animation %.2fx, backgrounds %.2fx, internal RAM freed %zu bytes\n",
+           anim_fps[1] / anim_fps[0], bg_fps[1] / bg_fps[0], ram[0] - ram[1]);
+
+    munmap(mapping, size);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,287 @@
+/*
+ * 资源包 v2 压缩率与解码速度 (main/images/asset_pack.h)
+ *
+ * 读取 scripts/pack_assets_v2.py 生成的分区镜像, 对每个资源段 (动画 / 背景 / 物品):
+ * 1. 压缩率: v2 段大小 / 同样帧数的 v1 大小 (每帧 RGB888 调色板 + 未压缩索引)
+ * 2. 解码速度: 与设备端相同的逐行 RLE 解码 (asset_rle.h) + 调色板展开为 RGB565,
+ *    以输出的 RGB565 字节计 MB/s; 同时给出未压缩行 (memcpy) + 展开的速度作为对照
+ * 3. 单行随机读取: 通过行偏移表解码随机行 (DecodeRow 低内存模式的路径)
+ * 4. 帧间差分 (--delta 打包): 顺序播放时在上一帧上修补, 只展开变化区间,
+ *    并统计关键帧 / 差分帧的平均读取字节数
+ *
+ * 编译 (在仓库根目录):
+ *   g++ -O2 -std=c++17 -Imain/images scripts/asset_pack_bench.cc -o asset_pack_bench
+ *
+ * 使用方法:
+ *   ./asset_pack_bench gifs/assets_v2.bin [rounds]
+ *
+ * 主机计时只反映相对开销; 设备上 flash 读取量按压缩率同比减少。
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "asset_rle.h"
+
+// Kept in sync with asset_pack.h (which needs esp_partition.h)
+#define ASSET_PACK_FLAG_DELTA 0x01
+
+struct Section {
+    size_t base;
+    uint8_t compression;
+    uint8_t flags;
+    uint16_t width, height, frame_count, palette_count, colors;
+    uint32_t palette_offset, frame_offset, data_size;
+};
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const uint8_t* frame_entry(const std::vector<uint8_t>& data, const Section& s, uint16_t f) {
+    return data.data() + s.base + s.frame_offset + f * 12;
+}
+
+static uint16_t frame_base(const std::vector<uint8_t>& data, const Section& s, uint16_t f) {
+    return (s.flags & ASSET_PACK_FLAG_DELTA) ? rd16(frame_entry(data, s, f) + 10) : 0xFFFF;
+}
+
+// Patch a delta frame into indices (AssetPack::ApplyDelta); changed pixels are expanded to out
+static bool apply_delta(const std::vector<uint8_t>& data, const Section& s, uint16_t f,
+                        uint8_t* indices, uint16_t* out, const uint16_t* palette) {
+    const uint8_t* entry = frame_entry(data, s, f);
+    const uint8_t* delta = data.data() + s.base + rd32(entry);
+    uint32_t size = rd32(entry + 4);
+    uint16_t span_count = rd16(delta);
+    size_t pos = 4;
+    for (uint16_t i = 0; i < span_count; i++) {
+        uint16_t y = rd16(delta + pos);
+        uint16_t x = rd16(delta + pos + 2);
+        uint16_t length = rd16(delta + pos + 4);
+        pos += 6;
+        uint8_t* dst = indices + (size_t)y * s.width + x;
+        if (s.compression == 1) {
+            size_t used = asset_rle_decode_row(delta + pos, size - pos, dst, length);
+            if (used == 0) {
+                return false;
+            }
+            pos += used;
+        } else {
+            memcpy(dst, delta + pos, length);
+            pos += length;
+        }
+        if (out != nullptr) {
+            uint16_t* row = out + (size_t)y * s.width + x;
+            for (uint16_t k = 0; k < length; k++) {
+                row[k] = palette[dst[k]];
+            }
+        }
+    }
+    return pos == size;
+}
+
+// Decode one frame to RGB565 the way AssetPack::ReadFrame + a palette expand does
+// (a delta frame is rebuilt from its key frame)
+static bool decode_frame(const std::vector<uint8_t>& data, const Section& s, uint16_t f,
+                         uint8_t* indices, uint16_t* out) {
+    const uint8_t* entry = frame_entry(data, s, f);
+    const uint16_t* palette = (const uint16_t*)(data.data() + s.base + s.palette_offset) +
+                              (size_t)rd16(entry + 8) * s.colors;
+    uint16_t base = frame_base(data, s, f);
+    if (base != 0xFFFF) {
+        if (!decode_frame(data, s, base, indices, nullptr) || !apply_delta(data, s, f, indices, nullptr, palette)) {
+            return false;
+        }
+    } else {
+        const uint8_t* frame = data.data() + s.base + rd32(entry);
+        uint32_t size = rd32(entry + 4);
+        size_t pos = (s.height + 1) * 4;
+        for (uint16_t y = 0; y < s.height; y++) {
+            uint8_t* row = indices + (size_t)y * s.width;
+            if (s.compression == 1) {
+                size_t used = asset_rle_decode_row(frame + pos, size - pos, row, s.width);
+                if (used == 0) {
+                    return false;
+                }
+                pos += used;
+            } else {
+                memcpy(row, frame + pos, s.width);
+                pos += s.width;
+            }
+        }
+    }
+    if (out != nullptr) {
+        size_t count = (size_t)s.width * s.height;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = palette[indices[i]];
+        }
+    }
+    return true;
+}
+
+static bool decode_row(const std::vector<uint8_t>& data, const Section& s, uint16_t f, uint16_t y, uint8_t* out) {
+    const uint8_t* entry = frame_entry(data, s, f);
+    const uint8_t* frame = data.data() + s.base + rd32(entry);
+    uint32_t start = rd32(frame + y * 4);
+    uint32_t end = rd32(frame + (y + 1) * 4);
+    if (s.compression == 1) {
+        return asset_rle_decode_row(frame + start, end - start, out, s.width) == end - start;
+    }
+    memcpy(out, frame + start, s.width);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s assets_v2.bin [rounds]\n", argv[0]);
+        return 1;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    FILE* fp = fopen(argv[1], "rb");
+    if (!fp) {
+        perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(fp);
+
+    size_t total_v1 = 0;
+    size_t total_v2 = 0;
+    size_t offset = 0;
+    while (offset + 32 <= data.size() && memcmp(data.data() + offset, "APK2", 4) == 0) {
+        const uint8_t* h = data.data() + offset;
+        Section s;
+        s.base = offset;
+        s.compression = h[6];
+        s.flags = h[7];
+        s.width = rd16(h + 8);
+        s.height = rd16(h + 10);
+        s.frame_count = rd16(h + 12);
+        s.palette_count = rd16(h + 14);
+        s.colors = rd16(h + 16);
+        s.palette_offset = rd32(h + 20);
+        s.frame_offset = rd32(h + 24);
+        s.data_size = rd32(h + 28);
+
+        size_t pixels = (size_t)s.width * s.height;
+        size_t v1_size = (size_t)s.frame_count * (s.colors * 3 + pixels);
+        total_v1 += v1_size;
+        total_v2 += s.data_size;
+        printf("%ux%u: %u frames, %u palettes, %s%s\n", s.width, s.height, s.frame_count, s.palette_count,
+               s.compression == 1 ? "RLE" : "raw", (s.flags & ASSET_PACK_FLAG_DELTA) ? " + delta" : "");
+        printf("  size: v1 %zu -> v2 %u bytes (%.1f%%)\n", v1_size, s.data_size,
+               s.data_size * 100.0 / v1_size);
+
+        std::vector<uint8_t> indices(pixels);
+        std::vector<uint16_t> out(pixels);
+
+        // v2 decode
+        double t0 = now_ms();
+        for (int r = 0; r < rounds; r++) {
+            for (uint16_t f = 0; f < s.frame_count; f++) {
+                if (!decode_frame(data, s, f, indices.data(), out.data())) {
+                    fprintf(stderr, "corrupt frame %u\n", f);
+                    return 1;
+                }
+            }
+        }
+        double v2_ms = now_ms() - t0;
+
+        // v1 equivalent: indices already raw, expand through a per-frame palette
+        std::vector<uint8_t> raw(pixels);
+        std::vector<uint16_t> palette(256);
+        t0 = now_ms();
+        for (int r = 0; r < rounds; r++) {
+            for (uint16_t f = 0; f < s.frame_count; f++) {
+                memcpy(raw.data(), indices.data(), pixels);
+                for (size_t i = 0; i < pixels; i++) {
+                    out[i] = palette[raw[i]];
+                }
+            }
+        }
+        double v1_ms = now_ms() - t0;
+
+        double out_mb = (double)rounds * s.frame_count * pixels * 2 / (1024.0 * 1024.0);
+        printf("  decode: v2 %.1f MB/s (%.3f ms/frame), uncompressed copy %.1f MB/s\n",
+               out_mb / (v2_ms / 1000.0), v2_ms / rounds / s.frame_count, out_mb / (v1_ms / 1000.0));
+
+        // Delta packs: sequential playback patches the previous frame and expands only the
+        // changed spans, the way AnimationLoader does
+        if (s.flags & ASSET_PACK_FLAG_DELTA) {
+            size_t key_bytes = 0, delta_bytes = 0;
+            int key_count = 0, delta_count = 0;
+            for (uint16_t f = 0; f < s.frame_count; f++) {
+                if (frame_base(data, s, f) == 0xFFFF) {
+                    key_bytes += rd32(frame_entry(data, s, f) + 4);
+                    key_count++;
+                } else {
+                    delta_bytes += rd32(frame_entry(data, s, f) + 4);
+                    delta_count++;
+                }
+            }
+            printf("  key frames %d (avg %zu bytes), delta frames %d (avg %zu bytes), loop deltas %u\n",
+                   key_count, key_count ? key_bytes / key_count : 0, delta_count,
+                   delta_count ? delta_bytes / delta_count : 0, rd16(h + 18));
+
+            t0 = now_ms();
+            for (int r = 0; r < rounds; r++) {
+                uint16_t prev = 0xFFFF;
+                for (uint16_t f = 0; f < s.frame_count; f++) {
+                    const uint16_t* palette = (const uint16_t*)(data.data() + s.base + s.palette_offset) +
+                                              (size_t)rd16(frame_entry(data, s, f) + 8) * s.colors;
+                    bool ok = prev != 0xFFFF && frame_base(data, s, f) == prev
+                                  ? apply_delta(data, s, f, indices.data(), out.data(), palette)
+                                  : decode_frame(data, s, f, indices.data(), out.data());
+                    if (!ok) {
+                        fprintf(stderr, "corrupt frame %u\n", f);
+                        return 1;
+                    }
+                    prev = f;
+                }
+            }
+            double play_ms = now_ms() - t0;
+            printf("  sequential playback: %.3f ms/frame (%.1fx the full decode)\n",
+                   play_ms / rounds / s.frame_count, v2_ms / play_ms);
+        }
+
+        // Random single rows (key frames only)
+        uint32_t seed = 1;
+        int row_count = rounds * 1000;
+        t0 = now_ms();
+        for (int i = 0; i < row_count; i++) {
+            seed = seed * 1103515245 + 12345;
+            uint16_t f = (seed >> 8) % s.frame_count;
+            if (frame_base(data, s, f) != 0xFFFF) {
+                continue;
+            }
+            if (!decode_row(data, s, f, (seed >> 16) % s.height, indices.data())) {
+                fprintf(stderr, "corrupt row\n");
+                return 1;
+            }
+        }
+        printf("  random row: %.2f us/row\n", (now_ms() - t0) * 1000.0 / row_count);
+
+        offset += s.data_size;
+    }
+
+    if (total_v1 == 0) {
+        fprintf(stderr, "%s: no asset pack v2 section found\n", argv[1]);
+        return 1;
+    }
+    printf("total: v1 %zu -> v2 %zu bytes (%.1f%%)\n", total_v1, total_v2, total_v2 * 100.0 / total_v1);
+    return 0;
+}
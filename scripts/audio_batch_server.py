@@ -0,0 +1,423 @@
+#!/usr/bin/env python3
+'''
+  上行音频批量发送 (audio batching) 的本地替身服务器
+
+  WebSocket 模式: 在本地端口上接受设备连接 (ws://, 不带 TLS), 回应 hello 时通过
+  features.audio_batch 开启批量发送, 然后校验每个二进制消息的分帧:
+    - 协议版本 2 / 3 的包头, payload_size 与消息长度一致
+    - 批量消息 (type 2): |count 1u|count x (timestamp 4u|length 2u)|frame...|,
+      count 不超过协商值, 各帧长度之和与负载一致
+  并统计每帧的开销: 每条消息的 WebSocket 帧头 + 协议包头 + 批量条目, 以及估算的
+  TLS 记录开销 (每条消息 29 字节, TLS 1.2 AES-GCM)。
+
+  UDP 模式: 只监听 UDP 端口, 校验 MQTT+UDP 音频包头 (type 1 单帧 / type 2 批量,
+  payload_len 与报文长度一致)。给出 --key / --nonce (hello 中下发的十六进制值) 且安装了
+  cryptography 时会解密并校验批量负载和序号连续性 (批量包的序号是第一帧的, 每帧占一个)。
+  hello 需要通过 MQTT 服务器交换, 这里不模拟。
+
+  --self-test 在本机启动服务器并用模拟设备 (与 main/protocols/binary_protocol.h 相同的
+  分帧) 以版本 2 / 3、逐帧和批量方式各发送一段 60ms 帧的音频, 校验服务器还原出的帧与
+  发送的一致, 并打印每帧开销对比。
+
+  用法:
+    python3 scripts/audio_batch_server.py --port 8765 --batch 8
+    python3 scripts/audio_batch_server.py --udp 8888 --key <hex> --nonce <hex>
+    python3 scripts/audio_batch_server.py --self-test
+  设备端把 websocket url 设置为 ws://<主机IP>:8765/ 即可连接。
+'''
+import argparse
+import base64
+import hashlib
+import json
+import random
+import socket
+import struct
+import threading
+import time
+
+AUDIO_BATCH_TYPE = 2
+AUDIO_BATCH_MAX_FRAMES = 8
+UDP_AUDIO_PACKET_TYPE = 0x01
+UDP_AUDIO_BATCH_PACKET_TYPE = 0x02
+UDP_AUDIO_HEADER_SIZE = 16
+TLS_RECORD_OVERHEAD = 29
+WS_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+
+class FramingError(Exception):
+    pass
+
+
+def parse_batch(payload, max_frames):
+    '''批量负载 -> [(timestamp, opus bytes)]'''
+    if len(payload) < 1:
+        raise FramingError('empty batch')
+    count = payload[0]
+    if count < 1 or count > max_frames:
+        raise FramingError(f'batch of {count} frames, negotiated {max_frames}')
+    offset = 1 + 6 * count
+    if len(payload) < offset:
+        raise FramingError('truncated batch header')
+    frames = []
+    for i in range(count):
+        timestamp, length = struct.unpack_from('>IH', payload, 1 + 6 * i)
+        if offset + length > len(payload):
+            raise FramingError(f'frame {i} overruns the batch')
+        frames.append((timestamp, payload[offset:offset + length]))
+        offset += length
+    if offset != len(payload):
+        raise FramingError(f'{len(payload) - offset} trailing bytes after the batch')
+    return frames
+
+
+def build_batch(frames):
+    '''与 WriteAudioBatch() 相同的分帧, 用于自测'''
+    header = bytes([len(frames)]) + b''.join(struct.pack('>IH', ts, len(data)) for ts, data in frames)
+    return header + b''.join(data for _, data in frames)
+
+
+def parse_binary_message(version, message, max_frames):
+    '''WebSocket 二进制消息 -> (协议头字节数, [(timestamp, opus)])'''
+    if version == 2:
+        if len(message) < 16:
+            raise FramingError('truncated v2 header')
+        _, msg_type, _, timestamp, size = struct.unpack_from('>HHIII', message)
+        header = 16
+    elif version == 3:
+        if len(message) < 4:
+            raise FramingError('truncated v3 header')
+        msg_type, _, size = struct.unpack_from('>BBH', message)
+        timestamp = 0
+        header = 4
+    else:
+        return 0, [(0, message)]
+    payload = message[header:]
+    if size != len(payload):
+        raise FramingError(f'payload_size {size}, message carries {len(payload)}')
+    if msg_type == AUDIO_BATCH_TYPE:
+        frames = parse_batch(payload, max_frames)
+        if version == 2 and frames[0][0] != timestamp:
+            raise FramingError('outer timestamp is not the first frame\'s')
+        return header, frames
+    if msg_type != 0:
+        raise FramingError(f'unknown message type {msg_type}')
+    return header, [(timestamp, payload)]
+
+
+class Stats:
+    def __init__(self):
+        self.messages = 0
+        self.frames = 0
+        self.opus_bytes = 0
+        self.overhead_bytes = 0     # 帧头 + 协议头 + 批量条目
+        self.errors = 0
+        self.histogram = {}
+
+    def add(self, frames, overhead):
+        self.messages += 1
+        self.frames += len(frames)
+        self.opus_bytes += sum(len(data) for _, data in frames)
+        self.overhead_bytes += overhead
+        self.histogram[len(frames)] = self.histogram.get(len(frames), 0) + 1
+
+    def report(self, title, tls=True):
+        if self.frames == 0:
+            print(f'{title}: no audio')
+            return
+        per_frame = self.overhead_bytes / self.frames
+        tls_per_frame = TLS_RECORD_OVERHEAD * self.messages / self.frames if tls else 0
+        batches = ' '.join(f'{k}x{v}' for k, v in sorted(self.histogram.items()))
+        print(f'{title}: {self.messages} messages, {self.frames} frames, {self.opus_bytes} opus bytes, '
+              f'overhead {per_frame:.1f} B/frame (+{tls_per_frame:.1f} TLS est.), '
+              f'{self.messages / self.frames:.2f} sends/frame, batches [{batches}], errors {self.errors}')
+
+
+# ============== WebSocket ==============
+
+def recv_exact(conn, size):
+    data = b''
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError('closed')
+        data += chunk
+    return data
+
+
+def read_ws_message(conn):
+    '''-> (opcode, payload, wire header bytes)'''
+    payload = b''
+    wire_header = 0
+    while True:
+        b0, b1 = recv_exact(conn, 2)
+        opcode = b0 & 0x0F
+        length = b1 & 0x7F
+        wire_header += 2
+        if length == 126:
+            length = struct.unpack('>H', recv_exact(conn, 2))[0]
+            wire_header += 2
+        elif length == 127:
+            length = struct.unpack('>Q', recv_exact(conn, 8))[0]
+            wire_header += 8
+        mask = b''
+        if b1 & 0x80:
+            mask = recv_exact(conn, 4)
+            wire_header += 4
+        data = recv_exact(conn, length)
+        if mask:
+            data = bytes(c ^ mask[i % 4] for i, c in enumerate(data))
+        if opcode == 0x9:  # ping
+            send_ws(conn, 0xA, data)
+            continue
+        if opcode != 0:
+            first_opcode = opcode
+        payload += data
+        if b0 & 0x80:
+            return first_opcode, payload, wire_header
+
+
+def send_ws(conn, opcode, data, mask=False):
+    header = bytes([0x80 | opcode])
+    length = len(data)
+    mask_bit = 0x80 if mask else 0
+    if length < 126:
+        header += bytes([mask_bit | length])
+    elif length < 65536:
+        header += bytes([mask_bit | 126]) + struct.pack('>H', length)
+    else:
+        header += bytes([mask_bit | 127]) + struct.pack('>Q', length)
+    if mask:
+        key = bytes(random.getrandbits(8) for _ in range(4))
+        data = key + bytes(c ^ key[i % 4] for i, c in enumerate(data))
+    conn.sendall(header + data)
+
+
+def ws_handshake(conn):
+    request = b''
+    while b'\r\n\r\n' not in request:
+        chunk = conn.recv(1024)
+        if not chunk:
+            raise ConnectionError('closed during handshake')
+        request += chunk
+    headers = {}
+    for line in request.decode(errors='replace').split('\r\n')[1:]:
+        if ':' in line:
+            name, value = line.split(':', 1)
+            headers[name.strip().lower()] = value.strip()
+    accept = base64.b64encode(hashlib.sha1((headers['sec-websocket-key'] + WS_GUID).encode()).digest()).decode()
+    conn.sendall(('HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                  f'Sec-WebSocket-Accept: {accept}\r\n\r\n').encode())
+    return headers
+
+
+def serve_ws_connection(conn, address, batch, received=None):
+    headers = ws_handshake(conn)
+    version = int(headers.get('protocol-version', '1'))
+    negotiated = 1
+    stats = Stats()
+    print(f'{address}: connected, protocol version {version}')
+    try:
+        while True:
+            opcode, payload, wire_header = read_ws_message(conn)
+            if opcode == 0x8:
+                break
+            if opcode == 0x1:
+                message = json.loads(payload)
+                if message.get('type') == 'hello':
+                    offered = message.get('features', {}).get('audio_batch', 1)
+                    negotiated = max(1, min(int(offered), batch))
+                    hello = {
+                        'type': 'hello', 'transport': 'websocket', 'session_id': 'stand-in',
+                        'audio_params': {'format': 'opus', 'sample_rate': 24000, 'channels': 1,
+                                         'frame_duration': 60},
+                    }
+                    if negotiated > 1:
+                        hello['features'] = {'audio_batch': negotiated}
+                    send_ws(conn, 0x1, json.dumps(hello).encode())
+                    print(f'{address}: hello, device offers audio_batch={offered}, using {negotiated}')
+                else:
+                    print(f'{address}: {payload.decode(errors="replace")}')
+                continue
+            if opcode != 0x2:
+                continue
+            try:
+                header, frames = parse_binary_message(version, payload, negotiated)
+            except FramingError as e:
+                stats.errors += 1
+                print(f'{address}: framing error: {e}')
+                continue
+            stats.add(frames, wire_header + header + (len(payload) - header - sum(len(d) for _, d in frames)))
+            if received is not None:
+                received.extend(frames)
+    except ConnectionError:
+        pass
+    finally:
+        conn.close()
+        stats.report(f'{address}')
+    return stats
+
+
+def run_ws_server(port, batch, once=False, result=None, ready=None):
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(('0.0.0.0', port))
+    server.listen(4)
+    if ready is not None:
+        ready.append(server.getsockname()[1])
+    else:
+        print(f'WebSocket stand-in server on ws://0.0.0.0:{port}/, audio_batch up to {batch}')
+    while True:
+        conn, address = server.accept()
+        if once:
+            received = []
+            stats = serve_ws_connection(conn, address, batch, received)
+            result.append((stats, received))
+            server.close()
+            return
+        threading.Thread(target=serve_ws_connection, args=(conn, address, batch), daemon=True).start()
+
+
+# ============== UDP ==============
+
+def make_decryptor(key_hex, nonce_hex):
+    if not key_hex or not nonce_hex:
+        return None
+    try:
+        from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes
+    except ImportError:
+        print('cryptography is not installed: checking headers only')
+        return None
+    key = bytes.fromhex(key_hex)
+
+    def decrypt(header, data):
+        decryptor = Cipher(algorithms.AES(key), modes.CTR(header)).decryptor()
+        return decryptor.update(data) + decryptor.finalize()
+    return decrypt
+
+
+def run_udp_server(port, key_hex, nonce_hex):
+    decrypt = make_decryptor(key_hex, nonce_hex)
+    server = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    server.bind(('0.0.0.0', port))
+    print(f'UDP stand-in server on 0.0.0.0:{port}')
+    stats = Stats()
+    expected_sequence = None
+    last_report = time.time()
+    try:
+        while True:
+            datagram, address = server.recvfrom(2048)
+            try:
+                if len(datagram) < UDP_AUDIO_HEADER_SIZE:
+                    raise FramingError('short datagram')
+                packet_type, _, size, _, timestamp, sequence = struct.unpack_from('>BBHIII', datagram)
+                payload = datagram[UDP_AUDIO_HEADER_SIZE:]
+                if size != len(payload):
+                    raise FramingError(f'payload_len {size}, datagram carries {len(payload)}')
+                if packet_type not in (UDP_AUDIO_PACKET_TYPE, UDP_AUDIO_BATCH_PACKET_TYPE):
+                    raise FramingError(f'unknown packet type {packet_type}')
+                frames = [(timestamp, payload)]
+                if decrypt is not None:
+                    plain = decrypt(datagram[:UDP_AUDIO_HEADER_SIZE], payload)
+                    if packet_type == UDP_AUDIO_BATCH_PACKET_TYPE:
+                        frames = parse_batch(plain, AUDIO_BATCH_MAX_FRAMES)
+                    if expected_sequence is not None and sequence != expected_sequence:
+                        print(f'{address}: sequence {sequence}, expected {expected_sequence}')
+                    expected_sequence = sequence + len(frames)
+                stats.add(frames, len(datagram) - sum(len(d) for _, d in frames))
+            except FramingError as e:
+                stats.errors += 1
+                print(f'{address}: framing error: {e}')
+            if time.time() - last_report > 5:
+                stats.report('udp', tls=False)
+                last_report = time.time()
+    except KeyboardInterrupt:
+        stats.report('udp', tls=False)
+
+
+# ============== Self test ==============
+
+def self_test():
+    rng = random.Random(1)
+    # 16kHz / 60ms 上行 Opus 帧, 60~110 字节; 时间戳为 0 或递增 (服务器 AEC)
+    frames = [(0 if i < 50 else 1000 + 60 * i, bytes(rng.getrandbits(8) for _ in range(rng.randint(60, 110))))
+              for i in range(300)]
+    ok = True
+    print(f'{len(frames)} frames of 60 ms (uplink), queue bursts of 1-8 frames')
+    for version in (2, 3):
+        for batching in (False, True):
+            result, ready = [], []
+            server = threading.Thread(target=run_ws_server, args=(0, AUDIO_BATCH_MAX_FRAMES, True, result, ready))
+            server.start()
+            while not ready:
+                time.sleep(0.01)
+            conn = socket.create_connection(('127.0.0.1', ready[0]))
+            key = base64.b64encode(bytes(16)).decode()
+            conn.sendall((f'GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                          f'Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n'
+                          f'Protocol-Version: {version}\r\n\r\n').encode())
+            response = b''
+            while b'\r\n\r\n' not in response:
+                response += conn.recv(1024)
+            hello = {'type': 'hello', 'version': version, 'transport': 'websocket',
+                     'features': {'mcp': True, 'audio_batch': AUDIO_BATCH_MAX_FRAMES}}
+            send_ws(conn, 0x1, json.dumps(hello).encode(), mask=True)
+            _, reply, _ = read_ws_message(conn)
+            negotiated = json.loads(reply).get('features', {}).get('audio_batch', 1) if batching else 1
+
+            # 队列深度随机: 与 Application::SendQueuedAudio 相同, 有几帧就打包几帧
+            i = 0
+            while i < len(frames):
+                burst = frames[i:i + rng.choice([1, 1, 1, 2, 3, 8])]
+                i += len(burst)
+                for j in range(0, len(burst), negotiated):
+                    group = burst[j:j + negotiated]
+                    if len(group) == 1:
+                        ts, data = group[0]
+                        msg_type, payload = 0, data
+                    else:
+                        ts, msg_type, payload = group[0][0], AUDIO_BATCH_TYPE, build_batch(group)
+                    if version == 2:
+                        message = struct.pack('>HHIII', 2, msg_type, 0, ts, len(payload)) + payload
+                    else:
+                        message = struct.pack('>BBH', msg_type, 0, len(payload)) + payload
+                    send_ws(conn, 0x2, message, mask=True)
+            send_ws(conn, 0x8, b'', mask=True)
+            server.join()
+            conn.close()
+            stats, received = result[0]
+            same =[d for _, d in received] == [d for _, d in frames]
+            if version == 2:
+                same = same and [t for t, _ in received] == [t for t, _ in frames]
+            same = same and stats.errors == 0
+            ok = ok and same
+            stats.report(f'  v{version} {"batched" if batching else "single "}')
+            if not same:
+                print('  FRAMES DIFFER')
+    print('self test', 'passed' if ok else 'FAILED')
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description='上行音频批量发送的本地替身服务器')
+    parser.add_argument('--port', type=int, default=8765, help='WebSocket 端口 (默认: 8765)')
+    parser.add_argument('--batch', type=int, default=AUDIO_BATCH_MAX_FRAMES,
+                        help='接受的每条消息最大帧数, 1 表示不开启批量 (默认: 8)')
+    parser.add_argument('--udp', type=int, help='改为监听该 UDP 端口, 校验 MQTT+UDP 音频包')
+    parser.add_argument('--key', help='UDP AES 密钥 (十六进制)')
+    parser.add_argument('--nonce', help='UDP nonce (十六进制)')
+    parser.add_argument('--self-test', action='store_true', help='本机自测分帧并对比开销')
+    args = parser.parse_args()
+
+    if args.self_test:
+        raise SystemExit(0 if self_test() else 1)
+    try:
+        if args.udp:
+            run_udp_server(args.udp, args.key, args.nonce)
+        else:
+            run_ws_server(args.port, args.batch)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
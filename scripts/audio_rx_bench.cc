@@ -0,0 +1,345 @@
+/*
+ * 下行音频接收路径基准测试 (main/protocols/binary_protocol.h)
+ *
+ * 在主机上按 24kHz / 60ms 的服务器下行 (每秒 16.7 个 Opus 包, 包长 100~300 字节) 生成
+ * WebSocket v2 / v3 帧和 MQTT UDP 加密包, 比较两种接收方式:
+ * 1. copy: 改动前的写法 - 在传输层缓冲区上原地字节交换包头, 每包 new 一个 AudioStreamPacket
+ *          并把负载拷贝进新的 std::vector
+ * 2. view: 现在的写法 - 包头只读解析为 AudioFrameView, 负载直接指向接收缓冲区, 只拷贝一次
+ *          (UDP 为直接解密) 到池化的包对象与负载缓冲区 (与 AudioBufferPool 相同的回收方式)
+ * 每种方式给出每包的堆分配次数 (替换全局 operator new 计数) 与 ns/包。
+ * 包在一个 8 深度的队列中停留后释放, 模拟解码队列。
+ *
+ * UDP 的 AES-CTR 用一个简单的异或密钥流代替 (主机上没有 mbedtls), 两种方式的解密开销相同,
+ * 比较的是解密之外的拷贝和分配。view 方式下解密时不修改接收缓冲区 (nonce 计数器用副本)。
+ *
+ * 编译 (在仓库根目录):
+ *   g++ -O2 -std=c++17 -Imain/protocols scripts/audio_rx_bench.cc -o audio_rx_bench
+ *
+ * 使用方法:
+ *   ./audio_rx_bench [rounds] [packets]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "binary_protocol.h"
+
+// Kept in sync with audio_buffer_pool.h
+#define AUDIO_POOL_OPUS_PACKETS     24
+#define AUDIO_POOL_OPUS_BYTES       320
+#define AUDIO_POOL_PACKET_OBJECTS   48
+
+#define DECODE_QUEUE_DEPTH  8
+
+static uint64_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+static inline uint16_t bswap16(uint16_t v) { return (uint16_t)((v >> 8) | (v << 8)); }
+static inline uint32_t bswap32(uint32_t v) { return __builtin_bswap32(v); }
+
+// AES-CTR stand-in: one keystream block per 16 bytes, counter taken from the nonce
+static void ctr_crypt(size_t size, uint8_t nonce[16], const uint8_t* in, uint8_t* out) {
+    for (size_t offset = 0; offset < size; offset += 16) {
+        uint64_t x = 0;
+        memcpy(&x, nonce + 8, 8);
+        uint8_t block[16];
+        for (int i = 0; i < 16; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            block[i] = (uint8_t)x;
+        }
+        for (size_t i = 0; i < 16 && offset + i < size; i++) {
+            out[offset + i] = in[offset + i] ^ block[i];
+        }
+        for (int i = 15; i >= 0 && ++nonce[i] == 0; i--) {
+        }
+    }
+}
+
+// ============== Before: heap packet + copied payload ==============
+
+struct HeapPacket {
+    int sample_rate = 0;
+    int frame_duration = 0;
+    uint32_t timestamp = 0;
+    std::vector<uint8_t> payload;
+};
+
+// ============== After: pooled packet object + recycled payload ==============
+
+class BenchPool {
+public:
+    static BenchPool& GetInstance() {
+        static BenchPool instance;
+        return instance;
+    }
+
+    void Initialize(size_t block_size) {
+        block_size_ = block_size;
+        slab_ = static_cast<uint8_t*>(::operator new(block_size * AUDIO_POOL_PACKET_OBJECTS));
+        free_blocks_.reserve(AUDIO_POOL_PACKET_OBJECTS);
+        opus_free_.reserve(AUDIO_POOL_OPUS_PACKETS);
+        for (int i = 0; i < AUDIO_POOL_PACKET_OBJECTS; i++) {
+            free_blocks_.push_back(slab_ + i * block_size);
+        }
+        for (int i = 0; i < AUDIO_POOL_OPUS_PACKETS; i++) {
+            std::vector<uint8_t> opus;
+            opus.reserve(AUDIO_POOL_OPUS_BYTES);
+            opus_free_.push_back(std::move(opus));
+        }
+    }
+
+    void* Allocate(size_t size) {
+        if (size <= block_size_ && !free_blocks_.empty()) {
+            void* ptr = free_blocks_.back();
+            free_blocks_.pop_back();
+            return ptr;
+        }
+        return ::operator new(size);
+    }
+
+    void Free(void* ptr) {
+        if (ptr >= slab_ && ptr < slab_ + block_size_ * AUDIO_POOL_PACKET_OBJECTS) {
+            free_blocks_.push_back(ptr);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    std::vector<uint8_t> AcquireOpus() {
+        if (!opus_free_.empty()) {
+            auto opus = std::move(opus_free_.back());
+            opus_free_.pop_back();
+            opus.clear();
+            return opus;
+        }
+        std::vector<uint8_t> opus;
+        opus.reserve(AUDIO_POOL_OPUS_BYTES);
+        return opus;
+    }
+
+    void ReleaseOpus(std::vector<uint8_t>&& opus) {
+        if (opus.capacity() != 0 && opus_free_.size() < AUDIO_POOL_OPUS_PACKETS) {
+            opus_free_.push_back(std::move(opus));
+        }
+    }
+
+private:
+    uint8_t* slab_ = nullptr;
+    size_t block_size_ = 0;
+    std::vector<void*> free_blocks_;
+    std::vector<std::vector<uint8_t>> opus_free_;
+};
+
+struct PooledPacket {
+    int sample_rate = 0;
+    int frame_duration = 0;
+    uint32_t timestamp = 0;
+    std::vector<uint8_t> payload;
+
+    ~PooledPacket() { BenchPool::GetInstance().ReleaseOpus(std::move(payload)); }
+    static void* operator new(size_t size) { return BenchPool::GetInstance().Allocate(size); }
+    static void operator delete(void* ptr) { BenchPool::GetInstance().Free(ptr); }
+};
+
+static std::unique_ptr<PooledPacket> acquire_packet() {
+    auto packet = std::make_unique<PooledPacket>();
+    packet->payload = BenchPool::GetInstance().AcquireOpus();
+    return packet;
+}
+
+// ============== Traffic ==============
+
+enum Transport { kWebsocketV2, kWebsocketV3, kUdp };
+static const char* kTransportNames[] = { "websocket v2", "websocket v3", "mqtt udp" };
+
+static std::vector<std::vector<uint8_t>> make_frames(Transport transport, int count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> size_dist(100, 300);
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < count; i++) {
+        size_t payload_size = size_dist(rng);
+        size_t header = transport == kWebsocketV2 ? sizeof(BinaryProtocol2) :
+                        transport == kWebsocketV3 ? sizeof(BinaryProtocol3) : UDP_AUDIO_HEADER_SIZE;
+        std::vector<uint8_t> frame(header + payload_size);
+        for (size_t j = header; j < frame.size(); j++) {
+            frame[j] = (uint8_t)rng();
+        }
+        uint32_t timestamp = i * 60;
+        if (transport == kWebsocketV2) {
+            auto bp2 = (BinaryProtocol2*)frame.data();
+            bp2->version = bswap16(2);
+            bp2->type = 0;
+            bp2->reserved = 0;
+            bp2->timestamp = bswap32(timestamp);
+            bp2->payload_size = bswap32(payload_size);
+        } else if (transport == kWebsocketV3) {
+            auto bp3 = (BinaryProtocol3*)frame.data();
+            bp3->type = 0;
+            bp3->reserved = 0;
+            bp3->payload_size = bswap16(payload_size);
+        } else {
+            frame[0] = UDP_AUDIO_PACKET_TYPE;
+            uint16_t len = bswap16(payload_size);
+            memcpy(&frame[2], &len, 2);
+            uint32_t ts = bswap32(timestamp), seq = bswap32(i + 1);
+            memcpy(&frame[8], &ts, 4);
+            memcpy(&frame[12], &seq, 4);
+        }
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+// The receive paths, as in WebsocketProtocol / MqttProtocol before and after
+
+static std::unique_ptr<HeapPacket> receive_copy(Transport transport, uint8_t* data, size_t len) {
+    auto packet = std::make_unique<HeapPacket>();
+    packet->sample_rate = 24000;
+    packet->frame_duration = 60;
+    if (transport == kWebsocketV2) {
+        BinaryProtocol2* bp2 = (BinaryProtocol2*)data;
+        bp2->version = bswap16(bp2->version);
+        bp2->type = bswap16(bp2->type);
+        bp2->timestamp = bswap32(bp2->timestamp);
+        bp2->payload_size = bswap32(bp2->payload_size);
+        packet->timestamp = bp2->timestamp;
+        packet->payload.assign(bp2->payload, bp2->payload + bp2->payload_size);
+    } else if (transport == kWebsocketV3) {
+        BinaryProtocol3* bp3 = (BinaryProtocol3*)data;
+        bp3->payload_size = bswap16(bp3->payload_size);
+        packet->payload.assign(bp3->payload, bp3->payload + bp3->payload_size);
+    } else {
+        uint32_t timestamp;
+        memcpy(&timestamp, data + 8, 4);
+        packet->timestamp = bswap32(timestamp);
+        size_t size = len - UDP_AUDIO_HEADER_SIZE;
+        packet->payload.resize(size);
+        ctr_crypt(size, data, data + UDP_AUDIO_HEADER_SIZE, packet->payload.data());  // Nonce advanced in place
+    }
+    return packet;
+}
+
+static std::unique_ptr<PooledPacket> receive_view(Transport transport, const uint8_t* data, size_t len) {
+    AudioFrameView frame;
+    bool ok = transport == kUdp ? ParseUdpAudioPacket(data, len, frame) :
+                                  ParseWebsocketAudioFrame(transport == kWebsocketV2 ? 2 : 3, data, len, frame);
+    if (!ok) {
+        return nullptr;
+    }
+    auto packet = acquire_packet();
+    packet->sample_rate = 24000;
+    packet->frame_duration = 60;
+    packet->timestamp = frame.timestamp;
+    if (transport == kUdp) {
+        uint8_t nonce[UDP_AUDIO_HEADER_SIZE];
+        memcpy(nonce, data, sizeof(nonce));
+        packet->payload.resize(frame.payload_size);
+        ctr_crypt(frame.payload_size, nonce, frame.payload, packet->payload.data());
+    } else {
+        packet->payload.assign(frame.payload, frame.payload + frame.payload_size);
+    }
+    return packet;
+}
+
+struct Measurement {
+    double ns_per_packet;
+    double allocations_per_packet;
+    uint64_t checksum;
+};
+
+template <typename Receive>
+static Measurement run(const std::vector<std::vector<uint8_t>>& pristine, int rounds, bool restore, Receive receive) {
+    std::vector<std::vector<uint8_t>> frames = pristine;
+    double total_ns = 0;
+    uint64_t allocations = 0, checksum = 0, packets = 0;
+    for (int r = 0; r < rounds; r++) {
+        if (restore) {
+            // The in-place paths rewrite the header (and nonce); give them fresh frames
+            for (size_t i = 0; i < frames.size(); i++) {
+                memcpy(frames[i].data(), pristine[i].data(), pristine[i].size());
+            }
+        }
+        uint64_t alloc_start = g_allocations;
+        auto start = std::chrono::steady_clock::now();
+        decltype(receive(frames[0])) queue[DECODE_QUEUE_DEPTH];
+        for (size_t i = 0; i < frames.size(); i++) {
+            auto packet = receive(frames[i]);
+            if (packet) {
+                checksum += packet->timestamp + packet->payload.size() + packet->payload[0];
+            }
+            queue[i % DECODE_QUEUE_DEPTH] = std::move(packet);  // Oldest one is decoded and freed
+        }
+        for (auto& p : queue) {
+            p.reset();
+        }
+        total_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        allocations += g_allocations - alloc_start;
+        packets += frames.size();
+    }
+    return { total_ns / packets, (double)allocations / packets, checksum };
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 200;
+    int count = argc > 2 ? atoi(argv[2]) : 1000;
+    if (rounds <= 0 || count <= 0) {
+        fprintf(stderr, "usage: %s [rounds] [packets]\n", argv[0]);
+        return 2;
+    }
+    BenchPool::GetInstance().Initialize(sizeof(PooledPacket));
+
+    printf("24kHz / 60ms downlink, %d packets x %d rounds, payload 100-300 bytes\n", count, rounds);
+    printf("%-14s %14s %14s %14s %14s\n", "transport", "copy ns/pkt", "copy allocs", "view ns/pkt", "view allocs");
+    bool ok = true;
+    for (Transport transport : { kWebsocketV2, kWebsocketV3, kUdp }) {
+        auto frames = make_frames(transport, count, 42 + transport);
+        Measurement copy = run(frames, rounds, true, [&](std::vector<uint8_t>& f) {
+            return receive_copy(transport, f.data(), f.size());
+        });
+        Measurement view = run(frames, rounds, false, [&](std::vector<uint8_t>& f) {
+            return receive_view(transport, f.data(), f.size());
+        });
+        bool same = copy.checksum == view.checksum;
+        ok = ok && same;
+        printf("%-14s %14.1f %14.2f %14.1f %14.2f%s\n", kTransportNames[transport], copy.ns_per_packet,
+               copy.allocations_per_packet, view.ns_per_packet, view.allocations_per_packet,
+               same ? "" : "  MISMATCH");
+    }
+
+    // Truncated and oversized frames must be rejected, not read past the end
+    uint8_t bad[8] = { 0, 2, 0, 0, 0, 0, 0, 0 };
+    AudioFrameView frame;
+    uint8_t v3[6] = { 0, 0, 0x01, 0x00, 1, 2 };
+    if (ParseWebsocketAudioFrame(2, bad, sizeof(bad), frame) || ParseWebsocketAudioFrame(3, v3, sizeof(v3), frame) ||
+        ParseUdpAudioPacket(bad, sizeof(bad), frame)) {
+        printf("malformed frame accepted\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
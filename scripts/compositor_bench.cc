@@ -0,0 +1,302 @@
+/*
+ * 宠物动画合成基准 (waveshare-c6-lcd-1.69 animation_timer_callback)
+ *
+ * 在主机上用真实的 frames.bin 对比两种合成循环:
+ * 1. pixel: 旧循环, 每个像素做边界判断、is_background_color() 和 sample_item_pixel_fast()
+ * 2. span:  新循环, 每帧先把不透明区域解析为逐行 run 列表 (SpriteRuns),
+ *           然后背景 memcpy, 物品和宠物按 run 拷贝, 无逐像素分支
+ * 两种结果逐像素比对, 不一致时报错退出。
+ *
+ * 编译 (在仓库根目录):
+ *   g++ -O2 -std=c++17 -Imain/images scripts/compositor_bench.cc main/images/sprite_runs.cc -o compositor_bench
+ *
+ * 使用方法:
+ *   ./compositor_bench gifs/frames.bin [gifs/items/frames.bin] [rounds]
+ *
+ * 帧格式与 main/images/animation_loader.h 一致 (每帧 768 字节 RGB888 调色板 + 160x160 索引),
+ * 物品格式与 main/images/item_loader.h 一致 (255 色调色板 + 40x40 索引)。
+ * 合成常量、色键范围和物品位置需与板级文件保持一致。主机计时只用于对比两种循环的相对开销。
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "sprite_runs.h"
+
+#define ANIM_FRAME_WIDTH    160
+#define ANIM_FRAME_HEIGHT   160
+#define ANIM_PALETTE_SIZE   (256 * 3)
+#define ANIM_PIXELS_SIZE    (ANIM_FRAME_WIDTH * ANIM_FRAME_HEIGHT)
+#define ANIM_FRAME_SIZE_RAW (ANIM_PALETTE_SIZE + ANIM_PIXELS_SIZE)
+
+#define ITEM_WIDTH          40
+#define ITEM_HEIGHT         40
+#define ITEM_PALETTE_SIZE   (255 * 3)
+#define ITEM_FRAME_SIZE     (ITEM_PALETTE_SIZE + ITEM_WIDTH * ITEM_HEIGHT)
+#define ITEM_TYPE_COUNT     2
+static const uint8_t ITEM_BG_COLOR_INDEX[ITEM_TYPE_COUNT] = {68, 0};  // item_loader.cc
+
+#define COMPOSITE_WIDTH     280
+#define COMPOSITE_HEIGHT    240
+#define TOP_UI_HEIGHT       25
+#define BOTTOM_UI_HEIGHT    25
+#define ANIM_OFFSET_X       ((COMPOSITE_WIDTH - ANIM_FRAME_WIDTH) / 2)
+#define ANIM_OFFSET_Y       ((COMPOSITE_HEIGHT - ANIM_FRAME_HEIGHT) / 2)
+#define ITEM_CENTER_X       (COMPOSITE_WIDTH / 2)
+#define ITEM_CENTER_Y       180
+
+#define BG_R_MAX  3
+#define BG_G_MIN  36
+#define BG_G_MAX  46
+#define BG_B_MIN  10
+#define BG_B_MAX  14
+
+static inline bool is_background_color(uint16_t pixel) {
+    uint8_t r = (pixel >> 11) & 0x1F;
+    uint8_t g = (pixel >> 5) & 0x3F;
+    uint8_t b = pixel & 0x1F;
+    return (r <= BG_R_MAX && g >= BG_G_MIN && g <= BG_G_MAX && b >= BG_B_MIN && b <= BG_B_MAX);
+}
+
+static inline uint16_t rgb888_to_rgb565(const uint8_t* rgb) {
+    return ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+}
+
+static bool decode_indexed(FILE* f, long offset, size_t palette_size, size_t pixels, uint16_t* out) {
+    std::vector<uint8_t> raw(palette_size + pixels);
+    if (fseek(f, offset, SEEK_SET) != 0 || fread(raw.data(), 1, raw.size(), f) != raw.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < pixels; i++) {
+        out[i] = rgb888_to_rgb565(&raw[raw[palette_size + i] * 3]);
+    }
+    return true;
+}
+
+// Stand-in for ItemLoader: out-of-line accessors like the firmware's singleton
+struct Items {
+    uint16_t pixels[ITEM_TYPE_COUNT][ITEM_WIDTH * ITEM_HEIGHT];
+    uint16_t key[ITEM_TYPE_COUNT];
+    SpriteRuns runs[ITEM_TYPE_COUNT];
+
+    __attribute__((noinline)) bool IsTransparent(uint16_t type, uint16_t x, uint16_t y) const {
+        if (type >= ITEM_TYPE_COUNT || x >= ITEM_WIDTH || y >= ITEM_HEIGHT) return true;
+        return pixels[type][y * ITEM_WIDTH + x] == key[type];
+    }
+    __attribute__((noinline)) uint16_t GetPixel(uint16_t type, uint16_t x, uint16_t y) const {
+        if (type >= ITEM_TYPE_COUNT || x >= ITEM_WIDTH || y >= ITEM_HEIGHT) return 0;
+        return pixels[type][y * ITEM_WIDTH + x];
+    }
+};
+static Items items;
+
+struct Item {
+    int16_t x1, y1, x2, y2;
+    uint8_t type;
+};
+
+struct Scene {
+    int16_t sprite_x, sprite_y;
+    bool mirror;
+    std::vector<Item> items;
+    int16_t items_min_y, items_max_y;
+};
+
+static Scene make_scene(int16_t offset_x, int16_t offset_y, bool mirror, const std::vector<std::pair<int, int>>& coins,
+                        const std::vector<std::pair<int, int>>& poops) {
+    Scene s = {(int16_t)(ANIM_OFFSET_X + offset_x), (int16_t)(ANIM_OFFSET_Y + offset_y), mirror, {},
+               COMPOSITE_HEIGHT, 0};
+    auto add = [&](int x, int y, uint8_t type) {
+        Item c;
+        c.x1 = ITEM_CENTER_X + x - ITEM_WIDTH / 2;
+        c.y1 = ITEM_CENTER_Y + y - ITEM_HEIGHT / 2;
+        c.x2 = c.x1 + ITEM_WIDTH;
+        c.y2 = c.y1 + ITEM_HEIGHT;
+        c.type = type;
+        if (c.y1 < s.items_min_y) s.items_min_y = c.y1;
+        if (c.y2 > s.items_max_y) s.items_max_y = c.y2;
+        s.items.push_back(c);
+    };
+    // Same order as prepare_item_bounds_cache(): poops first, then coins
+    for (auto& p : poops) add(p.first, p.second, 1);
+    for (auto& c : coins) add(c.first, c.second, 0);
+    return s;
+}
+
+// ---- Old loop (per-pixel) ----
+
+static inline bool sample_item_pixel(const Scene& s, int16_t x, int16_t y, uint16_t* out) {
+    if (y < s.items_min_y || y >= s.items_max_y) return false;
+    for (const auto& c : s.items) {
+        if (x < c.x1 || x >= c.x2 || y < c.y1 || y >= c.y2) continue;
+        uint16_t lx = x - c.x1, ly = y - c.y1;
+        if (items.IsTransparent(c.type, lx, ly)) continue;
+        *out = items.GetPixel(c.type, lx, ly);
+        return true;
+    }
+    return false;
+}
+
+static void composite_pixel(const Scene& s, const uint16_t* anim, const uint16_t* bg, uint16_t* out) {
+    bool has_items = !s.items.empty();
+    for (uint16_t y = TOP_UI_HEIGHT; y < COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT; y++) {
+        const uint16_t* bg_row = &bg[y * COMPOSITE_WIDTH];
+        uint16_t* out_row = &out[y * COMPOSITE_WIDTH];
+        bool in_anim_y = ((int16_t)y >= s.sprite_y && (int16_t)y < s.sprite_y + ANIM_FRAME_HEIGHT);
+        int16_t sy = (int16_t)y - s.sprite_y;
+        uint16_t src_y = (sy >= 0 && sy < ANIM_FRAME_HEIGHT) ? sy : 0;
+        for (uint16_t x = 0; x < COMPOSITE_WIDTH; x++) {
+            uint16_t out_pixel, item_pixel;
+            bool in_anim_x = ((int16_t)x >= s.sprite_x && (int16_t)x < s.sprite_x + ANIM_FRAME_WIDTH);
+            if (in_anim_y && in_anim_x) {
+                int16_t sx = (int16_t)x - s.sprite_x;
+                uint16_t src_x = (sx >= 0 && sx < ANIM_FRAME_WIDTH) ? sx : 0;
+                if (s.mirror) src_x = ANIM_FRAME_WIDTH - 1 - src_x;
+                uint16_t anim_pixel = anim[src_y * ANIM_FRAME_WIDTH + src_x];
+                if (is_background_color(anim_pixel)) {
+                    out_pixel = (has_items && sample_item_pixel(s, x, y, &item_pixel)) ? item_pixel : bg_row[x];
+                } else {
+                    out_pixel = anim_pixel;
+                }
+            } else {
+                out_pixel = (has_items && sample_item_pixel(s, x, y, &item_pixel)) ? item_pixel : bg_row[x];
+            }
+            out_row[x] = out_pixel;
+        }
+    }
+}
+
+// ---- New loop (runs) - mirrors composite_row_span() ----
+
+static SpriteRuns pet_runs;
+
+static void composite_span(const Scene& s, const uint16_t* anim, const uint16_t* bg, uint16_t* out) {
+    pet_runs.Build(anim, ANIM_FRAME_WIDTH, ANIM_FRAME_HEIGHT, is_background_color);
+    for (int16_t y = TOP_UI_HEIGHT; y < COMPOSITE_HEIGHT - BOTTOM_UI_HEIGHT; y++) {
+        const int16_t x1 = 0, x2 = COMPOSITE_WIDTH;
+        uint16_t* out_row = &out[y * COMPOSITE_WIDTH];
+        memcpy(out_row + x1, &bg[y * COMPOSITE_WIDTH] + x1, (x2 - x1) * sizeof(uint16_t));
+        if (y >= s.items_min_y && y < s.items_max_y) {
+            for (int i = (int)s.items.size() - 1; i >= 0; i--) {
+                const auto& c = s.items[i];
+                if (y < c.y1 || y >= c.y2) continue;
+                items.runs[c.type].BlitRow(y - c.y1, c.x1, false, out_row, x1, x2);
+            }
+        }
+        if (y >= s.sprite_y && y < s.sprite_y + ANIM_FRAME_HEIGHT) {
+            pet_runs.BlitRow(y - s.sprite_y, s.sprite_x, s.mirror, out_row, x1, x2);
+        }
+    }
+}
+
+template <typename Fn>
+static double time_ns(Fn fn, int rounds) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s frames.bin [items.bin] [rounds]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 3 ? atoi(argv[3]) : 20;
+
+    FILE* f = fopen(argv[1], "rb");
+    if (f == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long frame_count = ftell(f) / ANIM_FRAME_SIZE_RAW;
+    std::vector<std::vector<uint16_t>> frames(frame_count, std::vector<uint16_t>(ANIM_PIXELS_SIZE));
+    for (long i = 0; i < frame_count; i++) {
+        if (!decode_indexed(f, i * ANIM_FRAME_SIZE_RAW, ANIM_PALETTE_SIZE, ANIM_PIXELS_SIZE, frames[i].data())) {
+            fprintf(stderr, "failed to read frame %ld\n", i);
+            return 1;
+        }
+    }
+    fclose(f);
+    if (frame_count == 0) {
+        fprintf(stderr, "%s: no frames\n", argv[1]);
+        return 1;
+    }
+
+    bool have_items = false;
+    if (argc > 2) {
+        FILE* fi = fopen(argv[2], "rb");
+        if (fi == nullptr) {
+            perror(argv[2]);
+            return 1;
+        }
+        have_items = true;
+        for (int t = 0; t < ITEM_TYPE_COUNT; t++) {
+            if (!decode_indexed(fi, t * ITEM_FRAME_SIZE, ITEM_PALETTE_SIZE, ITEM_WIDTH * ITEM_HEIGHT, items.pixels[t])) {
+                fprintf(stderr, "failed to read item %d\n", t);
+                return 1;
+            }
+            // Key from the decoded palette entry, like ItemLoader
+            std::vector<uint8_t> pal(ITEM_PALETTE_SIZE);
+            fseek(fi, t * ITEM_FRAME_SIZE, SEEK_SET);
+            if (fread(pal.data(), 1, pal.size(), fi) != pal.size()) return 1;
+            uint16_t key = rgb888_to_rgb565(&pal[ITEM_BG_COLOR_INDEX[t] * 3]);
+            items.key[t] = key;
+            items.runs[t].Build(items.pixels[t], ITEM_WIDTH, ITEM_HEIGHT, [key](uint16_t p) { return p == key; });
+        }
+        fclose(fi);
+    }
+
+    // Background content does not change the cost of either loop; use a gradient
+    std::vector<uint16_t> bg(COMPOSITE_WIDTH * COMPOSITE_HEIGHT);
+    for (int y = 0; y < COMPOSITE_HEIGHT; y++) {
+        for (int x = 0; x < COMPOSITE_WIDTH; x++) {
+            bg[y * COMPOSITE_WIDTH + x] = ((x * 31 / COMPOSITE_WIDTH) << 11) | ((y * 63 / COMPOSITE_HEIGHT) << 5) | 8;
+        }
+    }
+
+    struct Case {
+        const char* name;
+        Scene scene;
+    } cases[] = {
+        {"centered", make_scene(0, 0, false, {}, {})},
+        {"walk mirrored", make_scene(-47, 9, true, {}, {})},
+        {"items", make_scene(20, 0, false, {{-90, 10}, {-40, 12}, {70, 8}}, {{100, 14}})},
+    };
+
+    std::vector<uint16_t> out_pixel(COMPOSITE_WIDTH * COMPOSITE_HEIGHT), out_span(COMPOSITE_WIDTH * COMPOSITE_HEIGHT);
+    size_t total_runs = 0;
+    for (long i = 0; i < frame_count; i++) {
+        pet_runs.Build(frames[i].data(), ANIM_FRAME_WIDTH, ANIM_FRAME_HEIGHT, is_background_color);
+        total_runs += pet_runs.GetRunCount();
+    }
+    printf("%ld frames, avg %.1f opaque runs per pet frame%s\n", frame_count, (double)total_runs / frame_count,
+           have_items ? "" : " (no items file: item case has no visible items)");
+
+    for (auto& c : cases) {
+        // Correctness: both loops must produce the same pixels for every frame
+        for (long i = 0; i < frame_count; i++) {
+            composite_pixel(c.scene, frames[i].data(), bg.data(), out_pixel.data());
+            composite_span(c.scene, frames[i].data(), bg.data(), out_span.data());
+            if (memcmp(out_pixel.data(), out_span.data(), out_pixel.size() * sizeof(uint16_t)) != 0) {
+                fprintf(stderr, "%s: frame %ld differs\n", c.name, i);
+                return 1;
+            }
+        }
+
+        double pixel_ns = time_ns([&] {
+            for (long i = 0; i < frame_count; i++) composite_pixel(c.scene, frames[i].data(), bg.data(), out_pixel.data());
+        }, rounds) / frame_count;
+        double span_ns = time_ns([&] {
+            for (long i = 0; i < frame_count; i++) composite_span(c.scene, frames[i].data(), bg.data(), out_span.data());
+        }, rounds) / frame_count;
+        printf("%-14s pixel %8.1f us/frame   span %8.1f us/frame (incl. run build)   %.1fx\n",
+               c.name, pixel_ns / 1000, span_ns / 1000, pixel_ns / span_ns);
+    }
+    return 0;
+}
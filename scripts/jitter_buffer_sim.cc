@@ -0,0 +1,301 @@
+/*
+ * 抖动缓冲区主机仿真 (main/audio/jitter_buffer.h)
+ *
+ * 在 Linux 上用与设备相同的 JitterBuffer 回放一段 UDP 下行音频包序列, 按到达时间
+ * 逐包 Push, 在 GetTimeToDeadline() 到期时 Poll (与 MqttProtocol 的定时器一致),
+ * 统计:
+ * - 播放的真实帧 / PLC 补帧 / FEC 恢复帧 / 跳过的帧 / 迟到丢弃的包
+ * - 缓冲区引入的额外延迟 (放行时间 - 到达时间, 平均值和最大值) 与目标延迟
+ * - 旧策略 (丢弃 seq <= 上一个包的包, 丢包不补帧) 下能播放的帧数, 用于对比
+ *
+ * 正确性: 真实包必须按序号严格递增放行, FEC 帧携带的必须是紧随其后放行的那个包,
+ * 每个收到的包都必须被放行或计入迟到/重复; 否则返回 1。
+ *
+ * 编译 (在仓库根目录):
+ *   g++ -O2 -std=c++17 -Imain/audio scripts/jitter_buffer_sim.cc -o jitter_buffer_sim
+ *
+ * 使用方法:
+ *   ./jitter_buffer_sim                         # 运行一组预设场景
+ *   ./jitter_buffer_sim [--packets N] [--frame MS] [--loss PCT] [--burst N] [--reorder PCT]
+ *                       [--jitter MS] [--fec] [--seed N]
+ *   ./jitter_buffer_sim --trace file [--frame MS] [--fec]
+ *
+ * 合成序列: 每 frame 毫秒发送一个包, 网络延迟 = 固定 40ms + [0, jitter) 的随机抖动,
+ * 以 loss% 的概率丢失连续 burst 个包, 以 reorder% 的概率额外延迟 1~2 帧 (乱序)。
+ * 轨迹文件: 每行 "到达时间ms 序号", 按文件顺序到达, 未出现的序号视为丢失,
+ * 可以从设备日志或抓包中整理得到。
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "jitter_buffer.h"
+
+#define NETWORK_BASE_DELAY_MS  40
+
+struct SimPacket {
+    std::vector<uint8_t> payload;   // 4 字节序号, 用于校验放行顺序
+    bool fec = false;
+};
+
+struct Arrival {
+    uint32_t time_ms;
+    uint32_t sequence;
+};
+
+struct Scenario {
+    const char* name;
+    int packets;
+    int loss;       // %
+    int burst;
+    int reorder;    // %
+    int jitter_ms;
+    bool fec;
+};
+
+struct Result {
+    uint32_t played = 0;        // 真实帧
+    uint32_t concealed = 0;
+    uint32_t recovered = 0;
+    uint32_t skipped = 0;
+    uint32_t late = 0;
+    uint32_t old_played = 0;    // 旧策略
+    double avg_delay_ms = 0;
+    uint32_t max_delay_ms = 0;
+    uint32_t final_target_ms = 0;
+    uint32_t jitter_ms = 0;
+    bool ok = true;
+};
+
+static std::vector<Arrival> synthesize(const Scenario& s, int frame_ms, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> jitter(0, std::max(s.jitter_ms - 1, 0));
+    std::vector<Arrival> arrivals;
+    for (int i = 0; i < s.packets; i++) {
+        if (percent(rng) < s.loss) {
+            i += s.burst - 1;  // 连续丢失 burst 个包
+            continue;
+        }
+        uint32_t time = 1000 + i * frame_ms + NETWORK_BASE_DELAY_MS + jitter(rng);
+        if (percent(rng) < s.reorder) {
+            time += frame_ms + percent(rng) * frame_ms / 100;
+        }
+        arrivals.push_back({time, (uint32_t)i + 1});
+    }
+    std::stable_sort(arrivals.begin(), arrivals.end(),
+                     [](const Arrival& a, const Arrival& b) { return a.time_ms < b.time_ms; });
+    return arrivals;
+}
+
+static bool read_trace(const char* path, std::vector<Arrival>& arrivals) {
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    unsigned long time, sequence;
+    char line[128];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (sscanf(line, "%lu %lu", &time, &sequence) == 2) {
+            arrivals.push_back({(uint32_t)time, (uint32_t)sequence});
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static uint32_t tag_of(const SimPacket& p) {
+    uint32_t tag = 0;
+    if (p.payload.size() == 4) {
+        memcpy(&tag, p.payload.data(), 4);
+    }
+    return tag;
+}
+
+static Result simulate(const std::vector<Arrival>& arrivals, int frame_ms, bool fec) {
+    Result result;
+    JitterBuffer<SimPacket> buffer;
+    buffer.Configure(frame_ms, fec);
+
+    std::vector<uint32_t> arrival_of;  // 按序号查到达时间
+    uint32_t now = 0;
+    uint32_t last_real = 0;
+    uint32_t expect_after_fec = 0;     // FEC 帧之后必须紧接着放行的序号
+    uint64_t delay_sum = 0;
+
+    auto emit = [&](std::unique_ptr<SimPacket> p) {
+        if (p->fec) {
+            result.recovered++;
+            if (expect_after_fec != 0) {
+                result.ok = false;
+            }
+            expect_after_fec = tag_of(*p);
+            return;
+        }
+        if (p->payload.empty()) {
+            result.concealed++;
+            return;
+        }
+        uint32_t seq = tag_of(*p);
+        if (seq <= last_real || (expect_after_fec != 0 && seq != expect_after_fec)) {
+            fprintf(stderr, "order error: seq %u after %u (fec expects %u)\n", seq, last_real, expect_after_fec);
+            result.ok = false;
+        }
+        expect_after_fec = 0;
+        last_real = seq;
+        result.played++;
+        uint32_t delay = now - arrival_of[seq];
+        delay_sum += delay;
+        result.max_delay_ms = std::max(result.max_delay_ms, delay);
+    };
+    auto make = []() { return std::make_unique<SimPacket>(); };
+
+    // 在到期时间 Poll, 直到 target 时刻
+    auto advance = [&](uint32_t target) {
+        while (true) {
+            int32_t wait = buffer.GetTimeToDeadline(now);
+            if (wait < 0 || now + wait > target) {
+                break;
+            }
+            now += wait;
+            buffer.Poll(now, emit, make);
+        }
+        now = target;
+    };
+
+    uint32_t old_last = 0;
+    uint32_t accepted = 0;
+    for (const auto& a : arrivals) {
+        advance(a.time_ms);
+        if (a.sequence >= arrival_of.size()) {
+            arrival_of.resize(a.sequence + 1);
+        }
+        arrival_of[a.sequence] = a.time_ms;
+
+        auto packet = std::make_unique<SimPacket>();
+        packet->payload.resize(4);
+        memcpy(packet->payload.data(), &a.sequence, 4);
+        auto r = buffer.Push(a.sequence, std::move(packet), now, emit, make);
+        if (r == JitterBuffer<SimPacket>::kPushAccepted || r == JitterBuffer<SimPacket>::kPushReset) {
+            accepted++;
+        }
+
+        // 旧策略: 只接受比上一个大的序号
+        if (a.sequence > old_last) {
+            old_last = a.sequence;
+            result.old_played++;
+        }
+    }
+    advance(now + JITTER_MAX_DELAY_MS * 2);
+
+    const auto& stats = buffer.GetStats();
+    result.skipped = stats.skipped;
+    result.late = stats.late;
+    result.jitter_ms = buffer.GetJitterMs();
+    result.final_target_ms = buffer.GetDelayMs();
+    result.avg_delay_ms = result.played ? (double)delay_sum / result.played : 0;
+    if (buffer.GetHeldCount() != 0 || result.played != accepted ||
+        stats.concealed != result.concealed || stats.recovered != result.recovered) {
+        fprintf(stderr, "accounting error: held=%zu played=%u accepted=%u\n",
+                buffer.GetHeldCount(), result.played, accepted);
+        result.ok = false;
+    }
+    return result;
+}
+
+static void print_header() {
+    printf("%-22s %7s %7s %6s %6s %6s %5s %9s %9s %7s %7s %10s\n", "scenario", "packets", "played", "plc",
+           "fec", "skip", "late", "avg ms", "max ms", "jit ms", "target", "old played");
+}
+
+static void print_result(const char* name, int packets, const Result& r) {
+    printf("%-22s %7d %7u %6u %6u %6u %5u %9.1f %9u %7u %7u %10u%s\n", name, packets, r.played, r.concealed,
+           r.recovered, r.skipped, r.late, r.avg_delay_ms, r.max_delay_ms, r.jitter_ms, r.final_target_ms,
+           r.old_played, r.ok ? "" : "  FAILED");
+}
+
+int main(int argc, char** argv) {
+    Scenario custom = { "custom", 2000, 0, 1, 0, 0, false };
+    int frame_ms = 60;
+    uint32_t seed = 1;
+    const char* trace = nullptr;
+    bool has_custom = false;
+    for (int i = 1; i < argc; i++) {
+        bool value = i + 1 < argc;
+        if (strcmp(argv[i], "--packets") == 0 && value) {
+            custom.packets = atoi(argv[++i]);
+            has_custom = true;
+        } else if (strcmp(argv[i], "--frame") == 0 && value) {
+            frame_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--loss") == 0 && value) {
+            custom.loss = atoi(argv[++i]);
+            has_custom = true;
+        } else if (strcmp(argv[i], "--burst") == 0 && value) {
+            custom.burst = std::max(atoi(argv[++i]), 1);
+            has_custom = true;
+        } else if (strcmp(argv[i], "--reorder") == 0 && value) {
+            custom.reorder = atoi(argv[++i]);
+            has_custom = true;
+        } else if (strcmp(argv[i], "--jitter") == 0 && value) {
+            custom.jitter_ms = atoi(argv[++i]);
+            has_custom = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && value) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--trace") == 0 && value) {
+            trace = argv[++i];
+        } else if (strcmp(argv[i], "--fec") == 0) {
+            custom.fec = true;
+        } else {
+            fprintf(stderr, "usage: %s [--packets N] [--frame MS] [--loss PCT] [--burst N] [--reorder PCT] "
+                            "[--jitter MS] [--fec] [--seed N] | --trace file [--frame MS] [--fec]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    print_header();
+    if (trace != nullptr) {
+        std::vector<Arrival> arrivals;
+        if (!read_trace(trace, arrivals)) {
+            return 1;
+        }
+        uint32_t packets = 0;
+        for (const auto& a : arrivals) {
+            packets = std::max(packets, a.sequence);
+        }
+        Result r = simulate(arrivals, frame_ms, custom.fec);
+        print_result(trace, packets, r);
+        return r.ok ? 0 : 1;
+    }
+
+    std::vector<Scenario> scenarios;
+    if (has_custom) {
+        scenarios.push_back(custom);
+    } else {
+        scenarios = {
+            { "clean",                2000, 0,  1, 0,  0,   false },
+            { "jitter 30ms",          2000, 0,  1, 0,  30,  false },
+            { "reorder 5%",           2000, 0,  1, 5,  10,  false },
+            { "loss 3%",              2000, 3,  1, 0,  10,  false },
+            { "loss 3% fec",          2000, 3,  1, 0,  10,  true },
+            { "burst 2x4 jitter 80",  2000, 2,  4, 2,  80,  false },
+            { "wifi: 5/5/60",         2000, 5,  1, 5,  60,  false },
+            { "wifi: 5/5/60 fec",     2000, 5,  1, 5,  60,  true },
+            { "bad: 10/10/150 fec",   2000, 10, 2, 10, 150, true },
+        };
+    }
+    for (const auto& s : scenarios) {
+        Result r = simulate(synthesize(s, frame_ms, seed), frame_ms, s.fec);
+        print_result(s.name, s.packets, r);
+        ok = ok && r.ok;
+    }
+    return ok ? 0 : 1;
+}
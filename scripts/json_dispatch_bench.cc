@@ -0,0 +1,277 @@
+/*
+ * 服务器控制消息解析基准测试 (main/protocols/server_message.h)
+ *
+ * 先做正确性检查:
+ * - 完美哈希表: 每个消息类型和字段名都能查到, 相近的名字 (前缀, 多一个字符, 大小写) 查不到
+ * - 一组样例消息 (含 \uXXXX / 代理对 / 转义字符, 嵌套对象, 多余字段, 畸形 JSON) 解析出的
+ *   字段与预期一致
+ * 然后按服务器下行的典型比例 (大部分为 tts sentence_start / stt / llm, 少量 mcp) 反复解析一组
+ * 消息, 给出 消息/秒 和 每条消息的堆分配字节数 (替换全局 operator new 计数):
+ * 1. stream: ParseServerMessage() 读入复用的 ServerMessage, 按类型分发; 需要 DOM 的 mcp 消息
+ *            额外用 cJSON 解析 (编译时带上 cJSON 才计入)
+ * 2. stream+copy: 同上, 再把 text / emotion 拷贝到 std::string (与 Schedule 捕获一致)
+ * 3. cjson: 改动前的写法 - cJSON_Parse 整条消息, strcmp 链判断类型, 拷贝字符串 (需要 cJSON)
+ *
+ * 编译 (在仓库根目录):
+ *   g++ -O2 -std=c++17 -Imain/protocols scripts/json_dispatch_bench.cc main/protocols/server_message.cc \
+ *       -o json_dispatch_bench
+ * 与 cJSON 对比 (cJSON 源码在 ESP-IDF 的 components/json/cJSON 下):
+ *   gcc -O2 -c $IDF_PATH/components/json/cJSON/cJSON.c -o cJSON.o
+ *   g++ -O2 -std=c++17 -DWITH_CJSON -Imain/protocols -I$IDF_PATH/components/json/cJSON \
+ *       scripts/json_dispatch_bench.cc main/protocols/server_message.cc cJSON.o -o json_dispatch_bench
+ *
+ * 使用方法:
+ *   ./json_dispatch_bench [rounds]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "server_message.h"
+#ifdef WITH_CJSON
+#include "cJSON.h"
+#endif
+
+static size_t g_alloc_count = 0;
+static size_t g_alloc_bytes = 0;
+
+void* operator new(size_t size) {
+    g_alloc_count++;
+    g_alloc_bytes += size;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+#ifdef WITH_CJSON
+static void* counting_malloc(size_t size) {
+    g_alloc_count++;
+    g_alloc_bytes += size;
+    return malloc(size);
+}
+#endif
+
+struct Sample {
+    const char* json;
+    bool ok;
+    ServerMessageType type;
+    const char* state;
+    const char* text;
+    const char* emotion;
+};
+
+static const Sample kSamples[] = {
+    { R"({"type":"tts","state":"start","session_id":"a1"})", true, kServerMessageTts, "start", "", "" },
+    { R"({"session_id":"a1","type":"tts","state":"sentence_start","text":"今天天气不错，适合出去走走。"})",
+      true, kServerMessageTts, "sentence_start", "今天天气不错，适合出去走走。", "" },
+    { R"({"type":"tts","state":"sentence_start","text":"你好，\"小智\"\n😀"})",
+      true, kServerMessageTts, "sentence_start", "你好，\"小智\"\n😀", "" },
+    { R"( { "type" : "stt" , "text" : "a\\b\/c\t" , "extra" : [1, {"x":"}"}, null] } )",
+      true, kServerMessageStt, "", "a\\b/c\t", "" },
+    { R"({"type":"llm","text":"😀","emotion":"happy","session_id":"a1"})", true, kServerMessageLlm, "", "😀", "happy" },
+    { R"({"type":"mcp","payload":{"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"self.get_device_status","arguments":{}}}})",
+      true, kServerMessageMcp, "", "", "" },
+    { R"({"type":"alert","status":"warning","message":"低电量","emotion":"sad"})", true, kServerMessageAlert, "", "", "sad" },
+    { R"({"type":"goodbye","session_id":"a1"})", true, kServerMessageGoodbye, "", "", "" },
+    { R"({"type":"ping","value":1.5e3,"flag":true})", true, kServerMessageUnknown, "", "", "" },
+    { R"({"state":"start"})", false, kServerMessageUnknown, "", "", "" },
+    { R"({"type":"tts","state":"start")", false, kServerMessageUnknown, "", "", "" },
+    { R"({"type":"tts","text":"unterminated})", false, kServerMessageUnknown, "", "", "" },
+    { R"(["type","tts"])", false, kServerMessageUnknown, "", "", "" },
+    { R"({"type":12})", false, kServerMessageUnknown, "", "", "" },
+};
+
+static bool check_lookup() {
+    bool ok = true;
+    const char* types[] = { "hello", "goodbye", "tts", "stt", "llm", "mcp", "system", "alert", "custom" };
+    for (const char* name : types) {
+        ServerMessageType type = LookupServerMessageType(name, strlen(name));
+        if (type == kServerMessageUnknown || strcmp(GetServerMessageTypeName(type), name) != 0) {
+            fprintf(stderr, "type lookup failed: %s\n", name);
+            ok = false;
+        }
+        std::string near[] = { std::string(name) + "s", std::string(name, strlen(name) - 1), std::string(name) };
+        near[2][0] = near[2][0] - 'a' + 'A';
+        for (const auto& n : near) {
+            if (LookupServerMessageType(n.data(), n.size()) != kServerMessageUnknown) {
+                fprintf(stderr, "false type match: %s\n", n.c_str());
+                ok = false;
+            }
+        }
+    }
+    // Fields are checked through parsing: each one must land in its own member
+    ServerMessage message;
+    const char* json = R"({"type":"t","state":"s","text":"x","emotion":"e","session_id":"i","command":"c","status":"st","message":"m","texts":"no"})";
+    if (!ParseServerMessage(json, strlen(json), message) || message.type_name != "t" || message.state != "s" ||
+        message.text != "x" || message.emotion != "e" || message.session_id != "i" || message.command != "c" ||
+        message.status != "st" || message.message != "m") {
+        fprintf(stderr, "field lookup failed\n");
+        ok = false;
+    }
+    return ok;
+}
+
+static bool check_samples() {
+    bool ok = true;
+    ServerMessage message;
+    for (const auto& s : kSamples) {
+        bool parsed = ParseServerMessage(s.json, strlen(s.json), message);
+        bool match = parsed == s.ok;
+        if (parsed && s.ok) {
+            match = message.type == s.type && message.state == s.state && message.text == s.text &&
+                    message.emotion == s.emotion &&
+                    message.needs_json == (s.type == kServerMessageMcp || s.type == kServerMessageHello ||
+                                           s.type == kServerMessageCustom);
+        }
+        if (!match) {
+            fprintf(stderr, "sample failed: %s\n  parsed=%d type=%d state=[%s] text=[%s] emotion=[%s]\n", s.json,
+                    parsed, message.type, message.state.c_str(), message.text.c_str(), message.emotion.c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Downlink mix of one spoken reply: sentences, stt, emotion, tts start/stop, one mcp call
+static std::vector<std::string> make_workload() {
+    std::vector<std::string> messages;
+    messages.push_back(R"({"type":"stt","text":"帮我把音量调到百分之六十","session_id":"6f1c2e"})");
+    messages.push_back(R"({"type":"llm","text":"😊","emotion":"happy","session_id":"6f1c2e"})");
+    messages.push_back(R"({"type":"mcp","payload":{"jsonrpc":"2.0","id":7,"method":"tools/call","params":{"name":"self.audio_speaker.set_volume","arguments":{"volume":60}}},"session_id":"6f1c2e"})");
+    messages.push_back(R"({"type":"tts","state":"start","sample_rate":24000,"session_id":"6f1c2e"})");
+    const char* sentences[] = {
+        "好的，已经帮你把音量调到百分之六十了。",
+        "\\u73b0\\u5728\\u542c\\u8d77\\u6765\\u600e\\u4e48\\u6837\\uff1f",
+        "如果还觉得太小声，可以随时叫我再调大一点。",
+        "对了，今天下午可能会下雨，出门记得带伞哦。",
+    };
+    for (const char* s : sentences) {
+        messages.push_back(std::string(R"({"type":"tts","state":"sentence_start","text":")") + s +
+                           R"(","session_id":"6f1c2e"})");
+        messages.push_back(R"({"type":"tts","state":"sentence_end","session_id":"6f1c2e"})");
+    }
+    messages.push_back(R"({"type":"tts","state":"stop","session_id":"6f1c2e"})");
+    return messages;
+}
+
+struct BenchResult {
+    double messages_per_second;
+    double bytes_per_message;
+    double allocs_per_message;
+};
+
+template <typename F>
+static BenchResult run(const std::vector<std::string>& messages, int rounds, F&& handle) {
+    // Warm up: buffers grow to the messages seen
+    for (const auto& m : messages) {
+        handle(m);
+    }
+    size_t count0 = g_alloc_count, bytes0 = g_alloc_bytes;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& m : messages) {
+            handle(m);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double total = (double)rounds * messages.size();
+    return { total / seconds, (g_alloc_bytes - bytes0) / total, (g_alloc_count - count0) / total };
+}
+
+static volatile size_t g_sink = 0;
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    bool ok = check_lookup() && check_samples();
+    printf("correctness: %s\n", ok ? "ok" : "FAILED");
+
+#ifdef WITH_CJSON
+    cJSON_Hooks hooks = { counting_malloc, free };
+    cJSON_InitHooks(&hooks);
+#endif
+
+    auto messages = make_workload();
+    size_t bytes = 0;
+    for (const auto& m : messages) {
+        bytes += m.size();
+    }
+    printf("workload: %zu messages per reply, %zu bytes on average, %d rounds\n", messages.size(),
+           bytes / messages.size(), rounds);
+
+    ServerMessage message;
+    auto stream = [&](const std::string& m, bool copy) {
+        if (!ParseServerMessage(m.data(), m.size(), message)) {
+            return;
+        }
+        if (message.needs_json) {
+#ifdef WITH_CJSON
+            cJSON* root = cJSON_ParseWithLength(m.data(), m.size());
+            g_sink += root != nullptr;
+            cJSON_Delete(root);
+#endif
+            return;
+        }
+        switch (message.type) {
+        case kServerMessageTts:
+        case kServerMessageStt:
+        case kServerMessageLlm:
+            if (copy) {
+                std::string captured = message.type == kServerMessageLlm ? message.emotion : message.text;
+                g_sink += captured.size();
+            } else {
+                g_sink += message.text.size() + message.emotion.size();
+            }
+            break;
+        default:
+            break;
+        }
+    };
+
+    printf("%-12s %14s %12s %12s\n", "path", "messages/s", "heap B/msg", "allocs/msg");
+    auto print = [](const char* name, const BenchResult& r) {
+        printf("%-12s %14.0f %12.1f %12.2f\n", name, r.messages_per_second, r.bytes_per_message, r.allocs_per_message);
+    };
+    print("stream", run(messages, rounds, [&](const std::string& m) { stream(m, false); }));
+    print("stream+copy", run(messages, rounds, [&](const std::string& m) { stream(m, true); }));
+
+#ifdef WITH_CJSON
+    print("cjson", run(messages, rounds, [&](const std::string& m) {
+        cJSON* root = cJSON_Parse(m.c_str());
+        auto type = cJSON_GetObjectItem(root, "type");
+        if (strcmp(type->valuestring, "tts") == 0) {
+            auto state = cJSON_GetObjectItem(root, "state");
+            if (strcmp(state->valuestring, "sentence_start") == 0) {
+                auto text = cJSON_GetObjectItem(root, "text");
+                std::string captured = text->valuestring;
+                g_sink += captured.size();
+            }
+        } else if (strcmp(type->valuestring, "stt") == 0) {
+            std::string captured = cJSON_GetObjectItem(root, "text")->valuestring;
+            g_sink += captured.size();
+        } else if (strcmp(type->valuestring, "llm") == 0) {
+            std::string captured = cJSON_GetObjectItem(root, "emotion")->valuestring;
+            g_sink += captured.size();
+        }
+        cJSON_Delete(root);
+    }));
+#else
+    printf("(built without cJSON: see the header for the comparison build)\n");
+#endif
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+#!/usr/bin/env python3
+"""
+记忆归档工具 - 分段二进制格式 (memory partition, /spiffs/memory)
+
+功能:
+1. export: 将分段归档 (<type>_NNNN.seg + <type>.idx) 导出为 JSONL, 便于调试
+2. import: 将 JSONL 归档转换为分段格式 (与设备端 MemoryArchive::ImportJsonl 一致)
+3. bench:  生成 3 年的合成归档, 对比 JSONL 全量扫描与分段索引召回的读取量和耗时,
+           以及关键词倒排索引 (<type>_kNN.pst, CJK 双字 + ASCII 单词) 与全量扫描
+
+使用方法:
+    python memory_archive_tool.py export <目录> fact [输出.jsonl]
+    python memory_archive_tool.py import <facts_archive.jsonl> <目录> fact
+    python memory_archive_tool.py bench [每天条数]
+
+格式需与 main/memory/memory_archive.h 保持一致。
+"""
+
+import io
+import json
+import os
+import random
+import struct
+import sys
+import tempfile
+import time
+
+RECORD_FMT = "<IIBBBB32s12s128s8s"      # ArchiveRecord, 192 bytes
+RECORD_SIZE = struct.calcsize(RECORD_FMT)
+FOOTER_FMT = "<4sHHIIII"                # ArchiveSegmentFooter, 24 bytes
+INDEX_HEADER_FMT = "<4sHH"              # ArchiveIndexHeader
+INDEX_ENTRY_FMT = "<HHIIII"             # ArchiveIndexEntry, 20 bytes
+RECORDS_PER_SEGMENT = 128
+FORMAT_VERSION = 1
+
+KINDS = {"fact": 0, "moment": 1, "event": 2}
+KIND_NAMES = {v: k for k, v in KINDS.items()}
+
+KEYWORD_BUCKETS = 32                    # KeywordIndex::BUCKET_COUNT
+MAX_KEYWORD_CANDIDATES = 256
+
+assert RECORD_SIZE == 192
+
+
+def _cstr(data):
+    return data.split(b"\0", 1)[0].decode("utf-8", errors="replace")
+
+
+def _fixed(text, size):
+    raw = text.encode("utf-8")[:size - 1]
+    return raw + b"\0" * (size - len(raw))
+
+
+def date_key(ts):
+    t = time.localtime(ts)
+    return t.tm_year * 10000 + t.tm_mon * 100 + t.tm_mday
+
+
+def pack_record(kind, ts, content, label="", date="", emotion_type=0, emotion_intensity=0, importance=0):
+    return struct.pack(RECORD_FMT, ts, date_key(ts), kind, emotion_type, emotion_intensity, importance,
+                       _fixed(label, 32), _fixed(date, 12), _fixed(content, 128), b"\0" * 8)
+
+
+def unpack_record(data):
+    ts, dkey, kind, et, ei, imp, label, date, content, _ = struct.unpack(RECORD_FMT, data)
+    return {"timestamp": ts, "date_key": dkey, "kind": kind, "emotion_type": et, "emotion_intensity": ei,
+            "importance": imp, "label": _cstr(label), "date": _cstr(date), "content": _cstr(content)}
+
+
+def record_to_json(rec):
+    out = {"timestamp": time.strftime("%Y-%m-%dT%H:%M:%S", time.localtime(rec["timestamp"]))}
+    kind = KIND_NAMES.get(rec["kind"], "event")
+    out["type"] = kind
+    if kind == "fact":
+        out["content"] = rec["content"]
+    elif kind == "moment":
+        out.update(topic=rec["label"], content=rec["content"], emotion_type=rec["emotion_type"],
+                   emotion_intensity=rec["emotion_intensity"], importance=rec["importance"])
+    else:
+        out.update(date=rec["date"], event_type=rec["label"], content=rec["content"],
+                   significance=rec["importance"])
+    return json.dumps(out, ensure_ascii=False, separators=(",", ":"))
+
+
+class SegmentWriter:
+    """按设备端 AppendRecord 的规则写入分段"""
+
+    def __init__(self, directory, type_name):
+        self.directory = directory
+        self.type_name = type_name
+        self.sealed = []
+        self.active = None
+
+    def _path(self, seg):
+        return os.path.join(self.directory, "%s_%04d.seg" % (self.type_name, seg))
+
+    def append(self, record):
+        rec = unpack_record(record)
+        if self.active is None:
+            seg = self.sealed[-1][0] + 1 if self.sealed else 1
+            self.active = [seg, 0, rec["date_key"], 0, rec["timestamp"], 0]
+            open(self._path(seg), "wb").close()
+        with open(self._path(self.active[0]), "ab") as f:
+            f.write(record)
+            self.active[1] += 1
+            self.active[3] = rec["date_key"]
+            self.active[5] = rec["timestamp"]
+            if self.active[1] >= RECORDS_PER_SEGMENT:
+                seg, count, fd, ld, ft, lt = self.active
+                f.write(struct.pack(FOOTER_FMT, b"XZSG", FORMAT_VERSION, count, fd, ld, ft, lt))
+                self.sealed.append(tuple(self.active))
+                self.active = None
+                self._save_index()
+
+    def _save_index(self):
+        with open(os.path.join(self.directory, "%s.idx" % self.type_name), "wb") as f:
+            f.write(struct.pack(INDEX_HEADER_FMT, b"XZAI", FORMAT_VERSION, len(self.sealed)))
+            for entry in self.sealed:
+                f.write(struct.pack(INDEX_ENTRY_FMT, *entry))
+
+
+def _fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def _is_cjk(ch):
+    cp = ord(ch)
+    return (0x3040 <= cp <= 0x30FF or 0x3400 <= cp <= 0x4DBF or 0x4E00 <= cp <= 0x9FFF or
+            0xAC00 <= cp <= 0xD7AF or 0xF900 <= cp <= 0xFAFF)
+
+
+def tokenize(text):
+    """与 KeywordIndex::Tokenize 一致: CJK 双字 + 小写 ASCII 单词"""
+    terms = []
+    i, prev = 0, None
+    while i < len(text):
+        ch = text[i]
+        if ch.isascii() and ch.isalnum():
+            j = i
+            while j < len(text) and text[j].isascii() and text[j].isalnum():
+                j += 1
+            terms.append(_fnv1a(text[i:j].lower().encode()[:32]))
+            i, prev = j, None
+            continue
+        if _is_cjk(ch):
+            if prev is not None:
+                terms.append(_fnv1a((prev + ch).encode("utf-8")))
+            prev = ch
+        else:
+            prev = None
+        i += 1
+    return terms
+
+
+def keyword_index_add(directory, type_name, record_id, texts):
+    terms = sorted(set(t for text in texts for t in tokenize(text)), key=lambda t: (t % KEYWORD_BUCKETS, t))
+    for term in terms:
+        posting = (((term >> 5) & 0xFFF) << 20) | record_id
+        with open(os.path.join(directory, "%s_k%02d.pst" % (type_name, term % KEYWORD_BUCKETS)), "ab") as f:
+            f.write(struct.pack("<I", posting))
+
+
+class CountingReader:
+    """统计读取字节数和 seek 次数, 近似 SPIFFS 上的 flash 读取量"""
+
+    def __init__(self):
+        self.bytes_read = 0
+        self.seeks = 0
+
+    def open(self, path):
+        reader = self
+
+        class _File(io.FileIO):
+            def read(self, n=-1):
+                data = super().read(n)
+                reader.bytes_read += len(data)
+                return data
+
+            def seek(self, *args):
+                reader.seeks += 1
+                return super().seek(*args)
+
+        return _File(path, "r")
+
+
+def load_segments(directory, type_name, reader):
+    segments = []
+    idx_path = os.path.join(directory, "%s.idx" % type_name)
+    if os.path.exists(idx_path):
+        with reader.open(idx_path) as f:
+            magic, version, count = struct.unpack(INDEX_HEADER_FMT, f.read(8))
+            if magic == b"XZAI" and version == FORMAT_VERSION:
+                for _ in range(count):
+                    segments.append(struct.unpack(INDEX_ENTRY_FMT, f.read(20)))
+    seg = segments[-1][0] + 1 if segments else 1
+    path = os.path.join(directory, "%s_%04d.seg" % (type_name, seg))
+    if os.path.exists(path):
+        count = min(os.path.getsize(path), RECORDS_PER_SEGMENT * RECORD_SIZE) // RECORD_SIZE
+        if count:
+            with reader.open(path) as f:
+                first = unpack_record(f.read(RECORD_SIZE))
+                f.seek((count - 1) * RECORD_SIZE)
+                last = unpack_record(f.read(RECORD_SIZE))
+            segments.append((seg, count, first["date_key"], last["date_key"], first["timestamp"], last["timestamp"]))
+    return segments
+
+
+def segment_range_recall(directory, type_name, start_key, end_key, limit, reader):
+    results = []
+    for seg, count, first_date, last_date, _, _ in load_segments(directory, type_name, reader):
+        if len(results) >= limit or first_date > end_key:
+            break
+        if last_date < start_key:
+            continue
+        with reader.open(os.path.join(directory, "%s_%04d.seg" % (type_name, seg))) as f:
+            lo, hi = 0, count
+            while lo < hi:
+                mid = (lo + hi) // 2
+                f.seek(mid * RECORD_SIZE)
+                if unpack_record(f.read(RECORD_SIZE))["date_key"] < start_key:
+                    lo = mid + 1
+                else:
+                    hi = mid
+            f.seek(lo * RECORD_SIZE)
+            for _ in range(lo, count):
+                rec = unpack_record(f.read(RECORD_SIZE))
+                if rec["date_key"] > end_key or len(results) >= limit:
+                    return results
+                results.append(rec)
+    return results
+
+
+def jsonl_range_recall(path, start_date, end_date, limit, reader):
+    results = []
+    with reader.open(path) as f:
+        for line in iter(f.readline, b""):
+            item = json.loads(line)
+            if start_date <= item["timestamp"][:10] <= end_date:
+                results.append(item)
+                if len(results) >= limit:
+                    break
+    return results
+
+
+def keyword_index_recall(directory, type_name, keyword, limit, reader, now):
+    terms = sorted(set(tokenize(keyword)))
+    if not terms:
+        return None
+    candidates = None
+    for term in terms:
+        ids = set()
+        path = os.path.join(directory, "%s_k%02d.pst" % (type_name, term % KEYWORD_BUCKETS))
+        if os.path.exists(path):
+            with reader.open(path) as f:
+                data = f.read()
+            sub = (term >> 5) & 0xFFF
+            for (posting,) in struct.iter_unpack("<I", data):
+                if posting >> 20 == sub:
+                    ids.add(posting & 0xFFFFF)
+        candidates = ids if candidates is None else candidates & ids
+        if not candidates:
+            return []
+    scored = []
+    for rid in sorted(candidates)[-MAX_KEYWORD_CANDIDATES:]:
+        with reader.open(os.path.join(directory, "%s_%04d.seg" % (type_name, rid // RECORDS_PER_SEGMENT + 1))) as f:
+            f.seek((rid % RECORDS_PER_SEGMENT) * RECORD_SIZE)
+            rec = unpack_record(f.read(RECORD_SIZE))
+        tf = (rec["content"] + rec["label"]).lower().count(keyword.lower())
+        if tf:
+            age_days = max(0, now - rec["timestamp"]) / 86400.0
+            scored.append((tf + 1.0 / (1.0 + age_days / 30.0), rec))
+    scored.sort(key=lambda x: -x[0])
+    return [rec for _, rec in scored[:limit]]
+
+
+def jsonl_keyword_recall(path, keyword, limit, reader):
+    results = []
+    with reader.open(path) as f:
+        for line in iter(f.readline, b""):
+            if keyword.lower() in line.decode("utf-8").lower():
+                results.append(json.loads(line))
+                if len(results) >= limit:
+                    break
+    return results
+
+
+def cmd_export(directory, type_name, out_path=None):
+    reader = CountingReader()
+    out = open(out_path, "w", encoding="utf-8") if out_path else sys.stdout
+    for seg, count, *_ in load_segments(directory, type_name, reader):
+        with open(os.path.join(directory, "%s_%04d.seg" % (type_name, seg)), "rb") as f:
+            for _ in range(count):
+                out.write(record_to_json(unpack_record(f.read(RECORD_SIZE))) + "\n")
+    if out_path:
+        out.close()
+
+
+def cmd_import(jsonl_path, directory, type_name):
+    writer = SegmentWriter(directory, type_name)
+    kind = KINDS[type_name]
+    count = 0
+    with open(jsonl_path, encoding="utf-8") as f:
+        for line in f:
+            item = json.loads(line)
+            ts = int(time.mktime(time.strptime(item["timestamp"], "%Y-%m-%dT%H:%M:%S")))
+            label = item.get("topic" if kind == 1 else "event_type", "")
+            importance = item.get("importance" if kind == 1 else "significance", 0)
+            writer.append(pack_record(kind, ts, item.get("content", ""), label, item.get("date", ""),
+                                      item.get("emotion_type", 0), item.get("emotion_intensity", 0), importance))
+            count += 1
+    print("导入 %d 条记录 -> %s" % (count, directory))
+
+
+def cmd_bench(per_day=20):
+    words = ["北京", "上海", "生日", "小猫", "钢琴", "学校", "妈妈", "爸爸", "旅行", "足球", "画画", "数学"]
+    rng = random.Random(1234)
+    start = int(time.mktime(time.strptime("2023-01-01", "%Y-%m-%d")))
+    days = 3 * 365
+
+    with tempfile.TemporaryDirectory() as tmp:
+        jsonl_path = os.path.join(tmp, "facts_archive.jsonl")
+        writer = SegmentWriter(tmp, "fact")
+        with open(jsonl_path, "w", encoding="utf-8") as jf:
+            for day in range(days):
+                for i in range(per_day):
+                    ts = start + day * 86400 + i * (86400 // per_day)
+                    content = "用户说%s和%s的事情 #%d" % (rng.choice(words), rng.choice(words), i)
+                    record = pack_record(0, ts, content)
+                    keyword_index_add(tmp, "fact", day * per_day + i, [content])
+                    writer.append(record)
+                    jf.write(record_to_json(unpack_record(record)) + "\n")
+
+        total = days * per_day
+        print("合成归档: %d 条 (%d 天 x %d 条/天)" % (total, days, per_day))
+        print("  JSONL 大小: %.1f KB" % (os.path.getsize(jsonl_path) / 1024))
+        seg_bytes = sum(os.path.getsize(os.path.join(tmp, n)) for n in os.listdir(tmp)
+                        if n.startswith("fact") and not n.endswith(".pst"))
+        pst_bytes = sum(os.path.getsize(os.path.join(tmp, n)) for n in os.listdir(tmp) if n.endswith(".pst"))
+        print("  分段大小:   %.1f KB" % (seg_bytes / 1024))
+        print("  关键词索引: %.1f KB" % (pst_bytes / 1024))
+
+        # 查询最后一年中的一周
+        cases = [("2025-06-01", "2025-06-07", 10), ("2023-01-01", "2025-12-31", 10), ("2025-12-25", "2025-12-31", 50)]
+        print("\n%-26s %12s %12s %10s %10s" % ("时间范围", "JSONL读取", "分段读取", "JSONL ms", "分段 ms"))
+        for s, e, limit in cases:
+            jr = CountingReader()
+            t0 = time.perf_counter()
+            a = jsonl_range_recall(jsonl_path, s, e, limit, jr)
+            t1 = time.perf_counter()
+            sr = CountingReader()
+            b = segment_range_recall(tmp, "fact", int(s.replace("-", "")), int(e.replace("-", "")), limit, sr)
+            t2 = time.perf_counter()
+            assert [x["content"] for x in a] == [x["content"] for x in b], "结果不一致"
+            print("%-26s %10d B %10d B %10.2f %10.2f" % ("%s~%s (%d)" % (s, e, limit), jr.bytes_read,
+                                                         sr.bytes_read, (t1 - t0) * 1000, (t2 - t1) * 1000))
+
+        # 关键词召回: JSONL 全量扫描 (取最早 N 条) vs 倒排索引 (词频 + 新近度排序)
+        now = start + days * 86400
+        print("\n%-26s %12s %12s %10s %10s" % ("关键词", "JSONL读取", "索引读取", "JSONL ms", "索引 ms"))
+        for keyword in ["北京和上海", "钢琴", "小猫", "不存在的词"]:
+            jr = CountingReader()
+            t0 = time.perf_counter()
+            jsonl_keyword_recall(jsonl_path, keyword, 10, jr)
+            t1 = time.perf_counter()
+            kr = CountingReader()
+            b = keyword_index_recall(tmp, "fact", keyword, 10, kr, now)
+            t2 = time.perf_counter()
+            assert all(keyword in rec["content"] for rec in b), "索引结果未包含关键词"
+            print("%-26s %10d B %10d B %10.2f %10.2f" % (keyword, jr.bytes_read, kr.bytes_read,
+                                                         (t1 - t0) * 1000, (t2 - t1) * 1000))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    cmd = sys.argv[1]
+    if cmd == "export" and len(sys.argv) >= 4:
+        cmd_export(sys.argv[2], sys.argv[3], sys.argv[4] if len(sys.argv) > 4 else None)
+    elif cmd == "import" and len(sys.argv) >= 5:
+        cmd_import(sys.argv[2], sys.argv[3], sys.argv[4])
+    elif cmd == "bench":
+        cmd_bench(int(sys.argv[2]) if len(sys.argv) > 2 else 20)
+    else:
+        print(__doc__)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
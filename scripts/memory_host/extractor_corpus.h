@@ -0,0 +1,120 @@
+// MemoryExtractor 的测试语料: 由关键词、名字和标点片段拼成的语句, 覆盖 memory_extractor.cc 中
+// 每张表的每个词, 以及否定 / 疑问 / 假设标记与触发词相邻、重叠的情况。
+// 只用 mt19937 的原始输出取模, 各平台生成的语料相同 (黄金输出依赖这一点)。
+#ifndef MEMORY_HOST_EXTRACTOR_CORPUS_H
+#define MEMORY_HOST_EXTRACTOR_CORPUS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "memory_types.h"
+
+namespace extractor_corpus {
+
+// 语句片段: memory_extractor.cc 各表中的词 (触发词、亲属、事件、否定 / 疑问 / 假设标记),
+// 加上名字、内容和标点; 基准测试也用它作为匹配器的模式表
+constexpr size_t FRAGMENT_COUNT = 144;
+inline constexpr std::array<const char*, FRAGMENT_COUNT> kFragments = {{
+    // 触发词
+    "我叫", "我的名字是", "我名叫", "叫我", "我是", "我今年", "我的年龄是", "岁了", "我住在", "我在",
+    "我来自", "我是男", "我是女", "我喜欢", "我爱", "我最喜欢", "我超喜欢", "我特别喜欢", "我比较喜欢",
+    "我讨厌", "我不喜欢", "我恨", "我最讨厌", "我不爱", "我有", "我会", "我能", "我学", "我正在",
+    "我在学", "我喜欢做", "我经常", "我每天", "我的", "我", "叫", "是",
+    // 亲属
+    "爸爸", "父亲", "老爸", "爹", "妈妈", "母亲", "老妈", "娘", "爷爷", "奶奶", "外公", "外婆",
+    "姥爷", "姥姥", "哥哥", "弟弟", "姐姐", "妹妹", "老公", "丈夫", "老婆", "妻子", "儿子", "女儿",
+    "朋友", "同事", "同学", "宠物", "狗狗", "猫咪", "猫", "狗",
+    // 事件
+    "生日", "纪念日", "考试", "面试", "约会", "会议", "旅行", "出差", "婚礼", "聚会",
+    // 否定 / 疑问 / 假设
+    "不是", "不叫", "没有", "不", "别", "没", "非", "未", "不再", "不想", "不要", "并非", "绝非",
+    "从不", "不会", "吗", "什么", "谁", "哪", "怎么", "为什么", "多少", "几", "如果", "假如",
+    "要是", "假设", "倘若", "万一",
+    // 内容与结尾
+    "小明", "李华", "王强", "咪咪", "北京", "上海", "八", "9", "男", "女", "草莓蛋糕", "弹钢琴",
+    "画画", "游泳", "恐龙", "lego", "pizza", "明天", "下周", "医生", "老师",
+    "，", "。", "！", "？", "、", ",", ".", "!", "?", "呢", "吧", "啊", "哦", "嘛", " ",
+}};
+
+// 手写的典型语句和边界情况
+inline const std::vector<std::string>& FixedUtterances() {
+    static const std::vector<std::string> utterances = {
+        "我叫小明，今年八岁",
+        "我最喜欢吃草莓蛋糕",
+        "我不喜欢下雨天出门",
+        "我妈妈叫李华，她是老师",
+        "下周三我要去医院体检",
+        "我家有一只猫叫咪咪",
+        "今天天气怎么样",
+        "如果我会飞就好了",
+        "我不叫小红",
+        "我的名字是王小明。我今年9岁了",
+        "我是男生",
+        "我是女孩子！",
+        "我住在上海，我来自北京",
+        "我的爸爸是医生，我的妈妈叫张丽",
+        "我爸爸叫王强吗",
+        "你叫什么名字？",
+        "我的猫咪叫花花，我的狗叫旺财",
+        "明天是我的生日，后天有考试",
+        "我会弹钢琴，我每天练习",
+        "我有一个哥哥和一个妹妹",
+        "我超喜欢恐龙，我最讨厌打针",
+        "我特别喜欢 lego",
+        "I like pizza",
+        "",
+        "我",
+        "我叫",
+        "我喜欢，",
+        "不不不不我叫",
+        "我叫我叫我叫阿强",
+        "假如我是超人",
+        "要是我有一只狗就好了",
+        "我从不吃辣",
+        "我并非不喜欢你",
+        "我在学画画呢",
+        "我正在看书吧",
+        "我的老婆是李娜，我的儿子叫乐乐",
+        "我的朋友叫小刚，同学是小美",
+        "姥姥和姥爷来了，奶奶说我爱吃饺子",
+    };
+    return utterances;
+}
+
+// 拼接 1 到 5 个 kFragments 中的片段; 同一 seed 生成的语料固定
+inline std::vector<std::string> Generate(size_t count, uint32_t seed = 20251016) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> utterances;
+    utterances.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string text;
+        uint32_t pieces = 1 + rng() % 5;
+        for (uint32_t k = 0; k < pieces; k++) {
+            text += kFragments[rng() % kFragments.size()];
+        }
+        utterances.push_back(text);
+    }
+    return utterances;
+}
+
+// 一条语句的抽取结果写成一行: 语句 \t type:category:content:confidence | ...
+inline std::string Format(const std::string& text, const std::vector<ExtractedMemory>& memories) {
+    std::string line = text + "\t";
+    for (size_t i = 0; i < memories.size(); i++) {
+        const auto& m = memories[i];
+        if (i > 0) {
+            line += " | ";
+        }
+        line += std::to_string((int)m.type) + ":" + m.category + ":" + m.content + ":" +
+                std::to_string((int)m.confidence);
+    }
+    return line;
+}
+
+} // namespace extractor_corpus
+
+#endif // MEMORY_HOST_EXTRACTOR_CORPUS_H
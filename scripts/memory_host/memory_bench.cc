@@ -0,0 +1,354 @@
+/*
+ * 记忆系统主机端基准测试 (Google Benchmark)
+ *
+ * 链接的是 main/memory 的真实源文件 (memory_storage / memory_record_store / memory_archive /
+ * keyword_index / memory_extractor / pending_memory / schedule_manager / chat_logger), NVS 和
+ * SPIFFS 由 shims/ 下的模拟器代替。除耗时外, 每个用例还给出每次操作写入的 flash 字节数:
+ * - nvs_flash_B:    NVS 写入的条目 x 32 字节 (相同值的重复写入不计, 与 NVS 相同)
+ * - nvs_erased:     因覆盖或删除标记为已擦除的条目数 (决定多久触发一次页回收)
+ * - spiffs_write_B: 写入 SPIFFS 文件的字节数
+ * - spiffs_opens:   fopen 次数
+ *
+ * 用例:
+ * - AddFact/Flush:       每条事实立即 Flush (改动前的写法), 队列满后最老的一条归档
+ * - AddFact/Coalesced:   每 8 条事实 Flush 一次 (写回合并)
+ * - Search:              MemoryStorage::Search, 全部类别写满
+ * - Archive:             每次归档一条事实
+ * - RecallKeyword:       在 N 条归档事件中按中文 (ascii:0) / 英文 (ascii:1) 关键词回忆
+ * - RecallRecent / RecallByTimeRange
+ * - Extract:             MemoryExtractor::Extract, extractor_corpus.h 生成的 2000 条语句 (每秒语句数 / 字节数)
+ * - KeywordScan/automaton: 关键词匹配器本身的吞吐, KeywordAutomaton 一次扫描找出 kFragments
+ *                        中全部 144 个词的所有出现位置
+ * - KeywordScan/find:    同一语料和词表, 逐词 std::string::find (改用自动机之前的写法)
+ * - ChatLog / PendingAddOrConfirm / ScheduleAddRemove: 每次操作后保存到 NVS
+ *
+ * 构建与运行见 README.md:
+ *   build_memory_host/memory_bench_slot --benchmark_counters_tabular=true
+ *   build_memory_host/memory_bench_blob --benchmark_counters_tabular=true
+ */
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "chat_logger.h"
+#include "extractor_corpus.h"
+#include "keyword_automaton.h"
+#include "memory_archive.h"
+#include "memory_extractor.h"
+#include "memory_storage.h"
+#include "nvs_emulator.h"
+#include "pending_memory.h"
+#include "schedule_manager.h"
+#include "spiffs_posix.h"
+
+namespace {
+
+const char* kFactTopics[] = {
+    "周末去公园散步", "喜欢吃妈妈做的红烧肉", "每天早上七点起床", "在学校学了 python",
+    "养了一只叫 mimi 的猫", "最近在练习钢琴", "下个月要去北京旅游", "不喜欢下雨天",
+};
+
+const char* kUtterances[] = {
+    "我叫小明，今年八岁",
+    "我最喜欢吃草莓蛋糕",
+    "我不喜欢下雨天出门",
+    "我妈妈叫李华，她是老师",
+    "下周三我要去医院体检",
+    "我家有一只猫叫咪咪",
+    "今天天气怎么样",
+    "如果我会飞就好了",
+};
+
+std::string MakeFact(int i) {
+    char content[128];
+    snprintf(content, sizeof(content), "%s (%d)", kFactTopics[i % 8], i);
+    return content;
+}
+
+void InitOnce() {
+    static bool initialized = [] {
+        spiffs_posix_clear();
+        nvs_emulator_reset();
+        MemoryArchive::GetInstance().Init();
+        MemoryStorage::GetInstance().Init();
+        ChatLogger::GetInstance().Initialize();
+        PendingMemory::GetInstance().Init();
+        ScheduleManager::GetInstance().Init();
+        return true;
+    }();
+    (void)initialized;
+}
+
+// Flash counters per iteration, from the emulators' totals since construction
+class FlashCounters {
+public:
+    FlashCounters() {
+        nvs_emulator_reset_stats();
+        spiffs_posix_reset_stats();
+    }
+
+    void Report(benchmark::State& state) {
+        auto nvs = nvs_emulator_get_stats();
+        auto spiffs = spiffs_posix_get_stats();
+        auto per_op = benchmark::Counter::kAvgIterations;
+        state.counters["nvs_flash_B"] = benchmark::Counter(nvs.flash_bytes, per_op);
+        state.counters["nvs_erased"] = benchmark::Counter(nvs.erased_entries, per_op);
+        state.counters["spiffs_write_B"] = benchmark::Counter(spiffs.bytes_written, per_op);
+        state.counters["spiffs_opens"] = benchmark::Counter(spiffs.opens, per_op);
+    }
+};
+
+void FillArchiveEvents(int count) {
+    auto& archive = MemoryArchive::GetInstance();
+    int have = archive.GetArchiveCount("event");
+    std::vector<Event> batch;
+    for (int i = have; i < count; i++) {
+        Event event;
+        snprintf(event.date, sizeof(event.date), "2025-%02d-%02d", 1 + (i / 28) % 12, 1 + i % 28);
+        snprintf(event.event_type, sizeof(event.event_type), "%s", i % 3 == 0 ? "birthday" : "trip");
+        snprintf(event.content, sizeof(event.content), "%s", MakeFact(i).c_str());
+        event.significance = 1 + i % 5;
+        batch.push_back(event);
+        if (batch.size() == 64 || i + 1 == count) {
+            archive.ArchiveEvents(batch);
+            batch.clear();
+        }
+    }
+}
+
+// NVS flash bytes per fact of the last AddFact/Flush run, checked by AddFact/Coalesced
+double g_flush_bytes_per_fact = 0;
+
+void BM_AddFactFlush(benchmark::State& state) {
+    InitOnce();
+    auto& storage = MemoryStorage::GetInstance();
+    storage.EraseAll();
+    int i = 0;
+    FlashCounters counters;
+    for (auto _ : state) {
+        storage.AddFact(MakeFact(i++).c_str());
+        storage.Flush();
+    }
+    counters.Report(state);
+    g_flush_bytes_per_fact = (double)nvs_emulator_get_stats().flash_bytes / state.iterations();
+}
+BENCHMARK(BM_AddFactFlush)->Name("AddFact/Flush");
+
+void BM_AddFactCoalesced(benchmark::State& state) {
+    InitOnce();
+    auto& storage = MemoryStorage::GetInstance();
+    storage.EraseAll();
+    int i = 0;
+    FlashCounters counters;
+    for (auto _ : state) {
+        storage.AddFact(MakeFact(i++).c_str());
+        if (i % 8 == 0) {
+            storage.Flush();
+        }
+    }
+    storage.Flush();
+    counters.Report(state);
+    // Batching must not cost more flash than flushing every fact
+    double bytes_per_fact = (double)nvs_emulator_get_stats().flash_bytes / state.iterations();
+    if (g_flush_bytes_per_fact > 0 && bytes_per_fact > g_flush_bytes_per_fact) {
+        state.SkipWithError("Coalesced writes more NVS flash per fact than Flush");
+    }
+}
+BENCHMARK(BM_AddFactCoalesced)->Name("AddFact/Coalesced");
+
+void BM_Search(benchmark::State& state) {
+    InitOnce();
+    auto& storage = MemoryStorage::GetInstance();
+    storage.EraseAll();
+    for (int i = 0; i < MAX_FACTS; i++) {
+        storage.AddFact(MakeFact(i).c_str());
+    }
+    for (int i = 0; i < MAX_MOMENTS; i++) {
+        storage.AddMoment("公园", MakeFact(i + 100).c_str(), 1, 3, 3);
+    }
+    for (int i = 0; i < MAX_TRAITS; i++) {
+        char content[32];
+        snprintf(content, sizeof(content), "性格开朗 %d", i);
+        storage.AddTrait("personality", content);
+    }
+    storage.Flush();
+    std::vector<char> buffer(4096);
+    FlashCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(storage.Search("公园", buffer.data(), buffer.size()));
+    }
+    counters.Report(state);
+}
+BENCHMARK(BM_Search)->Name("Search");
+
+void BM_Archive(benchmark::State& state) {
+    InitOnce();
+    auto& archive = MemoryArchive::GetInstance();
+    std::vector<Fact> facts(1);
+    int i = 0;
+    FlashCounters counters;
+    for (auto _ : state) {
+        facts[0].timestamp = 1735689600 + i * 3600;
+        snprintf(facts[0].content, sizeof(facts[0].content), "%s", MakeFact(i++).c_str());
+        archive.ArchiveFacts(facts);
+    }
+    counters.Report(state);
+}
+BENCHMARK(BM_Archive)->Name("Archive");
+
+const char* kRecallKeywords[] = { "钢琴", "mimi" };
+
+// The event archive only grows, so every size is registered in increasing order.
+// Args: archived events, keyword (0 = CJK, 1 = ASCII)
+void BM_RecallKeyword(benchmark::State& state) {
+    InitOnce();
+    FillArchiveEvents(state.range(0));
+    const char* keyword = kRecallKeywords[state.range(1)];
+    auto& archive = MemoryArchive::GetInstance();
+    FlashCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(archive.RecallByKeyword("event", keyword, 10));
+    }
+    counters.Report(state);
+    auto spiffs = spiffs_posix_get_stats();
+    state.counters["spiffs_read_B"] = benchmark::Counter(spiffs.bytes_read, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RecallKeyword)->ArgNames({"events", "ascii"})
+    ->Args({256, 0})->Args({256, 1})->Args({2048, 0})->Args({2048, 1});
+
+void BM_RecallRecent(benchmark::State& state) {
+    InitOnce();
+    FillArchiveEvents(state.range(0));
+    auto& archive = MemoryArchive::GetInstance();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(archive.RecallRecent("event", 10));
+    }
+}
+BENCHMARK(BM_RecallRecent)->Arg(2048);
+
+void BM_RecallByTimeRange(benchmark::State& state) {
+    InitOnce();
+    FillArchiveEvents(state.range(0));
+    auto& archive = MemoryArchive::GetInstance();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(archive.RecallByTimeRange("event", "2025-03-01", "2025-03-07", 10));
+    }
+}
+BENCHMARK(BM_RecallByTimeRange)->Arg(2048);
+
+const std::vector<std::string>& ExtractCorpus() {
+    static const std::vector<std::string> corpus = extractor_corpus::Generate(2000);
+    return corpus;
+}
+
+size_t CorpusBytes(const std::vector<std::string>& corpus) {
+    size_t bytes = 0;
+    for (const auto& text : corpus) {
+        bytes += text.length();
+    }
+    return bytes;
+}
+
+void BM_Extract(benchmark::State& state) {
+    const auto& corpus = ExtractCorpus();
+    for (auto _ : state) {
+        for (const auto& text : corpus) {
+            benchmark::DoNotOptimize(MemoryExtractor::Extract(text));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+    state.SetBytesProcessed(state.iterations() * CorpusBytes(corpus));
+}
+BENCHMARK(BM_Extract)->Name("Extract");
+
+constexpr size_t kScanNodes = KeywordAutomaton<extractor_corpus::FRAGMENT_COUNT,
+    KeywordAutomatonMaxNodes(extractor_corpus::kFragments)>(extractor_corpus::kFragments).GetNodeCount();
+constexpr KeywordAutomaton<extractor_corpus::FRAGMENT_COUNT, kScanNodes> kScanAutomaton(
+    extractor_corpus::kFragments);
+
+void BM_KeywordScanAutomaton(benchmark::State& state) {
+    const auto& corpus = ExtractCorpus();
+    size_t hits = 0;
+    for (auto _ : state) {
+        for (const auto& text : corpus) {
+            kScanAutomaton.Scan(text.data(), text.length(), [&](uint16_t, size_t) { hits++; });
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+    state.SetBytesProcessed(state.iterations() * CorpusBytes(corpus));
+    state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_KeywordScanAutomaton)->Name("KeywordScan/automaton");
+
+void BM_KeywordScanFind(benchmark::State& state) {
+    const auto& corpus = ExtractCorpus();
+    size_t hits = 0;
+    for (auto _ : state) {
+        for (const auto& text : corpus) {
+            for (const char* keyword : extractor_corpus::kFragments) {
+                for (size_t pos = text.find(keyword); pos != std::string::npos; pos = text.find(keyword, pos + 1)) {
+                    hits++;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+    state.SetBytesProcessed(state.iterations() * CorpusBytes(corpus));
+    state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_KeywordScanFind)->Name("KeywordScan/find");
+
+void BM_ChatLog(benchmark::State& state) {
+    InitOnce();
+    auto& logger = ChatLogger::GetInstance();
+    int i = 0;
+    FlashCounters counters;
+    for (auto _ : state) {
+        logger.Log(i % 2 == 0 ? "user" : "assistant", kUtterances[i % 8]);
+        i++;
+    }
+    logger.Flush();
+    counters.Report(state);
+}
+BENCHMARK(BM_ChatLog)->Name("ChatLog");
+
+void BM_PendingAddOrConfirm(benchmark::State& state) {
+    InitOnce();
+    auto& pending = PendingMemory::GetInstance();
+    int i = 0;
+    FlashCounters counters;
+    for (auto _ : state) {
+        ExtractedMemory memory = {};
+        memory.type = ExtractedType::PREFERENCE;
+        snprintf(memory.category, sizeof(memory.category), "like");
+        snprintf(memory.content, sizeof(memory.content), "水果 %d", i++ % 16);
+        memory.confidence = 3;
+        pending.AddOrConfirm(memory);
+        pending.Save();
+    }
+    counters.Report(state);
+}
+BENCHMARK(BM_PendingAddOrConfirm)->Name("PendingAddOrConfirm");
+
+void BM_ScheduleAddRemove(benchmark::State& state) {
+    InitOnce();
+    auto& schedules = ScheduleManager::GetInstance();
+    FlashCounters counters;
+    for (auto _ : state) {
+        uint32_t id = schedules.AddSchedule("2030-01-01 08:00", "吃药", "daily");
+        schedules.Save();
+        schedules.RemoveSchedule(id);
+        schedules.Save();
+    }
+    counters.Report(state);
+}
+BENCHMARK(BM_ScheduleAddRemove)->Name("ScheduleAddRemove");
+
+} // namespace
+
+BENCHMARK_MAIN();
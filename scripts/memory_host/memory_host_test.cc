@@ -0,0 +1,802 @@
+/*
+ * 记忆系统主机端单元测试 (GoogleTest), 与 memory_bench.cc 链接同一份真实源文件和模拟器。
+ * 由 ctest 对两种 NVS 记录布局各运行一次 (memory_host_test_slot / memory_host_test_blob)。
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "extractor_corpus.h"
+#include "keyword_automaton.h"
+#include "keyword_index.h"
+#include "memory_archive.h"
+#include "memory_extractor.h"
+#include "memory_record_store.h"
+#include "memory_storage.h"
+#include "nvs_emulator.h"
+#include "nvs_flash.h"
+#include "spiffs_posix.h"
+
+// Heap accounting for the peak-allocation tests: every operator new in the
+// binary goes through here. The size is kept in a header in front of the
+// block so delete can subtract it. All non-aligned forms are replaced, since
+// sanitizer runtimes do not route the array and nothrow ones through
+// operator new(size_t). stdio buffers come from malloc and are not counted;
+// they are fixed-size per open FILE anyway.
+namespace {
+constexpr size_t kAllocHeader = alignof(std::max_align_t);
+std::atomic<size_t> g_live_bytes{0};
+std::atomic<size_t> g_peak_bytes{0};
+
+void* CountedAlloc(size_t size) {
+    void* block = malloc(size + kAllocHeader);
+    if (!block) {
+        return nullptr;
+    }
+    *static_cast<size_t*>(block) = size;
+    size_t live = g_live_bytes.fetch_add(size) + size;
+    size_t peak = g_peak_bytes.load();
+    while (live > peak && !g_peak_bytes.compare_exchange_weak(peak, live)) {
+    }
+    return static_cast<char*>(block) + kAllocHeader;
+}
+
+void CountedFree(void* ptr) {
+    if (ptr) {
+        void* block = static_cast<char*>(ptr) - kAllocHeader;
+        g_live_bytes.fetch_sub(*static_cast<size_t*>(block));
+        free(block);
+    }
+}
+}
+
+void* operator new(size_t size) {
+    void* ptr = CountedAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+
+namespace {
+
+class MemoryEnvironment : public ::testing::Environment {
+public:
+    void SetUp() override {
+        spiffs_posix_clear();
+        nvs_emulator_reset();
+        ASSERT_TRUE(MemoryArchive::GetInstance().Init());
+        ASSERT_EQ(MemoryStorage::GetInstance().Init(), 0);
+    }
+};
+
+const auto* const kEnvironment = ::testing::AddGlobalTestEnvironment(new MemoryEnvironment);
+
+class MemoryStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(storage_.EraseAll());
+        nvs_emulator_reset_stats();
+    }
+
+    MemoryStorage& storage_ = MemoryStorage::GetInstance();
+};
+
+TEST(NvsEmulatorTest, IdenticalWriteIsSkipped) {
+    nvs_handle_t handle;
+    ASSERT_EQ(nvs_open("emu_test", NVS_READWRITE, &handle), ESP_OK);
+    nvs_emulator_reset_stats();
+    uint8_t blob[40] = { 1, 2, 3 };
+    ASSERT_EQ(nvs_set_blob(handle, "blob", blob, sizeof(blob)), ESP_OK);
+    ASSERT_EQ(nvs_set_blob(handle, "blob", blob, sizeof(blob)), ESP_OK);
+    auto stats = nvs_emulator_get_stats();
+    EXPECT_EQ(stats.sets, 1u);
+    EXPECT_EQ(stats.unchanged_sets, 1u);
+    EXPECT_EQ(stats.flash_bytes, 4u * NVS_EMULATOR_ENTRY_SIZE);    // Header + 2 data + index
+
+    blob[0] = 9;
+    ASSERT_EQ(nvs_set_blob(handle, "blob", blob, sizeof(blob)), ESP_OK);
+    EXPECT_EQ(nvs_emulator_get_stats().erased_entries, 4u);
+
+    uint8_t out[40];
+    size_t length = sizeof(out);
+    ASSERT_EQ(nvs_get_blob(handle, "blob", out, &length), ESP_OK);
+    EXPECT_EQ(out[0], 9);
+    EXPECT_EQ(nvs_set_blob(handle, "a_key_too_long_for_nvs", blob, 1), ESP_ERR_NVS_KEY_TOO_LONG);
+    nvs_erase_all(handle);
+    nvs_close(handle);
+}
+
+TEST(SpiffsPosixTest, EnforcesObjectNameLength) {
+    FILE* f = spiffs_posix_fopen("/spiffs/memory/a_name_that_is_too_long_for.seg", "wb");
+    EXPECT_EQ(f, nullptr);
+    f = spiffs_posix_fopen("/spiffs/memory/short.tmp", "wb");
+    ASSERT_NE(f, nullptr);
+    spiffs_posix_fclose(f);
+    spiffs_posix_remove("/spiffs/memory/short.tmp");
+}
+
+TEST_F(MemoryStorageTest, FlushWritesOnlyWhenPending) {
+    storage_.AddFact("我喜欢吃草莓");
+    EXPECT_TRUE(storage_.HasPendingWrites());
+    storage_.Flush();
+    EXPECT_FALSE(storage_.HasPendingWrites());
+    auto after_first = nvs_emulator_get_stats();
+    EXPECT_GT(after_first.flash_bytes, 0u);
+    EXPECT_EQ(after_first.commits, 1u);
+
+    storage_.Flush();
+    auto after_second = nvs_emulator_get_stats();
+    EXPECT_EQ(after_second.commits, after_first.commits);
+    EXPECT_EQ(after_second.flash_bytes, after_first.flash_bytes);
+}
+
+TEST_F(MemoryStorageTest, FailedFlushStaysPending) {
+    // Every write fails: the fact stays dirty and the batch pending
+    nvs_emulator_fail_writes_after(0);
+    storage_.AddFact("我喜欢吃草莓");
+    storage_.Flush();
+    nvs_emulator_fail_writes_after(-1);
+    EXPECT_TRUE(storage_.HasPendingWrites());
+    uint32_t commits = storage_.GetWriteBehindStats().commits;
+
+    // The commit fails: not counted, and still pending
+    ASSERT_TRUE(nvs_emulator_set_file("/nonexistent/nvs.bin"));    // Loads empty, saves fail
+    storage_.Flush();
+    ASSERT_TRUE(nvs_emulator_set_file(nullptr));
+    EXPECT_TRUE(storage_.HasPendingWrites());
+    EXPECT_EQ(storage_.GetWriteBehindStats().commits, commits);
+
+    storage_.Flush();
+    EXPECT_FALSE(storage_.HasPendingWrites());
+    EXPECT_EQ(storage_.GetWriteBehindStats().commits, commits + 1);
+    EXPECT_GT(nvs_emulator_get_stats().flash_bytes, 0u);
+}
+
+TEST_F(MemoryStorageTest, RollingFactsAreArchived) {
+    auto& archive = MemoryArchive::GetInstance();
+    size_t archived = archive.GetArchiveCount("fact");
+    for (int i = 0; i < MAX_FACTS + 3; i++) {
+        char content[32];
+        snprintf(content, sizeof(content), "fact %d", i);
+        EXPECT_EQ(storage_.AddFact(content), AUDNAction::ADDED);
+    }
+    storage_.Flush();
+    EXPECT_EQ(archive.GetArchiveCount("fact"), archived + 3);
+
+    std::vector<Fact> facts(MAX_FACTS);
+    ASSERT_EQ(storage_.GetFacts(facts.data(), MAX_FACTS), MAX_FACTS);
+    EXPECT_STREQ(facts[0].content, "fact 3");
+
+    char buffer[1024];
+    EXPECT_GT(storage_.Search("fact 22", buffer, sizeof(buffer)), 0);
+    EXPECT_NE(strstr(buffer, "fact 22"), nullptr);
+}
+
+// ========== Slot record store ==========
+
+// Same as SlotRecordStore::HashRecord
+uint32_t SlotHash(const void* record, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(record);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h | 1;
+}
+
+struct TestRecord {
+    uint64_t id;
+    uint64_t value;
+};
+
+const int kTestMaxCount = 20;
+
+bool Equal(const std::vector<TestRecord>& a, const std::vector<TestRecord>& b) {
+    return a.size() == b.size() &&
+           (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(TestRecord)) == 0);
+}
+
+class SlotRecordStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(nvs_open("store_test", NVS_READWRITE, &handle_), ESP_OK);
+        nvs_erase_all(handle_);
+    }
+
+    void TearDown() override {
+        nvs_emulator_fail_writes_after(-1);
+        nvs_erase_all(handle_);
+        nvs_close(handle_);
+    }
+
+    // A store with nothing cached, as after a reboot
+    std::vector<TestRecord> LoadFresh() {
+        SlotRecordStore store;
+        store.Bind(handle_);
+        std::vector<TestRecord> records(kTestMaxCount);
+        records.resize(store.Load("t", records.data(), sizeof(TestRecord), kTestMaxCount));
+        return records;
+    }
+
+    nvs_handle_t handle_ = 0;
+};
+
+TEST_F(SlotRecordStoreTest, HashCollisionIsWritten) {
+    // Two different records with the same hash (birthday search over 31 bits)
+    std::unordered_map<uint32_t, TestRecord> seen;
+    std::mt19937_64 random(1);
+    TestRecord a = {}, b = {};
+    while (true) {
+        TestRecord r = { random(), random() };
+        auto inserted = seen.emplace(SlotHash(&r, sizeof(r)), r);
+        if (!inserted.second) {
+            a = inserted.first->second;
+            b = r;
+            break;
+        }
+    }
+    ASSERT_EQ(SlotHash(&a, sizeof(a)), SlotHash(&b, sizeof(b)));
+
+    SlotRecordStore store;
+    store.Bind(handle_);
+    std::vector<TestRecord> records = { a, { 1, 1 } };
+    ASSERT_EQ(store.Save("t", records.data(), sizeof(TestRecord), records.size(), kTestMaxCount), ESP_OK);
+    records[0] = b;
+    ASSERT_EQ(store.Save("t", records.data(), sizeof(TestRecord), records.size(), kTestMaxCount), ESP_OK);
+    EXPECT_TRUE(Equal(LoadFresh(), records));
+}
+
+// Cut the power after every possible number of NVS writes during a save that
+// changes `changed` records of a full category: a reload must give either the
+// old or the new array, never a mix
+void CheckInterruptedSave(nvs_handle_t handle, int changed,
+                          const std::function<std::vector<TestRecord>()>& load_fresh) {
+    std::vector<TestRecord> old_records(kTestMaxCount), new_records;
+    for (int i = 0; i < kTestMaxCount; i++) {
+        old_records[i] = { (uint64_t)i, 100 };
+    }
+    new_records = old_records;
+    for (int i = 0; i < changed; i++) {
+        new_records[i * kTestMaxCount / changed].value = 200;
+    }
+
+    bool completed = false;
+    for (int writes = 0; !completed; writes++) {
+        ASSERT_LT(writes, 64);
+        nvs_erase_all(handle);
+        {
+            SlotRecordStore store;
+            store.Bind(handle);
+            ASSERT_EQ(store.Save("t", old_records.data(), sizeof(TestRecord), kTestMaxCount, kTestMaxCount),
+                      ESP_OK);
+        }
+
+        SlotRecordStore store;
+        store.Bind(handle);
+        std::vector<TestRecord> loaded(kTestMaxCount);
+        ASSERT_EQ(store.Load("t", loaded.data(), sizeof(TestRecord), kTestMaxCount), kTestMaxCount);
+        nvs_emulator_fail_writes_after(writes);
+        completed = store.Save("t", new_records.data(), sizeof(TestRecord), kTestMaxCount,
+                               kTestMaxCount) == ESP_OK;
+        nvs_emulator_fail_writes_after(-1);
+
+        auto reloaded = load_fresh();
+        bool is_old = Equal(reloaded, old_records);
+        bool is_new = Equal(reloaded, new_records);
+        EXPECT_TRUE(is_old || is_new) << changed << " changed, power lost after " << writes << " writes";
+        if (completed) {
+            EXPECT_TRUE(is_new) << changed << " changed";
+        }
+        // The reload completed any journaled save, so a second reload agrees
+        EXPECT_TRUE(Equal(load_fresh(), reloaded));
+    }
+}
+
+TEST_F(SlotRecordStoreTest, InterruptedSaveKeepsOldOrNewRecords) {
+    auto load_fresh = [this] { return LoadFresh(); };
+    for (int changed : { 1, MEMORY_SLOT_SPARE, MEMORY_SLOT_SPARE + 1, kTestMaxCount }) {
+        CheckInterruptedSave(handle_, changed, load_fresh);
+    }
+}
+
+// A save fails after its journal was written; the next save from the same store
+// must replace that journal, and a reload after cutting it short gives either the
+// journaled array or the new one
+TEST_F(SlotRecordStoreTest, SaveAfterFailedSaveReplacesJournal) {
+    std::vector<TestRecord> old_records(kTestMaxCount), journaled, new_records;
+    for (int i = 0; i < kTestMaxCount; i++) {
+        old_records[i] = { (uint64_t)i, 100 };
+    }
+    journaled = old_records;
+    new_records = old_records;
+    for (int i = 0; i < kTestMaxCount; i++) {
+        journaled[i].value = 200;
+        new_records[(i * 7) % kTestMaxCount].value = i % 2 == 0 ? 300 : 100;
+    }
+
+    bool completed = false;
+    for (int writes = 0; !completed; writes++) {
+        ASSERT_LT(writes, 64);
+        nvs_erase_all(handle_);
+        SlotRecordStore store;
+        store.Bind(handle_);
+        ASSERT_EQ(store.Save("t", old_records.data(), sizeof(TestRecord), kTestMaxCount, kTestMaxCount),
+                  ESP_OK);
+        // Spare slots, journal, then a few of the overwritten slots
+        nvs_emulator_fail_writes_after(MEMORY_SLOT_SPARE + 1 + 3);
+        ASSERT_NE(store.Save("t", journaled.data(), sizeof(TestRecord), kTestMaxCount, kTestMaxCount),
+                  ESP_OK);
+        nvs_emulator_fail_writes_after(writes);
+        completed = store.Save("t", new_records.data(), sizeof(TestRecord), kTestMaxCount,
+                               kTestMaxCount) == ESP_OK;
+        nvs_emulator_fail_writes_after(-1);
+
+        auto reloaded = LoadFresh();
+        EXPECT_TRUE(Equal(reloaded, journaled) || Equal(reloaded, new_records))
+            << "power lost after " << writes << " writes";
+        if (completed) {
+            EXPECT_TRUE(Equal(reloaded, new_records));
+        }
+        EXPECT_TRUE(Equal(LoadFresh(), reloaded));
+    }
+}
+
+TEST_F(SlotRecordStoreTest, JournalOnlyOverwrittenSlots) {
+    SlotRecordStore store;
+    store.Bind(handle_);
+    std::vector<TestRecord> records(kTestMaxCount);
+    for (int i = 0; i < kTestMaxCount; i++) {
+        records[i] = { (uint64_t)i, 100 };
+    }
+    ASSERT_EQ(store.Save("t", records.data(), sizeof(TestRecord), kTestMaxCount, kTestMaxCount), ESP_OK);
+
+    for (int i = 0; i < MEMORY_SLOT_SPARE; i++) {
+        records[i].value++;
+    }
+    uint32_t before = store.GetBytesWritten();
+    ASSERT_EQ(store.Save("t", records.data(), sizeof(TestRecord), kTestMaxCount, kTestMaxCount), ESP_OK);
+    EXPECT_EQ(store.GetBytesWritten() - before, MEMORY_SLOT_SPARE * sizeof(TestRecord) + sizeof(MemorySlotHeader));
+
+    // Beyond the spares only the records that overwrite a slot of the old header
+    // are journaled, with the new header
+    for (int changed : { MEMORY_SLOT_SPARE + 1, kTestMaxCount }) {
+        for (int i = 0; i < changed; i++) {
+            records[i].value++;
+        }
+        before = store.GetBytesWritten();
+        ASSERT_EQ(store.Save("t", records.data(), sizeof(TestRecord), kTestMaxCount, kTestMaxCount), ESP_OK);
+        size_t journaled = changed - MEMORY_SLOT_SPARE;
+        EXPECT_EQ(store.GetBytesWritten() - before,
+                  changed * sizeof(TestRecord) + journaled * (1 + sizeof(TestRecord)) +
+                  2 * sizeof(MemorySlotHeader)) << changed << " changed";
+        EXPECT_TRUE(Equal(LoadFresh(), records));
+    }
+
+    size_t size = 0;
+    EXPECT_EQ(nvs_get_blob(handle_, "t_j", nullptr, &size), ESP_ERR_NVS_NOT_FOUND);
+}
+
+// ========== Flash bytes per mutation ==========
+
+// NVS entries for a blob: header + data + blob index (see nvs_emulator.h)
+uint32_t BlobFlashBytes(size_t size) {
+    return (2 + (size + NVS_EMULATOR_ENTRY_SIZE - 1) / NVS_EMULATOR_ENTRY_SIZE) * NVS_EMULATOR_ENTRY_SIZE;
+}
+
+struct MutationCase {
+    const char* name;
+    size_t record_size;
+    int count_after;                        // Records in the category after the mutation
+    std::function<void(MemoryStorage&)> fill;
+    std::function<void(MemoryStorage&)> mutate;
+};
+
+// The bench comparison AddFact/Flush vs AddFact/Coalesced: a write-behind batch
+// must not cost more flash than flushing every fact (the slot layout used to
+// journal whole batches)
+TEST_F(MemoryStorageTest, CoalescedFactsWriteNoMoreThanFlushEach) {
+    auto add_facts = [this](int flush_every) {
+        EXPECT_TRUE(storage_.EraseAll());
+        for (int i = 0; i < MAX_FACTS; i++) {
+            storage_.AddFact(("fact " + std::to_string(i)).c_str());
+        }
+        storage_.Flush();
+        nvs_emulator_reset_stats();
+        for (int i = 0; i < 4 * MAX_FACTS; i++) {
+            storage_.AddFact(("rolling fact " + std::to_string(i)).c_str());
+            if ((i + 1) % flush_every == 0) {
+                storage_.Flush();
+            }
+        }
+        storage_.Flush();
+        return nvs_emulator_get_stats();
+    };
+
+    auto each = add_facts(1);
+    auto coalesced = add_facts(8);
+    EXPECT_LE(coalesced.flash_bytes, each.flash_bytes);
+    EXPECT_LE(coalesced.erased_entries, each.erased_entries);
+    printf("%d facts: flush each %llu flash bytes / %u erased, every 8 %llu / %u\n", 4 * MAX_FACTS,
+           (unsigned long long)each.flash_bytes, (unsigned)each.erased_entries,
+           (unsigned long long)coalesced.flash_bytes, (unsigned)coalesced.erased_entries);
+}
+
+TEST_F(MemoryStorageTest, FlashBytesPerMutation) {
+    const MutationCase cases[] = {
+        { "rolling fact", sizeof(Fact), MAX_FACTS,
+          [](MemoryStorage& s) {
+              for (int i = 0; i < MAX_FACTS; i++) {
+                  s.AddFact(("fact " + std::to_string(i)).c_str());
+              }
+          },
+          [](MemoryStorage& s) { s.AddFact("one more fact"); } },
+        { "add family member", sizeof(FamilyMember), 4,
+          [](MemoryStorage& s) {
+              s.AddFamilyMember("妈妈", "李华", "human", 5, "");
+              s.AddFamilyMember("爸爸", "王强", "human", 5, "");
+              s.AddFamilyMember("宠物", "咪咪", "pet", 4, "");
+          },
+          [](MemoryStorage& s) { s.AddFamilyMember("奶奶", "张兰", "human", 4, ""); } },
+        { "update goal", sizeof(PersonalGoal), 5,
+          [](MemoryStorage& s) {
+              for (int i = 0; i < MAX_GOALS; i++) {
+                  s.AddGoal(("goal " + std::to_string(i)).c_str(), 0, 1);
+              }
+          },
+          [](MemoryStorage& s) { s.UpdateGoal("goal 2", 50, 0); } },
+    };
+
+    for (const auto& c : cases) {
+        ASSERT_TRUE(storage_.EraseAll());
+        c.fill(storage_);
+        storage_.Flush();
+        nvs_emulator_reset_stats();
+        c.mutate(storage_);
+        storage_.Flush();
+        auto stats = nvs_emulator_get_stats();
+
+#if CONFIG_MEMORY_STORAGE_LAYOUT_BLOB
+        // The whole array
+        uint32_t expected = BlobFlashBytes(c.record_size * c.count_after);
+#else
+        // One record into a spare slot, then the header
+        uint32_t expected = BlobFlashBytes(c.record_size) + BlobFlashBytes(sizeof(MemorySlotHeader));
+#endif
+        EXPECT_EQ(stats.flash_bytes, expected) << c.name;
+        EXPECT_EQ(stats.commits, 1u) << c.name;
+        printf("%-20s %5llu flash bytes, %3u entries erased\n", c.name,
+               (unsigned long long)stats.flash_bytes, (unsigned)stats.erased_entries);
+    }
+}
+
+// ========== Keyword index ==========
+
+class KeywordIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        index_.Init("/spiffs/memory", "kwt");
+        index_.Clear();
+    }
+
+    void TearDown() override {
+        spiffs_posix_fail_writes_after(-1);
+        index_.Clear();
+    }
+
+    bool Add(uint32_t id, const char* text) {
+        const char* fields[] = { text };
+        return index_.Add(id, fields, 1);
+    }
+
+    KeywordIndex index_;
+};
+
+TEST_F(KeywordIndexTest, AddIsBufferedUntilFlush) {
+    spiffs_posix_reset_stats();
+    for (uint32_t id = 0; id < 16; id++) {
+        ASSERT_TRUE(Add(id, id % 2 == 0 ? "最近在练习钢琴" : "养了一只叫 mimi 的猫"));
+    }
+    EXPECT_EQ(spiffs_posix_get_stats().opens, 0u);
+    EXPECT_EQ(index_.GetIndexedCount(), 16u);
+
+    // Buffered postings are found without touching the bucket files
+    std::vector<uint32_t> candidates;
+    ASSERT_TRUE(index_.Lookup("钢琴", candidates));
+    EXPECT_EQ(candidates.size(), 8u);
+
+    spiffs_posix_reset_stats();
+    ASSERT_TRUE(index_.Flush());
+    // Each bucket at most once, plus the meta
+    EXPECT_LE(spiffs_posix_get_stats().opens, (uint32_t)KeywordIndex::BUCKET_COUNT + 1);
+    EXPECT_EQ(spiffs_posix_get_stats().peak_open_files, 1u);
+
+    // Nothing pending: no writes
+    spiffs_posix_reset_stats();
+    ASSERT_TRUE(index_.Flush());
+    EXPECT_EQ(spiffs_posix_get_stats().opens, 0u);
+
+    // The stored count survives a reload
+    KeywordIndex reloaded;
+    reloaded.Init("/spiffs/memory", "kwt");
+    EXPECT_EQ(reloaded.GetIndexedCount(), 16u);
+    ASSERT_TRUE(reloaded.Lookup("mimi", candidates));
+    EXPECT_EQ(candidates.size(), 8u);
+}
+
+TEST_F(KeywordIndexTest, FailedFlushRollsBack) {
+    ASSERT_TRUE(Add(0, "最近在练习钢琴"));
+    ASSERT_TRUE(index_.Flush());
+    ASSERT_TRUE(Add(1, "下个月要去北京旅游"));
+    ASSERT_TRUE(Add(2, "每天早上七点起床"));
+
+    spiffs_posix_fail_writes_after(1);
+    EXPECT_FALSE(index_.Flush());
+    spiffs_posix_fail_writes_after(-1);
+    EXPECT_EQ(index_.GetIndexedCount(), 1u);
+
+    // Records are indexed again from the stored count
+    EXPECT_FALSE(Add(2, "每天早上七点起床"));
+    ASSERT_TRUE(Add(1, "下个月要去北京旅游"));
+    ASSERT_TRUE(Add(2, "每天早上七点起床"));
+    ASSERT_TRUE(index_.Flush());
+
+    KeywordIndex reloaded;
+    reloaded.Init("/spiffs/memory", "kwt");
+    EXPECT_EQ(reloaded.GetIndexedCount(), 3u);
+    std::vector<uint32_t> candidates;
+    ASSERT_TRUE(reloaded.Lookup("北京", candidates));
+    EXPECT_EQ(candidates, std::vector<uint32_t>{1});
+}
+
+TEST_F(KeywordIndexTest, PendingCapFlushesEarly) {
+    // Every record has new ASCII words, so the buffer fills before a segment would
+    uint32_t id = 0;
+    spiffs_posix_reset_stats();
+    while (spiffs_posix_get_stats().opens == 0) {
+        char text[64];
+        snprintf(text, sizeof(text), "w%ua w%ub w%uc w%ud", id, id, id, id);
+        ASSERT_TRUE(Add(id++, text));
+        ASSERT_LE(id, KeywordIndex::MAX_PENDING_POSTINGS);
+    }
+    EXPECT_EQ(id * 4, KeywordIndex::MAX_PENDING_POSTINGS);
+}
+
+TEST(MemoryArchiveTest, PartialAsciiWordIsScanned) {
+    auto& archive = MemoryArchive::GetInstance();
+    std::vector<Event> events(2);
+    snprintf(events[0].date, sizeof(events[0].date), "2025-01-01");
+    snprintf(events[0].event_type, sizeof(events[0].event_type), "pet");
+    snprintf(events[0].content, sizeof(events[0].content), "养了一只叫 mimi 的猫");
+    snprintf(events[1].date, sizeof(events[1].date), "2025-01-02");
+    snprintf(events[1].event_type, sizeof(events[1].event_type), "pet");
+    snprintf(events[1].content, sizeof(events[1].content), "带 mimi 去打疫苗");
+    ASSERT_TRUE(archive.ArchiveEvents(events));
+
+    // Whole word through the index, partial word through the scan
+    EXPECT_EQ(archive.RecallByKeyword("event", "mimi", 10).size(), 2u);
+    EXPECT_EQ(archive.RecallByKeyword("event", "MIM", 10).size(), 2u);
+    EXPECT_EQ(archive.RecallByKeyword("event", "疫苗", 10).size(), 1u);
+    EXPECT_TRUE(archive.RecallByKeyword("event", "mimo", 10).empty());
+}
+
+TEST(MemoryArchiveTest, PartialAsciiWordFindsLongerWordsBesideWholeWord) {
+    auto& archive = MemoryArchive::GetInstance();
+    std::vector<Event> events(3);
+    const char* contents[] = { "去 ca 考试", "喂 cat 吃饭", "买了 cake" };
+    for (int i = 0; i < 3; i++) {
+        snprintf(events[i].date, sizeof(events[i].date), "2025-02-0%d", i + 1);
+        snprintf(events[i].event_type, sizeof(events[i].event_type), "misc");
+        snprintf(events[i].content, sizeof(events[i].content), "%s", contents[i]);
+    }
+    ASSERT_TRUE(archive.ArchiveEvents(events));
+
+    // "ca" is an indexed word of the first record, the other two only contain it
+    EXPECT_EQ(archive.RecallByKeyword("event", "ca", 10).size(), 3u);
+    EXPECT_EQ(archive.RecallByKeyword("event", "cat", 10).size(), 1u);
+}
+
+// Heap growth above the live bytes at construction, until destruction
+class PeakAllocation {
+public:
+    PeakAllocation() : base_(g_live_bytes.load()) { g_peak_bytes.store(base_); }
+    size_t Bytes() const { return g_peak_bytes.load() - base_; }
+
+private:
+    size_t base_;
+};
+
+TEST(MemoryArchiveTest, RecallRecentPeakAllocationIsBounded) {
+    auto& archive = MemoryArchive::GetInstance();
+    const int kLimit = 10;
+    // Result items plus one RECALL_BATCH chunk of records, with slack for the
+    // stream lookup and logging; independent of the archive size
+    const size_t kBudget = kLimit * sizeof(ArchivedItem) + 8 * sizeof(ArchiveRecord) + 1024;
+
+    auto archive_moments = [&archive](int first, int count) {
+        std::vector<SpecialMoment> moments(count);
+        for (int i = 0; i < count; i++) {
+            moments[i].timestamp = 1735689600 + first + i;
+            snprintf(moments[i].topic, sizeof(moments[i].topic), "topic");
+            snprintf(moments[i].content, sizeof(moments[i].content), "moment %d", first + i);
+            moments[i].importance = 3;
+        }
+        return archive.ArchiveMoments(moments);
+    };
+
+    std::vector<size_t> peaks;
+    int archived = 0;
+    for (int count : {ARCHIVE_RECORDS_PER_SEGMENT * 2, ARCHIVE_RECORDS_PER_SEGMENT * 14}) {
+        ASSERT_TRUE(archive_moments(archived, count));
+        archived += count;
+
+        std::vector<ArchivedItem> items;
+        PeakAllocation peak;
+        items = archive.RecallRecent("moment", kLimit);
+        peaks.push_back(peak.Bytes());
+
+        ASSERT_EQ(items.size(), (size_t)kLimit);
+        char expected[32];
+        snprintf(expected, sizeof(expected), "moment %d", archived - 1);
+        EXPECT_NE(strstr(items.back().content, expected), nullptr) << items.back().content;
+        EXPECT_LE(peaks.back(), kBudget) << archived << " records archived";
+    }
+    // 2 vs 16 segments: the reader must not scale with the archive
+    EXPECT_EQ(peaks[0], peaks[1]);
+}
+
+// Legacy events_archive.jsonl as written by the pre-segment firmware
+void WriteLegacyEvents(int count) {
+    FILE* f = spiffs_posix_fopen("/spiffs/memory/events_archive.jsonl", "w");
+    ASSERT_NE(f, nullptr);
+    for (int i = 0; i < count; i++) {
+        spiffs_posix_fprintf(f, "{\"timestamp\":\"2024-05-01T10:%02d:00\",\"event_type\":\"trip\","
+                             "\"date\":\"2024-05-01\",\"content\":\"legacy event %d\",\"significance\":3}\n",
+                             i, i);
+    }
+    spiffs_posix_fclose(f);
+}
+
+bool LegacyEventsExist() {
+    struct stat st;
+    return spiffs_posix_stat("/spiffs/memory/events_archive.jsonl", &st) == 0;
+}
+
+TEST(MemoryArchiveTest, InterruptedMigrationResumesWithoutDuplicates) {
+    auto& archive = MemoryArchive::GetInstance();
+    const int kLines = 40;
+    size_t base = archive.GetArchiveCount("event");
+    WriteLegacyEvents(kLines);
+
+    // Partition fills up partway through the import
+    archive.Deinit();
+    spiffs_posix_fail_writes_after(10);
+    ASSERT_TRUE(archive.Init());
+    spiffs_posix_fail_writes_after(-1);
+    size_t partial = archive.GetArchiveCount("event");
+    EXPECT_GT(partial, base);
+    EXPECT_LT(partial, base + kLines);
+    EXPECT_TRUE(LegacyEventsExist());
+
+    // Next boot appends only the rest
+    archive.Deinit();
+    ASSERT_TRUE(archive.Init());
+    EXPECT_EQ(archive.GetArchiveCount("event"), base + kLines);
+    EXPECT_FALSE(LegacyEventsExist());
+
+    auto items = archive.RecallRecent("event", kLines);
+    ASSERT_EQ(items.size(), (size_t)kLines);
+    for (int i = 0; i < kLines; i++) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "legacy event %d\"", i);
+        EXPECT_NE(strstr(items[i].content, expected), nullptr) << items[i].content;
+    }
+
+    // Reset after the last record was appended but before the JSONL was removed
+    WriteLegacyEvents(kLines);
+    FILE* marker = spiffs_posix_fopen("/spiffs/memory/event.mig", "wb");
+    ASSERT_NE(marker, nullptr);
+    uint32_t started_at = base;
+    spiffs_posix_fwrite(&started_at, sizeof(started_at), 1, marker);
+    spiffs_posix_fclose(marker);
+    archive.Deinit();
+    ASSERT_TRUE(archive.Init());
+    EXPECT_EQ(archive.GetArchiveCount("event"), base + kLines);
+    EXPECT_FALSE(LegacyEventsExist());
+}
+
+// ========== Memory extractor ==========
+
+constexpr std::array<const char*, 12> kAutomatonPatterns = {
+    "我", "我叫", "叫", "我叫", "不", "不叫", "ab", "b", "abab", "bab", "？", "a",
+};
+constexpr size_t kAutomatonNodes = KeywordAutomaton<kAutomatonPatterns.size(),
+    KeywordAutomatonMaxNodes(kAutomatonPatterns)>(kAutomatonPatterns).GetNodeCount();
+constexpr KeywordAutomaton<kAutomatonPatterns.size(), kAutomatonNodes> kAutomaton(kAutomatonPatterns);
+
+// Every (pattern, end) pair, duplicates and overlaps included
+std::vector<std::pair<uint16_t, size_t>> NaiveMatches(const std::string& text) {
+    std::vector<std::pair<uint16_t, size_t>> matches;
+    for (size_t p = 0; p < kAutomatonPatterns.size(); p++) {
+        for (size_t pos = text.find(kAutomatonPatterns[p]); pos != std::string::npos;
+             pos = text.find(kAutomatonPatterns[p], pos + 1)) {
+            matches.emplace_back((uint16_t)p, pos + strlen(kAutomatonPatterns[p]));
+        }
+    }
+    return matches;
+}
+
+TEST(KeywordAutomatonTest, MatchesNaiveSearch) {
+    static_assert(!kAutomaton.Overflowed(), "test automaton overflow");
+    const char* alphabet[] = { "我", "叫", "不", "a", "b", "？", "?", "x" };
+    std::mt19937 rng(7);
+    for (int round = 0; round < 2000; round++) {
+        std::string text;
+        for (uint32_t n = rng() % 24; n > 0; n--) {
+            text += alphabet[rng() % 8];
+        }
+
+        std::vector<std::pair<uint16_t, size_t>> hits;
+        kAutomaton.Scan(text.data(), text.length(), [&](uint16_t pattern, size_t end) {
+            ASSERT_TRUE(hits.empty() || hits.back().second <= end) << text;
+            hits.emplace_back(pattern, end);
+        });
+        auto expected = NaiveMatches(text);
+        std::sort(hits.begin(), hits.end());
+        std::sort(expected.begin(), expected.end());
+        ASSERT_EQ(hits, expected) << text;
+    }
+}
+
+// The golden file holds the output of the extractor before the automaton
+// (per-pattern std::string::find). MEMORY_HOST_UPDATE_GOLDEN=1 rewrites it.
+TEST(MemoryExtractorTest, MatchesGoldenOutput) {
+    auto corpus = extractor_corpus::FixedUtterances();
+    auto generated = extractor_corpus::Generate(2000);
+    corpus.insert(corpus.end(), generated.begin(), generated.end());
+
+    const std::string path = std::string(MEMORY_HOST_TESTDATA) + "/extractor_golden.txt";
+    if (getenv("MEMORY_HOST_UPDATE_GOLDEN") != nullptr) {
+        std::ofstream out(path);
+        for (const auto& text : corpus) {
+            out << extractor_corpus::Format(text, MemoryExtractor::Extract(text)) << "\n";
+        }
+        GTEST_SKIP() << "Wrote " << path;
+    }
+
+    std::ifstream in(path);
+    ASSERT_TRUE(in.is_open()) << path;
+    std::string line;
+    size_t index = 0;
+    for (; std::getline(in, line); index++) {
+        ASSERT_LT(index, corpus.size());
+        const auto& text = corpus[index];
+        EXPECT_EQ(extractor_corpus::Format(text, MemoryExtractor::Extract(text)), line) << "utterance " << index;
+    }
+    EXPECT_EQ(index, corpus.size());
+}
+
+} // namespace
@@ -0,0 +1,49 @@
+// 主机端 cJSON 替身: 只实现 main/memory 用到的接口, 结构和类型值与 cJSON 1.7 一致。
+// 设置了 IDF_PATH 时 CMake 改用 ESP-IDF 自带的 cJSON, 本文件不参与编译。
+#ifndef HOST_CJSON_H
+#define HOST_CJSON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define cJSON_Invalid   (0)
+#define cJSON_False     (1 << 0)
+#define cJSON_True      (1 << 1)
+#define cJSON_NULL      (1 << 2)
+#define cJSON_Number    (1 << 3)
+#define cJSON_String    (1 << 4)
+#define cJSON_Array     (1 << 5)
+#define cJSON_Object    (1 << 6)
+
+typedef int cJSON_bool;
+
+typedef struct cJSON {
+    struct cJSON* next;
+    struct cJSON* prev;
+    struct cJSON* child;
+    int type;
+    char* valuestring;
+    int valueint;
+    double valuedouble;
+    char* string;
+} cJSON;
+
+cJSON* cJSON_Parse(const char* value);
+char* cJSON_PrintUnformatted(const cJSON* item);
+void cJSON_Delete(cJSON* item);
+void cJSON_free(void* object);
+
+cJSON* cJSON_CreateObject(void);
+cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string);
+cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double number);
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string);
+
+cJSON_bool cJSON_IsString(const cJSON* item);
+cJSON_bool cJSON_IsNumber(const cJSON* item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_CJSON_H
@@ -0,0 +1,364 @@
+// 主机端 cJSON 替身, 说明见 cJSON.h
+#include "cJSON.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+
+namespace {
+
+cJSON* NewItem(int type) {
+    cJSON* item = static_cast<cJSON*>(calloc(1, sizeof(cJSON)));
+    if (item != nullptr) {
+        item->type = type;
+    }
+    return item;
+}
+
+char* Duplicate(const std::string& s) {
+    char* copy = static_cast<char*>(malloc(s.size() + 1));
+    if (copy != nullptr) {
+        memcpy(copy, s.c_str(), s.size() + 1);
+    }
+    return copy;
+}
+
+void Append(cJSON* parent, cJSON* item) {
+    if (parent->child == nullptr) {
+        parent->child = item;
+        item->prev = item;     // cJSON keeps the tail in child->prev
+        return;
+    }
+    cJSON* tail = parent->child->prev;
+    tail->next = item;
+    item->prev = tail;
+    parent->child->prev = item;
+}
+
+void SetNumber(cJSON* item, double number) {
+    item->valuedouble = number;
+    if (number >= 2147483647.0) {
+        item->valueint = 2147483647;
+    } else if (number <= -2147483648.0) {
+        item->valueint = -2147483647 - 1;
+    } else {
+        item->valueint = (int)number;
+    }
+}
+
+class Parser {
+public:
+    explicit Parser(const char* p) : p_(p) {}
+
+    cJSON* ParseValue() {
+        SkipSpace();
+        switch (*p_) {
+        case '{':
+            return ParseContainer(cJSON_Object, '}');
+        case '[':
+            return ParseContainer(cJSON_Array, ']');
+        case '"': {
+            std::string s;
+            if (!ParseString(s)) {
+                return nullptr;
+            }
+            cJSON* item = NewItem(cJSON_String);
+            item->valuestring = Duplicate(s);
+            return item;
+        }
+        case 't':
+            return ParseLiteral("true", cJSON_True);
+        case 'f':
+            return ParseLiteral("false", cJSON_False);
+        case 'n':
+            return ParseLiteral("null", cJSON_NULL);
+        default: {
+            char* end;
+            double number = strtod(p_, &end);
+            if (end == p_) {
+                return nullptr;
+            }
+            p_ = end;
+            cJSON* item = NewItem(cJSON_Number);
+            SetNumber(item, number);
+            return item;
+        }
+        }
+    }
+
+    bool AtEnd() {
+        SkipSpace();
+        return *p_ == '\0';
+    }
+
+private:
+    void SkipSpace() {
+        while (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r') {
+            p_++;
+        }
+    }
+
+    cJSON* ParseLiteral(const char* literal, int type) {
+        size_t length = strlen(literal);
+        if (strncmp(p_, literal, length) != 0) {
+            return nullptr;
+        }
+        p_ += length;
+        cJSON* item = NewItem(type);
+        item->valueint = type == cJSON_True;
+        return item;
+    }
+
+    cJSON* ParseContainer(int type, char close) {
+        cJSON* container = NewItem(type);
+        p_++;
+        SkipSpace();
+        if (*p_ == close) {
+            p_++;
+            return container;
+        }
+        while (true) {
+            std::string name;
+            if (type == cJSON_Object) {
+                SkipSpace();
+                if (*p_ != '"' || !ParseString(name)) {
+                    break;
+                }
+                SkipSpace();
+                if (*p_++ != ':') {
+                    break;
+                }
+            }
+            cJSON* child = ParseValue();
+            if (child == nullptr) {
+                break;
+            }
+            if (type == cJSON_Object) {
+                child->string = Duplicate(name);
+            }
+            Append(container, child);
+            SkipSpace();
+            if (*p_ == ',') {
+                p_++;
+                continue;
+            }
+            if (*p_ == close) {
+                p_++;
+                return container;
+            }
+            break;
+        }
+        cJSON_Delete(container);
+        return nullptr;
+    }
+
+    bool ParseString(std::string& out) {
+        p_++;
+        while (*p_ != '"') {
+            if (*p_ == '\0') {
+                return false;
+            }
+            if (*p_ != '\\') {
+                out.push_back(*p_++);
+                continue;
+            }
+            p_++;
+            switch (*p_) {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned code;
+                if (sscanf(p_ + 1, "%4x", &code) != 1) {
+                    return false;
+                }
+                p_ += 4;
+                if (code < 0x80) {
+                    out.push_back((char)code);
+                } else if (code < 0x800) {
+                    out.push_back((char)(0xC0 | (code >> 6)));
+                    out.push_back((char)(0x80 | (code & 0x3F)));
+                } else {
+                    out.push_back((char)(0xE0 | (code >> 12)));
+                    out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back((char)(0x80 | (code & 0x3F)));
+                }
+                break;
+            }
+            case '\0':
+                return false;
+            default:
+                out.push_back(*p_);
+                break;
+            }
+            p_++;
+        }
+        p_++;
+        return true;
+    }
+
+    const char* p_;
+};
+
+void PrintString(std::string& out, const char* s) {
+    out.push_back('"');
+    for (; *s != '\0'; s++) {
+        unsigned char c = *s;
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                out += escape;
+            } else {
+                out.push_back((char)c);
+            }
+            break;
+        }
+    }
+    out.push_back('"');
+}
+
+void PrintValue(std::string& out, const cJSON* item) {
+    switch (item->type) {
+    case cJSON_False: out += "false"; break;
+    case cJSON_True:  out += "true"; break;
+    case cJSON_NULL:  out += "null"; break;
+    case cJSON_Number: {
+        char number[32];
+        double d = item->valuedouble;
+        if (std::isnan(d) || std::isinf(d)) {
+            snprintf(number, sizeof(number), "null");
+        } else if (d == (double)item->valueint) {
+            snprintf(number, sizeof(number), "%d", item->valueint);
+        } else {
+            snprintf(number, sizeof(number), "%1.15g", d);
+            if (strtod(number, nullptr) != d) {
+                snprintf(number, sizeof(number), "%1.17g", d);
+            }
+        }
+        out += number;
+        break;
+    }
+    case cJSON_String:
+        PrintString(out, item->valuestring);
+        break;
+    case cJSON_Array:
+    case cJSON_Object: {
+        bool object = item->type == cJSON_Object;
+        out.push_back(object ? '{' : '[');
+        for (const cJSON* child = item->child; child != nullptr; child = child->next) {
+            if (child != item->child) {
+                out.push_back(',');
+            }
+            if (object) {
+                PrintString(out, child->string);
+                out.push_back(':');
+            }
+            PrintValue(out, child);
+        }
+        out.push_back(object ? '}' : ']');
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+cJSON* cJSON_Parse(const char* value) {
+    if (value == nullptr) {
+        return nullptr;
+    }
+    Parser parser(value);
+    cJSON* item = parser.ParseValue();
+    if (item != nullptr && !parser.AtEnd()) {
+        cJSON_Delete(item);
+        return nullptr;
+    }
+    return item;
+}
+
+char* cJSON_PrintUnformatted(const cJSON* item) {
+    if (item == nullptr) {
+        return nullptr;
+    }
+    std::string out;
+    PrintValue(out, item);
+    return Duplicate(out);
+}
+
+void cJSON_Delete(cJSON* item) {
+    while (item != nullptr) {
+        cJSON* next = item->next;
+        cJSON_Delete(item->child);
+        free(item->valuestring);
+        free(item->string);
+        free(item);
+        item = next;
+    }
+}
+
+void cJSON_free(void* object) {
+    free(object);
+}
+
+cJSON* cJSON_CreateObject(void) {
+    return NewItem(cJSON_Object);
+}
+
+cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string) {
+    if (object == nullptr || name == nullptr || string == nullptr) {
+        return nullptr;
+    }
+    cJSON* item = NewItem(cJSON_String);
+    item->valuestring = Duplicate(string);
+    item->string = Duplicate(name);
+    Append(object, item);
+    return item;
+}
+
+cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double number) {
+    if (object == nullptr || name == nullptr) {
+        return nullptr;
+    }
+    cJSON* item = NewItem(cJSON_Number);
+    SetNumber(item, number);
+    item->string = Duplicate(name);
+    Append(object, item);
+    return item;
+}
+
+// Case-insensitive like cJSON_GetObjectItem
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string) {
+    if (object == nullptr || string == nullptr) {
+        return nullptr;
+    }
+    for (cJSON* child = object->child; child != nullptr; child = child->next) {
+        if (child->string != nullptr && strcasecmp(child->string, string) == 0) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+cJSON_bool cJSON_IsString(const cJSON* item) {
+    return item != nullptr && (item->type & 0xFF) == cJSON_String;
+}
+
+cJSON_bool cJSON_IsNumber(const cJSON* item) {
+    return item != nullptr && (item->type & 0xFF) == cJSON_Number;
+}
@@ -0,0 +1,25 @@
+// 主机端 ESP-IDF 替身: esp_log.h
+// 日志输出到 stderr, 级别由环境变量 MEMORY_HOST_LOG (E/W/I/D, 默认 W) 控制
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void host_log_write(char level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_LOGE(tag, format, ...) host_log_write('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) host_log_write('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) host_log_write('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) host_log_write('D', tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) host_log_write('V', tag, format, ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H
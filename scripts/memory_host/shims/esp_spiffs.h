@@ -0,0 +1,22 @@
+// 主机端 ESP-IDF 替身: esp_spiffs.h, 挂载由 spiffs_posix.cc 模拟
+#ifndef HOST_ESP_SPIFFS_H
+#define HOST_ESP_SPIFFS_H
+
+#include <cstddef>
+
+#include "esp_err.h"
+
+typedef struct {
+    const char* base_path;
+    const char* partition_label;
+    size_t max_files;
+    bool format_if_mount_failed;
+} esp_vfs_spiffs_conf_t;
+
+extern "C" {
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf);
+esp_err_t esp_vfs_spiffs_unregister(const char* partition_label);
+esp_err_t esp_spiffs_info(const char* partition_label, size_t* total_bytes, size_t* used_bytes);
+}
+
+#endif // HOST_ESP_SPIFFS_H
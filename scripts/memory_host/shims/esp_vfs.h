@@ -0,0 +1,7 @@
+// 主机端 ESP-IDF 替身: esp_vfs.h (SPIFFS 替身见 esp_spiffs.h)
+#ifndef HOST_ESP_VFS_H
+#define HOST_ESP_VFS_H
+
+#include "esp_err.h"
+
+#endif // HOST_ESP_VFS_H
@@ -0,0 +1,394 @@
+// 主机端 NVS 模拟器, 说明见 nvs_emulator.h
+#include "nvs_emulator.h"
+#include "nvs_flash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum ItemType : uint8_t {
+    kItemU32 = 1,
+    kItemString = 2,
+    kItemBlob = 3,
+};
+
+struct Item {
+    ItemType type;
+    std::vector<uint8_t> data;
+};
+
+struct Handle {
+    std::string ns;
+    bool read_only;
+};
+
+std::mutex g_mutex;
+std::map<std::string, std::map<std::string, Item>> g_namespaces;
+std::map<nvs_handle_t, Handle> g_handles;
+nvs_handle_t g_next_handle = 1;
+NvsEmulatorStats g_stats = {};
+size_t g_partition_size = NVS_EMULATOR_DEFAULT_PARTITION;
+std::string g_file;
+int g_writes_left = -1;     // < 0: no simulated power loss
+
+uint32_t EntriesFor(ItemType type, size_t size) {
+    uint32_t data = (size + NVS_EMULATOR_ENTRY_SIZE - 1) / NVS_EMULATOR_ENTRY_SIZE;
+    switch (type) {
+    case kItemU32:
+        return 1;
+    case kItemString:
+        return 1 + data;
+    case kItemBlob:
+    default:
+        return 2 + data;
+    }
+}
+
+uint32_t CapacityEntries() {
+    size_t pages = g_partition_size / NVS_EMULATOR_PAGE_SIZE;
+    return pages > 1 ? (pages - 1) * NVS_EMULATOR_ENTRIES_PER_PAGE : 0;
+}
+
+bool SaveFileLocked() {
+    if (g_file.empty()) {
+        return true;
+    }
+    FILE* f = fopen(g_file.c_str(), "wb");
+    if (f == nullptr) {
+        return false;
+    }
+    fwrite("NVSH", 1, 4, f);
+    for (const auto& ns : g_namespaces) {
+        for (const auto& kv : ns.second) {
+            uint8_t header[3] = { (uint8_t)ns.first.size(), (uint8_t)kv.first.size(), kv.second.type };
+            uint32_t size = kv.second.data.size();
+            fwrite(header, 1, sizeof(header), f);
+            fwrite(&size, 1, sizeof(size), f);
+            fwrite(ns.first.data(), 1, ns.first.size(), f);
+            fwrite(kv.first.data(), 1, kv.first.size(), f);
+            fwrite(kv.second.data.data(), 1, size, f);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+bool LoadFileLocked() {
+    FILE* f = fopen(g_file.c_str(), "rb");
+    if (f == nullptr) {
+        return true;    // Starts empty
+    }
+    char magic[4];
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, "NVSH", 4) == 0;
+    g_namespaces.clear();
+    g_stats.used_entries = 0;
+    while (ok) {
+        uint8_t header[3];
+        uint32_t size;
+        if (fread(header, 1, sizeof(header), f) != sizeof(header)) {
+            break;
+        }
+        std::string ns(header[0], '\0'), key(header[1], '\0');
+        Item item = { (ItemType)header[2], {} };
+        ok = fread(&size, 1, sizeof(size), f) == sizeof(size) &&
+             fread(&ns[0], 1, ns.size(), f) == ns.size() &&
+             fread(&key[0], 1, key.size(), f) == key.size();
+        if (ok) {
+            item.data.resize(size);
+            ok = fread(item.data.data(), 1, size, f) == size;
+        }
+        if (ok) {
+            g_stats.used_entries += EntriesFor(item.type, size);
+            g_namespaces[ns][key] = std::move(item);
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+// Counts down the writes left before the simulated power loss
+bool WriteAllowed() {
+    if (g_writes_left < 0) {
+        return true;
+    }
+    if (g_writes_left == 0) {
+        return false;
+    }
+    g_writes_left--;
+    return true;
+}
+
+esp_err_t CheckKey(const char* key) {
+    if (key == nullptr || key[0] == '\0') {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    if (strlen(key) > NVS_KEY_NAME_MAX_SIZE - 1) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    return ESP_OK;
+}
+
+std::map<std::string, Item>* Lookup(nvs_handle_t handle, bool write, esp_err_t& err) {
+    auto it = g_handles.find(handle);
+    if (it == g_handles.end()) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+        return nullptr;
+    }
+    if (write && it->second.read_only) {
+        err = ESP_ERR_NVS_READ_ONLY;
+        return nullptr;
+    }
+    err = ESP_OK;
+    return &g_namespaces[it->second.ns];
+}
+
+esp_err_t SetItem(nvs_handle_t handle, const char* key, ItemType type, const void* value, size_t size) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    esp_err_t err = CheckKey(key);
+    if (err != ESP_OK) {
+        return err;
+    }
+    auto items = Lookup(handle, true, err);
+    if (items == nullptr) {
+        return err;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    auto old = items->find(key);
+    uint32_t old_entries = 0;
+    if (old != items->end()) {
+        if (old->second.type != type) {
+            return ESP_ERR_NVS_TYPE_MISMATCH;
+        }
+        if (old->second.data.size() == size && memcmp(old->second.data.data(), bytes, size) == 0) {
+            g_stats.unchanged_sets++;
+            return ESP_OK;
+        }
+        old_entries = EntriesFor(type, old->second.data.size());
+    }
+    uint32_t entries = EntriesFor(type, size);
+    if (g_stats.used_entries - old_entries + entries > CapacityEntries()) {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+    if (!WriteAllowed()) {
+        return ESP_FAIL;
+    }
+
+    g_stats.sets++;
+    g_stats.payload_bytes += size;
+    g_stats.flash_bytes += entries * NVS_EMULATOR_ENTRY_SIZE;
+    g_stats.erased_entries += old_entries;
+    g_stats.used_entries += entries - old_entries;
+    (*items)[key] = Item{ type, std::vector<uint8_t>(bytes, bytes + size) };
+    return ESP_OK;
+}
+
+const Item* GetItem(nvs_handle_t handle, const char* key, ItemType type, esp_err_t& err) {
+    err = CheckKey(key);
+    if (err != ESP_OK) {
+        return nullptr;
+    }
+    auto items = Lookup(handle, false, err);
+    if (items == nullptr) {
+        return nullptr;
+    }
+    auto it = items->find(key);
+    if (it == items->end()) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+        return nullptr;
+    }
+    if (it->second.type != type) {
+        err = ESP_ERR_NVS_TYPE_MISMATCH;
+        return nullptr;
+    }
+    return &it->second;
+}
+
+} // namespace
+
+// ============== Control ==============
+
+void nvs_emulator_reset() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_namespaces.clear();
+    g_stats = {};
+    g_writes_left = -1;
+}
+
+void nvs_emulator_reset_stats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    uint32_t used = g_stats.used_entries;
+    g_stats = {};
+    g_stats.used_entries = used;
+}
+
+NvsEmulatorStats nvs_emulator_get_stats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    NvsEmulatorStats stats = g_stats;
+    stats.capacity_entries = CapacityEntries();
+    return stats;
+}
+
+void nvs_emulator_set_partition_size(size_t bytes) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_partition_size = bytes;
+}
+
+void nvs_emulator_fail_writes_after(int count) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_writes_left = count;
+}
+
+bool nvs_emulator_set_file(const char* path) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_file = path != nullptr ? path : "";
+    return g_file.empty() || LoadFileLocked();
+}
+
+// ============== nvs_flash.h / nvs.h ==============
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    nvs_emulator_reset();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (name == nullptr || strlen(name) > NVS_KEY_NAME_MAX_SIZE - 1) {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    if (open_mode == NVS_READONLY && g_namespaces.find(name) == g_namespaces.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *out_handle = g_next_handle++;
+    g_handles[*out_handle] = Handle{ name, open_mode == NVS_READONLY };
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_handles.erase(handle);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_handles.find(handle) == g_handles.end()) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    g_stats.commits++;
+    return SaveFileLocked() ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    esp_err_t err = CheckKey(key);
+    if (err != ESP_OK) {
+        return err;
+    }
+    auto items = Lookup(handle, true, err);
+    if (items == nullptr) {
+        return err;
+    }
+    auto it = items->find(key);
+    if (it == items->end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (!WriteAllowed()) {
+        return ESP_FAIL;
+    }
+    uint32_t entries = EntriesFor(it->second.type, it->second.data.size());
+    g_stats.erases++;
+    g_stats.erased_entries += entries;
+    g_stats.used_entries -= entries;
+    items->erase(it);
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    esp_err_t err;
+    auto items = Lookup(handle, true, err);
+    if (items == nullptr) {
+        return err;
+    }
+    if (!WriteAllowed()) {
+        return ESP_FAIL;
+    }
+    for (const auto& kv : *items) {
+        uint32_t entries = EntriesFor(kv.second.type, kv.second.data.size());
+        g_stats.erases++;
+        g_stats.erased_entries += entries;
+        g_stats.used_entries -= entries;
+    }
+    items->clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    return SetItem(handle, key, kItemBlob, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    esp_err_t err;
+    const Item* item = GetItem(handle, key, kItemBlob, err);
+    if (item == nullptr) {
+        return err;
+    }
+    if (out_value == nullptr) {
+        *length = item->data.size();
+        return ESP_OK;
+    }
+    if (*length < item->data.size()) {
+        *length = item->data.size();
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, item->data.data(), item->data.size());
+    *length = item->data.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value) {
+    return SetItem(handle, key, kItemU32, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out_value) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    esp_err_t err;
+    const Item* item = GetItem(handle, key, kItemU32, err);
+    if (item == nullptr) {
+        return err;
+    }
+    memcpy(out_value, item->data.data(), sizeof(*out_value));
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char* key, const char* value) {
+    return SetItem(handle, key, kItemString, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char* key, char* out_value, size_t* length) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    esp_err_t err;
+    const Item* item = GetItem(handle, key, kItemString, err);
+    if (item == nullptr) {
+        return err;
+    }
+    if (out_value == nullptr) {
+        *length = item->data.size();
+        return ESP_OK;
+    }
+    if (*length < item->data.size()) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, item->data.data(), item->data.size());
+    *length = item->data.size();
+    return ESP_OK;
+}
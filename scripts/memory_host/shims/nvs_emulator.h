@@ -0,0 +1,41 @@
+// 主机端 NVS 模拟器的控制接口 (nvs.h 的实现见 nvs_emulator.cc)
+//
+// 按 ESP-IDF NVS 的 32 字节条目计数写入量: blob = 1 个数据头条目 + 数据条目 + 1 个 blob 索引
+// 条目, u32 = 1 个条目, 字符串 = 1 个头条目 + 数据条目。覆盖或删除时旧条目记为已擦除;
+// 与已存值完全相同的写入不写 flash (与 NVS 相同)。分区容量按 (页数 - 1) x 126 个条目计算
+// (保留一页用于垃圾回收), 超出时返回 ESP_ERR_NVS_NOT_ENOUGH_SPACE。
+#ifndef HOST_NVS_EMULATOR_H
+#define HOST_NVS_EMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define NVS_EMULATOR_ENTRY_SIZE         32
+#define NVS_EMULATOR_PAGE_SIZE          4096
+#define NVS_EMULATOR_ENTRIES_PER_PAGE   126
+#define NVS_EMULATOR_DEFAULT_PARTITION  0x4000      // partitions/v1/4m.csv, 8m.csv
+
+struct NvsEmulatorStats {
+    uint32_t sets;              // set 调用中实际写入的次数
+    uint32_t unchanged_sets;    // 与已存值相同, 未写入
+    uint32_t erases;            // 删除的键
+    uint32_t commits;
+    uint64_t payload_bytes;     // 写入的数据字节
+    uint64_t flash_bytes;       // 写入的条目 x 32
+    uint32_t erased_entries;    // 因覆盖或删除标记为已擦除的条目
+    uint32_t used_entries;      // 当前有效条目
+    uint32_t capacity_entries;
+};
+
+// 清空全部数据和计数
+void nvs_emulator_reset();
+void nvs_emulator_reset_stats();
+NvsEmulatorStats nvs_emulator_get_stats();
+void nvs_emulator_set_partition_size(size_t bytes);
+// 模拟写到一半掉电: 再成功执行 count 次写入或删除后, 之后的写入和删除都返回 ESP_FAIL;
+// count < 0 取消
+void nvs_emulator_fail_writes_after(int count);
+// 以文件保存模拟的 NVS: 立即读入 (文件存在时), 之后每次 nvs_commit 写回
+bool nvs_emulator_set_file(const char* path);
+
+#endif // HOST_NVS_EMULATOR_H
@@ -0,0 +1,18 @@
+// 主机端 ESP-IDF 替身: nvs_flash.h, 实现见 nvs_emulator.cc
+#ifndef HOST_NVS_FLASH_H
+#define HOST_NVS_FLASH_H
+
+#include "nvs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_NVS_FLASH_H
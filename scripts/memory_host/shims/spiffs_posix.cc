@@ -0,0 +1,273 @@
+// 主机端 SPIFFS 替身, 说明见 spiffs_posix.h
+// 本文件不包含 spiffs_posix.h 的宏 (CMake 只对 main/memory 源文件强制包含)
+#include "spiffs_posix.h"
+#include "esp_spiffs.h"
+
+#include <cerrno>
+#include <cstdarg>
+#include <dirent.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unistd.h>
+
+#undef fopen
+#undef fclose
+#undef fread
+#undef fwrite
+#undef fgets
+#undef fprintf
+#undef remove
+#undef stat
+
+namespace {
+
+std::mutex g_mutex;
+std::string g_root;
+std::string g_base_path;
+size_t g_max_files = 0;
+size_t g_total_bytes = 3 * 1024 * 1024;     // partitions/v2/16m_c3.csv: memory, 3M
+bool g_mounted = false;
+std::set<FILE*> g_open;
+SpiffsPosixStats g_stats = {};
+int g_writes_left = -1;         // < 0: no fault injection
+
+// Caller holds g_mutex
+bool WriteFails(FILE* f) {
+    if (g_writes_left < 0 || g_open.count(f) == 0) {
+        return false;
+    }
+    if (g_writes_left == 0) {
+        return true;
+    }
+    g_writes_left--;
+    return false;
+}
+
+const std::string& Root() {
+    if (g_root.empty()) {
+        const char* env = getenv("MEMORY_HOST_SPIFFS");
+        g_root = env != nullptr ? env : "/tmp/memory_host_spiffs";
+        mkdir(g_root.c_str(), 0755);
+    }
+    return g_root;
+}
+
+// Returns false when path is not under the mount point; object is "" when the name is invalid
+bool MapPath(const char* path, std::string& host_path, bool& valid) {
+    if (g_base_path.empty() || strncmp(path, g_base_path.c_str(), g_base_path.size()) != 0 ||
+        path[g_base_path.size()] != '/') {
+        return false;
+    }
+    const char* object = path + g_base_path.size();
+    valid = g_mounted && strlen(object) < SPIFFS_POSIX_OBJ_NAME_LEN;
+    std::string name(object + 1);
+    for (auto& c : name) {
+        if (c == '/') {
+            c = '#';
+        }
+    }
+    host_path = Root() + "/" + name;
+    return true;
+}
+
+} // namespace
+
+void spiffs_posix_set_root(const char* root) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_root = root;
+}
+
+void spiffs_posix_clear() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    DIR* dir = opendir(Root().c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    while (auto entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            unlink((Root() + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+}
+
+void spiffs_posix_set_total_bytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_total_bytes = bytes;
+}
+
+void spiffs_posix_reset_stats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    uint32_t open_files = g_stats.open_files;
+    g_stats = {};
+    g_stats.open_files = open_files;
+    g_stats.peak_open_files = open_files;
+}
+
+void spiffs_posix_fail_writes_after(int count) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_writes_left = count;
+}
+
+SpiffsPosixStats spiffs_posix_get_stats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_stats;
+}
+
+FILE* spiffs_posix_fopen(const char* path, const char* mode) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::string host_path;
+    bool valid = true;
+    if (!MapPath(path, host_path, valid)) {
+        return fopen(path, mode);
+    }
+    if (!valid || g_stats.open_files >= g_max_files) {
+        g_stats.open_failures++;
+        errno = !valid ? ENAMETOOLONG : ENFILE;
+        return nullptr;
+    }
+    FILE* f = fopen(host_path.c_str(), mode);
+    if (f == nullptr) {
+        g_stats.open_failures++;
+        return nullptr;
+    }
+    g_stats.opens++;
+    g_open.insert(f);
+    if (++g_stats.open_files > g_stats.peak_open_files) {
+        g_stats.peak_open_files = g_stats.open_files;
+    }
+    return f;
+}
+
+int spiffs_posix_fclose(FILE* f) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_open.erase(f) != 0) {
+            g_stats.open_files--;
+        }
+    }
+    return fclose(f);
+}
+
+size_t spiffs_posix_fread(void* buffer, size_t size, size_t count, FILE* f) {
+    size_t n = fread(buffer, size, count, f);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_stats.bytes_read += n * size;
+    return n;
+}
+
+size_t spiffs_posix_fwrite(const void* buffer, size_t size, size_t count, FILE* f) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (WriteFails(f)) {
+        errno = ENOSPC;
+        return 0;
+    }
+    size_t n = fwrite(buffer, size, count, f);
+    g_stats.bytes_written += n * size;
+    return n;
+}
+
+char* spiffs_posix_fgets(char* buffer, int size, FILE* f) {
+    char* line = fgets(buffer, size, f);
+    if (line != nullptr) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stats.bytes_read += strlen(line);
+    }
+    return line;
+}
+
+int spiffs_posix_fprintf(FILE* f, const char* format, ...) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (WriteFails(f)) {
+            errno = ENOSPC;
+            return -1;
+        }
+    }
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(f, format, args);
+    va_end(args);
+    if (n > 0) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stats.bytes_written += n;
+    }
+    return n;
+}
+
+int spiffs_posix_remove(const char* path) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::string host_path;
+    bool valid = true;
+    if (!MapPath(path, host_path, valid)) {
+        return remove(path);
+    }
+    if (!valid) {
+        errno = ENOENT;
+        return -1;
+    }
+    int ret = unlink(host_path.c_str());
+    if (ret == 0) {
+        g_stats.removes++;
+    }
+    return ret;
+}
+
+int spiffs_posix_stat(const char* path, struct stat* st) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::string host_path;
+    bool valid = true;
+    if (!MapPath(path, host_path, valid)) {
+        return stat(path, st);
+    }
+    if (!valid) {
+        errno = ENOENT;
+        return -1;
+    }
+    return stat(host_path.c_str(), st);
+}
+
+// ============== esp_spiffs.h ==============
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    g_base_path = conf->base_path;
+    g_max_files = conf->max_files;
+    g_mounted = true;
+    Root();
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_spiffs_unregister(const char* partition_label) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    g_mounted = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_spiffs_info(const char* partition_label, size_t* total_bytes, size_t* used_bytes) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t used = 0;
+    DIR* dir = opendir(Root().c_str());
+    if (dir != nullptr) {
+        while (auto entry = readdir(dir)) {
+            struct stat st;
+            if (entry->d_name[0] != '.' && stat((Root() + "/" + entry->d_name).c_str(), &st) == 0) {
+                used += st.st_size;
+            }
+        }
+        closedir(dir);
+    }
+    *total_bytes = g_total_bytes;
+    *used_bytes = used;
+    return ESP_OK;
+}
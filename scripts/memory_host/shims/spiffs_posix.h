@@ -0,0 +1,67 @@
+// 主机端 SPIFFS 替身: 以 -include 强制包含进 main/memory 源文件, 把其中的文件调用
+// 转到 spiffs_posix.cc。
+//
+// 挂载点下的路径 ("/spiffs/memory/fact_0001.seg") 映射为根目录下的单个文件, 名字中的 '/'
+// 换成 '#', 与 SPIFFS 的扁平命名一致; 对象名 (挂载点之后的部分) 超过 31 字节或同时打开的
+// 文件超过 max_files 时 fopen 失败, 与设备上相同。挂载点以外的路径原样交给 libc。
+// 根目录取环境变量 MEMORY_HOST_SPIFFS, 或由 spiffs_posix_set_root() 指定。
+#ifndef HOST_SPIFFS_POSIX_H
+#define HOST_SPIFFS_POSIX_H
+
+// 标准库头文件先于下面的宏包含, 避免 std::remove 等同名声明被替换
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#define SPIFFS_POSIX_OBJ_NAME_LEN   32      // CONFIG_SPIFFS_OBJ_NAME_LEN, 含结尾的 '\0'
+
+struct SpiffsPosixStats {
+    uint32_t opens;
+    uint32_t open_failures;     // 名字过长 / 文件数超限 / 不存在
+    uint32_t open_files;
+    uint32_t peak_open_files;
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+    uint32_t removes;
+};
+
+// 根目录必须已存在; 清空时删除其中全部文件
+void spiffs_posix_set_root(const char* root);
+void spiffs_posix_clear();
+void spiffs_posix_set_total_bytes(size_t bytes);
+void spiffs_posix_reset_stats();
+SpiffsPosixStats spiffs_posix_get_stats();
+// 故障注入: 再成功写入 count 次后, 挂载点下文件的 fwrite / fprintf 全部失败 (模拟分区写满);
+// count < 0 关闭
+void spiffs_posix_fail_writes_after(int count);
+
+FILE* spiffs_posix_fopen(const char* path, const char* mode);
+int spiffs_posix_fclose(FILE* f);
+size_t spiffs_posix_fread(void* buffer, size_t size, size_t count, FILE* f);
+size_t spiffs_posix_fwrite(const void* buffer, size_t size, size_t count, FILE* f);
+char* spiffs_posix_fgets(char* buffer, int size, FILE* f);
+int spiffs_posix_fprintf(FILE* f, const char* format, ...) __attribute__((format(printf, 2, 3)));
+int spiffs_posix_remove(const char* path);
+int spiffs_posix_stat(const char* path, struct stat* st);
+
+#define fopen(path, mode)               spiffs_posix_fopen(path, mode)
+#define fclose(f)                       spiffs_posix_fclose(f)
+#define fread(buffer, size, count, f)   spiffs_posix_fread(buffer, size, count, f)
+#define fwrite(buffer, size, count, f)  spiffs_posix_fwrite(buffer, size, count, f)
+#define fgets(buffer, size, f)          spiffs_posix_fgets(buffer, size, f)
+#define fprintf                         spiffs_posix_fprintf
+#define remove(path)                    spiffs_posix_remove(path)
+#define stat(path, st)                  spiffs_posix_stat(path, st)
+
+#endif // HOST_SPIFFS_POSIX_H
@@ -0,0 +1,567 @@
+#!/usr/bin/env python3
+"""
+资源打包 v2 (asset pack v2) - 把无文件头的 v1 资源转换为带文件头、逐行压缩的格式
+
+v1 (现有格式): frames.bin / backgrounds.bin / items/frames.bin
+  每帧 = RGB888 调色板 (colors*3 字节) + width*height 字节索引, 无文件头, 不压缩
+
+v2 (main/images/asset_pack.h):
+  Header (32 字节, 小端)
+    magic "APK2", version 2, compression (0=raw, 1=RLE), width, height,
+    frame_count, palette_count, colors, palette_offset, frame_offset, data_size
+  调色板:   palette_count x colors x RGB565 (设备端无需再转换)
+  帧表:     frame_count x {offset, size, palette, base} (12 字节)
+  每帧:     (height+1) 个 uint32 行偏移 + 各行数据 (RLE, 见 asset_rle.h)
+  行偏移表让单行仍可随机读取 (BackgroundLoader::DecodeRow 低内存模式)
+
+帧间差分 (--delta, 仅动画):
+  每个动画首帧为关键帧, 之后每帧只保存与上一帧不同的行内区间 (span_count + 若干
+  {y, x, length, 像素}), 设备端在上一帧上原地修补, 读 flash 和查调色板都只涉及变化部分。
+  另外为每个循环动画追加一条 "末帧 -> 首帧" 的差分 (帧表之后的额外条目), 循环回到首帧时
+  同样只需修补。差分不比关键帧小时仍存关键帧; 每隔最多 31 帧强制一个关键帧
+  (ASSET_PACK_MAX_DELTA_CHAIN), 切换动画等随机访问时从关键帧重建。
+
+调色板:
+  动画: 每个动画 (index.json 的 animations) 共用一个调色板。
+        各帧颜色按 RGB565 合并 (设备只显示 RGB565, 因此合并本身无损);
+        超过 256 色时用 median cut 减色, 但每帧的背景色 (bg_color_index) 和原索引 0
+        的颜色保持精确, 且普通像素不会被映射到这些颜色上, 色键透明判断不受影响。
+        新索引 0 为首帧原索引 0 的颜色 (DecodeFrameARGB 以索引 0 作为透明)。
+  背景 / 物品: 每帧一个调色板, 索引不变 (无损)。
+
+使用方法:
+    python scripts/pack_assets_v2.py -o gifs/assets_v2.bin
+    python scripts/pack_assets_v2.py --raw --per-frame-palette -o gifs/assets_v2.bin
+    python scripts/pack_assets_v2.py --verify -o gifs/assets_v2.bin
+    python scripts/pack_assets_v2.py --delta --verify -o gifs/assets_v2.bin
+
+输出为合并后的分区镜像 (动画 | 背景 | 物品), 烧录方式与 v1 的 assets_combined.bin 相同:
+    python -m esptool --chip esp32c6 -p COMx --baud 921600 write_flash 0x800000 gifs/assets_v2.bin
+固件同时支持 v1 和 v2, 按分区开头是否为 "APK2" 自动识别。
+
+只依赖 Python 标准库。
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+MAGIC = b'APK2'
+VERSION = 2
+HEADER_SIZE = 32
+FRAME_ENTRY_SIZE = 12
+COMPRESSION_RAW = 0
+COMPRESSION_RLE = 1
+FLAG_DELTA = 0x01
+NO_FRAME = 0xFFFF
+MAX_DELTA_CHAIN = 32
+SPAN_HEADER_SIZE = 6
+# 两个变化区间之间相同像素不超过此数时合并为一个区间 (省去一个 6 字节区间头)
+SPAN_MERGE_GAP = 8
+
+RLE_MAX_LITERAL = 128
+RLE_MIN_REPEAT = 3
+RLE_MAX_REPEAT = 130
+
+
+def rgb888_to_rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def rgb565_to_rgb888(c):
+    return ((c >> 11) & 0x1F) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3
+
+
+# ---------------------------------------------------------------------------
+# RLE (与 main/images/asset_rle.h 保持一致)
+# ---------------------------------------------------------------------------
+
+def rle_encode_row(row):
+    """PackBits 风格: 0..127 = 之后 n+1 字节原样, 128..255 = 下一字节重复 n-125 次"""
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+    n = len(row)
+
+    def flush_literal():
+        for start in range(0, len(literal), RLE_MAX_LITERAL):
+            chunk = literal[start:start + RLE_MAX_LITERAL]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+        literal.clear()
+
+    while i < n:
+        run = 1
+        while i + run < n and run < RLE_MAX_REPEAT and row[i + run] == row[i]:
+            run += 1
+        if run >= RLE_MIN_REPEAT:
+            flush_literal()
+            out.append(run + 125)
+            out.append(row[i])
+            i += run
+        else:
+            literal.append(row[i])
+            i += 1
+    flush_literal()
+    return bytes(out)
+
+
+def rle_decode_row(data, pos, width):
+    out = bytearray()
+    while len(out) < width:
+        control = data[pos]
+        pos += 1
+        if control < 128:
+            out.extend(data[pos:pos + control + 1])
+            pos += control + 1
+        else:
+            out.extend(bytes([data[pos]]) * (control - 125))
+            pos += 1
+    if len(out) != width:
+        raise ValueError("RLE row overruns width")
+    return bytes(out), pos
+
+
+# ---------------------------------------------------------------------------
+# v1 读取
+# ---------------------------------------------------------------------------
+
+def read_v1(path, width, height, colors):
+    """返回 [(palette_rgb565[colors], indices bytes)]"""
+    data = open(path, 'rb').read()
+    frame_size = colors * 3 + width * height
+    if len(data) % frame_size != 0:
+        print(f"警告: {path} 大小 {len(data)} 不是帧大小 {frame_size} 的整数倍, 忽略末尾 "
+              f"{len(data) % frame_size} 字节")
+    frames = []
+    for f in range(len(data) // frame_size):
+        base = f * frame_size
+        pal = data[base:base + colors * 3]
+        palette = [rgb888_to_rgb565(pal[i * 3], pal[i * 3 + 1], pal[i * 3 + 2]) for i in range(colors)]
+        frames.append((palette, data[base + colors * 3:base + frame_size]))
+    return frames
+
+
+# ---------------------------------------------------------------------------
+# 共享调色板 (每个动画一个)
+# ---------------------------------------------------------------------------
+
+def median_cut(histogram, count):
+    """histogram: {rgb565: pixels}; 返回最多 count 个 RGB565 颜色"""
+    if count <= 0 or not histogram:
+        return []
+    boxes = [[(rgb565_to_rgb888(c), n) for c, n in histogram.items()]]
+    while len(boxes) < count:
+        # 切分像素最多且可再分的盒子
+        boxes.sort(key=lambda b: sum(n for _, n in b) if len(b) > 1 else -1)
+        box = boxes.pop()
+        if len(box) < 2:
+            boxes.append(box)
+            break
+        ranges = [max(c[ch] for c, _ in box) - min(c[ch] for c, _ in box) for ch in range(3)]
+        ch = ranges.index(max(ranges))
+        box.sort(key=lambda e: e[0][ch])
+        total = sum(n for _, n in box)
+        acc = 0
+        split = 1
+        for i, (_, n) in enumerate(box):
+            acc += n
+            if acc * 2 >= total:
+                split = min(max(i + 1, 1), len(box) - 1)
+                break
+        boxes.append(box[:split])
+        boxes.append(box[split:])
+    palette = []
+    for box in boxes:
+        total = sum(n for _, n in box)
+        r = sum(c[0] * n for c, n in box) // total
+        g = sum(c[1] * n for c, n in box) // total
+        b = sum(c[2] * n for c, n in box) // total
+        palette.append(rgb888_to_rgb565(r, g, b))
+    return palette
+
+
+def color_distance(a, b):
+    ar, ag, ab = rgb565_to_rgb888(a)
+    br, bg, bb = rgb565_to_rgb888(b)
+    return (ar - br) ** 2 * 3 + (ag - bg) ** 2 * 4 + (ab - bb) ** 2 * 2
+
+
+def build_shared_palette(frames, key_indices, colors):
+    """frames: [(palette, indices)], key_indices: 每帧需精确保留的原索引 (索引 0 + 背景色)
+    返回 (palette, [新索引 bytes], 是否无损, 最大误差)"""
+    key_colors = []
+    histogram = {}
+    for (palette, indices), keys in zip(frames, key_indices):
+        for k in keys:
+            if palette[k] not in key_colors:
+                key_colors.append(palette[k])
+        counts = [0] * len(palette)
+        for idx in indices:
+            counts[idx] += 1
+        for i, n in enumerate(counts):
+            if n and i not in keys:
+                histogram[palette[i]] = histogram.get(palette[i], 0) + n
+
+    # 新索引 0 = 第一帧原索引 0 的颜色
+    first_zero = frames[0][0][0]
+    key_colors.remove(first_zero)
+    key_colors.insert(0, first_zero)
+    if len(key_colors) > colors:
+        raise ValueError(f"{len(key_colors)} 个色键颜色超过调色板大小 {colors}")
+
+    normal = [c for c in histogram if c not in key_colors]
+    slots = colors - len(key_colors)
+    lossless = len(normal) <= slots
+    if lossless:
+        normal_palette = sorted(normal)
+    else:
+        normal_palette = median_cut({c: histogram[c] for c in normal}, slots)
+    palette = key_colors + normal_palette
+    palette += [0] * (colors - len(palette))
+
+    key_lookup = {c: i for i, c in enumerate(key_colors)}
+    normal_lookup = {}
+    base = len(key_colors)
+    max_error = 0
+    for c in histogram:
+        if c in key_lookup:
+            normal_lookup[c] = key_lookup[c]
+            continue
+        best = min(range(len(normal_palette)), key=lambda i: color_distance(c, normal_palette[i])) \
+            if not lossless else normal_palette.index(c)
+        normal_lookup[c] = base + best
+        max_error = max(max_error, color_distance(c, palette[base + best]))
+
+    remapped = []
+    for (frame_palette, indices), keys in zip(frames, key_indices):
+        table = bytearray(256)
+        for i, c in enumerate(frame_palette):
+            if i in keys:
+                table[i] = key_lookup[c]
+            elif c in normal_lookup:
+                table[i] = normal_lookup[c]
+        remapped.append(bytes(indices).translate(bytes(table)))
+    return palette, remapped, lossless, max_error
+
+
+# ---------------------------------------------------------------------------
+# v2 写出
+# ---------------------------------------------------------------------------
+
+def align4(n):
+    return (n + 3) & ~3
+
+
+def encode_pixels(pixels, compression):
+    return rle_encode_row(pixels) if compression == COMPRESSION_RLE else bytes(pixels)
+
+
+def encode_frame(indices, width, height, compression):
+    rows = []
+    for y in range(height):
+        rows.append(encode_pixels(indices[y * width:(y + 1) * width], compression))
+    table_size = (height + 1) * 4
+    offsets = [table_size]
+    for row in rows:
+        offsets.append(offsets[-1] + len(row))
+    return struct.pack(f'<{height + 1}I', *offsets) + b''.join(rows)
+
+
+def diff_spans(base, indices, width, height):
+    """base -> indices 的变化区间 [(y, x, length)]"""
+    spans = []
+    for y in range(height):
+        row_start = y * width
+        x = 0
+        current = None
+        while x < width:
+            if base[row_start + x] != indices[row_start + x]:
+                if current is not None and x - (current[0] + current[1]) <= SPAN_MERGE_GAP:
+                    current[1] = x + 1 - current[0]
+                else:
+                    if current is not None:
+                        spans.append((y, current[0], current[1]))
+                    current = [x, 1]
+            x += 1
+        if current is not None:
+            spans.append((y, current[0], current[1]))
+    return spans
+
+
+def encode_delta(base, indices, width, height, compression):
+    spans = diff_spans(base, indices, width, height)
+    out = bytearray(struct.pack('<HH', len(spans), 0))
+    for y, x, length in spans:
+        start = y * width + x
+        out += struct.pack('<HHH', y, x, length)
+        out += encode_pixels(indices[start:start + length], compression)
+    return bytes(out)
+
+
+def build_section(width, height, colors, palettes, frames, compression, groups=None):
+    """palettes: [[rgb565]], frames: [(palette_idx, indices)]
+    groups: 帧间差分时为动画列表 [(name, [frame...], loop)], 否则 None"""
+    palette_offset = HEADER_SIZE
+    palette_bytes = b''.join(struct.pack(f'<{colors}H', *p[:colors]) for p in palettes)
+    frame_offset = palette_offset + len(palette_bytes)
+
+    # 每帧选关键帧或相对上一帧的差分 (同一调色板且更小时), 以及循环回首帧的额外差分
+    blobs = [encode_frame(indices, width, height, compression) for _, indices in frames]
+    bases = [NO_FRAME] * len(frames)
+    extras = []     # [(frame, base, blob)]
+    if groups is not None:
+        depth = [0] * len(frames)
+        for _, group, loop in groups:
+            for prev, f in zip(group, group[1:]):
+                if frames[prev][0] != frames[f][0] or depth[prev] + 1 >= MAX_DELTA_CHAIN:
+                    continue
+                delta = encode_delta(frames[prev][1], frames[f][1], width, height, compression)
+                if len(delta) < len(blobs[f]):
+                    blobs[f], bases[f], depth[f] = delta, prev, depth[prev] + 1
+            first, last = group[0], group[-1]
+            if loop and first != last and frames[first][0] == frames[last][0]:
+                delta = encode_delta(frames[last][1], frames[first][1], width, height, compression)
+                if len(delta) < len(blobs[first]):
+                    extras.append((first, last, delta))
+
+    data_offset = align4(frame_offset + (len(frames) + len(extras)) * FRAME_ENTRY_SIZE)
+    table = bytearray()
+    data = bytearray()
+    entries = [(palette_idx, bases[f], blobs[f]) for f, (palette_idx, _) in enumerate(frames)]
+    entries += [(frame, base, blob) for frame, base, blob in extras]
+    for field, base, blob in entries:
+        table += struct.pack('<IIHH', data_offset + len(data), len(blob), field,
+                             base if groups is not None else 0)
+        data += blob
+        data += b'\x00' * (align4(len(data)) - len(data))
+
+    data_size = data_offset + len(data)
+    header = MAGIC + struct.pack('<HBBHHHHHHIII', VERSION, compression,
+                                 FLAG_DELTA if groups is not None else 0, width, height,
+                                 len(frames), len(palettes), colors, len(extras),
+                                 palette_offset, frame_offset, data_size)
+    assert len(header) == HEADER_SIZE
+    section = bytearray(header + palette_bytes + table)
+    section += b'\x00' * (data_offset - len(section))
+    section += data
+    if groups is not None:
+        delta_frames = sum(1 for b in bases if b != NO_FRAME)
+        delta_bytes = sum(len(blobs[f]) for f in range(len(frames)) if bases[f] != NO_FRAME)
+        key_bytes = sum(len(blobs[f]) for f in range(len(frames)) if bases[f] == NO_FRAME)
+        print(f"  差分: {delta_frames} 帧 (平均 {delta_bytes // max(delta_frames, 1):,} 字节), "
+              f"关键帧 {len(frames) - delta_frames} 帧 (平均 {key_bytes // max(len(frames) - delta_frames, 1):,} 字节), "
+              f"循环差分 {len(extras)} 条")
+    return bytes(section)
+
+
+def decode_pixels(data, pos, width, compression):
+    if compression == COMPRESSION_RLE:
+        return rle_decode_row(data, pos, width)
+    return data[pos:pos + width], pos + width
+
+
+def apply_delta(data, offset, size, pixels, width, height, compression):
+    (span_count, _) = struct.unpack_from('<HH', data, offset)
+    pos = offset + 4
+    for _ in range(span_count):
+        y, x, length = struct.unpack_from('<HHH', data, pos)
+        if y >= height or length == 0 or x + length > width:
+            raise ValueError("差分区间越界")
+        span, pos = decode_pixels(data, pos + SPAN_HEADER_SIZE, length, compression)
+        start = y * width + x
+        pixels[start:start + length] = span
+    if pos != offset + size:
+        raise ValueError("差分长度与帧表不符")
+
+
+def decode_section(data):
+    """解析 v2 段, 返回 (width, height, [(palette, indices)], data_size)
+    额外的循环差分也会解码, 并检查结果与目标帧一致"""
+    if data[:4] != MAGIC:
+        raise ValueError("不是 v2 资源段")
+    (version, compression, flags, width, height, frame_count, palette_count, colors, delta_count,
+     palette_offset, frame_offset, data_size) = struct.unpack_from('<HBBHHHHHHIII', data, 4)
+    if not flags & FLAG_DELTA:
+        delta_count = 0
+    palettes = [list(struct.unpack_from(f'<{colors}H', data, palette_offset + p * colors * 2))
+                for p in range(palette_count)]
+    entries = [struct.unpack_from('<IIHH', data, frame_offset + e * FRAME_ENTRY_SIZE)
+               for e in range(frame_count + delta_count)]
+
+    decoded = {}
+
+    def decode_key(f, offset):
+        row_offsets = struct.unpack_from(f'<{height + 1}I', data, offset)
+        indices = bytearray()
+        for y in range(height):
+            pos = offset + row_offsets[y]
+            row, end = decode_pixels(data, pos, width, compression)
+            if end != offset + row_offsets[y + 1]:
+                raise ValueError(f"帧 {f} 第 {y} 行长度与行偏移表不符")
+            indices += row
+        return bytes(indices)
+
+    def decode(f, depth=0):
+        if f in decoded:
+            return decoded[f]
+        offset, size, _, base = entries[f]
+        if not flags & FLAG_DELTA or base == NO_FRAME:
+            indices = decode_key(f, offset)
+        else:
+            if depth >= MAX_DELTA_CHAIN:
+                raise ValueError(f"帧 {f} 的差分链过长")
+            pixels = bytearray(decode(base, depth + 1))
+            apply_delta(data, offset, size, pixels, width, height, compression)
+            indices = bytes(pixels)
+        decoded[f] = indices
+        return indices
+
+    frames = [(palettes[entries[f][2]], decode(f)) for f in range(frame_count)]
+    for e in range(frame_count, frame_count + delta_count):
+        offset, size, frame, base = entries[e]
+        pixels = bytearray(decode(base))
+        apply_delta(data, offset, size, pixels, width, height, compression)
+        if bytes(pixels) != decode(frame):
+            raise ValueError(f"循环差分 {base} -> {frame} 与目标帧不一致")
+    return width, height, frames, data_size
+
+
+def verify(section, source_frames, label, lossless):
+    width, height, frames, _ = decode_section(section)
+    if len(frames) != len(source_frames):
+        raise ValueError(f"{label}: 帧数不符")
+    worst = 0
+    for f, ((palette, indices), (src_palette, src_indices)) in enumerate(zip(frames, source_frames)):
+        for i in range(len(src_indices)):
+            a = palette[indices[i]]
+            b = src_palette[src_indices[i]]
+            if a != b:
+                if lossless:
+                    raise ValueError(f"{label}: 帧 {f} 像素 {i} 不一致 (0x{a:04X} != 0x{b:04X})")
+                worst = max(worst, color_distance(a, b))
+    print(f"  校验 {label}: OK" + (f" (最大颜色误差 {worst})" if not lossless else " (RGB565 逐像素一致)"))
+
+
+# ---------------------------------------------------------------------------
+
+def pack_animations(args, compression):
+    index = json.load(open(args.index, encoding='utf-8'))
+    width, height, colors = index['width'], index['height'], index['colors']
+    frames = read_v1(args.frames, width, height, colors)
+    print(f"\n[动画] {args.frames}: {len(frames)} 帧 {width}x{height}")
+
+    # 没有归入任何动画的帧各自一组
+    groups = []
+    covered = set()
+    for anim in index['animations']:
+        group = list(range(anim['start'], min(anim['start'] + anim['count'], len(frames))))
+        if group:
+            groups.append((anim['name'], group, anim.get('loop', True)))
+            covered.update(group)
+    for f in range(len(frames)):
+        if f not in covered:
+            groups.append((f"frame{f}", [f], False))
+    groups.sort(key=lambda g: g[1][0])
+
+    palettes = []
+    packed = []
+    if args.per_frame_palette:
+        for i, (palette, indices) in enumerate(frames):
+            palettes.append(palette)
+            packed.append((i, indices))
+        lossless_all = True
+    else:
+        lossless_all = True
+        packed = [None] * len(frames)
+        for name, group, _ in groups:
+            keys = []
+            for f in group:
+                k = {0}
+                if f < len(index.get('frames', [])):
+                    k.add(index['frames'][f]['bg_color_index'])
+                keys.append(k)
+            palette, remapped, lossless, max_error = build_shared_palette(
+                [frames[f] for f in group], keys, colors)
+            lossless_all &= lossless
+            for f, indices in zip(group, remapped):
+                packed[f] = (len(palettes), indices)
+            palettes.append(palette)
+            print(f"  {name}: {len(group)} 帧共用调色板, " +
+                  ("无损" if lossless else f"减色 (最大颜色误差 {max_error})"))
+
+    section = build_section(width, height, colors, palettes, packed, compression,
+                            groups if args.delta else None)
+    if args.verify:
+        verify(section, frames, "动画", lossless_all)
+    return section, len(frames) * (colors * 3 + width * height)
+
+
+def pack_simple(path, width, height, colors, label, compression, verify_section):
+    frames = read_v1(path, width, height, colors)
+    print(f"\n[{label}] {path}: {len(frames)} 帧 {width}x{height}")
+    section = build_section(width, height, colors, [p for p, _ in frames],
+                            [(i, indices) for i, (_, indices) in enumerate(frames)], compression)
+    if verify_section:
+        verify(section, frames, label, True)
+    return section, len(frames) * (colors * 3 + width * height)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="v1 资源转换为 asset pack v2")
+    parser.add_argument('--frames', default='gifs/frames.bin')
+    parser.add_argument('--index', default='gifs/index.json')
+    parser.add_argument('--backgrounds', default='gifs/backgrounds.bin')
+    parser.add_argument('--items', default='gifs/items/frames.bin')
+    parser.add_argument('--bg-size', default='280x240')
+    parser.add_argument('--item-size', default='40x40')
+    parser.add_argument('--item-colors', type=int, default=255)
+    parser.add_argument('-o', '--output', default='gifs/assets_v2.bin')
+    parser.add_argument('--raw', action='store_true', help="行数据不压缩 (仍使用 v2 文件头和共享调色板)")
+    parser.add_argument('--per-frame-palette', action='store_true', help="动画保留每帧调色板 (无损)")
+    parser.add_argument('--verify', action='store_true', help="解码输出并与输入逐像素比对")
+    parser.add_argument('--delta', action='store_true', help="动画帧间差分 (关键帧 + 变化区间, 含循环差分)")
+    args = parser.parse_args()
+
+    compression = COMPRESSION_RAW if args.raw else COMPRESSION_RLE
+    sections = []
+
+    if not os.path.exists(args.frames):
+        print(f"错误: {args.frames} 不存在")
+        sys.exit(1)
+    sections.append(("动画",) + pack_animations(args, compression))
+
+    bg_w, bg_h = (int(v) for v in args.bg_size.split('x'))
+    if os.path.exists(args.backgrounds):
+        sections.append(("背景",) + pack_simple(args.backgrounds, bg_w, bg_h, 256, "背景",
+                                                compression, args.verify))
+    else:
+        print(f"\n[背景] 跳过: {args.backgrounds} 不存在")
+
+    item_w, item_h = (int(v) for v in args.item_size.split('x'))
+    if os.path.exists(args.items):
+        sections.append(("物品",) + pack_simple(args.items, item_w, item_h, args.item_colors, "物品",
+                                                compression, args.verify))
+    else:
+        print(f"\n[物品] 跳过: {args.items} 不存在")
+
+    with open(args.output, 'wb') as f:
+        for _, section, _ in sections:
+            f.write(section)
+
+    print("\n" + "=" * 60)
+    print(f"输出: {args.output} ({'RLE' if compression == COMPRESSION_RLE else 'raw'})")
+    total_v1 = total_v2 = 0
+    for label, section, v1_size in sections:
+        total_v1 += v1_size
+        total_v2 += len(section)
+        print(f"  {label}: {v1_size:,} -> {len(section):,} 字节 ({len(section) / v1_size * 100:.1f}%)")
+    print(f"  合计: {total_v1:,} -> {total_v2:,} 字节 ({total_v2 / total_v1 * 100:.1f}%)")
+    print("解码速度: g++ -O2 -std=c++17 -Imain/images scripts/asset_pack_bench.cc -o asset_pack_bench && "
+          f"./asset_pack_bench {args.output}")
+
+
+if __name__ == '__main__':
+    main()
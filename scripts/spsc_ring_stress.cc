@@ -0,0 +1,373 @@
+/*
+ * SpscRing 压力测试与延迟直方图 (main/audio/spsc_ring.h)
+ *
+ * 1. 压力测试: 一个生产者、一个消费者、一个反复调用 RequestClear() 的线程和一个读 Size() 的线程
+ *    同时运行, 元素为带序号的 std::unique_ptr (与 AudioService 的队列相同)。检查:
+ *    - 弹出的序号严格递增 (不重复、不乱序);
+ *    - 每个元素恰好析构一次, 结束时没有泄漏;
+ *    - 未被弹出的 (被丢弃的) 元素都是在某次 RequestClear() 返回之前压入的;
+ *    - Size() 始终不超过容量。
+ *    两个生产者模式 (--producers 2) 按 AudioService::PushTaskToEncodeQueue 的做法用互斥锁串行化
+ *    生产者 (AFE 输出任务 + 输入任务的音频测试路径), 检查各生产者自己的序号仍然有序。
+ * 2. 延迟: 生产者按固定间隔压入带时间戳的元素, 消费者弹出时记录 push -> pop 的延迟, 输出 log2
+ *    直方图和 p50 / p99 / p99.9 / 最大值。对比改动前的 std::deque + std::mutex +
+ *    std::condition_variable 队列。消费者为忙等 (spin) 或让出 CPU (yield); 设备上消费者由任务
+ *    通知唤醒, 唤醒本身的延迟不在这里计入。
+ *
+ * 编译 (在仓库根目录), 建议另外各用 ThreadSanitizer / AddressSanitizer 编一次运行压力测试:
+ *   g++ -O2 -std=c++17 -pthread -Imain/audio scripts/spsc_ring_stress.cc -o spsc_ring_stress
+ *   g++ -O1 -g -std=c++17 -pthread -fsanitize=thread -Imain/audio scripts/spsc_ring_stress.cc -o spsc_ring_stress_tsan
+ *
+ * 使用方法:
+ *   ./spsc_ring_stress [--items N] [--producers 1|2] [--latency-items N]
+ * 检查失败时返回 1。
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+#define STRESS_CAPACITY     16      // Same order as the AudioService rings
+#define LATENCY_CAPACITY    16
+#define HISTOGRAM_BUCKETS   32
+
+namespace {
+
+// ========== Stress test ==========
+
+struct Tracker {
+    std::vector<std::atomic<uint8_t>> destroyed;
+    std::vector<std::atomic<uint8_t>> popped;
+    std::atomic<uint64_t> live{0};
+
+    explicit Tracker(size_t count) : destroyed(count), popped(count) {}
+};
+
+struct Item {
+    Tracker* tracker;
+    uint32_t producer;
+    uint64_t seq;           // Global push order
+    uint64_t producer_seq;  // Per producer
+
+    Item(Tracker* t, uint32_t p, uint64_t s, uint64_t ps) : tracker(t), producer(p), seq(s), producer_seq(ps) {
+        tracker->live++;
+    }
+    ~Item() {
+        tracker->destroyed[seq]++;
+        tracker->live--;
+    }
+};
+
+using ItemRing = SpscRing<std::unique_ptr<Item>, STRESS_CAPACITY>;
+
+struct ClearEvent {
+    uint64_t pushed_after;  // Value of pushed read after RequestClear() returned
+};
+
+bool RunStress(uint64_t items, int producers) {
+    Tracker tracker(items);
+    ItemRing ring;
+    std::mutex push_mutex;                  // Serializes producers, as encode_push_mutex_
+    std::atomic<uint64_t> next_seq{0};      // Next global seq, taken under push_mutex
+    std::atomic<uint64_t> pushed{0};        // Items whose Push() has returned
+    std::atomic<int> producers_running{producers};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> failed{false};
+    std::vector<ClearEvent> clears;
+    std::atomic<size_t> max_size{0};
+
+    auto fail = [&](const char* what, uint64_t value) {
+        if (!failed.exchange(true)) {
+            fprintf(stderr, "FAIL: %s (%llu)\n", what, (unsigned long long)value);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            uint64_t producer_seq = 0;
+            while (true) {
+                std::unique_lock<std::mutex> lock(push_mutex, std::defer_lock);
+                if (producers > 1) {
+                    lock.lock();
+                }
+                uint64_t seq = next_seq.load(std::memory_order_relaxed);
+                if (seq >= items) {
+                    break;
+                }
+                auto item = std::make_unique<Item>(&tracker, p, seq, producer_seq);
+                while (!ring.Push(std::move(item))) {
+                    std::this_thread::yield();
+                }
+                next_seq.store(seq + 1, std::memory_order_relaxed);
+                pushed.store(seq + 1, std::memory_order_release);
+                producer_seq++;
+            }
+            producers_running--;
+        });
+    }
+
+    threads.emplace_back([&] {
+        std::vector<uint64_t> last_producer_seq(producers, 0);
+        std::vector<bool> seen_producer(producers, false);
+        uint64_t last_seq = 0;
+        bool any = false;
+        std::unique_ptr<Item> item;
+        while (true) {
+            bool done = producers_running.load() == 0;
+            if (!ring.Pop(item)) {
+                if (done && ring.Empty()) {
+                    break;
+                }
+                continue;
+            }
+            if (any && item->seq <= last_seq) {
+                fail("popped out of order", item->seq);
+            }
+            uint32_t p = item->producer;
+            if (seen_producer[p] && item->producer_seq <= last_producer_seq[p]) {
+                fail("producer order broken", item->seq);
+            }
+            seen_producer[p] = true;
+            last_producer_seq[p] = item->producer_seq;
+            last_seq = item->seq;
+            any = true;
+            tracker.popped[item->seq] = 1;
+            item.reset();
+        }
+        ring.Clear();
+    });
+
+    std::thread clearer([&] {
+        uint32_t rng = 12345;
+        while (!stop.load()) {
+            rng = rng * 1103515245 + 12345;
+            std::this_thread::sleep_for(std::chrono::microseconds(20 + (rng >> 16) % 200));
+            ring.RequestClear();
+            clears.push_back({ pushed.load(std::memory_order_acquire) });
+        }
+    });
+
+    std::thread sizer([&] {
+        while (!stop.load()) {
+            size_t size = ring.Size();
+            if (size > ring.Capacity()) {
+                fail("Size() above capacity", size);
+            }
+            if (size > max_size.load()) {
+                max_size = size;
+            }
+        }
+    });
+
+    for (auto& t : threads) {
+        t.join();
+    }
+    stop = true;
+    clearer.join();
+    sizer.join();
+
+    uint64_t dropped = 0;
+    uint64_t latest_clear = 0;
+    for (const auto& c : clears) {
+        latest_clear = std::max(latest_clear, c.pushed_after);
+    }
+    for (uint64_t seq = 0; seq < items; seq++) {
+        if (tracker.destroyed[seq] != 1) {
+            fail("item not destroyed exactly once", seq);
+            break;
+        }
+        if (!tracker.popped[seq]) {
+            dropped++;
+            // Pushed after the last RequestClear() returned: must have been popped.
+            // One push may be inside Push() (head_ advanced, pushed not yet) when
+            // the clear reads head_, so seq == pushed_after can still be dropped
+            if (seq > latest_clear) {
+                fail("item pushed after the last clear was dropped", seq);
+                break;
+            }
+        }
+    }
+    if (tracker.live != 0) {
+        fail("items leaked", tracker.live.load());
+    }
+
+    printf("stress: %d producer(s), %llu items, %zu clears, %llu dropped, max Size() %zu: %s\n", producers,
+           (unsigned long long)items, clears.size(), (unsigned long long)dropped, max_size.load(),
+           failed ? "FAIL" : "ok");
+    return !failed;
+}
+
+// ========== Latency ==========
+
+uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Stamped {
+    uint64_t push_ns = 0;
+};
+
+// Before: std::deque behind one mutex and condition variable
+class LockedQueue {
+public:
+    bool Push(std::unique_ptr<Stamped>&& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= LATENCY_CAPACITY) {
+                return false;
+            }
+            queue_.push_back(std::move(item));
+        }
+        cv_.notify_all();
+        return true;
+    }
+
+    bool Pop(std::unique_ptr<Stamped>& item, bool block) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (block) {
+            cv_.wait_for(lock, std::chrono::milliseconds(1), [this] { return !queue_.empty(); });
+        }
+        if (queue_.empty()) {
+            return false;
+        }
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Stamped>> queue_;
+};
+
+class RingQueue {
+public:
+    bool Push(std::unique_ptr<Stamped>&& item) { return ring_.Push(std::move(item)); }
+    bool Pop(std::unique_ptr<Stamped>& item, bool) { return ring_.Pop(item); }
+
+private:
+    SpscRing<std::unique_ptr<Stamped>, LATENCY_CAPACITY> ring_;
+};
+
+enum class Wait { kSpin, kYield, kBlock };
+
+struct Histogram {
+    uint64_t buckets[HISTOGRAM_BUCKETS] = {};   // Bucket b: [2^b, 2^(b+1)) ns
+    std::vector<uint64_t> samples;
+
+    void Add(uint64_t ns) {
+        int b = 0;
+        while (b < HISTOGRAM_BUCKETS - 1 && (ns >> (b + 1)) != 0) {
+            b++;
+        }
+        buckets[b]++;
+        samples.push_back(ns);
+    }
+
+    uint64_t Percentile(double p) {
+        size_t index = (size_t)(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    void Print(const char* name) {
+        printf("%-22s p50 %7llu ns  p99 %7llu ns  p99.9 %8llu ns  max %9llu ns\n", name,
+               (unsigned long long)Percentile(0.5), (unsigned long long)Percentile(0.99),
+               (unsigned long long)Percentile(0.999), (unsigned long long)Percentile(1.0));
+        uint64_t peak = *std::max_element(std::begin(buckets), std::end(buckets));
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            if (buckets[b] == 0) {
+                continue;
+            }
+            int bar = (int)(buckets[b] * 50 / peak);
+            printf("  %9llu ns+ %9llu |%.*s\n", (unsigned long long)(1ull << b), (unsigned long long)buckets[b],
+                   bar, "##################################################");
+        }
+    }
+};
+
+// The producer pushes one item every interval_ns, like a 60ms frame source sped up
+template <typename Queue>
+Histogram MeasureLatency(uint64_t items, Wait wait, uint64_t interval_ns) {
+    Queue queue;
+    Histogram histogram;
+    histogram.samples.reserve(items);
+
+    std::thread consumer([&] {
+        std::unique_ptr<Stamped> item;
+        for (uint64_t received = 0; received < items;) {
+            if (queue.Pop(item, wait == Wait::kBlock)) {
+                histogram.Add(NowNs() - item->push_ns);
+                received++;
+            } else if (wait == Wait::kYield) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t next = NowNs();
+    for (uint64_t i = 0; i < items; i++) {
+        while (NowNs() < next) {
+        }
+        next += interval_ns;
+        auto item = std::make_unique<Stamped>();
+        item->push_ns = NowNs();
+        while (!queue.Push(std::move(item))) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    return histogram;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t items = 2000000;
+    uint64_t latency_items = 200000;
+    int producers = 0;      // 0: run both modes
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--items") == 0 && i + 1 < argc) {
+            items = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--producers") == 0 && i + 1 < argc) {
+            producers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--latency-items") == 0 && i + 1 < argc) {
+            latency_items = strtoull(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--items N] [--producers 1|2] [--latency-items N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    if (producers == 0 || producers == 1) {
+        ok = RunStress(items, 1) && ok;
+    }
+    if (producers == 0 || producers == 2) {
+        ok = RunStress(items, 2) && ok;
+    }
+
+    if (latency_items > 0) {
+        printf("\npush -> pop latency, %llu items, one push every 2 us\n", (unsigned long long)latency_items);
+        MeasureLatency<RingQueue>(latency_items, Wait::kSpin, 2000).Print("SpscRing, spin");
+        MeasureLatency<RingQueue>(latency_items, Wait::kYield, 2000).Print("SpscRing, yield");
+        MeasureLatency<LockedQueue>(latency_items, Wait::kSpin, 2000).Print("deque+mutex, spin");
+        MeasureLatency<LockedQueue>(latency_items, Wait::kBlock, 2000).Print("deque+mutex+cv, wait");
+    }
+    return ok ? 0 : 1;
+}